@@ -0,0 +1,112 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson https://irlanrobson.github.io
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#include <benchmark/framework/benchmark.h>
+
+// The benchmark records the profile scopes into the built-in profiler.
+void b3BeginProfileScope(const char* name)
+{
+	if (b3_profiler)
+	{
+		b3_profiler->BeginScope(name);
+	}
+}
+
+void b3EndProfileScope()
+{
+	if (b3_profiler)
+	{
+		b3_profiler->EndScope();
+	}
+}
+
+b3Recorder* g_recorder = NULL;
+
+Benchmark::Benchmark()
+{
+	// The world must be empty when the recording starts.
+	m_world.SetRecorder(g_recorder);
+
+	m_groundHull.Set(50.0f, 1.0f, 50.0f);
+}
+
+Benchmark::~Benchmark()
+{
+}
+
+void Benchmark::Step(float32 dt, u32 velocityIterations, u32 positionIterations)
+{
+	m_world.Step(dt, velocityIterations, positionIterations);
+}
+
+GridClothMesh::GridClothMesh(u32 width, u32 height)
+{
+	vertexCount = (width + 1) * (height + 1);
+	vertices = new b3Vec3[vertexCount];
+	
+	u32 index = 0;
+	for (u32 i = 0; i <= height; ++i)
+	{
+		for (u32 j = 0; j <= width; ++j)
+		{
+			vertices[index++].Set(float32(j) - 0.5f * float32(width), 0.0f, float32(i) - 0.5f * float32(height));
+		}
+	}
+
+	triangleCount = 2 * width * height;
+	triangles = new b3ClothMeshTriangle[triangleCount];
+
+	index = 0;
+	for (u32 i = 0; i < height; ++i)
+	{
+		for (u32 j = 0; j < width; ++j)
+		{
+			u32 v1 = i * (width + 1) + j;
+			u32 v2 = (i + 1) * (width + 1) + j;
+			u32 v3 = (i + 1) * (width + 1) + (j + 1);
+			u32 v4 = i * (width + 1) + (j + 1);
+
+			b3ClothMeshTriangle* t1 = triangles + index++;
+			t1->v1 = v3;
+			t1->v2 = v2;
+			t1->v3 = v1;
+
+			b3ClothMeshTriangle* t2 = triangles + index++;
+			t2->v1 = v1;
+			t2->v2 = v4;
+			t2->v3 = v3;
+		}
+	}
+
+	gridMesh.startTriangle = 0;
+	gridMesh.triangleCount = triangleCount;
+	gridMesh.startVertex = 0;
+	gridMesh.vertexCount = vertexCount;
+
+	meshCount = 1;
+	meshes = &gridMesh;
+	sewingLineCount = 0;
+	sewingLines = nullptr;
+}
+
+GridClothMesh::~GridClothMesh()
+{
+	delete[] vertices;
+	delete[] triangles;
+}
@@ -0,0 +1,65 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson https://irlanrobson.github.io
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <bounce/bounce.h>
+
+// A scene stepped without a renderer. 
+// The scenes mirror the testbed tests of the same name. 
+// The size parameter scales the number of objects in a scene.
+class Benchmark
+{
+public:
+	Benchmark();
+	virtual ~Benchmark();
+
+	// Step the scene once.
+	virtual void Step(float32 dt, u32 velocityIterations, u32 positionIterations);
+
+	b3World m_world;
+
+	b3BoxHull m_groundHull;
+};
+
+// A grid cloth mesh with a size chosen at run time.
+struct GridClothMesh : public b3ClothMesh
+{
+	GridClothMesh(u32 width, u32 height);
+	~GridClothMesh();
+
+	b3ClothMeshMesh gridMesh;
+};
+
+struct BenchmarkEntry
+{
+	typedef Benchmark* (*BenchmarkCreate)(u32 size);
+	const char* name;
+	BenchmarkCreate create;
+	u32 defaultSize;
+};
+
+extern BenchmarkEntry g_benchmarks[];
+extern u32 g_benchmarkCount;
+
+// If not NULL, the worlds of the created scenes are recorded into this recorder.
+extern b3Recorder* g_recorder;
+
+#endif
@@ -0,0 +1,52 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson https://irlanrobson.github.io
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <benchmark/framework/benchmark.h>
+#include <benchmark/scenes/pyramids.h>
+#include <benchmark/scenes/jenga.h>
+#include <benchmark/scenes/tumbler.h>
+#include <benchmark/scenes/sheet_stack.h>
+#include <benchmark/scenes/smash_softbody.h>
+#include <benchmark/scenes/table_cloth.h>
+#include <benchmark/scenes/cloth_self_collision.h>
+
+BenchmarkEntry g_benchmarks[] =
+{
+	{ "pyramids", &PyramidsBenchmark::Create, 10 },
+	{ "jenga", &JengaBenchmark::Create, 20 },
+	{ "tumbler", &TumblerBenchmark::Create, 100 },
+	{ "sheet_stack", &SheetStackBenchmark::Create, 10 },
+	{ "smash_softbody", &SmashSoftBodyBenchmark::Create, 1 },
+	{ "table_cloth", &TableClothBenchmark::Create, 10 },
+	{ "cloth_self_collision", &ClothSelfCollisionBenchmark::Create, 10 },
+	{ NULL, NULL, 0 }
+};
+
+//
+static u32 BenchmarkCount()
+{
+	u32 count = 0;
+	while (g_benchmarks[count].create != NULL)
+	{
+		++count;
+	}
+	return count;
+}
+
+// Count the benchmarks
+u32 g_benchmarkCount = BenchmarkCount();
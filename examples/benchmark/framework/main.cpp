@@ -0,0 +1,372 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson https://irlanrobson.github.io
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <benchmark/framework/benchmark.h>
+#include <common/benchmark_utils.h>
+
+// The settings of a benchmark run.
+struct Settings
+{
+	Settings()
+	{
+		frameCount = 600;
+		warmupCount = 0;
+		threadCount = 1;
+		hertz = 60.0f;
+		velocityIterations = 8;
+		positionIterations = 2;
+		output = NULL;
+		record = NULL;
+	}
+
+	std::vector<const char*> scenes;
+	std::vector<u32> sizes;
+	u32 frameCount;
+	u32 warmupCount;
+	u32 threadCount;
+	float32 hertz;
+	u32 velocityIterations;
+	u32 positionIterations;
+	const char* output;
+	const char* record;
+};
+
+// A profile scope accumulated over the measured frames.
+struct Phase
+{
+	const char* name;
+	u32 callCount;
+	float64 time;
+};
+
+static void PrintUsage()
+{
+	printf("Usage: benchmark [options]\n");
+	printf("  --scene <name>           Run a scene. Can be repeated. Runs all scenes by default.\n");
+	printf("  --sizes <n,n,...>        Scene sizes. Uses the default size of each scene by default.\n");
+	printf("  --frames <n>             Number of measured steps. Default is 600.\n");
+	printf("  --warmup <n>             Number of steps before measuring. Default is 0.\n");
+	printf("  --threads <n>            Number of scheduler threads. Default is 1.\n");
+	printf("  --hertz <n>              Step frequency. Default is 60.\n");
+	printf("  --velocity-iterations <n>\n");
+	printf("  --position-iterations <n>\n");
+	printf("  --output <file>          Write the JSON report to a file instead of stdout.\n");
+	printf("  --record <file>          Record the world of a single run into a log for the replay program.\n");
+	printf("  --list                   List the scenes.\n");
+	printf("Scenes:\n");
+	for (u32 i = 0; i < g_benchmarkCount; ++i)
+	{
+		printf("  %s (default size %d)\n", g_benchmarks[i].name, g_benchmarks[i].defaultSize);
+	}
+}
+
+static bool ParseArgs(Settings* settings, int argc, char** argv)
+{
+	ArgReader args(argc, argv);
+	while (args.Next())
+	{
+		if (args.Is("--list") || args.Is("--help"))
+		{
+			return false;
+		}
+
+		const char* value = args.ReadValue();
+		if (value == NULL)
+		{
+			return false;
+		}
+
+		if (args.Is("--scene"))
+		{
+			settings->scenes.push_back(value);
+		}
+		else if (args.Is("--sizes"))
+		{
+			if (ParseSizeList(&settings->sizes, value) == false)
+			{
+				return false;
+			}
+		}
+		else if (args.Is("--frames"))
+		{
+			settings->frameCount = (u32)atoi(value);
+		}
+		else if (args.Is("--warmup"))
+		{
+			settings->warmupCount = (u32)atoi(value);
+		}
+		else if (args.Is("--threads"))
+		{
+			settings->threadCount = ParseThreadCount(value);
+		}
+		else if (args.Is("--hertz"))
+		{
+			settings->hertz = (float32)atof(value);
+		}
+		else if (args.Is("--velocity-iterations"))
+		{
+			settings->velocityIterations = (u32)atoi(value);
+		}
+		else if (args.Is("--position-iterations"))
+		{
+			settings->positionIterations = (u32)atoi(value);
+		}
+		else if (args.Is("--output"))
+		{
+			settings->output = value;
+		}
+		else if (args.Is("--record"))
+		{
+			settings->record = value;
+		}
+		else
+		{
+			printf("Unknown option %s\n", args.GetArg());
+			return false;
+		}
+	}
+
+	if (settings->frameCount == 0 || settings->hertz <= 0.0f)
+	{
+		printf("The number of frames and the frequency must be positive\n");
+		return false;
+	}
+
+	if (settings->record && (settings->scenes.size() != 1 || settings->sizes.size() > 1))
+	{
+		printf("Recording requires a single scene and size\n");
+		return false;
+	}
+
+	return true;
+}
+
+static const BenchmarkEntry* FindBenchmark(const char* name)
+{
+	for (u32 i = 0; i < g_benchmarkCount; ++i)
+	{
+		if (strcmp(g_benchmarks[i].name, name) == 0)
+		{
+			return g_benchmarks + i;
+		}
+	}
+	return NULL;
+}
+
+// Step a scene and write its results as a JSON object.
+static void Run(FILE* file, const Settings& settings, b3TaskScheduler* scheduler, const BenchmarkEntry* entry, u32 size)
+{
+	fprintf(stderr, "Running %s (size %d)\n", entry->name, size);
+
+	Benchmark* benchmark = entry->create(size);
+	benchmark->m_world.SetTaskScheduler(scheduler);
+
+	float32 dt = 1.0f / settings.hertz;
+
+	for (u32 i = 0; i < settings.warmupCount; ++i)
+	{
+		benchmark->Step(dt, settings.velocityIterations, settings.positionIterations);
+	}
+
+	b3Profiler profiler;
+	b3_profiler = &profiler;
+
+	std::vector<float64> stepTimes;
+	stepTimes.reserve(settings.frameCount);
+
+	std::vector<Phase> phases;
+
+	for (u32 i = 0; i < settings.frameCount; ++i)
+	{
+		profiler.BeginFrame();
+
+		b3Time timer;
+		benchmark->Step(dt, settings.velocityIterations, settings.positionIterations);
+		timer.Update();
+
+		profiler.EndFrame();
+
+		stepTimes.push_back(timer.GetElapsedMilis());
+
+		// Accumulate the profile scopes of this frame.
+		const b3ProfilerScope* scopes = profiler.GetScopes();
+		for (u32 j = 0; j < profiler.GetScopeCount(); ++j)
+		{
+			const b3ProfilerScope* scope = scopes + j;
+
+			Phase* phase = NULL;
+			for (u32 k = 0; k < phases.size(); ++k)
+			{
+				if (phases[k].name == scope->name)
+				{
+					phase = &phases[k];
+					break;
+				}
+			}
+
+			if (phase == NULL)
+			{
+				Phase newPhase;
+				newPhase.name = scope->name;
+				newPhase.callCount = 0;
+				newPhase.time = 0.0;
+				phases.push_back(newPhase);
+				phase = &phases.back();
+			}
+
+			phase->callCount += scope->callCount;
+			phase->time += scope->time;
+		}
+	}
+
+	b3_profiler = NULL;
+
+	float64 frameCount = float64(settings.frameCount);
+
+	const b3World& world = benchmark->m_world;
+
+	fprintf(file, "\t\t{\n");
+	fprintf(file, "\t\t\t\"scene\": \"%s\",\n", entry->name);
+	fprintf(file, "\t\t\t\"size\": %d,\n", size);
+	fprintf(file, "\t\t\t\"bodies\": %d,\n", world.GetBodyList().m_count);
+	fprintf(file, "\t\t\t\"contacts\": %d,\n", world.GetContactList().m_count);
+	fprintf(file, "\t\t\t\"step\": ");
+	WriteStepTimes(file, stepTimes);
+	fprintf(file, ",\n");
+	fprintf(file, "\t\t\t\"phases\": [\n");
+	for (u32 i = 0; i < phases.size(); ++i)
+	{
+		const Phase& phase = phases[i];
+		fprintf(file, "\t\t\t\t{ \"name\": \"%s\", \"calls\": %f, \"mean\": %f, \"total\": %f }%s\n", 
+			phase.name, float64(phase.callCount) / frameCount, phase.time / frameCount, phase.time, 
+			i + 1 < phases.size() ? "," : "");
+	}
+	fprintf(file, "\t\t\t]\n");
+	fprintf(file, "\t\t}");
+
+	delete benchmark;
+}
+
+// This program steps the benchmark scenes without a renderer and 
+// reports the step times and the time spent in each profile scope as JSON. 
+// All times are in milliseconds.
+int main(int argc, char** argv)
+{
+	Settings settings;
+	if (ParseArgs(&settings, argc, argv) == false)
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	std::vector<const BenchmarkEntry*> entries;
+	if (settings.scenes.empty())
+	{
+		for (u32 i = 0; i < g_benchmarkCount; ++i)
+		{
+			entries.push_back(g_benchmarks + i);
+		}
+	}
+	else
+	{
+		for (u32 i = 0; i < settings.scenes.size(); ++i)
+		{
+			const BenchmarkEntry* entry = FindBenchmark(settings.scenes[i]);
+			if (entry == NULL)
+			{
+				printf("Unknown scene %s\n", settings.scenes[i]);
+				PrintUsage();
+				return 1;
+			}
+			entries.push_back(entry);
+		}
+	}
+
+	FILE* file = OpenReport(settings.output);
+	if (file == NULL)
+	{
+		return 1;
+	}
+
+	b3Recorder recorder;
+	if (settings.record)
+	{
+		g_recorder = &recorder;
+	}
+
+	b3TaskScheduler* scheduler = NULL;
+	if (settings.threadCount > 1)
+	{
+		scheduler = new b3WorkStealingTaskScheduler(settings.threadCount);
+	}
+
+	fprintf(file, "{\n");
+	fprintf(file, "\t\"version\": \"%d.%d.%d\",\n", b3_version.major, b3_version.minor, b3_version.revision);
+	fprintf(file, "\t\"frames\": %d,\n", settings.frameCount);
+	fprintf(file, "\t\"warmup\": %d,\n", settings.warmupCount);
+	fprintf(file, "\t\"threads\": %d,\n", settings.threadCount);
+	fprintf(file, "\t\"hertz\": %f,\n", settings.hertz);
+	fprintf(file, "\t\"velocityIterations\": %d,\n", settings.velocityIterations);
+	fprintf(file, "\t\"positionIterations\": %d,\n", settings.positionIterations);
+	fprintf(file, "\t\"results\": [\n");
+
+	bool first = true;
+	for (u32 i = 0; i < entries.size(); ++i)
+	{
+		const BenchmarkEntry* entry = entries[i];
+
+		std::vector<u32> sizes = settings.sizes;
+		if (sizes.empty())
+		{
+			sizes.push_back(entry->defaultSize);
+		}
+
+		for (u32 j = 0; j < sizes.size(); ++j)
+		{
+			if (first == false)
+			{
+				fprintf(file, ",\n");
+			}
+			first = false;
+
+			Run(file, settings, scheduler, entry, sizes[j]);
+		}
+	}
+
+	fprintf(file, "\n\t]\n");
+	fprintf(file, "}\n");
+
+	CloseReport(file);
+
+	delete scheduler;
+
+	if (settings.record)
+	{
+		g_recorder = NULL;
+
+		if (recorder.Save(settings.record) == false)
+		{
+			printf("Could not write %s\n", settings.record);
+			return 1;
+		}
+
+		fprintf(stderr, "Recorded %d steps into %s\n", recorder.GetStepCount(), settings.record);
+	}
+
+	return 0;
+}
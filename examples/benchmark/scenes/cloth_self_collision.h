@@ -0,0 +1,88 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson https://irlanrobson.github.io
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef CLOTH_SELF_COLLISION_BENCHMARK_H
+#define CLOTH_SELF_COLLISION_BENCHMARK_H
+
+// A cloth falling onto a capsule and folding onto itself. 
+// The size is the number of cells along each side of the cloth.
+class ClothSelfCollisionBenchmark : public Benchmark
+{
+public:
+	ClothSelfCollisionBenchmark(u32 cellCount) : m_clothMesh(cellCount, cellCount)
+	{
+		// Translate the mesh
+		for (u32 i = 0; i < m_clothMesh.vertexCount; ++i)
+		{
+			m_clothMesh.vertices[i].y += 5.0f;
+		}
+
+		// Create cloth
+		b3ClothDef def;
+		def.mesh = &m_clothMesh;
+		def.density = 1.0f;
+		def.streching = 100000.0f;
+		def.thickness = 0.2f;
+		def.friction = 0.3f;
+
+		m_cloth = new b3Cloth(def);
+
+		m_cloth->SetGravity(b3Vec3(0.0f, -9.8f, 0.0f));
+		m_cloth->SetWorld(&m_world);
+
+		{
+			b3BodyDef bd;
+			bd.type = e_staticBody;
+
+			b3Body* b = m_world.CreateBody(bd);
+
+			b3CapsuleShape capsuleShape;
+			capsuleShape.m_centers[0].Set(0.0f, 0.0f, -5.0f);
+			capsuleShape.m_centers[1].Set(0.0f, 0.0f, 5.0f);
+			capsuleShape.m_radius = 1.0f;
+
+			b3ShapeDef sd;
+			sd.shape = &capsuleShape;
+			sd.friction = 1.0f;
+
+			b->CreateShape(sd);
+		}
+	}
+
+	~ClothSelfCollisionBenchmark()
+	{
+		delete m_cloth;
+	}
+
+	void Step(float32 dt, u32 velocityIterations, u32 positionIterations)
+	{
+		Benchmark::Step(dt, velocityIterations, positionIterations);
+
+		m_cloth->Step(dt, velocityIterations, positionIterations);
+	}
+
+	static Benchmark* Create(u32 size)
+	{
+		return new ClothSelfCollisionBenchmark(size);
+	}
+
+	GridClothMesh m_clothMesh;
+	b3Cloth* m_cloth;
+};
+
+#endif
@@ -0,0 +1,106 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson https://irlanrobson.github.io
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef JENGA_BENCHMARK_H
+#define JENGA_BENCHMARK_H
+
+// A jenga tower. The size is the number of layers.
+class JengaBenchmark : public Benchmark
+{
+public:
+	enum
+	{
+		e_depthCount = 3,
+	};
+
+	JengaBenchmark(u32 layerCount)
+	{
+		{
+			b3BodyDef bd;
+			b3Body* body = m_world.CreateBody(bd);
+
+			b3HullShape hs;
+			hs.m_hull = &m_groundHull;
+
+			b3ShapeDef sd;
+			sd.shape = &hs;
+
+			body->CreateShape(sd);
+		}
+
+		b3Vec3 boxScale(1.0f, 0.5f, 3.0f);
+
+		b3Transform m;
+		m.rotation = b3Diagonal(boxScale.x, boxScale.y, boxScale.z);
+		m.position.SetZero();
+
+		m_boxHull.SetTransform(m);
+
+		float32 y = 2.0f;
+
+		for (u32 i = 0; i < layerCount; ++i)
+		{
+			// Alternate the direction of the layers.
+			bool rotate = (i % 2) == 1;
+			
+			for (u32 j = 0; j < e_depthCount; ++j)
+			{
+				b3BodyDef bd;
+				bd.type = b3BodyType::e_dynamicBody;
+
+				if (rotate)
+				{
+					bd.orientation.Set(b3Vec3(0.0f, 1.0f, 0.0f), 0.5f * B3_PI);
+
+					bd.position.x = 2.0f * boxScale.x;
+					bd.position.y = y;
+					bd.position.z = -2.0f * boxScale.x + 2.0f * float32(j) * boxScale.x;
+				}
+				else
+				{
+					bd.position.x = 2.0f * float32(j) * boxScale.x;
+					bd.position.y = y;
+					bd.position.z = 0.0f;
+				}
+				
+				b3Body* body = m_world.CreateBody(bd);
+
+				b3HullShape hs;
+				hs.m_hull = &m_boxHull;
+
+				b3ShapeDef sd;
+				sd.shape = &hs;
+				sd.density = 0.1f;
+				sd.friction = 0.3f;
+
+				body->CreateShape(sd);
+			}
+
+			y += 2.05f * boxScale.y;
+		}
+	}
+
+	static Benchmark* Create(u32 size)
+	{
+		return new JengaBenchmark(size);
+	}
+
+	b3BoxHull m_boxHull;
+};
+
+#endif
@@ -0,0 +1,82 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson https://irlanrobson.github.io
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef SHEET_STACK_BENCHMARK_H
+#define SHEET_STACK_BENCHMARK_H
+
+// A stack of thin sheets. The size is the number of sheets.
+class SheetStackBenchmark : public Benchmark
+{
+public:
+	SheetStackBenchmark(u32 sheetCount) : 
+		m_sheetExtents(4.05f, 2.0f * B3_LINEAR_SLOP, 4.05f), 
+		m_sheetHull(m_sheetExtents.x, m_sheetExtents.y, m_sheetExtents.z)
+	{
+		{
+			b3BodyDef bdef;
+			bdef.type = b3BodyType::e_staticBody;
+
+			b3Body* body = m_world.CreateBody(bdef);
+
+			b3HullShape hs;
+			hs.m_hull = &m_groundHull;
+
+			b3ShapeDef sdef;
+			sdef.shape = &hs;
+			sdef.friction = 1.0f;
+
+			body->CreateShape(sdef);
+		}
+		
+		b3Vec3 stackOrigin;
+		stackOrigin.Set(0.0f, 4.05f, 0.0f);
+
+		for (u32 i = 0; i < sheetCount; ++i)
+		{
+			b3BodyDef bdef;
+			bdef.type = b3BodyType::e_dynamicBody;
+
+			bdef.position.x = 0.0f;
+			bdef.position.y = float32(i) * 50.0f * m_sheetExtents.y;
+			bdef.position.z = 0.0f;
+			bdef.position += stackOrigin;
+
+			b3Body* body = m_world.CreateBody(bdef);
+
+			b3HullShape hs;
+			hs.m_hull = &m_sheetHull;
+
+			b3ShapeDef sdef;
+			sdef.shape = &hs;
+			sdef.density = 0.5f;
+			sdef.friction = 0.2f;
+			
+			body->CreateShape(sdef);
+		}
+	}
+
+	static Benchmark* Create(u32 size)
+	{
+		return new SheetStackBenchmark(size);
+	}
+
+	b3Vec3 m_sheetExtents;
+	b3BoxHull m_sheetHull;
+};
+
+#endif
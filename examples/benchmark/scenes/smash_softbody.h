@@ -0,0 +1,121 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson https://irlanrobson.github.io
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef SMASH_SOFTBODY_BENCHMARK_H
+#define SMASH_SOFTBODY_BENCHMARK_H
+
+// A box falling onto a plastic soft sphere. 
+// The size is the number of subdivisions of the sphere mesh.
+class SmashSoftBodyBenchmark : public Benchmark
+{
+public:
+	SmashSoftBodyBenchmark(u32 subdivisions)
+	{
+		m_mesh.SetAsSphere(2.0f, subdivisions);
+
+		for (u32 i = 0; i < m_mesh.vertexCount; ++i)
+		{
+			m_mesh.vertices[i].y += 3.0f;
+		}
+
+		// Create soft body
+		b3SoftBodyDef def;
+		def.mesh = &m_mesh;
+		def.density = 0.2f;
+		def.E = 100.0f;
+		def.nu = 0.33f;
+		def.c_yield = 0.6f;
+		def.c_creep = 1.0f;
+		def.c_max = 1.0f;
+
+		m_body = new b3SoftBody(def);
+
+		b3Vec3 gravity(0.0f, -9.8f, 0.0f);
+		m_body->SetGravity(gravity);
+		m_body->SetWorld(&m_world);
+
+		for (u32 i = 0; i < m_mesh.vertexCount; ++i)
+		{
+			b3SoftBodyNode* n = m_body->GetVertexNode(i);
+
+			n->SetRadius(0.05f);
+			n->SetFriction(0.2f);
+		}
+
+		// Create ground
+		{
+			b3BodyDef bd;
+			bd.type = e_staticBody;
+
+			b3Body* b = m_world.CreateBody(bd);
+
+			b3HullShape groundShape;
+			groundShape.m_hull = &m_groundHull;
+
+			b3ShapeDef sd;
+			sd.shape = &groundShape;
+			sd.friction = 0.3f;
+
+			b->CreateShape(sd);
+		}
+
+		// Create body
+		{
+			b3BodyDef bd;
+			bd.type = e_dynamicBody;
+			bd.position.y = 10.0f;
+
+			b3Body* b = m_world.CreateBody(bd);
+
+			m_boxHull.Set(5.0f, 1.0f, 5.0f);
+
+			b3HullShape boxShape;
+			boxShape.m_hull = &m_boxHull;
+
+			b3ShapeDef sd;
+			sd.shape = &boxShape;
+			sd.density = 0.1f;
+			sd.friction = 0.3f;
+
+			b->CreateShape(sd);
+		}
+	}
+
+	~SmashSoftBodyBenchmark()
+	{
+		delete m_body;
+	}
+
+	void Step(float32 dt, u32 velocityIterations, u32 positionIterations)
+	{
+		Benchmark::Step(dt, velocityIterations, positionIterations);
+
+		m_body->Step(dt, velocityIterations, positionIterations);
+	}
+
+	static Benchmark* Create(u32 size)
+	{
+		return new SmashSoftBodyBenchmark(size);
+	}
+
+	b3QSoftBodyMesh m_mesh;
+	b3SoftBody* m_body;
+	b3BoxHull m_boxHull;
+};
+
+#endif
@@ -0,0 +1,171 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson https://irlanrobson.github.io
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef BENCHMARK_UTILS_H
+#define BENCHMARK_UTILS_H
+
+#include <bounce/bounce.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <vector>
+
+// These helpers are shared by the programs that time the library 
+// and report the results as JSON.
+
+// Reads the arguments of a command line. 
+// An option is an argument that begins with -- followed by a value.
+class ArgReader
+{
+public:
+	ArgReader(int argc, char** argv)
+	{
+		m_argc = argc;
+		m_argv = argv;
+		m_index = 0;
+		m_next = 1;
+	}
+
+	// Advance to the next argument. 
+	// Return false if there are no more arguments.
+	bool Next()
+	{
+		m_index = m_next;
+		m_next = m_index + 1;
+		return m_index < m_argc;
+	}
+
+	// Get the current argument.
+	const char* GetArg() const
+	{
+		return m_argv[m_index];
+	}
+
+	// Is the current argument this one?
+	bool Is(const char* arg) const
+	{
+		return strcmp(m_argv[m_index], arg) == 0;
+	}
+
+	// Is the current argument an option?
+	bool IsOption() const
+	{
+		return strncmp(m_argv[m_index], "--", 2) == 0;
+	}
+
+	// Read the value of the current option. The next argument follows the value. 
+	// Print an error and return NULL if the value is missing.
+	const char* ReadValue()
+	{
+		if (m_index + 1 >= m_argc)
+		{
+			printf("Missing value for %s\n", m_argv[m_index]);
+			return NULL;
+		}
+
+		m_next = m_index + 2;
+		return m_argv[m_index + 1];
+	}
+private:
+	int m_argc;
+	char** m_argv;
+	int m_index;
+	int m_next;
+};
+
+// Parse a comma separated list of positive sizes.
+inline bool ParseSizeList(std::vector<u32>* sizes, const char* value)
+{
+	const char* s = value;
+	while (*s)
+	{
+		char* end;
+		u32 size = (u32)strtoul(s, &end, 10);
+		if (end == s || size == 0)
+		{
+			printf("Invalid size list %s\n", value);
+			return false;
+		}
+
+		sizes->push_back(size);
+
+		s = *end == ',' ? end + 1 : end;
+	}
+	return true;
+}
+
+// Parse a number of scheduler threads.
+inline u32 ParseThreadCount(const char* value)
+{
+	return b3Clamp((u32)atoi(value), 1u, u32(B3_MAX_THREADS));
+}
+
+// Open the file a report is written to. 
+// The report is written to stdout if the file name is NULL.
+inline FILE* OpenReport(const char* fileName)
+{
+	if (fileName == NULL)
+	{
+		return stdout;
+	}
+
+	FILE* file = fopen(fileName, "w");
+	if (file == NULL)
+	{
+		printf("Could not open %s\n", fileName);
+	}
+	return file;
+}
+
+// Close a file opened by OpenReport.
+inline void CloseReport(FILE* file)
+{
+	if (file != stdout)
+	{
+		fclose(file);
+	}
+}
+
+// Return the nearest-rank percentile of sorted values.
+inline float64 Percentile(const std::vector<float64>& values, float64 percent)
+{
+	u32 rank = (u32)ceil(0.01 * percent * float64(values.size()));
+	u32 index = rank > 0 ? rank - 1 : 0;
+	return values[b3Min(index, u32(values.size() - 1))];
+}
+
+// Sort step times and write their summary as a JSON object.
+inline void WriteStepTimes(FILE* file, std::vector<float64>& times)
+{
+	float64 totalTime = 0.0;
+	for (u32 i = 0; i < times.size(); ++i)
+	{
+		totalTime += times[i];
+	}
+
+	std::sort(times.begin(), times.end());
+
+	fprintf(file, "{ \"mean\": %f, \"min\": %f, \"p50\": %f, \"p90\": %f, \"p99\": %f, \"max\": %f, \"total\": %f }",
+		totalTime / float64(times.size()), times.front(), 
+		Percentile(times, 50.0), Percentile(times, 90.0), Percentile(times, 99.0), 
+		times.back(), totalTime);
+}
+
+#endif
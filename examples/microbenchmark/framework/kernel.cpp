@@ -0,0 +1,121 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson https://irlanrobson.github.io
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <microbenchmark/framework/kernel.h>
+
+// The kernels don't profile.
+void b3BeginProfileScope(const char* name)
+{
+	B3_NOT_USED(name);
+}
+
+void b3EndProfileScope()
+{
+}
+
+Random::Random(u32 seed)
+{
+	m_state = seed;
+}
+
+u32 Random::Next()
+{
+	// Xorshift
+	m_state ^= m_state << 13;
+	m_state ^= m_state >> 17;
+	m_state ^= m_state << 5;
+	return m_state;
+}
+
+float32 Random::Float(float32 a, float32 b)
+{
+	float32 x = float32(Next() & 0xFFFFFF) / float32(0xFFFFFF);
+	return a + x * (b - a);
+}
+
+b3Vec3 Random::Vec3(float32 a, float32 b)
+{
+	float32 x = Float(a, b);
+	float32 y = Float(a, b);
+	float32 z = Float(a, b);
+	return b3Vec3(x, y, z);
+}
+
+b3Quat Random::Rotation()
+{
+	b3Vec3 axis = Vec3(-1.0f, 1.0f);
+	if (b3Dot(axis, axis) < B3_EPSILON * B3_EPSILON)
+	{
+		axis.Set(0.0f, 1.0f, 0.0f);
+	}
+	axis.Normalize();
+
+	float32 angle = Float(-B3_PI, B3_PI);
+
+	return b3Quat(axis, angle);
+}
+
+void GeneratePairs(Random& random, TransformPair* pairs, u32 count, float32 maxDistance)
+{
+	for (u32 i = 0; i < count; ++i)
+	{
+		TransformPair* pair = pairs + i;
+
+		pair->xf1 = b3Transform(random.Rotation(), b3Vec3_zero);
+
+		b3Vec3 direction = random.Vec3(-1.0f, 1.0f);
+		if (b3Dot(direction, direction) < B3_EPSILON * B3_EPSILON)
+		{
+			direction.Set(1.0f, 0.0f, 0.0f);
+		}
+		direction.Normalize();
+
+		float32 distance = random.Float(0.0f, maxDistance);
+
+		pair->xf2 = b3Transform(random.Rotation(), distance * direction);
+	}
+}
+
+Kernel::Kernel()
+{
+	m_callCount = 0;
+	m_sink = 0.0f;
+}
+
+Kernel::~Kernel()
+{
+}
+
+HullPairKernel::HullPairKernel(u32 pairCount)
+{
+	m_box.Set(1.0f, 1.0f, 1.0f);
+	m_cylinder.SetAsCylinder(1.0f, 1.0f);
+
+	m_pairCount = pairCount;
+	m_pairs = (TransformPair*)b3Alloc(m_pairCount * sizeof(TransformPair));
+
+	Random random;
+	GeneratePairs(random, m_pairs, m_pairCount, 4.0f);
+
+	m_callCount = m_pairCount;
+}
+
+HullPairKernel::~HullPairKernel()
+{
+	b3Free(m_pairs);
+}
@@ -0,0 +1,112 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson https://irlanrobson.github.io
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef KERNEL_H
+#define KERNEL_H
+
+#include <bounce/bounce.h>
+
+// Headers not included by bounce.h.
+#include <bounce/collision/shapes/triangle_hull.h>
+#include <bounce/collision/trees/dynamic_tree.h>
+#include <bounce/collision/trees/static_tree.h>
+#include <bounce/quickhull/qh_hull.h>
+#include <bounce/dynamics/contacts/collide/collide.h>
+#include <bounce/dynamics/contacts/contact_cluster.h>
+#include <bounce/sparse/sparse_mat33.h>
+#include <bounce/sparse/sparse_mat33_view.h>
+
+// A deterministic random number generator. 
+// Kernel inputs are generated with it so that every run sees the same inputs.
+class Random
+{
+public:
+	Random(u32 seed = 1);
+
+	// Get a random integer.
+	u32 Next();
+
+	// Get a random number in the range [a, b].
+	float32 Float(float32 a, float32 b);
+
+	// Get a random vector inside the box [a, b]^3.
+	b3Vec3 Vec3(float32 a, float32 b);
+
+	// Get a random rotation.
+	b3Quat Rotation();
+private:
+	u32 m_state;
+};
+
+// A pair of transforms for the pairwise collision kernels.
+struct TransformPair
+{
+	b3Transform xf1;
+	b3Transform xf2;
+};
+
+// Generate randomly oriented pairs whose origins are at most 
+// maxDistance apart. Overlapping and separated pairs are mixed.
+void GeneratePairs(Random& random, TransformPair* pairs, u32 count, float32 maxDistance);
+
+// A kernel called a number of times over generated inputs. 
+// The size parameter scales the number of inputs or the input size.
+class Kernel
+{
+public:
+	Kernel();
+	virtual ~Kernel();
+
+	// Call the kernel over all inputs once.
+	virtual void Run() = 0;
+
+	// The number of kernel calls done by a run. 
+	// Times are reported per call.
+	u32 m_callCount;
+
+	// Kernel results are accumulated here so that 
+	// the compiler can't remove the calls.
+	float32 m_sink;
+};
+
+struct KernelEntry
+{
+	typedef Kernel* (*KernelCreate)(u32 size);
+	const char* name;
+	KernelCreate create;
+	u32 defaultSize;
+};
+
+// A kernel over pairs of a box and a cylinder hull.
+class HullPairKernel : public Kernel
+{
+public:
+	HullPairKernel(u32 pairCount);
+	~HullPairKernel();
+
+	b3BoxHull m_box;
+	b3QHull m_cylinder;
+
+	u32 m_pairCount;
+	TransformPair* m_pairs;
+};
+
+extern KernelEntry g_kernels[];
+extern u32 g_kernelCount;
+
+#endif
@@ -0,0 +1,60 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson https://irlanrobson.github.io
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <microbenchmark/framework/kernel.h>
+#include <microbenchmark/kernels/gjk.h>
+#include <microbenchmark/kernels/sat.h>
+#include <microbenchmark/kernels/collide.h>
+#include <microbenchmark/kernels/cluster.h>
+#include <microbenchmark/kernels/tree.h>
+#include <microbenchmark/kernels/quickhull.h>
+#include <microbenchmark/kernels/sparse.h>
+
+KernelEntry g_kernels[] =
+{
+	{ "gjk", &GJKKernel::Create, 1024 },
+	{ "gjk_cache", &GJKCacheKernel::Create, 1024 },
+	{ "face_separation", &FaceSeparationKernel::Create, 1024 },
+	{ "edge_separation", &EdgeSeparationKernel::Create, 1024 },
+	{ "collide_hulls", &CollideHullsKernel::Create, 1024 },
+	{ "collide_capsule_hull", &CollideCapsuleAndHullKernel::Create, 1024 },
+	{ "cluster_solver", &ClusterSolverKernel::Create, 256 },
+	{ "dynamic_tree_insert", &DynamicTreeInsertKernel::Create, 4096 },
+	{ "dynamic_tree_query", &DynamicTreeQueryKernel::Create, 4096 },
+	{ "dynamic_tree_raycast", &DynamicTreeRayCastKernel::Create, 4096 },
+	{ "dynamic_tree_raycast_packet", &DynamicTreeRayCastPacketKernel::Create, 4096 },
+	{ "static_tree_build", &StaticTreeBuildKernel::Create, 4096 },
+	{ "quickhull", &QuickhullKernel::Create, 256 },
+	{ "sparse_mat33_mul", &SparseMat33Kernel::Create, 32 },
+	{ "sparse_mat33_view_mul", &SparseMat33ViewKernel::Create, 32 },
+	{ NULL, NULL, 0 }
+};
+
+//
+static u32 KernelCount()
+{
+	u32 count = 0;
+	while (g_kernels[count].create != NULL)
+	{
+		++count;
+	}
+	return count;
+}
+
+// Count the kernels
+u32 g_kernelCount = KernelCount();
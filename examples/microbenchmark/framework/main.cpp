@@ -0,0 +1,294 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson https://irlanrobson.github.io
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <microbenchmark/framework/kernel.h>
+#include <common/benchmark_utils.h>
+
+// The settings of a microbenchmark run.
+struct Settings
+{
+	Settings()
+	{
+		sampleCount = 100;
+		warmupCount = 10;
+		runCount = 0;
+		minSampleTime = 1.0;
+		output = NULL;
+	}
+
+	std::vector<const char*> kernels;
+	std::vector<u32> sizes;
+	u32 sampleCount;
+	u32 warmupCount;
+	u32 runCount;
+	float64 minSampleTime;
+	const char* output;
+};
+
+static void PrintUsage()
+{
+	printf("Usage: microbenchmark [options]\n");
+	printf("  --kernel <name>          Run a kernel. Can be repeated. Runs all kernels by default.\n");
+	printf("  --sizes <n,n,...>        Kernel sizes. Uses the default size of each kernel by default.\n");
+	printf("  --samples <n>            Number of measured samples. Default is 100.\n");
+	printf("  --warmup <n>             Number of runs before measuring. Default is 10.\n");
+	printf("  --runs <n>               Number of runs per sample. By default a sample \n");
+	printf("                           lasts at least --min-sample-time.\n");
+	printf("  --min-sample-time <ms>   Default is 1.\n");
+	printf("  --output <file>          Write the JSON report to a file instead of stdout.\n");
+	printf("  --list                   List the kernels.\n");
+	printf("Kernels:\n");
+	for (u32 i = 0; i < g_kernelCount; ++i)
+	{
+		printf("  %s (default size %d)\n", g_kernels[i].name, g_kernels[i].defaultSize);
+	}
+}
+
+static bool ParseArgs(Settings* settings, int argc, char** argv)
+{
+	ArgReader args(argc, argv);
+	while (args.Next())
+	{
+		if (args.Is("--list") || args.Is("--help"))
+		{
+			return false;
+		}
+
+		const char* value = args.ReadValue();
+		if (value == NULL)
+		{
+			return false;
+		}
+
+		if (args.Is("--kernel"))
+		{
+			settings->kernels.push_back(value);
+		}
+		else if (args.Is("--sizes"))
+		{
+			if (ParseSizeList(&settings->sizes, value) == false)
+			{
+				return false;
+			}
+		}
+		else if (args.Is("--samples"))
+		{
+			settings->sampleCount = (u32)atoi(value);
+		}
+		else if (args.Is("--warmup"))
+		{
+			settings->warmupCount = (u32)atoi(value);
+		}
+		else if (args.Is("--runs"))
+		{
+			settings->runCount = (u32)atoi(value);
+		}
+		else if (args.Is("--min-sample-time"))
+		{
+			settings->minSampleTime = atof(value);
+		}
+		else if (args.Is("--output"))
+		{
+			settings->output = value;
+		}
+		else
+		{
+			printf("Unknown option %s\n", args.GetArg());
+			return false;
+		}
+	}
+
+	if (settings->sampleCount == 0)
+	{
+		printf("The number of samples must be positive\n");
+		return false;
+	}
+
+	return true;
+}
+
+static const KernelEntry* FindKernel(const char* name)
+{
+	for (u32 i = 0; i < g_kernelCount; ++i)
+	{
+		if (strcmp(g_kernels[i].name, name) == 0)
+		{
+			return g_kernels + i;
+		}
+	}
+	return NULL;
+}
+
+// Time a number of runs of a kernel in milliseconds.
+static float64 Time(Kernel* kernel, u32 runCount)
+{
+	b3Time timer;
+	for (u32 i = 0; i < runCount; ++i)
+	{
+		kernel->Run();
+	}
+	timer.Update();
+	return timer.GetElapsedMilis();
+}
+
+// Sample a kernel and write its results as a JSON object.
+static void Run(FILE* file, const Settings& settings, const KernelEntry* entry, u32 size)
+{
+	fprintf(stderr, "Running %s (size %d)\n", entry->name, size);
+
+	Kernel* kernel = entry->create(size);
+
+	for (u32 i = 0; i < settings.warmupCount; ++i)
+	{
+		kernel->Run();
+	}
+
+	// Double the runs per sample until a sample is long enough 
+	// for the timer resolution.
+	u32 runCount = settings.runCount;
+	if (runCount == 0)
+	{
+		runCount = 1;
+		while (runCount < (1 << 20) && Time(kernel, runCount) < settings.minSampleTime)
+		{
+			runCount *= 2;
+		}
+	}
+
+	float64 callCount = float64(runCount) * float64(kernel->m_callCount);
+
+	// Nanoseconds per kernel call
+	std::vector<float64> samples;
+	samples.reserve(settings.sampleCount);
+	for (u32 i = 0; i < settings.sampleCount; ++i)
+	{
+		float64 time = Time(kernel, runCount);
+		samples.push_back(1000000.0 * time / callCount);
+	}
+
+	float64 mean = 0.0;
+	for (u32 i = 0; i < samples.size(); ++i)
+	{
+		mean += samples[i];
+	}
+	mean /= float64(samples.size());
+
+	float64 variance = 0.0;
+	for (u32 i = 0; i < samples.size(); ++i)
+	{
+		float64 d = samples[i] - mean;
+		variance += d * d;
+	}
+	if (samples.size() > 1)
+	{
+		variance /= float64(samples.size() - 1);
+	}
+
+	std::sort(samples.begin(), samples.end());
+
+	fprintf(file, "\t\t{\n");
+	fprintf(file, "\t\t\t\"kernel\": \"%s\",\n", entry->name);
+	fprintf(file, "\t\t\t\"size\": %d,\n", size);
+	fprintf(file, "\t\t\t\"calls\": %d,\n", kernel->m_callCount);
+	fprintf(file, "\t\t\t\"runs\": %d,\n", runCount);
+	fprintf(file, "\t\t\t\"time\": { \"mean\": %f, \"stddev\": %f, \"min\": %f, \"p50\": %f, \"p90\": %f, \"p99\": %f, \"max\": %f }\n",
+		mean, sqrt(variance), samples.front(), 
+		Percentile(samples, 50.0), Percentile(samples, 90.0), Percentile(samples, 99.0), 
+		samples.back());
+	fprintf(file, "\t\t}");
+
+	delete kernel;
+}
+
+// This program times isolated kernels of the library over generated inputs 
+// and reports the time per kernel call as JSON. 
+// All times are in nanoseconds.
+int main(int argc, char** argv)
+{
+	Settings settings;
+	if (ParseArgs(&settings, argc, argv) == false)
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	std::vector<const KernelEntry*> entries;
+	if (settings.kernels.empty())
+	{
+		for (u32 i = 0; i < g_kernelCount; ++i)
+		{
+			entries.push_back(g_kernels + i);
+		}
+	}
+	else
+	{
+		for (u32 i = 0; i < settings.kernels.size(); ++i)
+		{
+			const KernelEntry* entry = FindKernel(settings.kernels[i]);
+			if (entry == NULL)
+			{
+				printf("Unknown kernel %s\n", settings.kernels[i]);
+				PrintUsage();
+				return 1;
+			}
+			entries.push_back(entry);
+		}
+	}
+
+	FILE* file = OpenReport(settings.output);
+	if (file == NULL)
+	{
+		return 1;
+	}
+
+	fprintf(file, "{\n");
+	fprintf(file, "\t\"version\": \"%d.%d.%d\",\n", b3_version.major, b3_version.minor, b3_version.revision);
+	fprintf(file, "\t\"samples\": %d,\n", settings.sampleCount);
+	fprintf(file, "\t\"warmup\": %d,\n", settings.warmupCount);
+	fprintf(file, "\t\"results\": [\n");
+
+	bool first = true;
+	for (u32 i = 0; i < entries.size(); ++i)
+	{
+		const KernelEntry* entry = entries[i];
+
+		std::vector<u32> sizes = settings.sizes;
+		if (sizes.empty())
+		{
+			sizes.push_back(entry->defaultSize);
+		}
+
+		for (u32 j = 0; j < sizes.size(); ++j)
+		{
+			if (first == false)
+			{
+				fprintf(file, ",\n");
+			}
+			first = false;
+
+			Run(file, settings, entry, sizes[j]);
+		}
+	}
+
+	fprintf(file, "\n\t]\n");
+	fprintf(file, "}\n");
+
+	CloseReport(file);
+
+	return 0;
+}
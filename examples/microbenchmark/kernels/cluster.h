@@ -0,0 +1,164 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson https://irlanrobson.github.io
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef CLUSTER_KERNEL_H
+#define CLUSTER_KERNEL_H
+
+// The contact clustering of a box resting on a bumpy triangle patch. 
+// The input manifolds are the per-triangle manifolds a mesh contact would create.
+class ClusterSolverKernel : public Kernel
+{
+public:
+	enum
+	{
+		e_patchSize = 4,
+		e_triangleCount = 2 * e_patchSize * e_patchSize
+	};
+
+	ClusterSolverKernel(u32 problemCount)
+	{
+		m_box.Set(1.0f, 1.0f, 1.0f);
+
+		m_boxShape.m_hull = &m_box;
+		m_boxShape.m_radius = 0.0f;
+
+		m_problemCount = problemCount;
+		m_problems = (Problem*)b3Alloc(m_problemCount * sizeof(Problem));
+
+		Random random;
+		for (u32 i = 0; i < m_problemCount; ++i)
+		{
+			// Retry until the box touches the patch.
+			do 
+			{
+				Generate(random, m_problems + i);
+			} while (m_problems[i].manifoldCount == 0);
+		}
+
+		m_callCount = m_problemCount;
+	}
+
+	~ClusterSolverKernel()
+	{
+		b3Free(m_problems);
+	}
+
+	void Run()
+	{
+		for (u32 i = 0; i < m_problemCount; ++i)
+		{
+			const Problem* problem = m_problems + i;
+
+			b3Manifold manifolds[B3_MAX_MANIFOLDS];
+			u32 manifoldCount = 0;
+
+			b3ClusterSolver solver;
+			solver.Run(manifolds, manifoldCount, problem->manifolds, problem->manifoldCount, 
+				problem->xf, 0.0f, b3Transform_identity, B3_HULL_RADIUS);
+
+			m_sink += float32(manifoldCount);
+		}
+	}
+
+	static Kernel* Create(u32 size)
+	{
+		return new ClusterSolverKernel(size);
+	}
+
+	struct Problem
+	{
+		b3Transform xf;
+		b3Manifold manifolds[e_triangleCount];
+		u32 manifoldCount;
+	};
+
+	void Generate(Random& random, Problem* problem)
+	{
+		const u32 w = e_patchSize;
+
+		b3Vec3 vertices[(w + 1) * (w + 1)];
+		for (u32 i = 0; i <= w; ++i)
+		{
+			for (u32 j = 0; j <= w; ++j)
+			{
+				float32 x = float32(j) - 0.5f * float32(w);
+				float32 y = random.Float(-0.1f, 0.1f);
+				float32 z = float32(i) - 0.5f * float32(w);
+				vertices[i * (w + 1) + j].Set(x, y, z);
+			}
+		}
+
+		b3Vec3 axis = random.Vec3(-1.0f, 1.0f);
+		if (b3Dot(axis, axis) < B3_EPSILON * B3_EPSILON)
+		{
+			axis.Set(0.0f, 1.0f, 0.0f);
+		}
+		axis.Normalize();
+
+		b3Quat rotation(axis, random.Float(-0.1f, 0.1f));
+		b3Vec3 position(random.Float(-0.5f, 0.5f), random.Float(0.9f, 1.0f), random.Float(-0.5f, 0.5f));
+
+		problem->xf = b3Transform(rotation, position);
+		problem->manifoldCount = 0;
+
+		for (u32 i = 0; i < w; ++i)
+		{
+			for (u32 j = 0; j < w; ++j)
+			{
+				u32 v1 = i * (w + 1) + j;
+				u32 v2 = (i + 1) * (w + 1) + j;
+				u32 v3 = (i + 1) * (w + 1) + (j + 1);
+				u32 v4 = i * (w + 1) + (j + 1);
+
+				AddTriangle(problem, vertices[v1], vertices[v2], vertices[v3]);
+				AddTriangle(problem, vertices[v3], vertices[v4], vertices[v1]);
+			}
+		}
+	}
+
+	void AddTriangle(Problem* problem, const b3Vec3& A, const b3Vec3& B, const b3Vec3& C)
+	{
+		b3TriangleHull hull(A, B, C);
+
+		b3HullShape shape;
+		shape.m_hull = &hull;
+		shape.m_radius = B3_HULL_RADIUS;
+
+		b3ConvexCache cache;
+		cache.simplexCache.count = 0;
+		cache.featureCache.m_featurePair.state = b3SATCacheType::e_empty;
+
+		b3Manifold* manifold = problem->manifolds + problem->manifoldCount;
+		manifold->Initialize();
+
+		b3CollideHullAndHull(*manifold, problem->xf, &m_boxShape, b3Transform_identity, &shape, &cache);
+		
+		if (manifold->pointCount > 0)
+		{
+			++problem->manifoldCount;
+		}
+	}
+
+	b3BoxHull m_box;
+	b3HullShape m_boxShape;
+
+	u32 m_problemCount;
+	Problem* m_problems;
+};
+
+#endif
@@ -0,0 +1,125 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson https://irlanrobson.github.io
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef COLLIDE_KERNEL_H
+#define COLLIDE_KERNEL_H
+
+// The manifold of a box and a cylinder. 
+// The convex cache of a pair is kept between runs.
+class CollideHullsKernel : public HullPairKernel
+{
+public:
+	CollideHullsKernel(u32 pairCount) : HullPairKernel(pairCount)
+	{
+		// The feature cache compares the orientations of the bodies, 
+		// so the shapes are attached to bodies that don't move.
+		b3BodyDef bd;
+		
+		b3HullShape hs1;
+		hs1.m_hull = &m_box;
+
+		b3ShapeDef sd1;
+		sd1.shape = &hs1;
+
+		m_shape1 = (b3HullShape*)m_world.CreateBody(bd)->CreateShape(sd1);
+
+		b3HullShape hs2;
+		hs2.m_hull = &m_cylinder;
+
+		b3ShapeDef sd2;
+		sd2.shape = &hs2;
+
+		m_shape2 = (b3HullShape*)m_world.CreateBody(bd)->CreateShape(sd2);
+
+		m_caches = (b3ConvexCache*)b3Alloc(m_pairCount * sizeof(b3ConvexCache));
+		for (u32 i = 0; i < m_pairCount; ++i)
+		{
+			m_caches[i].simplexCache.count = 0;
+			m_caches[i].featureCache.m_featurePair.state = b3SATCacheType::e_empty;
+		}
+	}
+
+	~CollideHullsKernel()
+	{
+		b3Free(m_caches);
+	}
+
+	void Run()
+	{
+		for (u32 i = 0; i < m_pairCount; ++i)
+		{
+			const TransformPair* pair = m_pairs + i;
+
+			b3Manifold manifold;
+			manifold.Initialize();
+
+			b3CollideHullAndHull(manifold, pair->xf1, m_shape1, pair->xf2, m_shape2, m_caches + i);
+			
+			m_sink += float32(manifold.pointCount);
+		}
+	}
+
+	static Kernel* Create(u32 size)
+	{
+		return new CollideHullsKernel(size);
+	}
+
+	b3World m_world;
+	b3HullShape* m_shape1;
+	b3HullShape* m_shape2;
+	b3ConvexCache* m_caches;
+};
+
+// The manifold of a capsule and a cylinder.
+class CollideCapsuleAndHullKernel : public HullPairKernel
+{
+public:
+	CollideCapsuleAndHullKernel(u32 pairCount) : HullPairKernel(pairCount)
+	{
+		m_shape1.m_centers[0].Set(0.0f, -1.0f, 0.0f);
+		m_shape1.m_centers[1].Set(0.0f, 1.0f, 0.0f);
+		m_shape1.m_radius = 0.5f;
+		
+		m_shape2.m_hull = &m_cylinder;
+	}
+
+	void Run()
+	{
+		for (u32 i = 0; i < m_pairCount; ++i)
+		{
+			const TransformPair* pair = m_pairs + i;
+
+			b3Manifold manifold;
+			manifold.Initialize();
+
+			b3CollideCapsuleAndHull(manifold, pair->xf1, &m_shape1, pair->xf2, &m_shape2);
+			
+			m_sink += float32(manifold.pointCount);
+		}
+	}
+
+	static Kernel* Create(u32 size)
+	{
+		return new CollideCapsuleAndHullKernel(size);
+	}
+
+	b3CapsuleShape m_shape1;
+	b3HullShape m_shape2;
+};
+
+#endif
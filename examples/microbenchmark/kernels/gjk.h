@@ -0,0 +1,98 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson https://irlanrobson.github.io
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef GJK_KERNEL_H
+#define GJK_KERNEL_H
+
+// The distance between a box and a cylinder from scratch.
+class GJKKernel : public HullPairKernel
+{
+public:
+	GJKKernel(u32 pairCount) : HullPairKernel(pairCount)
+	{
+		m_proxy1.vertexCount = m_box.vertexCount;
+		m_proxy1.vertices = m_box.vertices;
+		m_proxy1.radius = 0.0f;
+
+		m_proxy2.vertexCount = m_cylinder.vertexCount;
+		m_proxy2.vertices = m_cylinder.vertices;
+		m_proxy2.radius = 0.0f;
+	}
+
+	void Run()
+	{
+		for (u32 i = 0; i < m_pairCount; ++i)
+		{
+			const TransformPair* pair = m_pairs + i;
+
+			b3GJKOutput output = b3GJK(pair->xf1, m_proxy1, pair->xf2, m_proxy2);
+			
+			m_sink += output.distance;
+		}
+	}
+
+	static Kernel* Create(u32 size)
+	{
+		return new GJKKernel(size);
+	}
+
+	b3GJKProxy m_proxy1;
+	b3GJKProxy m_proxy2;
+};
+
+// The distance between a box and a cylinder using a simplex cache.
+// The cache of a pair is kept between runs, as between 
+// the steps of a resting contact.
+class GJKCacheKernel : public GJKKernel
+{
+public:
+	GJKCacheKernel(u32 pairCount) : GJKKernel(pairCount)
+	{
+		m_caches = (b3SimplexCache*)b3Alloc(m_pairCount * sizeof(b3SimplexCache));
+		for (u32 i = 0; i < m_pairCount; ++i)
+		{
+			m_caches[i].count = 0;
+		}
+	}
+
+	~GJKCacheKernel()
+	{
+		b3Free(m_caches);
+	}
+
+	void Run()
+	{
+		for (u32 i = 0; i < m_pairCount; ++i)
+		{
+			const TransformPair* pair = m_pairs + i;
+
+			b3GJKOutput output = b3GJK(pair->xf1, m_proxy1, pair->xf2, m_proxy2, false, m_caches + i);
+			
+			m_sink += output.distance;
+		}
+	}
+
+	static Kernel* Create(u32 size)
+	{
+		return new GJKCacheKernel(size);
+	}
+
+	b3SimplexCache* m_caches;
+};
+
+#endif
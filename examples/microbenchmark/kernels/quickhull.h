@@ -0,0 +1,77 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson https://irlanrobson.github.io
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef QUICKHULL_KERNEL_H
+#define QUICKHULL_KERNEL_H
+
+// Construct the convex hulls of random point clouds.
+// The points lie close to the surface of a sphere so that most of them are on the hull.
+class QuickhullKernel : public Kernel
+{
+public:
+	enum
+	{
+		e_cloudCount = 16
+	};
+
+	QuickhullKernel(u32 pointCount)
+	{
+		m_pointCount = b3Max(pointCount, 4u);
+		m_points = (b3Vec3*)b3Alloc(e_cloudCount * m_pointCount * sizeof(b3Vec3));
+
+		Random random;
+		for (u32 i = 0; i < e_cloudCount * m_pointCount; ++i)
+		{
+			b3Vec3 n = random.Vec3(-1.0f, 1.0f);
+			if (b3Dot(n, n) < B3_EPSILON * B3_EPSILON)
+			{
+				n.Set(0.0f, 1.0f, 0.0f);
+			}
+			n.Normalize();
+
+			m_points[i] = random.Float(0.9f, 1.0f) * n;
+		}
+
+		m_callCount = e_cloudCount;
+	}
+
+	~QuickhullKernel()
+	{
+		b3Free(m_points);
+	}
+
+	void Run()
+	{
+		for (u32 i = 0; i < e_cloudCount; ++i)
+		{
+			qhHull hull;
+			hull.Construct(m_points + i * m_pointCount, m_pointCount);
+			m_sink += float32(hull.GetFaceList().count);
+		}
+	}
+
+	static Kernel* Create(u32 size)
+	{
+		return new QuickhullKernel(size);
+	}
+
+	u32 m_pointCount;
+	b3Vec3* m_points;
+};
+
+#endif
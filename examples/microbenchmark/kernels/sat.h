@@ -0,0 +1,74 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson https://irlanrobson.github.io
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef SAT_KERNEL_H
+#define SAT_KERNEL_H
+
+// The face separation query between a box and a cylinder.
+class FaceSeparationKernel : public HullPairKernel
+{
+public:
+	FaceSeparationKernel(u32 pairCount) : HullPairKernel(pairCount)
+	{
+	}
+
+	void Run()
+	{
+		for (u32 i = 0; i < m_pairCount; ++i)
+		{
+			const TransformPair* pair = m_pairs + i;
+
+			b3FaceQuery query = b3QueryFaceSeparation(pair->xf1, &m_box, pair->xf2, &m_cylinder);
+			
+			m_sink += query.separation;
+		}
+	}
+
+	static Kernel* Create(u32 size)
+	{
+		return new FaceSeparationKernel(size);
+	}
+};
+
+// The edge separation query between a box and a cylinder.
+class EdgeSeparationKernel : public HullPairKernel
+{
+public:
+	EdgeSeparationKernel(u32 pairCount) : HullPairKernel(pairCount)
+	{
+	}
+
+	void Run()
+	{
+		for (u32 i = 0; i < m_pairCount; ++i)
+		{
+			const TransformPair* pair = m_pairs + i;
+
+			b3EdgeQuery query = b3QueryEdgeSeparation(pair->xf1, &m_box, pair->xf2, &m_cylinder);
+			
+			m_sink += query.separation;
+		}
+	}
+
+	static Kernel* Create(u32 size)
+	{
+		return new EdgeSeparationKernel(size);
+	}
+};
+
+#endif
@@ -0,0 +1,112 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson https://irlanrobson.github.io
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef SPARSE_KERNEL_H
+#define SPARSE_KERNEL_H
+
+// Matrix-vector products with the system matrix of a grid cloth. 
+// Each particle is coupled to its structural, shear and bending neighbours.
+class SparseMat33Kernel : public Kernel
+{
+public:
+	SparseMat33Kernel(u32 width) : m_A((width + 1) * (width + 1)), m_x((width + 1) * (width + 1)), m_y((width + 1) * (width + 1))
+	{
+		u32 w = width + 1;
+		u32 n = w * w;
+
+		Random random;
+
+		b3Mat33 I = b3Mat33_identity;
+
+		for (u32 i = 0; i < n; ++i)
+		{
+			m_A(i, i) = 4.0f * I;
+			m_x[i] = random.Vec3(-1.0f, 1.0f);
+		}
+
+		const i32 offsets[6][2] = { { 1, 0 }, { 0, 1 }, { 1, 1 }, { 1, -1 }, { 2, 0 }, { 0, 2 } };
+
+		for (u32 i = 0; i < w; ++i)
+		{
+			for (u32 j = 0; j < w; ++j)
+			{
+				u32 a = i * w + j;
+
+				for (u32 k = 0; k < 6; ++k)
+				{
+					i32 ni = i32(i) + offsets[k][0];
+					i32 nj = i32(j) + offsets[k][1];
+
+					if (ni < 0 || ni >= i32(w) || nj < 0 || nj >= i32(w))
+					{
+						continue;
+					}
+
+					u32 b = u32(ni) * w + u32(nj);
+
+					b3Vec3 d = random.Vec3(-1.0f, 1.0f);
+					b3Mat33 K = -0.1f * b3Outer(d, d);
+
+					m_A(a, b) = K;
+					m_A(b, a) = K;
+				}
+			}
+		}
+
+		m_callCount = 1;
+	}
+
+	void Run()
+	{
+		b3Mul(m_y, m_A, m_x);
+		m_sink += m_y[0].x;
+	}
+
+	static Kernel* Create(u32 size)
+	{
+		return new SparseMat33Kernel(size);
+	}
+
+	b3SparseMat33 m_A;
+	b3DenseVec3 m_x;
+	b3DenseVec3 m_y;
+};
+
+// The same products through the array view the MPCG solver multiplies with.
+class SparseMat33ViewKernel : public SparseMat33Kernel
+{
+public:
+	SparseMat33ViewKernel(u32 width) : SparseMat33Kernel(width), m_view(m_A)
+	{
+	}
+
+	void Run()
+	{
+		b3Mul(m_y, m_view, m_x);
+		m_sink += m_y[0].x;
+	}
+
+	static Kernel* Create(u32 size)
+	{
+		return new SparseMat33ViewKernel(size);
+	}
+
+	b3SparseMat33View m_view;
+};
+
+#endif
@@ -0,0 +1,230 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson https://irlanrobson.github.io
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef TREE_KERNEL_H
+#define TREE_KERNEL_H
+
+// Random AABBs with a roughly constant density.
+class TreeKernel : public Kernel
+{
+public:
+	TreeKernel(u32 proxyCount)
+	{
+		m_proxyCount = proxyCount;
+		m_aabbs = (b3AABB3*)b3Alloc(m_proxyCount * sizeof(b3AABB3));
+
+		m_extent = 2.0f * pow(float32(m_proxyCount), 1.0f / 3.0f);
+
+		Random random;
+		for (u32 i = 0; i < m_proxyCount; ++i)
+		{
+			b3Vec3 center = random.Vec3(-m_extent, m_extent);
+			b3Vec3 r = random.Vec3(0.1f, 1.0f);
+
+			m_aabbs[i].Set(center, r);
+		}
+
+		m_callCount = m_proxyCount;
+	}
+
+	~TreeKernel()
+	{
+		b3Free(m_aabbs);
+	}
+
+	u32 m_proxyCount;
+	b3AABB3* m_aabbs;
+	float32 m_extent;
+};
+
+// Insert AABBs into an empty dynamic tree.
+class DynamicTreeInsertKernel : public TreeKernel
+{
+public:
+	DynamicTreeInsertKernel(u32 proxyCount) : TreeKernel(proxyCount)
+	{
+	}
+
+	void Run()
+	{
+		b3DynamicTree tree;
+		for (u32 i = 0; i < m_proxyCount; ++i)
+		{
+			m_sink += float32(tree.InsertNode(m_aabbs[i], NULL));
+		}
+	}
+
+	static Kernel* Create(u32 size)
+	{
+		return new DynamicTreeInsertKernel(size);
+	}
+};
+
+// Query a dynamic tree with the AABBs it contains.
+class DynamicTreeQueryKernel : public TreeKernel
+{
+public:
+	DynamicTreeQueryKernel(u32 proxyCount) : TreeKernel(proxyCount)
+	{
+		for (u32 i = 0; i < m_proxyCount; ++i)
+		{
+			m_tree.InsertNode(m_aabbs[i], NULL);
+		}
+	}
+
+	bool Report(u32 proxyId)
+	{
+		B3_NOT_USED(proxyId);
+		++m_overlapCount;
+		return true;
+	}
+
+	void Run()
+	{
+		m_overlapCount = 0;
+		for (u32 i = 0; i < m_proxyCount; ++i)
+		{
+			m_tree.QueryAABB(this, m_aabbs[i]);
+		}
+		m_sink += float32(m_overlapCount);
+	}
+
+	static Kernel* Create(u32 size)
+	{
+		return new DynamicTreeQueryKernel(size);
+	}
+
+	b3DynamicTree m_tree;
+	u32 m_overlapCount;
+};
+
+// Cast rays through a dynamic tree. 
+// The rays cross the whole tree and report all hit proxies.
+class DynamicTreeRayCastKernel : public TreeKernel
+{
+public:
+	DynamicTreeRayCastKernel(u32 proxyCount) : TreeKernel(proxyCount)
+	{
+		for (u32 i = 0; i < m_proxyCount; ++i)
+		{
+			m_tree.InsertNode(m_aabbs[i], NULL);
+		}
+
+		m_rays = (b3RayCastInput*)b3Alloc(m_proxyCount * sizeof(b3RayCastInput));
+
+		Random random(2);
+		for (u32 i = 0; i < m_proxyCount; ++i)
+		{
+			m_rays[i].p1 = random.Vec3(-m_extent, m_extent);
+			m_rays[i].p1.y = -2.0f * m_extent;
+			m_rays[i].p2 = random.Vec3(-m_extent, m_extent);
+			m_rays[i].p2.y = 2.0f * m_extent;
+			m_rays[i].maxFraction = 1.0f;
+		}
+	}
+
+	~DynamicTreeRayCastKernel()
+	{
+		b3Free(m_rays);
+	}
+
+	float32 Report(const b3RayCastInput& input, u32 proxyId)
+	{
+		B3_NOT_USED(proxyId);
+		++m_hitCount;
+		return input.maxFraction;
+	}
+
+	void Run()
+	{
+		m_hitCount = 0;
+		for (u32 i = 0; i < m_proxyCount; ++i)
+		{
+			m_tree.RayCast(this, m_rays[i]);
+		}
+		m_sink += float32(m_hitCount);
+	}
+
+	static Kernel* Create(u32 size)
+	{
+		return new DynamicTreeRayCastKernel(size);
+	}
+
+	b3DynamicTree m_tree;
+	b3RayCastInput* m_rays;
+	u32 m_hitCount;
+};
+
+// Cast the rays of the ray cast kernel through a dynamic tree in packets.
+class DynamicTreeRayCastPacketKernel : public DynamicTreeRayCastKernel
+{
+public:
+	DynamicTreeRayCastPacketKernel(u32 proxyCount) : DynamicTreeRayCastKernel(proxyCount)
+	{
+	}
+
+	void Report(u32 mask, u32 proxyId)
+	{
+		B3_NOT_USED(proxyId);
+		for (; mask; mask &= mask - 1)
+		{
+			++m_hitCount;
+		}
+	}
+
+	void Run()
+	{
+		m_hitCount = 0;
+		for (u32 i = 0; i < m_proxyCount; i += B3_MAX_RAY_PACKET)
+		{
+			b3RayPacket packet;
+			packet.Set(m_rays + i, b3Min(m_proxyCount - i, u32(B3_MAX_RAY_PACKET)));
+			m_tree.RayCastPacket(this, &packet, packet.GetActiveMask());
+		}
+		m_sink += float32(m_hitCount);
+	}
+
+	static Kernel* Create(u32 size)
+	{
+		return new DynamicTreeRayCastPacketKernel(size);
+	}
+};
+
+// Build a static tree.
+class StaticTreeBuildKernel : public TreeKernel
+{
+public:
+	StaticTreeBuildKernel(u32 proxyCount) : TreeKernel(proxyCount)
+	{
+		m_callCount = 1;
+	}
+
+	void Run()
+	{
+		b3StaticTree tree;
+		tree.Build(m_aabbs, m_proxyCount);
+		m_sink += float32(tree.GetSize());
+	}
+
+	static Kernel* Create(u32 size)
+	{
+		return new StaticTreeBuildKernel(size);
+	}
+};
+
+#endif
@@ -0,0 +1,254 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson https://irlanrobson.github.io
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <common/benchmark_utils.h>
+
+// The replay doesn't profile the scopes.
+void b3BeginProfileScope(const char* name)
+{
+	B3_NOT_USED(name);
+}
+
+void b3EndProfileScope()
+{
+}
+
+// The settings of a replay.
+struct Settings
+{
+	Settings()
+	{
+		log = NULL;
+		runCount = 1;
+		threadCount = 1;
+		output = NULL;
+	}
+
+	const char* log;
+	u32 runCount;
+	u32 threadCount;
+	const char* output;
+};
+
+// A replayed step. The time is the minimum over the runs.
+struct Frame
+{
+	float64 time;
+	b3StepStats stats;
+};
+
+static void PrintUsage()
+{
+	printf("Usage: replay <log> [options]\n");
+	printf("  --runs <n>               Number of times the log is replayed. Default is 1.\n");
+	printf("  --threads <n>            Number of scheduler threads. Default is 1.\n");
+	printf("  --output <file>          Write the JSON report to a file instead of stdout.\n");
+}
+
+static bool ParseArgs(Settings* settings, int argc, char** argv)
+{
+	ArgReader args(argc, argv);
+	while (args.Next())
+	{
+		if (args.Is("--help"))
+		{
+			return false;
+		}
+
+		if (args.IsOption() == false)
+		{
+			settings->log = args.GetArg();
+			continue;
+		}
+
+		const char* value = args.ReadValue();
+		if (value == NULL)
+		{
+			return false;
+		}
+
+		if (args.Is("--runs"))
+		{
+			settings->runCount = (u32)atoi(value);
+		}
+		else if (args.Is("--threads"))
+		{
+			settings->threadCount = ParseThreadCount(value);
+		}
+		else if (args.Is("--output"))
+		{
+			settings->output = value;
+		}
+		else
+		{
+			printf("Unknown option %s\n", args.GetArg());
+			return false;
+		}
+	}
+
+	if (settings->log == NULL)
+	{
+		printf("Missing log\n");
+		return false;
+	}
+
+	if (settings->runCount == 0)
+	{
+		printf("The number of runs must be positive\n");
+		return false;
+	}
+
+	return true;
+}
+
+// This program drives a world from a log written by a b3Recorder 
+// without a renderer and reports the time of each step as JSON. 
+// The replay fails if the world diverges from the recorded world 
+// because the remaining steps wouldn't run the recorded scene. 
+// Replaying the same log with two builds of the library compares them 
+// on the same input. All times are in milliseconds.
+int main(int argc, char** argv)
+{
+	Settings settings;
+	if (ParseArgs(&settings, argc, argv) == false)
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	b3Replayer replayer;
+	if (replayer.Load(settings.log) == false)
+	{
+		printf("Could not load %s\n", settings.log);
+		return 1;
+	}
+
+	b3TaskScheduler* scheduler = NULL;
+	if (settings.threadCount > 1)
+	{
+		scheduler = new b3WorkStealingTaskScheduler(settings.threadCount);
+	}
+
+	std::vector<Frame> frames;
+	u32 bodyCount = 0;
+	bool diverged = false;
+
+	for (u32 run = 0; run < settings.runCount; ++run)
+	{
+		fprintf(stderr, "Replaying %s (run %d)\n", settings.log, run + 1);
+
+		b3World* world = new b3World();
+		world->SetTaskScheduler(scheduler);
+
+		for (u32 i = 0; ; ++i)
+		{
+			b3Time timer;
+			bool stepped = replayer.Step(world);
+			timer.Update();
+
+			if (stepped == false)
+			{
+				break;
+			}
+
+			// A diverged replay doesn't run the recorded scene.
+			if (replayer.Verify(world) == false)
+			{
+				printf("%s diverged from the recording at step %d\n", settings.log, i + 1);
+				diverged = true;
+				break;
+			}
+
+			// The time includes the calls made before the step.
+			float64 time = timer.GetElapsedMilis();
+
+			if (i == frames.size())
+			{
+				Frame frame;
+				frame.time = time;
+				frame.stats = world->GetStepStats();
+				frames.push_back(frame);
+			}
+			else
+			{
+				frames[i].time = b3Min(frames[i].time, time);
+			}
+		}
+
+		bodyCount = world->GetBodyList().m_count;
+
+		delete world;
+
+		replayer.Rewind();
+
+		if (diverged)
+		{
+			break;
+		}
+	}
+
+	delete scheduler;
+
+	if (diverged)
+	{
+		return 1;
+	}
+
+	if (frames.empty())
+	{
+		printf("%s has no steps\n", settings.log);
+		return 1;
+	}
+
+	FILE* file = OpenReport(settings.output);
+	if (file == NULL)
+	{
+		return 1;
+	}
+
+	std::vector<float64> stepTimes;
+	stepTimes.reserve(frames.size());
+	for (u32 i = 0; i < frames.size(); ++i)
+	{
+		stepTimes.push_back(frames[i].time);
+	}
+
+	fprintf(file, "{\n");
+	fprintf(file, "\t\"version\": \"%d.%d.%d\",\n", b3_version.major, b3_version.minor, b3_version.revision);
+	fprintf(file, "\t\"log\": \"%s\",\n", settings.log);
+	fprintf(file, "\t\"runs\": %d,\n", settings.runCount);
+	fprintf(file, "\t\"threads\": %d,\n", settings.threadCount);
+	fprintf(file, "\t\"bodies\": %d,\n", bodyCount);
+	fprintf(file, "\t\"step\": ");
+	WriteStepTimes(file, stepTimes);
+	fprintf(file, ",\n");
+	fprintf(file, "\t\"frames\": [\n");
+	for (u32 i = 0; i < frames.size(); ++i)
+	{
+		const Frame& frame = frames[i];
+		fprintf(file, "\t\t{ \"time\": %f, \"contacts\": %d, \"manifoldPoints\": %d, \"islands\": %d, \"toi\": %d }%s\n", 
+			frame.time, frame.stats.contactCount, frame.stats.manifoldPointCount, frame.stats.islandCount, frame.stats.toiCount,
+			i + 1 < frames.size() ? "," : "");
+	}
+	fprintf(file, "\t]\n");
+	fprintf(file, "}\n");
+
+	CloseReport(file);
+
+	return 0;
+}
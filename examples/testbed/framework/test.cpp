@@ -20,9 +20,6 @@
 #include <testbed/framework/profiler.h>
 #include <testbed/framework/profiler_st.h>
 
-extern u32 b3_allocCalls, b3_maxAllocCalls;
-extern u32 b3_convexCalls, b3_convexCacheHits;
-extern u32 b3_gjkCalls, b3_gjkIters, b3_gjkMaxIters;
 extern bool b3_convexCache;
 
 void b3BeginProfileScope(const char* name)
@@ -97,24 +94,46 @@ void Test::Step()
 		g_draw->DrawString(b3Color_white, "Joints %d", m_world.GetJointList().m_count);
 		g_draw->DrawString(b3Color_white, "Contacts %d", m_world.GetContactList().m_count);
 
+		const b3StepStats& stats = m_world.GetStepStats();
+		const b3CollisionStats& collision = stats.collision;
+
+		g_draw->DrawString(b3Color_white, "Pairs %d Created %d Destroyed %d", stats.pairCount, stats.contactsCreated, stats.contactsDestroyed);
+		g_draw->DrawString(b3Color_white, "Manifolds %d Points %d", stats.manifoldCount, stats.manifoldPointCount);
+
 		float32 avgGjkIters = 0.0f;
-		if (b3_gjkCalls > 0)
+		float32 gjkCacheHitRatio = 0.0f;
+		if (collision.gjkCalls > 0)
+		{
+			avgGjkIters = float32(collision.gjkIters) / float32(collision.gjkCalls);
+			gjkCacheHitRatio = float32(collision.gjkCacheHits) / float32(collision.gjkCalls);
+		}
+
+		g_draw->DrawString(b3Color_white, "GJK Calls %d", collision.gjkCalls);
+		g_draw->DrawString(b3Color_white, "GJK Iterations %d (%d) (%f)", collision.gjkIters, collision.gjkMaxIters, avgGjkIters);
+		g_draw->DrawString(b3Color_white, "GJK Cache Hits %d (%f)", collision.gjkCacheHits, gjkCacheHitRatio);
+
+		float32 avgToiIters = 0.0f;
+		if (collision.toiCalls > 0)
 		{
-			avgGjkIters = float32(b3_gjkIters) / float32(b3_gjkCalls);
+			avgToiIters = float32(collision.toiIters) / float32(collision.toiCalls);
 		}
 
-		g_draw->DrawString(b3Color_white, "GJK Calls %d", b3_gjkCalls);
-		g_draw->DrawString(b3Color_white, "GJK Iterations %d (%d) (%f)", b3_gjkIters, b3_gjkMaxIters, avgGjkIters);
+		g_draw->DrawString(b3Color_white, "TOI Calls %d", collision.toiCalls);
+		g_draw->DrawString(b3Color_white, "TOI Iterations %d (%d) (%f)", collision.toiIters, collision.toiMaxIters, avgToiIters);
 
 		float32 convexCacheHitRatio = 0.0f;
-		if (b3_convexCalls > 0)
+		if (collision.satCalls > 0)
 		{
-			convexCacheHitRatio = float32(b3_convexCacheHits) / float32(b3_convexCalls);
+			convexCacheHitRatio = float32(collision.satCacheHits) / float32(collision.satCalls);
 		}
 
-		g_draw->DrawString(b3Color_white, "Convex Calls %d", b3_convexCalls);
-		g_draw->DrawString(b3Color_white, "Convex Cache Hits %d (%f)", b3_convexCacheHits, convexCacheHitRatio);
-		g_draw->DrawString(b3Color_white, "Frame Allocations %d (%d)", b3_allocCalls, b3_maxAllocCalls);
+		g_draw->DrawString(b3Color_white, "Convex Calls %d", collision.satCalls);
+		g_draw->DrawString(b3Color_white, "Convex Cache Hits %d (%f)", collision.satCacheHits, convexCacheHitRatio);
+		g_draw->DrawString(b3Color_white, "Frame Allocations %d", collision.allocCalls);
+		
+		g_draw->DrawString(b3Color_white, "Islands %d Largest %d", stats.islandCount, stats.maxIslandBodyCount);
+		g_draw->DrawString(b3Color_white, "Velocity Iterations %d Position Iterations %d", stats.velocityIterations, stats.positionIterations);
+		g_draw->DrawString(b3Color_white, "Step %f ms (Collide %f Solve %f TOI %f)", stats.stepTime, stats.collideTime, stats.solveTime, stats.solveTOITime);
 	}
 }
 
@@ -53,6 +53,7 @@
 #include <testbed/tests/pyramid.h>
 #include <testbed/tests/pyramids.h>
 #include <testbed/tests/ray_cast.h>
+#include <testbed/tests/shape_cast.h>
 #include <testbed/tests/sensor_test.h>
 #include <testbed/tests/body_types.h>
 #include <testbed/tests/varying_friction.h>
@@ -105,6 +106,7 @@ TestEntry g_tests[] =
 	{ "Box Pyramid", &Pyramid::Create },
 	{ "Box Pyramid Rows", &Pyramids::Create },
 	{ "Ray Cast", &RayCast::Create },
+	{ "Shape Cast", &ShapeCast::Create },
 	{ "Sensor Test", &SensorTest::Create },
 	{ "Body Types", &BodyTypes::Create },
 	{ "Varying Friction", &VaryingFriction::Create },
@@ -114,8 +114,7 @@ public:
 			g_draw->DrawSegment(pA, pB, b3Color_white);
 		}
 
-		extern u32 b3_softBodySolverIterations;
-		g_draw->DrawString(b3Color_white, "Iterations = %d", b3_softBodySolverIterations);
+		g_draw->DrawString(b3Color_white, "Iterations = %d", m_body->GetSolverIterations());
 
 		float32 E = m_body->GetEnergy();
 		g_draw->DrawString(b3Color_white, "E = %f", E);
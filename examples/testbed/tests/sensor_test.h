@@ -78,49 +78,18 @@ public:
 		m_attack = false;
 	}
 
-	void BeginContact(b3Contact* c)
+	void Step()
 	{
-		b3Shape* sA = c->GetShapeA();
-		b3Body* bA = sA->GetBody();
-		b3Shape* sB = c->GetShapeB();
-		b3Body* bB = sB->GetBody();
-
-		if (sA == m_sensor)
+		const b3SensorEvents& events = m_world.GetSensorEvents();
+		for (u32 i = 0; i < events.beginEvents.Count(); ++i)
 		{
-			if (bB == m_character)
+			const b3SensorBeginEvent& event = events.beginEvents[i];
+			if (event.sensorShape == m_sensor && event.visitorShape->GetBody() == m_character)
 			{
 				m_attack = true;
 			}
 		}
 
-		if (sB == m_sensor)
-		{
-			if (bA == m_character)
-			{
-				m_attack = true;
-			}
-		}
-
-	}
-
-	void EndContact(b3Contact* c)
-	{
-		b3Shape* sA = c->GetShapeA();
-		b3Body* bA = sA->GetBody();
-		b3Shape* sB = c->GetShapeB();
-		b3Body* bB = sB->GetBody();
-
-		if (sA == m_sensor)
-		{
-		}
-
-		if (sB == m_sensor)
-		{
-		}
-	}
-
-	void Step()
-	{
 		if (m_attack)
 		{
 			b3Body* sensorBody = m_sensor->GetBody();
@@ -1,3 +1,22 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson https://irlanrobson.github.io
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+
 #ifndef SHAPE_CAST_H
 #define SHAPE_CAST_H
 
@@ -6,116 +25,145 @@ class ShapeCast : public Test
 public:
 	ShapeCast()
 	{
-		m_shapeA.m_hull = &b3BoxHull_identity;
-		m_shapeA.m_radius = 0.0f;
+		{
+			b3BodyDef bdef;
+			b3Body* body = m_world.CreateBody(bdef);
 
-		m_shapeB.m_hull = &b3BoxHull_identity;
-		m_shapeB.m_radius = 0.0f;
+			b3HullShape hs;
+			hs.m_hull = &m_groundHull;
 
-		m_xfA.position.Set(-5.0f, 0.0f, 0.0f);
-		m_xfA.rotation.SetIdentity();
+			b3ShapeDef sdef;
+			sdef.shape = &hs;
 
-		m_xfB.position.Set(10.0f, 0.0f, 0.0f);
-		m_xfB.rotation.SetIdentity();
-		
-		m_proxyA.Set(&m_shapeA, 0);
-		m_proxyB.Set(&m_shapeB, 0);
-	}
+			body->CreateShape(sdef);
+		}
 
-	void Step()
-	{
-		g_draw->DrawString(b3Color_white, "Left/Right/Up/Down Arrow - Translate shape");
-		g_draw->DrawString(b3Color_white, "X/Y/Z - Rotate shape");
+		{
+			b3BodyDef bdef;
+			bdef.position.Set(0.0f, 2.0f, 10.0f);
+			bdef.orientation = b3QuatRotationY(0.25f * B3_PI);
 
-		g_draw->DrawTransform(m_xfA);
-		g_draw->DrawTransform(m_xfB);
+			b3Body* body = m_world.CreateBody(bdef);
 
-		m_world.DrawShape(m_xfA, &m_shapeA, b3Color_black);
-		m_world.DrawShape(m_xfB, &m_shapeB, b3Color_black);
+			b3HullShape hs;
+			hs.m_hull = &b3BoxHull_identity;
 
-		m_world.DrawSolidShape(m_xfA, &m_shapeA, b3Color_white);
-		m_world.DrawSolidShape(m_xfB, &m_shapeB, b3Color_white);
+			b3ShapeDef sdef;
+			sdef.shape = &hs;
 
-		b3Vec3 translationB = -100.0f * b3Vec3_x;
-		g_draw->DrawSegment(m_xfB.position, m_xfB.position + translationB, b3Color_white);
+			body->CreateShape(sdef);
+		}
 
-		b3GJKShapeCastOutput out;
-		bool hit = b3GJKShapeCast(&out, m_xfA, m_proxyA, m_xfB, m_proxyB, translationB);
+		{
+			b3BodyDef bdef;
+			bdef.position.Set(-10.0f, 6.0f, -10.0f);
+			bdef.orientation = b3QuatRotationY(0.25f * B3_PI);
 
-		g_draw->DrawString(b3Color_white, "Iterations = %d", out.iterations);
+			b3Body* body = m_world.CreateBody(bdef);
 
-		if (hit)
-		{
-			g_draw->DrawPoint(out.point, 4.0f, b3Color_green);
-			g_draw->DrawSegment(out.point, out.point + out.normal, b3Color_green);
+			static b3BoxHull boxHull(2.0f, 4.0f, 0.5f);
 
-			b3Transform xfB;
-			xfB.rotation = m_xfB.rotation;
-			xfB.position = m_xfB.position + out.t * translationB;
+			b3HullShape hs;
+			hs.m_hull = &boxHull;
 
-			m_world.DrawShape(xfB, &m_shapeB, b3Color_black);
-		}
-	}
+			b3ShapeDef sdef;
+			sdef.shape = &hs;
 
-	void KeyDown(int key)
-	{
-		if (key == GLFW_KEY_LEFT)
-		{
-			m_xfB.position.x -= 0.105f;
+			body->CreateShape(sdef);
 		}
 
-		if (key == GLFW_KEY_RIGHT)
 		{
-			m_xfB.position.x += 0.105f;
-		}
+			b3BodyDef bdef;
+			bdef.position.Set(12.0f, 2.0f, 5.0f);
 
-		if (key == GLFW_KEY_UP)
-		{
-			m_xfB.position.y += 0.105f;
-		}
+			b3Body* body = m_world.CreateBody(bdef);
 
-		if (key == GLFW_KEY_DOWN)
-		{
-			m_xfB.position.y -= 0.105f;
-		}
+			b3SphereShape hs;
+			hs.m_center.SetZero();
+			hs.m_radius = 2.5f;
 
-		if (key == GLFW_KEY_X)
-		{
-			b3Quat qx(b3Vec3(1.0f, 0.0f, 0.0f), 0.05f * B3_PI);
-			b3Mat33 xfx = b3QuatMat33(qx);
+			b3ShapeDef sdef;
+			sdef.shape = &hs;
 
-			m_xfB.rotation = m_xfB.rotation * xfx;
+			body->CreateShape(sdef);
 		}
 
-		if (key == GLFW_KEY_Y)
 		{
-			b3Quat qy(b3Vec3(0.0f, 1.0f, 0.0f), 0.05f * B3_PI);
-			b3Mat33 xfy = b3QuatMat33(qy);
+			b3BodyDef bdef;
+			bdef.position.Set(0.0f, 1.0f, -12.0f);
+
+			b3Body* body = m_world.CreateBody(bdef);
 
-			m_xfB.rotation = m_xfB.rotation * xfy;
+			b3CapsuleShape hs;
+			hs.m_centers[0].Set(0.0f, 1.0f, 0.0f);
+			hs.m_centers[1].Set(0.0f, -1.0f, 0.0f);
+			hs.m_radius = 3.0f;
+
+			b3ShapeDef sdef;
+			sdef.shape = &hs;
+
+			body->CreateShape(sdef);
 		}
 
-		if (key == GLFW_KEY_Z)
+		m_capsule.m_centers[0].Set(0.0f, 1.0f, 0.0f);
+		m_capsule.m_centers[1].Set(0.0f, -1.0f, 0.0f);
+		m_capsule.m_radius = 0.5f;
+
+		m_p1.Set(0.0f, 3.0f, 0.0f);
+		m_p2.Set(50.0f, 3.0f, 0.0f);
+	}
+
+	void DrawCapsule(const b3Vec3& position, const b3Color& color) const
+	{
+		b3Vec3 c1 = position + m_capsule.m_centers[0];
+		b3Vec3 c2 = position + m_capsule.m_centers[1];
+		g_draw->DrawCapsule(c1, c2, m_capsule.m_radius, color);
+	}
+
+	void CastCapsule(const b3Vec3& p1, const b3Vec3& p2) const
+	{
+		b3Transform xf;
+		xf.position = p1;
+		xf.rotation.SetIdentity();
+
+		DrawCapsule(p1, b3Color_white);
+
+		b3ShapeCastSingleOutput out;
+		if (m_world.ShapeCastSingle(&out, &m_capsule, xf, p2 - p1))
 		{
-			b3Quat qy(b3Vec3(0.0f, 0.0f, 1.0f), 0.05f * B3_PI);
-			b3Mat33 xfz = b3QuatMat33(qy);
+			b3Vec3 p = p1 + out.fraction * (p2 - p1);
 
-			m_xfB.rotation = m_xfB.rotation * xfz;
+			g_draw->DrawSegment(p1, p, b3Color_green);
+			DrawCapsule(p, b3Color_red);
+
+			g_draw->DrawPoint(out.point, 4.0f, b3Color_red);
+			g_draw->DrawSegment(out.point, out.point + out.normal, b3Color_white);
+		}
+		else
+		{
+			g_draw->DrawSegment(p1, p2, b3Color_green);
 		}
 	}
 
+	void Step()
+	{
+		float32 dt = g_testSettings->inv_hertz;
+		b3Quat dq = b3QuatRotationY(0.05f * B3_PI * dt);
+
+		m_p1 = b3Mul(dq, m_p1);
+		m_p2 = b3Mul(dq, m_p2);
+		CastCapsule(m_p1, m_p2);
+
+		Test::Step();
+	}
+
 	static Test* Create()
 	{
 		return new ShapeCast();
 	}
 
-	b3HullShape m_shapeA;
-	b3Transform m_xfA;
-	b3ShapeGJKProxy m_proxyA;
-
-	b3HullShape m_shapeB;
-	b3Transform m_xfB;
-	b3ShapeGJKProxy m_proxyB;
+	b3CapsuleShape m_capsule;
+	b3Vec3 m_p1, m_p2;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -92,8 +92,7 @@ public:
 			g_draw->DrawSegment(pA, pB, b3Color_white);
 		}
 
-		extern u32 b3_clothSolverIterations;
-		g_draw->DrawString(b3Color_white, "Iterations = %d", b3_clothSolverIterations);
+		g_draw->DrawString(b3Color_white, "Iterations = %d", m_cloth->GetSolverIterations());
 
 		float32 E = m_cloth->GetEnergy();
 		g_draw->DrawString(b3Color_white, "E = %f", E);
@@ -23,13 +23,20 @@
 
 #include <bounce/common/settings.h>
 #include <bounce/common/time.h>
+#include <bounce/common/profiler.h>
+#include <bounce/common/stats.h>
 #include <bounce/common/draw.h>
+#include <bounce/common/memory/snapshot.h>
+
+#include <bounce/common/thread/task_scheduler.h>
+#include <bounce/common/thread/work_stealing_task_scheduler.h>
 
 #include <bounce/common/math/math.h>
 
 #include <bounce/collision/gjk/gjk.h>
 #include <bounce/collision/sat/sat.h>
 #include <bounce/collision/collision.h>
+#include <bounce/collision/time_of_impact.h>
 #include <bounce/collision/broad_phase.h>
 
 #include <bounce/collision/shapes/sphere.h>
@@ -53,6 +60,8 @@
 #include <bounce/dynamics/shapes/mesh_shape.h>
 
 #include <bounce/dynamics/contacts/contact.h>
+#include <bounce/dynamics/contacts/contact_events.h>
+#include <bounce/dynamics/step_stats.h>
 #include <bounce/dynamics/contacts/convex_contact.h>
 #include <bounce/dynamics/contacts/mesh_contact.h>
 
@@ -60,6 +69,8 @@
 
 #include <bounce/dynamics/world.h>
 #include <bounce/dynamics/world_listeners.h>
+#include <bounce/dynamics/recorder.h>
+#include <bounce/dynamics/replayer.h>
 
 #include <bounce/rope/rope.h>
 
@@ -27,6 +27,8 @@
 
 class b3World;
 
+class b3TaskScheduler;
+
 struct b3ParticleDef;
 class b3Particle;
 
@@ -116,6 +118,13 @@ public:
 	const b3World* GetWorld() const;
 	b3World* GetWorld();
 
+	// Set the task scheduler used to run the force solver in parallel. 
+	// Set to NULL to run the cloth on the thread that calls Step. This is the default.
+	void SetTaskScheduler(b3TaskScheduler* scheduler);
+
+	// Get the task scheduler used to run the force solver in parallel.
+	b3TaskScheduler* GetTaskScheduler();
+
 	// Create a particle.
 	b3Particle* CreateParticle(const b3ParticleDef& def);
 
@@ -152,6 +161,9 @@ public:
 	// Return the kinetic (or dynamic) energy in this system.
 	float32 GetEnergy() const;
 
+	// Return the number of MPCG iterations of the last step.
+	u32 GetSolverIterations() const;
+
 	// Perform a time step. 
 	void Step(float32 dt, u32 velocityIterations, u32 positionIterations);
 
@@ -178,9 +190,15 @@ private:
 	// The world attached to this cloth
 	b3World* m_world;
 
+	// Task scheduler
+	b3TaskScheduler* m_taskScheduler;
+
 	// Gravity acceleration
 	b3Vec3 m_gravity;
 
+	// Number of MPCG iterations of the last step
+	u32 m_solverIterations;
+
 	// Proxy mesh
 	const b3ClothMesh* m_mesh;
 	
@@ -216,6 +234,11 @@ inline b3Vec3 b3Cloth::GetGravity() const
 	return m_gravity;
 }
 
+inline u32 b3Cloth::GetSolverIterations() const
+{
+	return m_solverIterations;
+}
+
 inline const b3World* b3Cloth::GetWorld() const
 {
 	return m_world;
@@ -226,6 +249,16 @@ inline b3World* b3Cloth::GetWorld()
 	return m_world;
 }
 
+inline void b3Cloth::SetTaskScheduler(b3TaskScheduler* scheduler)
+{
+	m_taskScheduler = scheduler;
+}
+
+inline b3TaskScheduler* b3Cloth::GetTaskScheduler()
+{
+	return m_taskScheduler;
+}
+
 inline const b3ClothMesh* b3Cloth::GetMesh() const
 {
 	return m_mesh;
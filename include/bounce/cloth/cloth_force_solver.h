@@ -23,6 +23,7 @@
 #include <bounce/common/math/mat33.h>
 
 class b3StackAllocator;
+class b3TaskScheduler;
 
 class b3Particle;
 class b3Force;
@@ -35,6 +36,7 @@ struct b3SparseMat33View;
 struct b3ClothForceSolverDef
 {
 	b3StackAllocator* stack;
+	b3TaskScheduler* scheduler;
 	u32 particleCount;
 	b3Particle** particles;
 	u32 forceCount;
@@ -59,11 +61,13 @@ public:
 	b3ClothForceSolver(const b3ClothForceSolverDef& def);
 	~b3ClothForceSolver();
 
-	void Solve(float32 dt, const b3Vec3& gravity);
+	// Solve the internal dynamics and return the number of MPCG iterations.
+	u32 Solve(float32 dt, const b3Vec3& gravity);
 private:
 	void ApplyForces();
 
 	b3StackAllocator* m_allocator;
+	b3TaskScheduler* m_scheduler;
 
 	u32 m_particleCount;
 	b3Particle** m_particles;
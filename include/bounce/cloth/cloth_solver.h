@@ -23,6 +23,7 @@
 #include <bounce/common/math/mat33.h>
 
 class b3StackAllocator;
+class b3TaskScheduler;
 
 class b3Particle;
 class b3Force;
@@ -32,6 +33,7 @@ class b3ParticleTriangleContact;
 struct b3ClothSolverDef
 {
 	b3StackAllocator* stack;
+	b3TaskScheduler* scheduler;
 	u32 particleCapacity;
 	u32 forceCapacity;
 	u32 bodyContactCapacity;
@@ -49,9 +51,11 @@ public:
 	void Add(b3ParticleBodyContact* c);
 	void Add(b3ParticleTriangleContact* c);
 
-	void Solve(float32 dt, const b3Vec3& gravity, u32 velocityIterations, u32 positionIterations);
+	// Solve and return the number of MPCG iterations of the force solver.
+	u32 Solve(float32 dt, const b3Vec3& gravity, u32 velocityIterations, u32 positionIterations);
 private:
 	b3StackAllocator* m_allocator;
+	b3TaskScheduler* m_scheduler;
 
 	u32 m_particleCapacity;
 	u32 m_particleCount;
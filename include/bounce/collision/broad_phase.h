@@ -20,10 +20,45 @@
 #define B3_BROAD_PHASE_H
 
 #include <bounce/collision/trees/dynamic_tree.h>
-#include <algorithm>
+#include <bounce/common/thread/task_scheduler.h>
+#include <bounce/common/stats.h>
 
 #define B3_NULL_PROXY (0xFFFFFFFF)
 
+// The collision filtering data of a broad-phase proxy.
+struct b3Filter
+{
+	b3Filter()
+	{
+		categoryBits = 0x0001;
+		maskBits = 0xFFFFFFFF;
+		groupIndex = 0;
+	}
+
+	// The collision category bits. 
+	// Normally only one bit is set.
+	u32 categoryBits;
+	
+	// The categories this proxy accepts for collision.
+	u32 maskBits;
+	
+	// Proxies in the same positive group always collide. 
+	// Proxies in the same negative group never collide. 
+	// Zero means no group. A group overrides the category and mask bits.
+	i32 groupIndex;
+};
+
+// Return true if two proxies with the given filters can collide.
+inline bool b3ShouldCollide(const b3Filter& filterA, const b3Filter& filterB)
+{
+	if (filterA.groupIndex == filterB.groupIndex && filterA.groupIndex != 0)
+	{
+		return filterA.groupIndex > 0;
+	}
+
+	return (filterA.maskBits & filterB.categoryBits) != 0 && (filterA.categoryBits & filterB.maskBits) != 0;
+}
+
 // A pair of broad-phase proxies.
 struct b3Pair
 {
@@ -31,6 +66,14 @@ struct b3Pair
 	u32 proxy2;
 };
 
+// A growable buffer of broad-phase pairs.
+struct b3PairBuffer
+{
+	b3Pair* pairs;
+	u32 count;
+	u32 capacity;
+};
+
 // The broad-phase interface. 
 // It is used to perform ray casts, volume queries, and overlapping queries 
 // against AABBs.
@@ -41,7 +84,7 @@ public:
 	~b3BroadPhase();
 
 	// Create a proxy and return a index to it.
-	u32 CreateProxy(const b3AABB3& aabb, void* userData);
+	u32 CreateProxy(const b3AABB3& aabb, void* userData, const b3Filter& filter = b3Filter());
 	
 	// Destroy a given proxy and remove it from the broadphase.
 	void DestroyProxy(u32 proxyId);
@@ -60,6 +103,14 @@ public:
 	// Get the user data attached to a proxy.
 	void* GetUserData(u32 proxyId) const;
 
+	// Get the filter of a proxy.
+	const b3Filter& GetFilter(u32 proxyId) const;
+
+	// Set the filter of a proxy. 
+	// The pairs that are filtered out are not removed by the broad-phase. 
+	// The proxy is buffered so that new pairs can be found.
+	void SetFilter(u32 proxyId, const b3Filter& filter);
+
 	// Get the number of proxies.
 	u32 GetProxyCount() const;
 
@@ -75,45 +126,89 @@ public:
 	template<class T>
 	void RayCast(T* callback, const b3RayCastInput& input) const;
 
+	// Notify the client callback the AABBs that are overlapping the 
+	// rays of a packet given by a mask.
+	template<class T>
+	void RayCastPacket(T* callback, const b3RayPacket* packet, u32 mask) const;
+
+	// Notify the client callback the AABBs that are overlapping the 
+	// passed AABB swept along a translation.
+	template<class T>
+	void AABBCast(T* callback, const b3AABB3& aabb, const b3Vec3& translation) const;
+
 	// Find and store overlapping AABB pairs.
-	// Notify the client callback the AABB pairs that are overlapping.
+	// Notify the client callback the AABB pairs that are overlapping. 
+	// The pairs whose proxy filters don't collide are never reported.
 	// The client must store the notified pairs.
+	// If a task scheduler is given then the moved proxies are queried in parallel. 
+	// The pairs are always reported in the same order.
 	template<class T>
-	void FindPairs(T* callback);
+	void FindPairs(T* callback, b3TaskScheduler* scheduler = NULL);
+
+	// Set the counters of each scheduler thread. 
+	// The threads that query the moved proxies add to these. 
+	// Set NULL to leave the threads as they are.
+	void SetThreadStats(b3CollisionStats* threadStats);
 
 	// Draw the proxy AABBs.
 	void Draw() const;
+
+	// Write the tree and the moved proxies to a snapshot.
+	void WriteSnapshot(b3Snapshot* snapshot) const;
+
+	// Read the state written by WriteSnapshot. 
+	// No proxies must have been created or destroyed since the snapshot was written.
+	void ReadSnapshot(b3SnapshotReader* reader);
 private :
 	friend class b3DynamicTree;
 
 	void BufferMove(u32 proxyId);
 	void UnbufferMove(u32 proxyId);
 	
-	// The client callback used to add an overlapping pair
-	// to the overlapping pair buffer.
-	bool Report(u32 proxyId);
-	
+	// Query the tree for each moved proxy and store the unique 
+	// overlapping pairs sorted by proxy.
+	void UpdatePairs(b3TaskScheduler* scheduler);
+
+	// The parallel-for callback that queries the tree for a range of moved proxies.
+	static void QueryMoveBuffer(void* context, u32 begin, u32 end, u32 threadIndex);
+
 	// The dynamic tree.
 	b3DynamicTree m_tree;
 
 	// Number of proxies
 	u32 m_proxyCount;
 
-	// The current proxy being queried for overlap with another proxies. 
-	// It is used to avoid a proxy overlap with itself.
-	u32 m_queryProxyId;
+	// The proxy filters indexed by proxy.
+	b3Filter* m_filters;
+	u32 m_filterCapacity;
 
 	// The objects that have moved in a step.
 	u32* m_moveBuffer;
 	u32 m_moveBufferCount;
 	u32 m_moveBufferCapacity;
 
+	// The (duplicated) overlapping pairs found by each thread.
+	b3PairBuffer m_threadPairs[B3_MAX_THREADS];
+
+	// The counters of each thread. 
+	// This is NULL if the threads are not bound to counters.
+	b3CollisionStats* m_threadStats;
+
 	// The buffer holding the unique overlapping AABB pairs.
 	b3Pair* m_pairs;
 	u32 m_pairCapacity;
 	u32 m_pairCount;
+
+	// Scratch buffer used to sort the pairs. 
+	// It has the same capacity as the pair buffer.
+	b3Pair* m_sortPairs;
 };
 
+inline void b3BroadPhase::SetThreadStats(b3CollisionStats* threadStats)
+{
+	m_threadStats = threadStats;
+}
+
 inline const b3AABB3& b3BroadPhase::GetAABB(u32 proxyId) const 
 {
 	return m_tree.GetAABB(proxyId);
@@ -124,6 +219,12 @@ inline void* b3BroadPhase::GetUserData(u32 proxyId) const
 	return m_tree.GetUserData(proxyId);
 }
 
+inline const b3Filter& b3BroadPhase::GetFilter(u32 proxyId) const
+{
+	B3_ASSERT(proxyId < m_filterCapacity);
+	return m_filters[proxyId];
+}
+
 inline u32 b3BroadPhase::GetProxyCount() const
 {
 	return m_proxyCount;
@@ -141,69 +242,29 @@ inline void b3BroadPhase::RayCast(T* callback, const b3RayCastInput& input) cons
 	return m_tree.RayCast(callback, input);
 }
 
-static B3_FORCE_INLINE bool operator<(const b3Pair& pair1, const b3Pair& pair2) 
+template<class T>
+inline void b3BroadPhase::RayCastPacket(T* callback, const b3RayPacket* packet, u32 mask) const 
 {
-	if (pair1.proxy1 < pair2.proxy1) 
-	{
-		return true;
-	}
-
-	if (pair1.proxy1 == pair2.proxy1) 
-	{
-		return pair1.proxy2 < pair2.proxy2;
-	}
-
-	return false;
+	return m_tree.RayCastPacket(callback, packet, mask);
 }
 
 template<class T>
-inline void b3BroadPhase::FindPairs(T* callback) 
+inline void b3BroadPhase::AABBCast(T* callback, const b3AABB3& aabb, const b3Vec3& translation) const 
 {
-	// Reset the overlapping pairs buffer count for the current step.
-	m_pairCount = 0;
-
-	// Notifying this class with QueryCallback(), gets the (duplicated) overlapping pair buffer.
-	for (u32 i = 0; i < m_moveBufferCount; ++i) 
-	{
-		// Keep the current queried proxy ID to avoid self overlapping.
-		m_queryProxyId = m_moveBuffer[i];
-
-		if (m_queryProxyId == B3_NULL_PROXY)
-		{
-			// Proxy was unbuffered
-			continue;
-		}
-
-		const b3AABB3& aabb = m_tree.GetAABB(m_queryProxyId);
-		m_tree.QueryAABB(this, aabb);
-	}
-
-	// Reset the move buffer for the next step.
-	m_moveBufferCount = 0;
+	return m_tree.AABBCast(callback, aabb, translation);
+}
 
-	// Sort the (duplicated) overlapping pair buffer to prune duplicated pairs.
-	std::sort(m_pairs, m_pairs + m_pairCount);
+template<class T>
+inline void b3BroadPhase::FindPairs(T* callback, b3TaskScheduler* scheduler) 
+{
+	// Find the unique overlapping pairs.
+	UpdatePairs(scheduler);
 
-	// Skip duplicated overlapping pairs.
-	u32 index = 0;
-	while (index < m_pairCount) 
+	// Report the pairs to the client.
+	for (u32 i = 0; i < m_pairCount; ++i) 
 	{
-		const b3Pair* primaryPair = m_pairs + index;
-
-		// Report an unique overlapping pair to the client.
-		callback->AddPair(m_tree.GetUserData(primaryPair->proxy1), m_tree.GetUserData(primaryPair->proxy2));
-
-		// Skip all duplicated pairs until an unique pair is found.
-		++index;
-		while (index < m_pairCount) 
-		{
-			const b3Pair* secondaryPair = m_pairs + index;
-			if (secondaryPair->proxy1 != primaryPair->proxy1 || secondaryPair->proxy2 != primaryPair->proxy2) 
-			{
-				break;
-			}
-			++index;
-		}
+		const b3Pair* pair = m_pairs + i;
+		callback->AddPair(m_tree.GetUserData(pair->proxy1), m_tree.GetUserData(pair->proxy2));
 	}
 }
 
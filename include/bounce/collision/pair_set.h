@@ -0,0 +1,64 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson https://irlanrobson.github.io
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B3_PAIR_SET_H
+#define B3_PAIR_SET_H
+
+#include <bounce/common/settings.h>
+
+// A hash set of unordered broad-phase proxy pairs. 
+// It uses open addressing with linear probing so that adding, 
+// removing and finding a pair is O(1) on average.
+class b3PairSet
+{
+public:
+	b3PairSet();
+	~b3PairSet();
+
+	// Add a pair to this set. 
+	// The pair must not be in this set.
+	void Add(u32 proxy1, u32 proxy2);
+
+	// Remove a pair from this set. 
+	// The pair must be in this set.
+	void Remove(u32 proxy1, u32 proxy2);
+
+	// Test if a pair is in this set.
+	bool Contains(u32 proxy1, u32 proxy2) const;
+
+	// Get the number of pairs in this set.
+	u32 GetCount() const;
+private:
+	// The key of a pair doesn't depend on the proxy order.
+	static u64 GetKey(u32 proxy1, u32 proxy2);
+
+	u32 GetSlot(u64 key) const;
+
+	void Grow();
+
+	u64* m_keys;
+	u32 m_count;
+	u32 m_capacity;
+};
+
+inline u32 b3PairSet::GetCount() const
+{
+	return m_count;
+}
+
+#endif
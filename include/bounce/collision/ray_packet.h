@@ -0,0 +1,138 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson https://irlanrobson.github.io
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B3_RAY_PACKET_H
+#define B3_RAY_PACKET_H
+
+#include <bounce/collision/collision.h>
+
+// The maximum number of rays in a packet. 
+// The rays of a packet are selected by the bits of a mask.
+#define B3_MAX_RAY_PACKET (32)
+
+// A packet of rays that traverse a tree together. 
+// A tree node is visited once for all the rays of a packet 
+// and only the rays that overlap the node are tested against its children.
+// The rays are clipped in place as hits are found.
+struct b3RayPacket
+{
+	// Set the rays of this packet. 
+	// The rays must stay valid while this packet is used.
+	void Set(b3RayCastInput* inputs, u32 count);
+
+	// Get the mask of the rays of this packet that are not degenerate 
+	// and haven't been stopped.
+	u32 GetActiveMask() const;
+
+	// Get the mask of the rays of a given mask that overlap an AABB.
+	u32 TestAABB(const b3AABB3& aabb, u32 mask) const;
+
+	// Return true if the rays should visit the first AABB before the second.
+	bool IsFirstCloser(const b3AABB3& aabb1, const b3AABB3& aabb2) const;
+
+	b3RayCastInput* inputs;
+	u32 count;
+	
+	// The inverse of the segment of each ray.
+	b3Vec3 invDirections[B3_MAX_RAY_PACKET];
+
+	// The sum of the segments of the rays.
+	b3Vec3 direction;
+};
+
+inline void b3RayPacket::Set(b3RayCastInput* _inputs, u32 _count)
+{
+	B3_ASSERT(_count <= B3_MAX_RAY_PACKET);
+	inputs = _inputs;
+	count = _count;
+	direction.SetZero();
+	
+	for (u32 i = 0; i < count; ++i)
+	{
+		b3Vec3 d = inputs[i].p2 - inputs[i].p1;
+		direction += d;
+
+		// A parallel axis gets a large inverse so the slabs stay finite.
+		for (u32 j = 0; j < 3; ++j)
+		{
+			invDirections[i][j] = d[j] != 0.0f ? 1.0f / d[j] : B3_MAX_FLOAT;
+		}
+	}
+}
+
+inline u32 b3RayPacket::GetActiveMask() const
+{
+	u32 mask = 0;
+	for (u32 i = 0; i < count; ++i)
+	{
+		const b3RayCastInput& input = inputs[i];
+		b3Vec3 d = input.p2 - input.p1;
+		if (input.maxFraction > 0.0f && b3Dot(d, d) > B3_EPSILON * B3_EPSILON)
+		{
+			mask |= 1 << i;
+		}
+	}
+	return mask;
+}
+
+inline u32 b3RayPacket::TestAABB(const b3AABB3& aabb, u32 mask) const
+{
+	u32 result = 0;
+	for (u32 i = 0; i < count; ++i)
+	{
+		u32 bit = 1 << i;
+		if ((mask & bit) == 0)
+		{
+			continue;
+		}
+
+		const b3RayCastInput& input = inputs[i];
+		if (input.maxFraction == 0.0f)
+		{
+			// The ray has been stopped.
+			continue;
+		}
+
+		const b3Vec3& invDirection = invDirections[i];
+
+		float32 lower = 0.0f;
+		float32 upper = input.maxFraction;
+		
+		for (u32 j = 0; j < 3; ++j)
+		{
+			float32 t1 = (aabb.m_lower[j] - input.p1[j]) * invDirection[j];
+			float32 t2 = (aabb.m_upper[j] - input.p1[j]) * invDirection[j];
+
+			lower = b3Max(lower, b3Min(t1, t2));
+			upper = b3Min(upper, b3Max(t1, t2));
+		}
+
+		if (lower <= upper)
+		{
+			result |= bit;
+		}
+	}
+	return result;
+}
+
+inline bool b3RayPacket::IsFirstCloser(const b3AABB3& aabb1, const b3AABB3& aabb2) const
+{
+	return b3Dot(aabb2.Centroid() - aabb1.Centroid(), direction) >= 0.0f;
+}
+
+#endif
@@ -0,0 +1,54 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson https://irlanrobson.github.io
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#ifndef B3_TIME_OF_IMPACT_H
+#define B3_TIME_OF_IMPACT_H
+
+#include <bounce/collision/gjk/gjk.h>
+#include <bounce/collision/gjk/gjk_proxy.h>
+
+// Output parameters for b3TimeOfImpact.
+struct b3TOIOutput
+{
+	enum State
+	{
+		e_unknown,
+		e_failed,
+		e_overlapped,
+		e_touching,
+		e_separated
+	};
+
+	State state;
+	float32 t; // sweep fraction
+	u32 iterations; // number of conservative advancement iterations
+};
+
+// Compute the upper bound on the time of impact of two proxies moving along 
+// their sweeps over the interval [0, tMax] using conservative advancement. 
+// The proxy vertices must be in the body frame and the sweeps must start at the same time. 
+// The time of impact is the sweep fraction where the proxies overlap by up to 
+// a linear slop, so that the discrete collision finds contact points.
+// If the root finder fails then the time is a safe time before the impact.
+void b3TimeOfImpact(b3TOIOutput* output, 
+	const b3Sweep& sweepA, const b3GJKProxy& proxyA, 
+	const b3Sweep& sweepB, const b3GJKProxy& proxyB, 
+	float32 tMax);
+
+#endif
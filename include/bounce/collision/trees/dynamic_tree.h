@@ -21,7 +21,10 @@
 
 #include <bounce/common/template/stack.h>
 #include <bounce/collision/shapes/aabb3.h>
-#include <bounce/collision/collision.h>
+#include <bounce/collision/ray_packet.h>
+
+class b3Snapshot;
+class b3SnapshotReader;
 
 #define B3_NULL_NODE_D (0xFFFFFFFF)
 
@@ -62,11 +65,32 @@ public :
 	template<class T>
 	void RayCast(T* callback, const b3RayCastInput& input) const;
 
+	// Keep reporting the client callback the leaves that are overlapping with 
+	// the rays of a packet given by a mask. The client callback receives the mask 
+	// of the rays overlapping a leaf and can clip the rays by decreasing their 
+	// maximum fractions. A ray with a maximum fraction of zero is stopped.
+	template<class T>
+	void RayCastPacket(T* callback, const b3RayPacket* packet, u32 mask) const;
+
+	// Keep reporting the client callback all AABBs that are overlapping with 
+	// the given AABB swept along a translation. The client callback receives 
+	// the ray of the center of the swept AABB and must return the new fraction 
+	// of the translation. If the fraction == 0 then the query is cancelled immediately.
+	template<class T>
+	void AABBCast(T* callback, const b3AABB3& aabb, const b3Vec3& translation) const;
+
 	// Validate a given node of this tree.
 	void Validate(u32 node) const;
 
 	// Draw this tree.
 	void Draw() const;
+
+	// Write the nodes of this tree to a snapshot.
+	void WriteSnapshot(b3Snapshot* snapshot) const;
+
+	// Read the nodes written by WriteSnapshot. 
+	// The tree must have the same node capacity it had when the snapshot was written.
+	void ReadSnapshot(b3SnapshotReader* reader);
 private :
 	struct b3Node 
 	{
@@ -228,6 +252,144 @@ inline void b3DynamicTree::RayCast(T* callback, const b3RayCastInput& input) con
 					// The client has stopped the query.
 					return;
 				}
+
+				if (newFraction > 0.0f && newFraction < maxFraction)
+				{
+					// The client has clipped the ray.
+					maxFraction = newFraction;
+				}
+			}
+			else 
+			{
+				stack.Push(node->child1);
+				stack.Push(node->child2);
+			}
+		}
+	}
+}
+
+template<class T>
+inline void b3DynamicTree::RayCastPacket(T* callback, const b3RayPacket* packet, u32 mask) const
+{
+	if (mask == 0)
+	{
+		return;
+	}
+
+	// A node and the rays of its parent that overlap it.
+	struct b3PacketNode
+	{
+		u32 node;
+		u32 mask;
+	};
+
+	b3Stack<b3PacketNode, 256> stack;
+	
+	b3PacketNode root;
+	root.node = m_root;
+	root.mask = mask;
+	stack.Push(root);
+
+	while (stack.IsEmpty() == false) 
+	{
+		b3PacketNode entry = stack.Top();
+		stack.Pop();
+
+		if (entry.node == B3_NULL_NODE_D)
+		{
+			continue;
+		}
+
+		const b3Node* node = m_nodes + entry.node;
+
+		// The rays may have been clipped since the node was pushed.
+		u32 nodeMask = packet->TestAABB(node->aabb, entry.mask);
+		if (nodeMask == 0)
+		{
+			continue;
+		}
+
+		if (node->IsLeaf() == true) 
+		{
+			callback->Report(nodeMask, entry.node);
+		}
+		else 
+		{
+			// Visit the closest child first so the rays are clipped earlier.
+			b3PacketNode child1, child2;
+			child1.node = node->child1;
+			child1.mask = nodeMask;
+			child2.node = node->child2;
+			child2.mask = nodeMask;
+
+			if (packet->IsFirstCloser(m_nodes[node->child1].aabb, m_nodes[node->child2].aabb))
+			{
+				stack.Push(child2);
+				stack.Push(child1);
+			}
+			else
+			{
+				stack.Push(child1);
+				stack.Push(child2);
+			}
+		}
+	}
+}
+
+template<class T>
+inline void b3DynamicTree::AABBCast(T* callback, const b3AABB3& aabb, const b3Vec3& translation) const 
+{
+	// Cast the center of the AABB against the nodes extended by the AABB extents.
+	b3Vec3 h = 0.5f * (aabb.m_upper - aabb.m_lower);
+	b3Vec3 p1 = aabb.Centroid();
+	b3Vec3 p2 = p1 + translation;
+	float32 maxFraction = 1.0f;
+
+	// Ensure non-degenerate translation.
+	B3_ASSERT(b3Dot(translation, translation) > B3_EPSILON * B3_EPSILON);
+
+	b3Stack<u32, 256> stack;
+	stack.Push(m_root);
+
+	while (stack.IsEmpty() == false) 
+	{
+		u32 nodeIndex = stack.Top();
+		stack.Pop();
+
+		if (nodeIndex == B3_NULL_NODE_D) 
+		{
+			continue;
+		}
+
+		const b3Node* node = m_nodes + nodeIndex;
+
+		b3AABB3 nodeAABB;
+		nodeAABB.m_lower = node->aabb.m_lower - h;
+		nodeAABB.m_upper = node->aabb.m_upper + h;
+
+		float32 minFraction;
+		if (nodeAABB.TestRay(minFraction, p1, p2, maxFraction) == true)
+		{
+			if (node->IsLeaf() == true) 
+			{
+				b3RayCastInput subInput;
+				subInput.p1 = p1;
+				subInput.p2 = p2;
+				subInput.maxFraction = maxFraction;
+
+				float32 newFraction = callback->Report(subInput, nodeIndex);
+
+				if (newFraction == 0.0f)
+				{
+					// The client has stopped the query.
+					return;
+				}
+
+				if (newFraction > 0.0f && newFraction < maxFraction)
+				{
+					// The client has clipped the translation.
+					maxFraction = newFraction;
+				}
 			}
 			else 
 			{
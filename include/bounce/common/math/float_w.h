@@ -0,0 +1,345 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson https://irlanrobson.github.io
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#ifndef B3_FLOAT_W_H
+#define B3_FLOAT_W_H
+
+#include <bounce/common/math/math.h>
+
+// Select the SIMD instruction set from the compiler flags.
+// AVX2 packs 8 floats per register, SSE2 packs 4 floats. 
+// If neither is available then the wide operations are emulated 
+// with 4 scalar lanes. 
+#if defined(__AVX2__)
+	#define B3_SIMD_AVX2
+	#define B3_SIMD_WIDTH (8)
+	#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define B3_SIMD_SSE2
+	#define B3_SIMD_WIDTH (4)
+	#include <emmintrin.h>
+#else
+	#define B3_SIMD_WIDTH (4)
+#endif
+
+// A SIMD register of B3_SIMD_WIDTH floats. 
+// Each float is a lane. The lanes are independent.
+// The operations are lane-wise and give the same results as the scalar operations.
+struct b3FloatW
+{
+#if defined(B3_SIMD_AVX2)
+	__m256 v;
+#elif defined(B3_SIMD_SSE2)
+	__m128 v;
+#else
+	float32 v[B3_SIMD_WIDTH];
+#endif
+};
+
+#if defined(B3_SIMD_AVX2)
+
+inline b3FloatW b3MakeW(__m256 v)
+{
+	b3FloatW r;
+	r.v = v;
+	return r;
+}
+
+// Set all lanes to a given value.
+inline b3FloatW b3SplatW(float32 s)
+{
+	return b3MakeW(_mm256_set1_ps(s));
+}
+
+inline b3FloatW operator+(const b3FloatW& a, const b3FloatW& b)
+{
+	return b3MakeW(_mm256_add_ps(a.v, b.v));
+}
+
+inline b3FloatW operator-(const b3FloatW& a, const b3FloatW& b)
+{
+	return b3MakeW(_mm256_sub_ps(a.v, b.v));
+}
+
+inline b3FloatW operator*(const b3FloatW& a, const b3FloatW& b)
+{
+	return b3MakeW(_mm256_mul_ps(a.v, b.v));
+}
+
+inline b3FloatW operator/(const b3FloatW& a, const b3FloatW& b)
+{
+	return b3MakeW(_mm256_div_ps(a.v, b.v));
+}
+
+// Negate each lane.
+inline b3FloatW operator-(const b3FloatW& a)
+{
+	return b3MakeW(_mm256_xor_ps(a.v, _mm256_set1_ps(-0.0f)));
+}
+
+// Same as b3Min for each lane.
+inline b3FloatW b3MinW(const b3FloatW& a, const b3FloatW& b)
+{
+	return b3MakeW(_mm256_min_ps(a.v, b.v));
+}
+
+// Same as b3Max for each lane.
+inline b3FloatW b3MaxW(const b3FloatW& a, const b3FloatW& b)
+{
+	return b3MakeW(_mm256_max_ps(a.v, b.v));
+}
+
+inline b3FloatW b3SqrtW(const b3FloatW& a)
+{
+	return b3MakeW(_mm256_sqrt_ps(a.v));
+}
+
+// Return a mask whose lanes are set where a > b.
+inline b3FloatW b3GreaterW(const b3FloatW& a, const b3FloatW& b)
+{
+	return b3MakeW(_mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ));
+}
+
+// Select the lanes of a where the mask is set and the lanes of b otherwise.
+inline b3FloatW b3SelectW(const b3FloatW& mask, const b3FloatW& a, const b3FloatW& b)
+{
+	return b3MakeW(_mm256_blendv_ps(b.v, a.v, mask.v));
+}
+
+#elif defined(B3_SIMD_SSE2)
+
+inline b3FloatW b3MakeW(__m128 v)
+{
+	b3FloatW r;
+	r.v = v;
+	return r;
+}
+
+// Set all lanes to a given value.
+inline b3FloatW b3SplatW(float32 s)
+{
+	return b3MakeW(_mm_set1_ps(s));
+}
+
+inline b3FloatW operator+(const b3FloatW& a, const b3FloatW& b)
+{
+	return b3MakeW(_mm_add_ps(a.v, b.v));
+}
+
+inline b3FloatW operator-(const b3FloatW& a, const b3FloatW& b)
+{
+	return b3MakeW(_mm_sub_ps(a.v, b.v));
+}
+
+inline b3FloatW operator*(const b3FloatW& a, const b3FloatW& b)
+{
+	return b3MakeW(_mm_mul_ps(a.v, b.v));
+}
+
+inline b3FloatW operator/(const b3FloatW& a, const b3FloatW& b)
+{
+	return b3MakeW(_mm_div_ps(a.v, b.v));
+}
+
+// Negate each lane.
+inline b3FloatW operator-(const b3FloatW& a)
+{
+	return b3MakeW(_mm_xor_ps(a.v, _mm_set1_ps(-0.0f)));
+}
+
+// Same as b3Min for each lane.
+inline b3FloatW b3MinW(const b3FloatW& a, const b3FloatW& b)
+{
+	return b3MakeW(_mm_min_ps(a.v, b.v));
+}
+
+// Same as b3Max for each lane.
+inline b3FloatW b3MaxW(const b3FloatW& a, const b3FloatW& b)
+{
+	return b3MakeW(_mm_max_ps(a.v, b.v));
+}
+
+inline b3FloatW b3SqrtW(const b3FloatW& a)
+{
+	return b3MakeW(_mm_sqrt_ps(a.v));
+}
+
+// Return a mask whose lanes are set where a > b.
+inline b3FloatW b3GreaterW(const b3FloatW& a, const b3FloatW& b)
+{
+	return b3MakeW(_mm_cmpgt_ps(a.v, b.v));
+}
+
+// Select the lanes of a where the mask is set and the lanes of b otherwise.
+inline b3FloatW b3SelectW(const b3FloatW& mask, const b3FloatW& a, const b3FloatW& b)
+{
+	return b3MakeW(_mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v)));
+}
+
+#else
+
+// Set all lanes to a given value.
+inline b3FloatW b3SplatW(float32 s)
+{
+	b3FloatW r;
+	for (u32 i = 0; i < B3_SIMD_WIDTH; ++i)
+	{
+		r.v[i] = s;
+	}
+	return r;
+}
+
+inline b3FloatW operator+(const b3FloatW& a, const b3FloatW& b)
+{
+	b3FloatW r;
+	for (u32 i = 0; i < B3_SIMD_WIDTH; ++i)
+	{
+		r.v[i] = a.v[i] + b.v[i];
+	}
+	return r;
+}
+
+inline b3FloatW operator-(const b3FloatW& a, const b3FloatW& b)
+{
+	b3FloatW r;
+	for (u32 i = 0; i < B3_SIMD_WIDTH; ++i)
+	{
+		r.v[i] = a.v[i] - b.v[i];
+	}
+	return r;
+}
+
+inline b3FloatW operator*(const b3FloatW& a, const b3FloatW& b)
+{
+	b3FloatW r;
+	for (u32 i = 0; i < B3_SIMD_WIDTH; ++i)
+	{
+		r.v[i] = a.v[i] * b.v[i];
+	}
+	return r;
+}
+
+inline b3FloatW operator/(const b3FloatW& a, const b3FloatW& b)
+{
+	b3FloatW r;
+	for (u32 i = 0; i < B3_SIMD_WIDTH; ++i)
+	{
+		r.v[i] = a.v[i] / b.v[i];
+	}
+	return r;
+}
+
+// Negate each lane.
+inline b3FloatW operator-(const b3FloatW& a)
+{
+	b3FloatW r;
+	for (u32 i = 0; i < B3_SIMD_WIDTH; ++i)
+	{
+		r.v[i] = -a.v[i];
+	}
+	return r;
+}
+
+// Same as b3Min for each lane.
+inline b3FloatW b3MinW(const b3FloatW& a, const b3FloatW& b)
+{
+	b3FloatW r;
+	for (u32 i = 0; i < B3_SIMD_WIDTH; ++i)
+	{
+		r.v[i] = b3Min(a.v[i], b.v[i]);
+	}
+	return r;
+}
+
+// Same as b3Max for each lane.
+inline b3FloatW b3MaxW(const b3FloatW& a, const b3FloatW& b)
+{
+	b3FloatW r;
+	for (u32 i = 0; i < B3_SIMD_WIDTH; ++i)
+	{
+		r.v[i] = b3Max(a.v[i], b.v[i]);
+	}
+	return r;
+}
+
+inline b3FloatW b3SqrtW(const b3FloatW& a)
+{
+	b3FloatW r;
+	for (u32 i = 0; i < B3_SIMD_WIDTH; ++i)
+	{
+		r.v[i] = b3Sqrt(a.v[i]);
+	}
+	return r;
+}
+
+// Return a mask whose lanes are set where a > b.
+inline b3FloatW b3GreaterW(const b3FloatW& a, const b3FloatW& b)
+{
+	b3FloatW r;
+	for (u32 i = 0; i < B3_SIMD_WIDTH; ++i)
+	{
+		r.v[i] = a.v[i] > b.v[i] ? 1.0f : 0.0f;
+	}
+	return r;
+}
+
+// Select the lanes of a where the mask is set and the lanes of b otherwise.
+inline b3FloatW b3SelectW(const b3FloatW& mask, const b3FloatW& a, const b3FloatW& b)
+{
+	b3FloatW r;
+	for (u32 i = 0; i < B3_SIMD_WIDTH; ++i)
+	{
+		r.v[i] = mask.v[i] != 0.0f ? a.v[i] : b.v[i];
+	}
+	return r;
+}
+
+#endif
+
+// Set all lanes to zero.
+inline b3FloatW b3ZeroW()
+{
+	return b3SplatW(0.0f);
+}
+
+// Same as b3Clamp for each lane.
+inline b3FloatW b3ClampW(const b3FloatW& a, const b3FloatW& low, const b3FloatW& high)
+{
+	return b3MaxW(low, b3MinW(a, high));
+}
+
+// Get a lane. 
+// This is slow and should only be used for packing and unpacking.
+inline float32 b3GetLaneW(const b3FloatW& a, u32 lane)
+{
+	B3_ASSERT(lane < B3_SIMD_WIDTH);
+	float32 s;
+	memcpy(&s, (const u8*)&a + lane * sizeof(float32), sizeof(float32));
+	return s;
+}
+
+// Set a lane.
+// This is slow and should only be used for packing and unpacking.
+inline void b3SetLaneW(b3FloatW& a, u32 lane, float32 s)
+{
+	B3_ASSERT(lane < B3_SIMD_WIDTH);
+	memcpy((u8*)&a + lane * sizeof(float32), &s, sizeof(float32));
+}
+
+#endif
@@ -0,0 +1,47 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson https://irlanrobson.github.io
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#ifndef B3_MAT33_W_H
+#define B3_MAT33_W_H
+
+#include <bounce/common/math/vec3_w.h>
+#include <bounce/common/math/mat33.h>
+
+// B3_SIMD_WIDTH 3-by-3 matrices stored in column-major order 
+// as a structure of arrays.
+struct b3Mat33W
+{
+	b3Vec3W x, y, z;
+};
+
+// Multiply a matrix times a vector.
+inline b3Vec3W operator*(const b3Mat33W& A, const b3Vec3W& v)
+{
+	return v.x * A.x + v.y * A.y + v.z * A.z;
+}
+
+// Set a lane.
+inline void b3SetLaneW(b3Mat33W& A, u32 lane, const b3Mat33& s)
+{
+	b3SetLaneW(A.x, lane, s.x);
+	b3SetLaneW(A.y, lane, s.y);
+	b3SetLaneW(A.z, lane, s.z);
+}
+
+#endif
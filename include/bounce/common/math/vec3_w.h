@@ -0,0 +1,118 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson https://irlanrobson.github.io
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#ifndef B3_VEC3_W_H
+#define B3_VEC3_W_H
+
+#include <bounce/common/math/float_w.h>
+#include <bounce/common/math/vec3.h>
+
+// B3_SIMD_WIDTH 3D vectors stored as a structure of arrays.
+struct b3Vec3W
+{
+	// Add a vector to this vector.
+	void operator+=(const b3Vec3W& b)
+	{
+		x = x + b.x;
+		y = y + b.y;
+		z = z + b.z;
+	}
+
+	// Subtract a vector from this vector.
+	void operator-=(const b3Vec3W& b)
+	{
+		x = x - b.x;
+		y = y - b.y;
+		z = z - b.z;
+	}
+
+	b3FloatW x, y, z;
+};
+
+// Set all lanes to the zero vector.
+inline b3Vec3W b3ZeroVec3W()
+{
+	b3Vec3W r;
+	r.x = b3ZeroW();
+	r.y = b3ZeroW();
+	r.z = b3ZeroW();
+	return r;
+}
+
+// Compute the sum of two vectors.
+inline b3Vec3W operator+(const b3Vec3W& a, const b3Vec3W& b)
+{
+	b3Vec3W r;
+	r.x = a.x + b.x;
+	r.y = a.y + b.y;
+	r.z = a.z + b.z;
+	return r;
+}
+
+// Compute the subtraction of two vectors.
+inline b3Vec3W operator-(const b3Vec3W& a, const b3Vec3W& b)
+{
+	b3Vec3W r;
+	r.x = a.x - b.x;
+	r.y = a.y - b.y;
+	r.z = a.z - b.z;
+	return r;
+}
+
+// Compute a scalar-vector product.
+inline b3Vec3W operator*(const b3FloatW& s, const b3Vec3W& v)
+{
+	b3Vec3W r;
+	r.x = s * v.x;
+	r.y = s * v.y;
+	r.z = s * v.z;
+	return r;
+}
+
+// Compute the dot-product of two vectors.
+inline b3FloatW b3Dot(const b3Vec3W& a, const b3Vec3W& b)
+{
+	return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+// Compute the cross-product of two vectors.
+inline b3Vec3W b3Cross(const b3Vec3W& a, const b3Vec3W& b)
+{
+	b3Vec3W r;
+	r.x = a.y * b.z - a.z * b.y;
+	r.y = a.z * b.x - a.x * b.z;
+	r.z = a.x * b.y - a.y * b.x;
+	return r;
+}
+
+// Get a lane. 
+inline b3Vec3 b3GetLaneW(const b3Vec3W& v, u32 lane)
+{
+	return b3Vec3(b3GetLaneW(v.x, lane), b3GetLaneW(v.y, lane), b3GetLaneW(v.z, lane));
+}
+
+// Set a lane.
+inline void b3SetLaneW(b3Vec3W& v, u32 lane, const b3Vec3& s)
+{
+	b3SetLaneW(v.x, lane, s.x);
+	b3SetLaneW(v.y, lane, s.y);
+	b3SetLaneW(v.z, lane, s.z);
+}
+
+#endif
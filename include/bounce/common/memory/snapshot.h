@@ -0,0 +1,108 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson https://irlanrobson.github.io
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B3_SNAPSHOT_H
+#define B3_SNAPSHOT_H
+
+#include <bounce/common/settings.h>
+
+// A growable binary buffer holding the saved state of an object.
+// The memory is kept when the snapshot is cleared, so saving 
+// the same object repeatedly doesn't allocate.
+class b3Snapshot
+{
+public:
+	b3Snapshot();
+	~b3Snapshot();
+
+	// Remove the data from this snapshot but keep its memory.
+	void Clear();
+
+	// Append data to this snapshot.
+	void Write(const void* data, u32 size);
+
+	// Append a value to this snapshot.
+	template<class T>
+	void Write(const T& value)
+	{
+		Write(&value, sizeof(T));
+	}
+
+	// Get the data in this snapshot.
+	const void* GetData() const;
+
+	// Get the size of the data in this snapshot in bytes.
+	u32 GetSize() const;
+private:
+	b3Snapshot(const b3Snapshot&);
+	b3Snapshot& operator=(const b3Snapshot&);
+
+	u8* m_data;
+	u32 m_size;
+	u32 m_capacity;
+};
+
+inline const void* b3Snapshot::GetData() const
+{
+	return m_data;
+}
+
+inline u32 b3Snapshot::GetSize() const
+{
+	return m_size;
+}
+
+// Reads back the data of a snapshot in the order it was written.
+class b3SnapshotReader
+{
+public:
+	b3SnapshotReader(const b3Snapshot& snapshot);
+
+	// Read data from the snapshot.
+	void Read(void* data, u32 size);
+
+	// Read a value from the snapshot.
+	template<class T>
+	void Read(T& value)
+	{
+		Read(&value, sizeof(T));
+	}
+
+	// Get a value from the snapshot.
+	template<class T>
+	T Read()
+	{
+		T value;
+		Read(&value, sizeof(T));
+		return value;
+	}
+
+	// Have all the data been read?
+	bool IsAtEnd() const;
+private:
+	const u8* m_data;
+	u32 m_size;
+	u32 m_offset;
+};
+
+inline bool b3SnapshotReader::IsAtEnd() const
+{
+	return m_offset == m_size;
+}
+
+#endif
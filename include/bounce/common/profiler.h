@@ -0,0 +1,154 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson https://irlanrobson.github.io
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#ifndef B3_PROFILER_H
+#define B3_PROFILER_H
+
+#include <bounce/common/settings.h>
+#include <bounce/common/time.h>
+#include <atomic>
+
+// The number of events the ring buffer of each thread holds. 
+// This must be a power of two. Old events are overwritten when the buffer is full.
+#define B3_PROFILER_EVENT_CAPACITY (16384)
+
+// The maximum number of threads that can record events.
+#define B3_PROFILER_MAX_THREADS (64)
+
+// The maximum number of distinct scopes aggregated in a frame.
+#define B3_PROFILER_MAX_SCOPES (256)
+
+// A profiler event. 
+// The name is NULL if the event closes the last scope opened by the thread.
+struct b3ProfilerEvent
+{
+	const char* name;
+	u64 ticks;
+};
+
+// The time spent in a scope in the last frame summed over all threads.
+struct b3ProfilerScope
+{
+	const char* name; 
+	u32 callCount; // number of times the scope was closed in the frame
+	float64 time; // inclusive time in milliseconds
+};
+
+// A built-in profiler that records the profile scopes into a 
+// lock-free ring buffer per thread. 
+// A thread only writes to its own buffer, so recording a scope costs 
+// a timestamp read and two stores. 
+// The recorded scopes are aggregated per frame and can be 
+// exported to the Chrome trace format read by chrome://tracing and Perfetto.
+// Set B3_ENABLE_PROFILER to one and set b3_profiler to record all B3_PROFILE scopes, 
+// or call BeginScope and EndScope from your own b3BeginProfileScope and b3EndProfileScope.
+class b3Profiler
+{
+public:
+	b3Profiler();
+	~b3Profiler();
+
+	// Record the beginning of a scope in the buffer of the calling thread. 
+	// The name must stay valid while the events are read.
+	void BeginScope(const char* name);
+
+	// Record the end of the last scope opened by the calling thread.
+	void EndScope();
+
+	// Mark the beginning of a frame. 
+	void BeginFrame();
+
+	// Mark the end of a frame and aggregate the scopes closed in the frame. 
+	// This must not be called while other threads are recording.
+	void EndFrame();
+
+	// Get the duration of the last frame in milliseconds.
+	float64 GetFrameTime() const;
+
+	// Get the scopes aggregated in the last frame in order of first appearance.
+	const b3ProfilerScope* GetScopes() const;
+	u32 GetScopeCount() const;
+
+	// Write the events still held in the ring buffers to a file in the 
+	// Chrome trace event format. Return true if the file was written. 
+	// This must not be called while other threads are recording.
+	bool ExportChromeTrace(const char* fileName);
+
+	// Discard all recorded events.
+	void Clear();
+private:
+	struct b3ThreadBuffer
+	{
+		b3ProfilerEvent events[B3_PROFILER_EVENT_CAPACITY];
+		
+		// The number of events ever written to this buffer.
+		std::atomic<u32> head;
+		
+		// The head at the beginning of the frame.
+		u32 frameHead;
+	};
+
+	// Get the buffer of the calling thread. 
+	// Return NULL if there are too many threads.
+	b3ThreadBuffer* GetThreadBuffer();
+
+	// Update the conversion from timestamp ticks to milliseconds.
+	void Calibrate();
+
+	// Convert ticks to milliseconds since the creation of this profiler.
+	float64 ToMilis(u64 ticks) const;
+
+	// The profiler generation. A thread claims a new buffer 
+	// if its cached buffer belongs to another profiler.
+	u32 m_id;
+
+	std::atomic<u32> m_threadCount;
+	std::atomic<b3ThreadBuffer*> m_threads[B3_PROFILER_MAX_THREADS];
+
+	b3Time m_timer;
+	u64 m_ticks0;
+	float64 m_milisPerTick;
+
+	u64 m_frameTicks;
+	float64 m_frameTime;
+
+	b3ProfilerScope m_scopes[B3_PROFILER_MAX_SCOPES];
+	u32 m_scopeCount;
+};
+
+// The profiler that receives the B3_PROFILE scopes if B3_ENABLE_PROFILER is one. 
+// The scopes are not recorded if this is NULL.
+extern b3Profiler* b3_profiler;
+
+inline float64 b3Profiler::GetFrameTime() const
+{
+	return m_frameTime;
+}
+
+inline const b3ProfilerScope* b3Profiler::GetScopes() const
+{
+	return m_scopes;
+}
+
+inline u32 b3Profiler::GetScopeCount() const
+{
+	return m_scopeCount;
+}
+
+#endif
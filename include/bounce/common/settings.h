@@ -100,10 +100,42 @@ typedef float float32;
 // However values very close to 1 may lead to overshoot.
 #define B3_BAUMGARTE (0.1f)
 
+// This controls how faster overlaps are resolved at a time of impact.
+#define B3_TOI_BAUMGARTE (0.75f)
+
 // If the relative velocity of a contact point is below 
 // the threshold then restitution is not applied.
 #define B3_VELOCITY_THRESHOLD (1.0f)
 
+// The stiffness and damping ratio of the soft contacts used when substepping. 
+// The stiffness is capped to a quarter of the substep rate.
+#define B3_CONTACT_HERTZ (30.0f)
+#define B3_CONTACT_DAMPING_RATIO (10.0f)
+
+// The maximum speed used to push overlapping shapes apart when substepping.
+#define B3_MAX_CONTACT_PUSH_SPEED (3.0f)
+
+// The separation below which speculative contact points are built 
+// in addition to the distance the shapes approach in a step.
+#define B3_SPECULATIVE_DISTANCE (4.0f * B3_LINEAR_SLOP)
+
+// The maximum number of iterations used to compute a time of impact.
+#define B3_MAX_TOI_ITERATIONS (20)
+
+// The maximum number of times a contact is resolved at its time of impact per step.
+#define B3_MAX_TOI_SUBSTEPS (8)
+
+// The number of position iterations used to push the bodies apart at a time of impact.
+#define B3_TOI_POSITION_ITERATIONS (20)
+
+// The maximum number of colors used to partition the constraints of an island. 
+// Constraints that can't be colored are solved serially after the colored constraints.
+#define B3_MAX_COLORS (64)
+
+// Islands with at least this number of constraints are solved 
+// using graph coloring if it is enabled in the world.
+#define B3_GRAPH_COLORING_THRESHOLD (256)
+
 // Sleep
 #define B3_TIME_TO_SLEEP (0.2f)
 #define B3_SLEEP_LINEAR_TOL (0.05f)
@@ -134,6 +166,8 @@ typedef float float32;
 #define B3_PROFILE(name) b3ProfileScope B3_UNIQUE_NAME(scope)(name)
 
 // You should implement this function to use your own memory allocator.
+// If a task scheduler with more than one thread is used then this function can be called 
+// concurrently from the worker threads.
 void* b3Alloc(u32 size);
 
 // You must implement this function if you have implemented b3Alloc.
@@ -144,23 +178,47 @@ void b3Free(void* block);
 void b3Log(const char* string, ...);
 
 // You should implement this function to listen when a profile scope is opened.
+// If a task scheduler with more than one thread is used then this function can be called 
+// concurrently from the worker threads.
 void b3BeginProfileScope(const char* name);
 
 // You must implement this function if you have implemented b3BeginProfileScope.
 // Implement this function to listen when a profile scope is closed.
 void b3EndProfileScope();
 
+// Set this to one to record the profile scopes into the built-in profiler b3_profiler 
+// instead of calling b3BeginProfileScope and b3EndProfileScope. See profiler.h.
+#ifndef B3_ENABLE_PROFILER
+#define B3_ENABLE_PROFILER (0)
+#endif
+
+#if B3_ENABLE_PROFILER
+
+// Record a profile scope into b3_profiler if it is set.
+void b3ProfilerBeginScope(const char* name);
+void b3ProfilerEndScope();
+
+#endif
+
 // 
 struct b3ProfileScope
 {
 	b3ProfileScope(const char* name)
 	{
+#if B3_ENABLE_PROFILER
+		b3ProfilerBeginScope(name);
+#else
 		b3BeginProfileScope(name);
+#endif
 	}
 
 	~b3ProfileScope()
 	{
+#if B3_ENABLE_PROFILER
+		b3ProfilerEndScope();
+#else
 		b3EndProfileScope();
+#endif
 	}
 };
 
@@ -0,0 +1,95 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson https://irlanrobson.github.io
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#ifndef B3_STATS_H
+#define B3_STATS_H
+
+#include <bounce/common/settings.h>
+
+// Set this to zero to compile the statistics out of the library.
+#ifndef B3_ENABLE_STATS
+#define B3_ENABLE_STATS (1)
+#endif
+
+// Compile a statement only if the statistics are enabled.
+#if B3_ENABLE_STATS
+#define B3_STAT(...) __VA_ARGS__
+#else
+#define B3_STAT(...)
+#endif
+
+// The counters of the collision routines. 
+struct b3CollisionStats
+{
+	// Set all counters to zero.
+	void Reset()
+	{
+		gjkCalls = 0;
+		gjkIters = 0;
+		gjkMaxIters = 0;
+		gjkCacheHits = 0;
+		satCalls = 0;
+		satCacheHits = 0;
+		toiCalls = 0;
+		toiIters = 0;
+		toiMaxIters = 0;
+		allocCalls = 0;
+	}
+
+	// Add the counters of another thread to these counters.
+	void Add(const b3CollisionStats& other)
+	{
+		gjkCalls += other.gjkCalls;
+		gjkIters += other.gjkIters;
+		gjkMaxIters = gjkMaxIters > other.gjkMaxIters ? gjkMaxIters : other.gjkMaxIters;
+		gjkCacheHits += other.gjkCacheHits;
+		satCalls += other.satCalls;
+		satCacheHits += other.satCacheHits;
+		toiCalls += other.toiCalls;
+		toiIters += other.toiIters;
+		toiMaxIters = toiMaxIters > other.toiMaxIters ? toiMaxIters : other.toiMaxIters;
+		allocCalls += other.allocCalls;
+	}
+
+	u32 gjkCalls; // number of distance queries
+	u32 gjkIters; // total number of support point calls
+	u32 gjkMaxIters; // maximum number of support point calls in a query
+	u32 gjkCacheHits; // number of queries that started from the cached simplex
+	u32 satCalls; // number of hull-hull manifolds
+	u32 satCacheHits; // number of hull-hull manifolds that were built from the feature cache
+	u32 toiCalls; // number of time of impact queries
+	u32 toiIters; // total number of root finder iterations
+	u32 toiMaxIters; // maximum number of root finder iterations in a query
+	u32 allocCalls; // number of calls to b3Alloc
+};
+
+// The counters the calling thread adds to. 
+// This is NULL if the calling thread doesn't count. 
+// The world points this to its own counters of the thread while it steps. 
+extern thread_local b3CollisionStats* b3_threadStats;
+
+// Set the counters the calling thread adds to and return the previous ones.
+inline b3CollisionStats* b3SetThreadStats(b3CollisionStats* stats)
+{
+	b3CollisionStats* old = b3_threadStats;
+	b3_threadStats = stats;
+	return old;
+}
+
+#endif
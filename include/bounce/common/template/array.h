@@ -250,4 +250,18 @@ protected:
 	T m_stackElements[N];
 };
 
+// Move an array of bytes (POD) into a new block with a given capacity.
+// The old block is freed.
+template <typename T>
+inline void b3Grow(T*& elements, u32 count, u32 capacity)
+{
+	T* oldElements = elements;
+	elements = (T*)b3Alloc(capacity * sizeof(T));
+	if (oldElements)
+	{
+		memcpy(elements, oldElements, count * sizeof(T));
+		b3Free(oldElements);
+	}
+}
+
 #endif
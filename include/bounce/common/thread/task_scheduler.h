@@ -0,0 +1,111 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson https://irlanrobson.github.io
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#ifndef B3_TASK_SCHEDULER_H
+#define B3_TASK_SCHEDULER_H
+
+#include <bounce/common/settings.h>
+#include <atomic>
+
+// The maximum number of threads that a task scheduler can use, 
+// including the thread that waits for the tasks.
+#define B3_MAX_THREADS (32)
+
+// A task callback. 
+// The thread index is the index of the thread executing the task 
+// in the range [0, thread count).
+typedef void (*b3TaskFcn)(void* context, u32 threadIndex);
+
+// A parallel-for callback. 
+// It is called for a range of work items [begin, end).
+typedef void (*b3ParallelForFcn)(void* context, u32 begin, u32 end, u32 threadIndex);
+
+// A group of tasks that can be waited on.
+struct b3TaskGroup
+{
+	b3TaskGroup()
+	{
+		pendingCount = 0;
+		userData = nullptr;
+	}
+
+	// Number of submitted tasks that haven't finished.
+	std::atomic<u32> pendingCount;
+
+	// Free for use by custom task schedulers.
+	void* userData;
+};
+
+// A unit of work. 
+// A task is owned by the caller and must stay valid until 
+// its group has been waited on.
+struct b3Task
+{
+	b3TaskFcn fcn;
+	void* context;
+	
+	// The group this task was submitted to. This is set by the scheduler.
+	b3TaskGroup* group;
+};
+
+// Implement this interface to run the engine on your own job system.
+// A scheduler can be shared by worlds, cloths and soft bodies but 
+// only one thread can step them at a time.
+class b3TaskScheduler
+{
+public:
+	virtual ~b3TaskScheduler() { }
+
+	// Get the number of threads that can execute tasks, 
+	// including the thread that waits for them.
+	virtual u32 GetThreadCount() const = 0;
+
+	// Get the index of the calling thread in the range [0, thread count).
+	// The thread that waits for the tasks must have index zero.
+	virtual u32 GetThreadIndex() const = 0;
+
+	// Submit a task to a group. The task may be executed immediately.
+	// Tasks can submit other tasks.
+	virtual void Submit(b3TaskGroup* group, b3Task* task) = 0;
+
+	// Wait for all the tasks submitted to a group to finish.
+	virtual void Wait(b3TaskGroup* group) = 0;
+
+	// Call the callback over [0, count) in ranges of at least grainSize items 
+	// and wait for all calls to finish. 
+	// The default implementation submits one task per range.
+	virtual void ParallelFor(u32 count, u32 grainSize, b3ParallelForFcn fcn, void* context);
+};
+
+// A scheduler that executes the tasks on the calling thread.
+class b3SerialTaskScheduler : public b3TaskScheduler
+{
+public:
+	u32 GetThreadCount() const;
+
+	u32 GetThreadIndex() const;
+
+	void Submit(b3TaskGroup* group, b3Task* task);
+
+	void Wait(b3TaskGroup* group);
+
+	void ParallelFor(u32 count, u32 grainSize, b3ParallelForFcn fcn, void* context);
+};
+
+#endif
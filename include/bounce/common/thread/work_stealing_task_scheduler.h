@@ -0,0 +1,86 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson https://irlanrobson.github.io
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#ifndef B3_WORK_STEALING_TASK_SCHEDULER_H
+#define B3_WORK_STEALING_TASK_SCHEDULER_H
+
+#include <bounce/common/thread/task_scheduler.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// The maximum number of tasks that can be queued on a single thread.
+// If a queue is full then submitted tasks are executed immediately.
+#define B3_MAX_QUEUED_TASKS (256)
+
+// A built-in scheduler backed by a fixed number of worker threads.
+// Each thread owns a task queue. A thread executes its own tasks 
+// in LIFO order and steals tasks in FIFO order from the other 
+// threads when its queue is empty.
+// The thread that waits on a group executes tasks while waiting.
+class b3WorkStealingTaskScheduler : public b3TaskScheduler
+{
+public:
+	// Spawn (threadCount - 1) worker threads.
+	b3WorkStealingTaskScheduler(u32 threadCount);
+	~b3WorkStealingTaskScheduler();
+
+	u32 GetThreadCount() const;
+
+	u32 GetThreadIndex() const;
+
+	void Submit(b3TaskGroup* group, b3Task* task);
+
+	void Wait(b3TaskGroup* group);
+private:
+	struct b3TaskQueue
+	{
+		std::mutex mutex;
+		b3Task* tasks[B3_MAX_QUEUED_TASKS];
+		u32 head;
+		u32 count;
+	};
+
+	void WorkerMain(u32 threadIndex);
+
+	// Pop a task from the queue of the given thread or steal one from another thread.
+	b3Task* Pop(u32 threadIndex);
+
+	void Execute(b3Task* task, u32 threadIndex);
+
+	u32 m_threadCount;
+	std::thread* m_threads[B3_MAX_THREADS];
+	b3TaskQueue m_queues[B3_MAX_THREADS];
+
+	// Number of tasks in all queues.
+	std::atomic<u32> m_queuedCount;
+
+	// Idle workers sleep here.
+	std::mutex m_sleepMutex;
+	std::condition_variable m_sleepCondition;
+	std::atomic<u32> m_sleepingCount;
+	bool m_exit;
+};
+
+inline u32 b3WorkStealingTaskScheduler::GetThreadCount() const
+{
+	return m_threadCount;
+}
+
+#endif
@@ -25,6 +25,8 @@
 #include <bounce/common/math/transform.h>
 #include <bounce/common/template/list.h>
 #include <bounce/dynamics/time_step.h>
+#include <bounce/dynamics/body_store.h>
+#include <bounce/dynamics/world.h>
 
 class b3World;
 class b3Shape;
@@ -32,6 +34,7 @@ class b3Shape;
 struct b3ShapeDef;
 struct b3MassData;
 struct b3JointEdge;
+struct b3PersistentIsland;
 
 // Static body: Has zero mass, can be moved manually.
 // Kinematic body: Has zero mass, non-zero velocity, can be moved by the solver.
@@ -50,6 +53,7 @@ struct b3BodyDef
 	{
 		type = e_staticBody;
 		awake = true;
+		bullet = false;
 		fixedRotationX = false;
 		fixedRotationY = false;
 		fixedRotationZ = false;
@@ -68,6 +72,11 @@ struct b3BodyDef
 	
 	//
 	bool awake;
+
+	// Is this a fast moving body that should be prevented from tunneling through 
+	// other bodies? 
+	// A bullet is moved to its first time of impact with other bodies in a step.
+	bool bullet;
 	
 	//
 	bool fixedRotationX;
@@ -131,9 +140,11 @@ public:
 	void DestroyShape(b3Shape* shape);
 
 	// Get the body sweep.
+	// The reference is invalidated when a body is created or destroyed.
 	const b3Sweep& GetSweep() const;
 
 	// Get the body world transform.
+	// The reference is invalidated when a body is created or destroyed.
 	const b3Transform& GetTransform() const;
 
 	// Set the body world transform from a position, axis of rotation and an angle 
@@ -271,6 +282,12 @@ public:
 	// Set the awake status of the body.
 	void SetAwake(bool flag);
 
+	// Is this body treated like a bullet for continuous collision detection?
+	bool IsBullet() const;
+
+	// Should this body be treated like a bullet for continuous collision detection?
+	void SetBullet(bool flag);
+
 	// Get the user data associated with the body.
 	// The user data is usually a game entity.
 	void* GetUserData() const;
@@ -287,6 +304,7 @@ public:
 private:
 	friend class b3World;
 	friend class b3Island;
+	friend class b3IslandManager;
 
 	friend class b3Contact;
 	friend class b3ConvexContact;
@@ -306,6 +324,8 @@ private:
 
 	friend class b3List2<b3Body>;
 
+	friend class b3BodyStore;
+
 	friend class b3ClothSolver;
 	friend class b3ClothContactSolver;
 
@@ -320,6 +340,7 @@ private:
 		e_fixedRotationX = 0x0004,
 		e_fixedRotationY = 0x0008,
 		e_fixedRotationZ = 0x0010,
+		e_bulletFlag = 0x0020,
 	};
 
 	b3Body(const b3BodyDef& def, b3World* world);
@@ -337,9 +358,44 @@ private:
 	void SynchronizeTransform();
 	void SynchronizeShapes();
 
+	// Move the body to a given time of impact in the step.
+	// This doesn't synchronize the shapes.
+	void Advance(float32 t);
+
 	// Check if this body should collide with another.
 	bool ShouldCollide(const b3Body* other) const;
 
+	// Recalculate this body mass data based on all of its shapes. 
+	// Unlike ResetMass this isn't recorded.
+	void UpdateMass();
+
+	// Record a call to this body in the world recorder.
+	void RecordSetTransform(const b3Vec3& position, const b3Vec3& axis, float32 angle);
+	void RecordVector(b3RecordType type, const b3Vec3& v);
+	void RecordVectorWake(b3RecordType type, const b3Vec3& v, bool wake);
+	void RecordPointWake(b3RecordType type, const b3Vec3& v, const b3Vec3& point, bool wake);
+	void RecordScalar(b3RecordType type, float32 value);
+	void RecordFlag(b3RecordType type, bool flag);
+
+	// The state of this body in the body store.
+	b3Sweep& Sweep();
+	const b3Sweep& Sweep() const;
+	
+	b3Transform& Transform();
+	const b3Transform& Transform() const;
+	
+	b3Vec3& LinearVelocity();
+	const b3Vec3& LinearVelocity() const;
+	
+	b3Vec3& AngularVelocity();
+	const b3Vec3& AngularVelocity() const;
+	
+	b3Mat33& WorldInvI();
+	const b3Mat33& WorldInvI() const;
+	
+	b3Vec3& Force();
+	b3Vec3& Torque();
+
 	b3BodyType m_type;
 	u32 m_islandID;
 	u32 m_flags;
@@ -366,32 +422,94 @@ private:
 	// Inverse inertia about the body local center of mass.
 	b3Mat33 m_invI;	
 	
-	// Inverse inertia about the body world center of mass.
-	b3Mat33 m_worldInvI;
-	
-	b3Vec3 m_force;
-	b3Vec3 m_torque;
-	b3Vec3 m_linearVelocity;
-	b3Vec3 m_angularVelocity;
-	
 	float32 m_linearDamping;
 	float32 m_angularDamping;
 	float32 m_gravityScale;
 	
-	// Motion proxy for CCD.
-	b3Sweep m_sweep;
-
-	// The body origin transform. 
-	b3Transform m_xf;
+	// The store holding the state this body reads and writes every step, 
+	// and the index of this body in the store.
+	b3BodyStore* m_store;
+	u32 m_storeIndex;
 		
 	// The parent world of this body.
 	b3World* m_world;
+
+	// The identifier of this body in the world recorder.
+	u32 m_recordID;
 	
 	// Links to the world body list.
 	b3Body* m_prev;
 	b3Body* m_next;
+
+	// The persistent island of this body. 
+	// This is NULL if the body is static.
+	b3PersistentIsland* m_island;
+
+	// Links to the island body list.
+	b3Body* m_islandPrev;
+	b3Body* m_islandNext;
 };
 
+inline b3Sweep& b3Body::Sweep()
+{
+	return m_store->m_sweeps[m_storeIndex];
+}
+
+inline const b3Sweep& b3Body::Sweep() const
+{
+	return m_store->m_sweeps[m_storeIndex];
+}
+
+inline b3Transform& b3Body::Transform()
+{
+	return m_store->m_transforms[m_storeIndex];
+}
+
+inline const b3Transform& b3Body::Transform() const
+{
+	return m_store->m_transforms[m_storeIndex];
+}
+
+inline b3Vec3& b3Body::LinearVelocity()
+{
+	return m_store->m_linearVelocities[m_storeIndex];
+}
+
+inline const b3Vec3& b3Body::LinearVelocity() const
+{
+	return m_store->m_linearVelocities[m_storeIndex];
+}
+
+inline b3Vec3& b3Body::AngularVelocity()
+{
+	return m_store->m_angularVelocities[m_storeIndex];
+}
+
+inline const b3Vec3& b3Body::AngularVelocity() const
+{
+	return m_store->m_angularVelocities[m_storeIndex];
+}
+
+inline b3Mat33& b3Body::WorldInvI()
+{
+	return m_store->m_worldInvInertias[m_storeIndex];
+}
+
+inline const b3Mat33& b3Body::WorldInvI() const
+{
+	return m_store->m_worldInvInertias[m_storeIndex];
+}
+
+inline b3Vec3& b3Body::Force()
+{
+	return m_store->m_forces[m_storeIndex];
+}
+
+inline b3Vec3& b3Body::Torque()
+{
+	return m_store->m_torques[m_storeIndex];
+}
+
 inline const b3Body* b3Body::GetNext() const
 {
 	return m_next;
@@ -439,78 +557,85 @@ inline b3List1<b3Shape>& b3Body::GetShapeList()
 
 inline const b3Transform& b3Body::GetTransform() const
 {
-	return m_xf;
+	return Transform();
 }
 
 inline void b3Body::SetTransform(const b3Vec3& position, const b3Vec3& axis, float32 angle) 
 {
+	if (m_world->m_recorder)
+	{
+		RecordSetTransform(position, axis, angle);
+	}
+
 	b3Quat q = b3Quat(axis, angle);
 	
-	m_xf.position = position;
-	m_xf.rotation = b3QuatMat33(q);
+	b3Transform& xf = Transform();
+	xf.position = position;
+	xf.rotation = b3QuatMat33(q);
 
-	m_sweep.worldCenter = b3Mul(m_xf, m_sweep.localCenter);
-	m_sweep.orientation = q;
+	b3Sweep& sweep = Sweep();
+	sweep.worldCenter = b3Mul(xf, sweep.localCenter);
+	sweep.orientation = q;
 
-	m_sweep.worldCenter0 = m_sweep.worldCenter;
-	m_sweep.orientation0 = m_sweep.orientation;
+	sweep.worldCenter0 = sweep.worldCenter;
+	sweep.orientation0 = sweep.orientation;
 
 	SynchronizeShapes();
 }
 
 inline b3Vec3 b3Body::GetPosition() const
 {
-	return m_xf.position;
+	return Transform().position;
 }
 
 inline b3Quat b3Body::GetOrientation() const
 {
-	return m_sweep.orientation;
+	return Sweep().orientation;
 }
 
 inline b3Vec3 b3Body::GetWorldCenter() const
 {
-	return m_sweep.worldCenter;
+	return Sweep().worldCenter;
 }
 
 inline b3Vec3 b3Body::GetLocalCenter() const
 {
-	return m_sweep.localCenter;
+	return Sweep().localCenter;
 }
 
 inline b3Vec3 b3Body::GetLocalVector(const b3Vec3& vector) const
 {
-	return b3MulT(m_xf.rotation, vector);
+	return b3MulT(Transform().rotation, vector);
 }
 
 inline b3Vec3 b3Body::GetWorldVector(const b3Vec3& localVector) const
 {
-	return b3Mul(m_xf.rotation, localVector);
+	return b3Mul(Transform().rotation, localVector);
 }
 
 inline b3Vec3 b3Body::GetLocalPoint(const b3Vec3& point) const
 {
-	return b3MulT(m_xf, point);
+	return b3MulT(Transform(), point);
 }
 
 inline b3Vec3 b3Body::GetWorldPoint(const b3Vec3& point) const
 {
-	return b3Mul(m_xf, point);
+	return b3Mul(Transform(), point);
 }
 
 inline b3Transform b3Body::GetLocalFrame(const b3Transform& xf) const
 {
-	return b3MulT(m_xf, xf);
+	return b3MulT(Transform(), xf);
 }
 
 inline b3Transform b3Body::GetWorldFrame(const b3Transform& xf) const
 {
-	return b3Mul(m_xf, xf);
+	return b3Mul(Transform(), xf);
 }
 
 inline const b3Sweep& b3Body::GetSweep() const
 {
-	return m_sweep;
+	return Sweep();
 }
 
 inline bool b3Body::IsAwake() const
@@ -518,24 +643,25 @@ inline bool b3Body::IsAwake() const
 	return (m_flags & e_awakeFlag) != 0;
 }
 
-inline void b3Body::SetAwake(bool flag) 
+inline bool b3Body::IsBullet() const
 {
-	if (flag) 
+	return (m_flags & e_bulletFlag) != 0;
+}
+
+inline void b3Body::SetBullet(bool flag)
+{
+	if (m_world->m_recorder)
+	{
+		RecordFlag(e_recordSetBullet, flag);
+	}
+
+	if (flag)
 	{
-		if (!IsAwake()) 
-		{
-			m_flags |= e_awakeFlag;
-			m_sleepTime = 0.0f;
-		}
+		m_flags |= e_bulletFlag;
 	}
-	else 
+	else
 	{
-		m_flags &= ~e_awakeFlag;
-		m_sleepTime = 0.0f;
-		m_force.SetZero();
-		m_torque.SetZero();
-		m_linearVelocity.SetZero();
-		m_angularVelocity.SetZero();		
+		m_flags &= ~e_bulletFlag;
 	}
 }
 
@@ -546,6 +672,11 @@ inline float32 b3Body::GetLinearDamping() const
 
 inline void b3Body::SetLinearDamping(float32 damping) 
 {
+	if (m_world->m_recorder)
+	{
+		RecordScalar(e_recordSetLinearDamping, damping);
+	}
+
 	m_linearDamping = damping;
 }
 
@@ -556,6 +687,11 @@ inline float32 b3Body::GetAngularDamping() const
 
 inline void b3Body::SetAngularDamping(float32 damping) 
 {
+	if (m_world->m_recorder)
+	{
+		RecordScalar(e_recordSetAngularDamping, damping);
+	}
+
 	m_angularDamping = damping;
 }
 
@@ -566,6 +702,11 @@ inline float32 b3Body::GetGravityScale() const
 
 inline void b3Body::SetGravityScale(float32 scale)
 {
+	if (m_world->m_recorder)
+	{
+		RecordScalar(e_recordSetGravityScale, scale);
+	}
+
 	if (m_type != e_staticBody) 
 	{
 		m_gravityScale = scale;
@@ -574,16 +715,21 @@ inline void b3Body::SetGravityScale(float32 scale)
 
 inline b3Vec3 b3Body::GetPointVelocity(const b3Vec3& point) const
 {
-	return m_linearVelocity + b3Cross(m_angularVelocity, point - m_sweep.worldCenter);
+	return LinearVelocity() + b3Cross(AngularVelocity(), point - Sweep().worldCenter);
 }
 
 inline b3Vec3 b3Body::GetLinearVelocity() const
 {
-	return m_linearVelocity;
+	return LinearVelocity();
 }
 
 inline void b3Body::SetLinearVelocity(const b3Vec3& linearVelocity)
 {
+	if (m_world->m_recorder)
+	{
+		RecordVector(e_recordSetLinearVelocity, linearVelocity);
+	}
+
 	if (m_type == e_staticBody) 
 	{
 		return;
@@ -594,16 +740,21 @@ inline void b3Body::SetLinearVelocity(const b3Vec3& linearVelocity)
 		SetAwake(true);
 	}
 
-	m_linearVelocity = linearVelocity;
+	LinearVelocity() = linearVelocity;
 }
 
 inline b3Vec3 b3Body::GetAngularVelocity() const
 {
-	return m_angularVelocity;
+	return AngularVelocity();
 }
 
 inline void b3Body::SetAngularVelocity(const b3Vec3& angularVelocity) 
 {
+	if (m_world->m_recorder)
+	{
+		RecordVector(e_recordSetAngularVelocity, angularVelocity);
+	}
+
 	if (m_type == e_staticBody) 
 	{
 		return;
@@ -614,7 +765,7 @@ inline void b3Body::SetAngularVelocity(const b3Vec3& angularVelocity)
 		SetAwake(true);
 	}
 
-	m_angularVelocity = angularVelocity;
+	AngularVelocity() = angularVelocity;
 }
 
 inline float32 b3Body::GetMass() const
@@ -629,7 +780,7 @@ inline float32 b3Body::GetInverseMass() const
 
 inline const b3Mat33& b3Body::GetWorldInverseInertia() const
 {
-	return m_worldInvI;
+	return WorldInvI();
 }
 
 inline const b3Mat33& b3Body::GetInertia() const
@@ -639,15 +790,15 @@ inline const b3Mat33& b3Body::GetInertia() const
 
 inline float32 b3Body::GetLinearEnergy() const
 {
-	b3Vec3 P = m_mass * m_linearVelocity;
-	return b3Dot(P, m_linearVelocity);
+	b3Vec3 P = m_mass * LinearVelocity();
+	return b3Dot(P, LinearVelocity());
 }
 
 inline float32 b3Body::GetAngularEnergy() const
 {
-	b3Mat33 I = b3RotateToFrame(m_I, m_xf.rotation);
-	b3Vec3 L = I * m_angularVelocity;
-	return b3Dot(L, m_angularVelocity);
+	b3Mat33 I = b3RotateToFrame(m_I, Transform().rotation);
+	b3Vec3 L = I * AngularVelocity();
+	return b3Dot(L, AngularVelocity());
 }
 
 inline float32 b3Body::GetEnergy() const
@@ -659,6 +810,11 @@ inline float32 b3Body::GetEnergy() const
 
 inline void b3Body::ApplyForce(const b3Vec3& force, const b3Vec3& point, bool wake) 
 {
+	if (m_world->m_recorder)
+	{
+		RecordPointWake(e_recordApplyForce, force, point, wake);
+	}
+
 	if (m_type != e_dynamicBody) 
 	{
 		return;
@@ -671,13 +827,18 @@ inline void b3Body::ApplyForce(const b3Vec3& force, const b3Vec3& point, bool wa
 
 	if (IsAwake()) 
 	{
-		m_force += force;
-		m_torque += b3Cross(point - m_sweep.worldCenter, force);
+		Force() += force;
+		Torque() += b3Cross(point - Sweep().worldCenter, force);
 	}
 }
 
 inline void b3Body::ApplyForceToCenter(const b3Vec3& force, bool wake) 
 {
+	if (m_world->m_recorder)
+	{
+		RecordVectorWake(e_recordApplyForceToCenter, force, wake);
+	}
+
 	if (m_type != e_dynamicBody) 
 	{
 		return;
@@ -690,12 +851,17 @@ inline void b3Body::ApplyForceToCenter(const b3Vec3& force, bool wake)
 
 	if (IsAwake()) 
 	{
-		m_force += force;
+		Force() += force;
 	}
 }
 
 inline void b3Body::ApplyTorque(const b3Vec3& torque, bool wake) 
 {
+	if (m_world->m_recorder)
+	{
+		RecordVectorWake(e_recordApplyTorque, torque, wake);
+	}
+
 	if (m_type != e_dynamicBody) 
 	{
 		return;
@@ -708,12 +874,17 @@ inline void b3Body::ApplyTorque(const b3Vec3& torque, bool wake)
 
 	if (IsAwake()) 
 	{
-		m_torque += torque;
+		Torque() += torque;
 	}
 }
 
 inline void b3Body::ApplyLinearImpulse(const b3Vec3& impulse, const b3Vec3& worldPoint, bool wake) 
 {
+	if (m_world->m_recorder)
+	{
+		RecordPointWake(e_recordApplyLinearImpulse, impulse, worldPoint, wake);
+	}
+
 	if (m_type != e_dynamicBody) 
 	{
 		return;
@@ -726,13 +897,18 @@ inline void b3Body::ApplyLinearImpulse(const b3Vec3& impulse, const b3Vec3& worl
 
 	if (IsAwake()) 
 	{
-		m_linearVelocity += m_invMass * impulse;
-		m_angularVelocity += b3Mul(m_worldInvI, b3Cross(worldPoint - m_sweep.worldCenter, impulse));
+		LinearVelocity() += m_invMass * impulse;
+		AngularVelocity() += b3Mul(WorldInvI(), b3Cross(worldPoint - Sweep().worldCenter, impulse));
 	}
 }
 
 inline void b3Body::ApplyAngularImpulse(const b3Vec3& impulse, bool wake) 
 {
+	if (m_world->m_recorder)
+	{
+		RecordVectorWake(e_recordApplyAngularImpulse, impulse, wake);
+	}
+
 	if (m_type != e_dynamicBody) 
 	{
 		return;
@@ -745,7 +921,7 @@ inline void b3Body::ApplyAngularImpulse(const b3Vec3& impulse, bool wake)
 
 	if (IsAwake()) 
 	{
-		m_angularVelocity += b3Mul(m_worldInvI, impulse);
+		AngularVelocity() += b3Mul(WorldInvI(), impulse);
 	}
 }
 
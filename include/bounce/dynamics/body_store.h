@@ -0,0 +1,78 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson https://irlanrobson.github.io
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B3_BODY_STORE_H
+#define B3_BODY_STORE_H
+
+#include <bounce/common/math/transform.h>
+#include <bounce/common/math/mat33.h>
+
+class b3Body;
+
+// Structure-of-arrays storage for the body state that is read and written 
+// every step. The state of a body is stored at its index in each array. 
+// The arrays are dense. Removing a body moves the last body into its index.
+// Data that is rarely touched, such as the damping, the user data, and the 
+// shape and joint lists, stays in the body.
+class b3BodyStore
+{
+public:
+	b3BodyStore();
+	~b3BodyStore();
+
+	// Add a body to the store and return its index.
+	u32 Add(b3Body* body);
+
+	// Remove the body at a given index. 
+	// The last body is moved into this index and its index is updated.
+	void Remove(u32 index);
+
+	// Get the number of bodies in the store.
+	u32 GetCount() const;
+
+	u32 m_count;
+	u32 m_capacity;
+
+	// The body at each index.
+	b3Body** m_bodies;
+
+	// Motion proxies for CCD.
+	b3Sweep* m_sweeps;
+
+	// Body origin transforms.
+	b3Transform* m_transforms;
+
+	b3Vec3* m_linearVelocities;
+	b3Vec3* m_angularVelocities;
+
+	// Inverse inertias about the body world centers of mass.
+	b3Mat33* m_worldInvInertias;
+
+	b3Vec3* m_forces;
+	b3Vec3* m_torques;
+private:
+	// Grow the arrays to a given capacity.
+	void Reserve(u32 capacity);
+};
+
+inline u32 b3BodyStore::GetCount() const
+{
+	return m_count;
+}
+
+#endif
@@ -21,13 +21,23 @@
 
 #include <bounce/common/memory/block_pool.h>
 #include <bounce/common/template/list.h>
+#include <bounce/common/template/array.h>
 #include <bounce/collision/broad_phase.h>
+#include <bounce/collision/pair_set.h>
+#include <bounce/dynamics/contacts/contact_store.h>
+#include <bounce/dynamics/contacts/contact_events.h>
+#include <bounce/dynamics/step_stats.h>
 
 class b3Shape;
 class b3Contact;
 class b3ContactFilter;
 class b3ContactListener;
+struct b3ContactEvents;
+class b3IslandManager;
 struct b3MeshContactLink;
+struct b3SensorPair;
+class b3StackAllocator;
+class b3TaskScheduler;
 
 // Contact delegator for b3World.
 class b3ContactManager 
@@ -42,21 +52,82 @@ public:
 	// synchronized body transforms.
 	void SynchronizeShapes();
 
-	void FindNewContacts();
+	// Find new contacts. 
+	// The broad-phase is queried in parallel if a task scheduler is given.
+	void FindNewContacts(b3TaskScheduler* scheduler);
 	
-	void UpdateContacts();
+	// Update the active contacts. 
+	// The manifolds are computed in parallel using one stack allocator 
+	// per scheduler thread. Contact events are reported serially in store order.
+	void UpdateContacts(b3TaskScheduler* scheduler, b3StackAllocator** allocators);
+
+	// The parallel-for callback that updates a range of contacts.
+	static void UpdateContactRange(void* context, u32 begin, u32 end, u32 threadIndex);
+
+	// Report the state computed by the last contact update to the listener 
+	// and the event buffer, and link or unlink the contact from the islands.
+	void ReportContact(b3Contact* c);
 
 	b3Contact* Create(b3Shape* shapeA, b3Shape* shapeB);
 	void Destroy(b3Contact* c);
 
+	b3SensorPair* CreateSensor(b3Shape* shapeA, b3Shape* shapeB);
+	void DestroySensor(b3SensorPair* pair);
+
+	// Mark the sensor pairs of a shape that has moved so they are tested again.
+	void TouchSensors(b3Shape* shape);
+
+	// Test the sensor pairs that were marked since the last update 
+	// and record the sensor events.
+	void UpdateSensors();
+
+	// Move a contact into the active range of its store.
+	void ActivateContact(b3Contact* c);
+
+	// Move a contact out of the active range of its store.
+	void DeactivateContact(b3Contact* c);
+
 	b3BlockPool m_convexBlocks;
 	b3BlockPool m_meshBlocks;
+	b3BlockPool m_sensorBlocks;
 	
 	b3BroadPhase m_broadPhase;	
+	
+	// The proxy pairs of the shapes that have a contact or a sensor pair. 
+	// Used to find an existing pair without searching the shape edge lists.
+	b3PairSet m_pairSet;
 	b3List2<b3Contact> m_contactList;
 	b3List2<b3MeshContactLink> m_meshContactList;
+	b3List2<b3SensorPair> m_sensorList;
+	
+	// The state of the convex and the mesh contacts. 
+	// The contacts that have at least one body in an awake island 
+	// are at the front of each store. 
+	// Only these contacts are updated in a step.
+	b3ContactStore m_convexStore;
+	b3ContactStore m_meshStore;
+
+	// The sensor pairs that have a shape that moved since the last update.
+	// Only these sensor pairs are tested in a step.
+	b3StackArray<b3SensorPair*, 256> m_dirtySensors;
 	b3ContactFilter* m_contactFilter;
 	b3ContactListener* m_contactListener;
+	
+	// The buffer the contact events are recorded into. 
+	// This is NULL if the events are not recorded.
+	b3ContactEvents* m_contactEvents;
+
+	// The sensor events of the current step.
+	b3SensorEvents m_sensorEvents;
+
+	// The statistics of the current step.
+	b3StepStats* m_stats;
+
+	// The collision counters of each scheduler thread.
+	b3CollisionStats* m_threadStats;
+
+	// The island manager of the world.
+	b3IslandManager* m_islandMan;
 };
 
 #endif
\ No newline at end of file
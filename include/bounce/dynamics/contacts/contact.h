@@ -20,14 +20,20 @@
 #define B3_CONTACT_H
 
 #include <bounce/common/math/math.h>
+#include <bounce/common/math/transform.h>
 #include <bounce/common/template/list.h>
 #include <bounce/common/template/array.h>
+#include <bounce/collision/gjk/gjk.h>
 #include <bounce/dynamics/contacts/manifold.h>
+#include <bounce/dynamics/contacts/contact_store.h>
 
 class b3Shape;
 class b3Body;
 class b3Contact;
 class b3ContactListener;
+class b3StackAllocator;
+struct b3ContactEvents;
+struct b3PersistentIsland;
 
 // A contact edge for the contact graph, 
 // where a shape is a vertex and a contact 
@@ -53,10 +59,12 @@ struct b3OverlappingPair
 	b3ContactEdge edgeB;
 };
 
-// todo
+// The time of impact of a contact in a step.
 struct b3TOIEvent
 {
-	float32 t;
+	float32 t; // time of impact between [0, 1]
+	u32 index; // child index of the shape B at the time of impact
+	u32 count; // number of times the contact was resolved at its time of impact
 };
 
 enum b3ContactType
@@ -84,6 +92,8 @@ public:
 	u32 GetManifoldCapacity() const;
 	
 	// Get a contact manifold from this contact.
+	// The manifolds are stored in the contact store of the world. 
+	// Don't keep the pointer after the world is changed.
 	const b3Manifold* GetManifold(u32 index) const;
 	b3Manifold* GetManifold(u32 index);
 
@@ -96,52 +106,128 @@ public:
 	// Are the shapes in this contact overlapping?
 	bool IsOverlapping() const;
 
+	// Does this contact have a speculative contact point? 
+	// The shapes in a speculative contact are separated but might begin 
+	// touching in the next step.
+	bool IsSpeculative() const;
+
 	// Get the next contact in the world contact list.
 	const b3Contact* GetNext() const;
 	b3Contact* GetNext();
 protected:
 	friend class b3World;
 	friend class b3Island;
+	friend class b3IslandManager;
 	friend class b3Shape;
 	friend class b3ContactManager;
 	friend class b3ContactSolver;
+	friend class b3ContactStore;
 	friend class b3List2<b3Contact>;
 
 	enum b3ContactFlags 
 	{
 		e_overlapFlag = 0x0001,
-		e_islandFlag = 0x0002,
+		e_wasOverlapFlag = 0x0004,
+		e_toiFlag = 0x0008, // m_toi.t is valid
+		e_speculativeFlag = 0x0010,
 	};
 
 	b3Contact() { }
-	virtual ~b3Contact() { }
+	~b3Contact() { }
+
+	// Update the contact manifolds and the overlap state.
+	// Different contacts can be updated concurrently if each thread 
+	// uses its own stack allocator.
+	void Update(b3StackAllocator* allocator);
+
+	// Wake the bodies and notify the listener about the state 
+	// computed by the last update.
+	// The events are also recorded if an event buffer is given.
+	void Report(b3ContactListener* listener, b3ContactEvents* events);
+
+	// Record the impulses applied to the manifolds of this contact by the last solve.
+	void RecordPostSolve(b3ContactEvents* events);
 
-	// Update the contact state.
-	void Update(b3ContactListener* listener);
+	// The functions below are implemented by each contact type. 
+	// They are dispatched on the contact type, which is chosen from 
+	// the shape types when the contact is created. 
+	// This avoids a virtual call per contact in the contact update.
 
 	// Test if the shapes in this contact are overlapping.
-	virtual bool TestOverlap() = 0;
+	bool TestOverlap();
 
 	// Initialize contact constraits.
-	virtual void Collide() = 0;
+	void Collide(b3StackAllocator* allocator);
+
+	// Compute the first time of impact of the shapes in this contact 
+	// as a fraction of the given body sweeps and remember the child shape that was hit. 
+	// The sweeps must start at the same time. 
+	// Return one if the shapes don't begin touching along the sweeps.
+	float32 ComputeTOI(const b3Sweep& sweepA, const b3Sweep& sweepB);
+
+	// Build a single point manifold from the closest points of the shapes 
+	// after the bodies were moved to the time of impact. 
+	// This is used when the shapes are close but not overlapping, 
+	// which prevents them from tunneling in the rest of the step.
+	void CollideTOI();
+
+	// Build a speculative contact point if the separated shapes in this contact 
+	// might begin touching within the given time step.
+	void CollideSpeculative(float32 dt);
+
+	// Compute the closest points between the shape A and the child shape B with a given index.
+	// Return the separation between the shapes including their radii, or 
+	// B3_MAX_FLOAT if the core shapes are overlapping.
+	float32 ComputeClosestPoints(b3GJKOutput* output, u32 index) const;
+
+	// Get the separation below which the closest points become a speculative contact point. 
+	// This is the distance the closest points approach each other in the given time step 
+	// plus a margin.
+	float32 GetSpeculativeSeparation(const b3GJKOutput& output, float32 dt) const;
+
+	// Build a single point manifold from the closest points between the shape A 
+	// and the child shape B with a given index.
+	void BuildClosestPointManifold(const b3GJKOutput& output, u32 index);
+
+	// The contact state in the store.
+	u32& Flags();
+	const u32& Flags() const;
+	b3Manifold* Manifolds();
+	const b3Manifold* Manifolds() const;
+	u32& ManifoldCount();
+	const u32& ManifoldCount() const;
+
+	// Is this contact updated in a step?
+	bool IsActive() const;
 
 	b3ContactType m_type;
-	u32 m_flags;
 	b3OverlappingPair m_pair;
 
-	// Collision event from discrete collision to 
-	// discrete physics.
-	u32 m_manifoldCapacity;
-	b3Manifold* m_manifolds;
-	u32 m_manifoldCount;
+	// Indices of the bodies in the island solver buffers.
+	// These are set by the world when the contact is added to an island.
+	u32 m_indexA;
+	u32 m_indexB;
+
+	// The store of the contact type and the index of this contact in it. 
+	// The flags, the manifolds, and the cache of this contact are stored there.
+	b3ContactStore* m_store;
+	u32 m_storeIndex;
 
 	// Time of impact event from continuous collision
 	// to continuous physics.
-	//b3TOIEvent m_toi;
+	b3TOIEvent m_toi;
 
 	// Links to the world contact list.
 	b3Contact* m_prev;
 	b3Contact* m_next;
+
+	// The persistent island of this contact. 
+	// This is NULL if the contact is not touching.
+	b3PersistentIsland* m_island;
+
+	// Links to the island contact list.
+	b3Contact* m_islandPrev;
+	b3Contact* m_islandNext;
 };
 
 inline b3ContactType b3Contact::GetType() const
@@ -169,31 +255,71 @@ inline const b3Shape* b3Contact::GetShapeB() const
 	return m_pair.shapeB;
 }
 
+inline u32& b3Contact::Flags()
+{
+	return m_store->m_flags[m_storeIndex];
+}
+
+inline const u32& b3Contact::Flags() const
+{
+	return m_store->m_flags[m_storeIndex];
+}
+
+inline b3Manifold* b3Contact::Manifolds()
+{
+	return m_store->m_manifolds + m_storeIndex * m_store->m_manifoldCapacity;
+}
+
+inline const b3Manifold* b3Contact::Manifolds() const
+{
+	return m_store->m_manifolds + m_storeIndex * m_store->m_manifoldCapacity;
+}
+
+inline u32& b3Contact::ManifoldCount()
+{
+	return m_store->m_manifoldCounts[m_storeIndex];
+}
+
+inline const u32& b3Contact::ManifoldCount() const
+{
+	return m_store->m_manifoldCounts[m_storeIndex];
+}
+
+inline bool b3Contact::IsActive() const
+{
+	return m_storeIndex < m_store->m_activeCount;
+}
+
 inline u32 b3Contact::GetManifoldCapacity() const
 {
-	return m_manifoldCapacity;
+	return m_store->m_manifoldCapacity;
 }
 
 inline const b3Manifold* b3Contact::GetManifold(u32 index) const
 {
-	B3_ASSERT(index < m_manifoldCount);
-	return m_manifolds + index;
+	B3_ASSERT(index < ManifoldCount());
+	return Manifolds() + index;
 }
 
 inline b3Manifold* b3Contact::GetManifold(u32 index)
 {
-	B3_ASSERT(index < m_manifoldCount);
-	return m_manifolds + index;
+	B3_ASSERT(index < ManifoldCount());
+	return Manifolds() + index;
 }
 
 inline u32 b3Contact::GetManifoldCount() const
 {
-	return m_manifoldCount;
+	return ManifoldCount();
 }
 
 inline bool b3Contact::IsOverlapping() const 
 {
-	return (m_flags & e_overlapFlag) != 0;
+	return (Flags() & e_overlapFlag) != 0;
+}
+
+inline bool b3Contact::IsSpeculative() const 
+{
+	return (Flags() & e_speculativeFlag) != 0;
 }
 
 inline const b3Contact* b3Contact::GetNext() const
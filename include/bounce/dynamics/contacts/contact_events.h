@@ -0,0 +1,138 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson https://irlanrobson.github.io
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B3_CONTACT_EVENTS_H
+#define B3_CONTACT_EVENTS_H
+
+#include <bounce/common/math/vec2.h>
+#include <bounce/common/template/array.h>
+
+class b3Shape;
+class b3Contact;
+
+// Remove the first count events of an array and keep the order of the others.
+template<class T>
+inline void b3RemoveFirstEvents(b3Array<T>& events, u32 count)
+{
+	B3_ASSERT(count <= events.Count());
+	u32 keepCount = events.Count() - count;
+	memmove(events.Begin(), events.Begin() + count, keepCount * sizeof(T));
+	events.Resize(keepCount);
+}
+
+// Two shapes have begun touching.
+struct b3ContactBeginEvent
+{
+	b3Contact* contact;
+	b3Shape* shapeA;
+	b3Shape* shapeB;
+};
+
+// Two shapes have stopped touching. 
+// The contact might have been destroyed, so only the shapes are reported. 
+// The shapes might have been destroyed too, so they should only be compared.
+struct b3ContactEndEvent
+{
+	b3Shape* shapeA;
+	b3Shape* shapeB;
+};
+
+// The impulses the solver has applied to a contact manifold.
+struct b3ContactPostSolveEvent
+{
+	b3Contact* contact;
+	b3Shape* shapeA;
+	b3Shape* shapeB;
+	u32 manifoldIndex;
+	u32 pointCount;
+	float32 normalImpulses[B3_MAX_MANIFOLD_POINTS];
+	b3Vec2 tangentImpulse;
+	float32 motorImpulse;
+};
+
+// The contact events recorded during a step. 
+// Destroying a touching contact outside a step records an end event 
+// that is kept until the next step has been consumed. 
+// The events are stored in the order the contacts were reported, 
+// which doesn't depend on the number of threads.
+struct b3ContactEvents
+{
+	// Remove all events.
+	void Clear()
+	{
+		beginEvents.Resize(0);
+		endEvents.Resize(0);
+		postSolveEvents.Resize(0);
+	}
+
+	// Remove the events recorded by a step. 
+	// The step recorded the first stepEndEventCount end events. 
+	// The end events recorded after the step are kept.
+	void ClearStep(u32 stepEndEventCount)
+	{
+		beginEvents.Resize(0);
+		b3RemoveFirstEvents(endEvents, stepEndEventCount);
+		postSolveEvents.Resize(0);
+	}
+
+	b3StackArray<b3ContactBeginEvent, 32> beginEvents;
+	b3StackArray<b3ContactEndEvent, 32> endEvents;
+	b3StackArray<b3ContactPostSolveEvent, 32> postSolveEvents;
+};
+
+// A shape has begun overlapping a sensor shape.
+struct b3SensorBeginEvent
+{
+	b3Shape* sensorShape;
+	b3Shape* visitorShape;
+};
+
+// A shape has stopped overlapping a sensor shape. 
+// The shapes might have been destroyed, so they should only be compared.
+struct b3SensorEndEvent
+{
+	b3Shape* sensorShape;
+	b3Shape* visitorShape;
+};
+
+// The sensor events recorded during a step. 
+// Destroying an overlapping sensor pair outside a step records an end event 
+// that is kept until the next step has been consumed. 
+struct b3SensorEvents
+{
+	// Remove all events.
+	void Clear()
+	{
+		beginEvents.Resize(0);
+		endEvents.Resize(0);
+	}
+
+	// Remove the events recorded by a step. 
+	// The step recorded the first stepEndEventCount end events. 
+	// The end events recorded after the step are kept.
+	void ClearStep(u32 stepEndEventCount)
+	{
+		beginEvents.Resize(0);
+		b3RemoveFirstEvents(endEvents, stepEndEventCount);
+	}
+
+	b3StackArray<b3SensorBeginEvent, 32> beginEvents;
+	b3StackArray<b3SensorEndEvent, 32> endEvents;
+};
+
+#endif
@@ -21,10 +21,13 @@
 
 #include <bounce/common/math/vec2.h>
 #include <bounce/common/math/mat22.h>
+#include <bounce/common/math/mat33_w.h>
 #include <bounce/dynamics/time_step.h>
 #include <bounce/dynamics/contacts/manifold.h>
 
 class b3StackAllocator;
+class b3TaskScheduler;
+class b3GraphColoring;
 class b3Contact;
 struct b3Position;
 struct b3Velocity;
@@ -67,6 +70,15 @@ struct b3VelocityConstraintPoint
 	float32 normalMass;
 	float32 normalImpulse;
 	float32 velocityBias;
+
+	// Substepping data.
+	// The anchors relative to the body centers in the body frames.
+	b3Vec3 localAnchorA;
+	b3Vec3 localAnchorB;
+	
+	// The separation and the normal velocity at the beginning of the step.
+	float32 baseSeparation;
+	float32 relativeVelocity;
 };
 
 struct b3VelocityConstraintManifold
@@ -114,6 +126,62 @@ struct b3ContactVelocityConstraint
 	u32 manifoldCount;
 };
 
+// A contact point of a wide velocity constraint.
+struct b3WideVelocityConstraintPoint
+{
+	b3Vec3W rA;
+	b3Vec3W rB;
+
+	b3Vec3W normal;
+	b3FloatW normalMass;
+	b3FloatW normalImpulse;
+	b3FloatW velocityBias;
+};
+
+// A batch of up to B3_SIMD_WIDTH contacts with a single manifold.
+// Each contact is stored in a lane. 
+// The contacts of a batch don't share a body with non-zero mass. 
+// Unused lanes and points are zero so they don't apply impulses.
+struct b3WideContactVelocityConstraint
+{
+	u32 contacts[B3_SIMD_WIDTH];
+	u32 indexA[B3_SIMD_WIDTH];
+	u32 indexB[B3_SIMD_WIDTH];
+	u32 count;
+	u32 pointCount;
+
+	b3FloatW invMassA;
+	b3Mat33W invIA;
+	b3FloatW invMassB;
+	b3Mat33W invIB;
+	b3FloatW friction;
+
+	b3Vec3W rA;
+	b3Vec3W rB;
+	
+	b3Vec3W normal;
+	b3Vec3W tangent1;
+	b3Vec3W tangent2;
+
+	// The columns of the tangent mass matrix.
+	b3FloatW tangentMassXX, tangentMassXY;
+	b3FloatW tangentMassYX, tangentMassYY;
+	b3FloatW tangentImpulseX, tangentImpulseY;
+	b3FloatW motorImpulse;
+	b3FloatW motorMass;
+
+	b3WideVelocityConstraintPoint points[B3_MAX_MANIFOLD_POINTS];
+};
+
+// The wide constraints and the remaining scalar constraints of a color.
+struct b3WideColor
+{
+	u32 batchStart;
+	u32 batchCount;
+	u32 contactStart;
+	u32 contactCount;
+};
+
 struct b3ContactSolverDef 
 {
 	b3Position* positions;
@@ -123,6 +191,18 @@ struct b3ContactSolverDef
 	u32 count;
 	b3StackAllocator* allocator;
 	float32 dt;
+	
+	// If this is not NULL then the contacts are partitioned into colors 
+	// and each color is solved in parallel using this scheduler.
+	b3TaskScheduler* scheduler;
+
+	// If this is true then the velocity constraints of contacts with a 
+	// single manifold are packed into SIMD batches.
+	bool wide;
+
+	// If this is true then dt is the substep and the constraints 
+	// are solved using SolveSubStep and ApplyRestitution.
+	bool subStepping;
 };
 
 class b3ContactSolver 
@@ -138,7 +218,56 @@ public:
 	void StoreImpulses();
 
 	bool SolvePositionConstraints();
+
+	// Push the shapes apart at a time of impact. 
+	// Unlike SolvePositionConstraints this keeps the core shapes separated 
+	// so that the time of impact of the remaining motion can be computed.
+	bool SolveTOIPositionConstraints();
+
+	// Solve the soft velocity constraints of a substep using the current positions.
+	// If useBias is false then the velocities are relaxed without pushing the 
+	// overlapping shapes apart.
+	void SolveSubStep(bool useBias);
+
+	// Apply restitution once after all substeps.
+	void ApplyRestitution();
 protected:
+	enum b3ColorTask
+	{
+		e_warmStartTask,
+		e_solveVelocityTask,
+		e_solvePositionTask,
+		e_solveSubStepTask,
+		e_relaxSubStepTask,
+		e_restitutionTask
+	};
+
+	void BuildColoring();
+	void BuildWideConstraints();
+
+	// Solve a wide batch.
+	void SolveWideVelocityConstraint(u32 index);
+
+	// Copy the impulses of the wide batches back to the scalar constraints.
+	void UnpackWideImpulses();
+
+	// Solve a single contact.
+	void WarmStart(u32 index);
+	void SolveVelocityConstraint(u32 index);
+	float32 SolvePositionConstraint(u32 index, float32 baumgarte, bool toi);
+	void SolveSubStepConstraint(u32 index, bool useBias);
+	void ApplyRestitution(u32 index);
+
+	// Run a task over all colors and return the minimum separation.
+	float32 SolveColors(u32 task);
+
+	// The parallel-for callback that runs a task for a range of contacts in a color.
+	static void SolveColorRange(void* context, u32 begin, u32 end, u32 threadIndex);
+
+	// The parallel-for callback that solves a range of wide batches and 
+	// remaining contacts in a color.
+	static void SolveWideColorRange(void* context, u32 begin, u32 end, u32 threadIndex);
+
 	b3Position* m_positions;
 	b3Velocity* m_velocities;
 	b3Mat33* m_inertias;
@@ -147,7 +276,18 @@ protected:
 	b3ContactVelocityConstraint* m_velocityConstraints;
 	u32 m_count;
 	float32 m_dt, m_invDt;
+	bool m_subStepping;
+	float32 m_biasRate, m_massScale, m_impulseScale;
 	b3StackAllocator* m_allocator;
+	b3TaskScheduler* m_scheduler;
+	u32* m_colorBodies;
+	b3GraphColoring* m_coloring;
+	bool m_wide;
+	b3WideColor* m_wideColors;
+	u32* m_wideContacts;
+	void* m_wideBlock;
+	b3WideContactVelocityConstraint* m_wideConstraints;
+	u32 m_wideConstraintCount;
 };
 
 #endif
@@ -0,0 +1,108 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson https://irlanrobson.github.io
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#ifndef B3_CONTACT_STORE_H
+#define B3_CONTACT_STORE_H
+
+#include <bounce/dynamics/contacts/manifold.h>
+#include <bounce/dynamics/contacts/collide/collide.h>
+
+class b3Contact;
+
+// Structure-of-arrays storage for the contact state that is read and written 
+// every step. There is one store per contact type. The state of a contact is 
+// stored at its index in each array. The arrays are dense. 
+// The active contacts are kept at the front of the store so that 
+// the contact update streams through the arrays. 
+// The shapes, the links and the triangle caches of a mesh contact, 
+// which vary in count, stay in the contact.
+class b3ContactStore
+{
+public:
+	// Create a store for contacts with a given number of manifolds.
+	// The contacts have a convex cache if the flag is set.
+	b3ContactStore(u32 manifoldCapacity, bool hasCache);
+	~b3ContactStore();
+
+	// Add an inactive contact to the store and return its index.
+	// The contact state is cleared.
+	u32 Add(b3Contact* contact);
+
+	// Remove the inactive contact at a given index. 
+	// The last contact is moved into this index and its index is updated.
+	void Remove(u32 index);
+
+	// Move the inactive contact at a given index to the end of the active contacts.
+	void Activate(u32 index);
+
+	// Move the active contact at a given index out of the active contacts.
+	void Deactivate(u32 index);
+
+	// Swap the contacts at two indices and update their indices.
+	// This never grows the arrays.
+	void Swap(u32 index1, u32 index2);
+
+	// Get the number of contacts in the store.
+	u32 GetCount() const;
+
+	// Get the number of active contacts. 
+	// These are the contacts at the indices below this number.
+	u32 GetActiveCount() const;
+
+	u32 m_count;
+	u32 m_capacity;
+	u32 m_activeCount;
+
+	// The number of manifolds of each contact.
+	u32 m_manifoldCapacity;
+
+	// The contact at each index.
+	b3Contact** m_contacts;
+
+	u32* m_flags;
+
+	// The manifolds of the contact at an index begin at 
+	// the index times the manifold capacity.
+	u32* m_manifoldCounts;
+	b3Manifold* m_manifolds;
+
+	// Temporal coherence for the convex contacts. 
+	// This is NULL if the contacts don't have a convex cache.
+	b3ConvexCache* m_caches;
+private:
+	bool m_hasCache;
+
+	// Grow the arrays to a given capacity.
+	void Reserve(u32 capacity);
+
+	// Copy the state of the contact at an index into another index.
+	void Move(u32 dst, u32 src);
+};
+
+inline u32 b3ContactStore::GetCount() const
+{
+	return m_count;
+}
+
+inline u32 b3ContactStore::GetActiveCount() const
+{
+	return m_activeCount;
+}
+
+#endif
@@ -27,6 +27,8 @@ class b3ConvexContact : public b3Contact
 {
 public:
 private:
+	friend class b3World;
+	friend class b3Contact;
 	friend class b3ContactManager;
 
 	b3ConvexContact(b3Shape* shapeA, b3Shape* shapeB);
@@ -34,10 +36,19 @@ private:
 
 	bool TestOverlap();
 
-	void Collide();
+	void Collide(b3StackAllocator* allocator);
+
+	float32 ComputeTOI(const b3Sweep& sweepA, const b3Sweep& sweepB);
+
+	void CollideSpeculative(float32 dt);
 	
-	b3Manifold m_stackManifold;
-	b3ConvexCache m_cache;
+	// The cache of this contact in the store.
+	b3ConvexCache& Cache();
 };
 
+inline b3ConvexCache& b3ConvexContact::Cache()
+{
+	return m_store->m_caches[m_storeIndex];
+}
+
 #endif
@@ -47,6 +47,8 @@ class b3MeshContact : public b3Contact
 {
 public:
 private:
+	friend class b3World;
+	friend class b3Contact;
 	friend class b3ContactManager;
 	friend class b3List2<b3MeshContact>;
 	friend class b3StaticTree;
@@ -56,10 +58,14 @@ private:
 
 	bool TestOverlap();
 
-	void Collide();
+	void Collide(b3StackAllocator* allocator);
 	
 	void CollideSphere();
 
+	float32 ComputeTOI(const b3Sweep& sweepA, const b3Sweep& sweepB);
+
+	void CollideSpeculative(float32 dt);
+
 	void SynchronizeShapes();
 
 	bool MoveAABB(const b3AABB3& aabb, const b3Vec3& displacement);
@@ -80,9 +86,6 @@ private:
 	b3TriangleCache* m_triangles;
 	u32 m_triangleCount;
 
-	// Contact manifolds.
-	b3Manifold m_stackManifolds[B3_MAX_MANIFOLDS];
-
 	// Link to the world mesh contact list.
 	b3MeshContactLink m_link;
 };
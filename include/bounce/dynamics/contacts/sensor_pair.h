@@ -0,0 +1,84 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson https://irlanrobson.github.io
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#ifndef B3_SENSOR_PAIR_H
+#define B3_SENSOR_PAIR_H
+
+#include <bounce/common/template/list.h>
+#include <bounce/dynamics/contacts/collide/collide.h>
+
+class b3Shape;
+struct b3SensorPair;
+
+// A sensor edge for the sensor graph, 
+// where a shape is a vertex and a sensor pair 
+// an edge.
+struct b3SensorEdge
+{
+	b3Shape* other;
+	b3SensorPair* pair;
+	// Links to the sensor edge list.
+	b3SensorEdge* m_prev;
+	b3SensorEdge* m_next;
+};
+
+// A sensor pair holds a sensor shape and a non-sensor shape whose AABBs 
+// are overlapping. Unlike a contact it has no manifolds. 
+// It only remembers if the shapes are overlapping and is 
+// tested again only when one of the shapes has moved.
+struct b3SensorPair
+{
+	enum b3SensorPairFlags
+	{
+		e_overlapFlag = 0x0001,
+	};
+
+	// Test if the shapes in this pair are overlapping.
+	bool TestOverlap();
+
+	// Get the sensor shape in this pair.
+	b3Shape* GetSensorShape();
+
+	// Get the shape that is visiting the sensor shape.
+	b3Shape* GetVisitorShape();
+
+	// To the shape A sensor edge list.
+	b3Shape* shapeA;
+	b3SensorEdge edgeA;
+	
+	// To the shape B sensor edge list. 
+	// If one of the shapes is a mesh then this is the mesh.
+	b3Shape* shapeB;
+	b3SensorEdge edgeB;
+
+	u32 flags;
+
+	// The last step simplex. Only used if none of the shapes is a mesh.
+	b3ConvexCache cache;
+
+	// The index of this pair in the dirty sensor pair array. 
+	// This is B3_MAX_U32 if none of the shapes has moved since the last update.
+	u32 dirtyIndex;
+
+	// Links to the world sensor pair list.
+	b3SensorPair* m_prev;
+	b3SensorPair* m_next;
+};
+
+#endif
@@ -0,0 +1,102 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson https://irlanrobson.github.io
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#ifndef B3_GRAPH_COLORING_H
+#define B3_GRAPH_COLORING_H
+
+#include <bounce/common/settings.h>
+
+class b3StackAllocator;
+
+// Use this body index for a constraint body that is never 
+// written by the solver, such as a static body.
+#define B3_NULL_COLOR_BODY (0xFFFFFFFF)
+
+// The minimum number of constraints of a color that are solved by a single task.
+#define B3_COLOR_GRAIN_SIZE (32)
+
+// A partition of a set of constraints into colors. 
+// The constraints in a color don't share a body, therefore 
+// they can be solved in parallel. 
+// The colors are computed greedily in constraint order, so the 
+// partition doesn't depend on the number of threads.
+class b3GraphColoring
+{
+public:
+	// The bodies of the constraint i are bodies[2 * i] and bodies[2 * i + 1].
+	// The body indices must be in the range [0, bodyCount) or B3_NULL_COLOR_BODY.
+	b3GraphColoring(b3StackAllocator* allocator, const u32* bodies, u32 constraintCount, u32 bodyCount);
+	~b3GraphColoring();
+
+	// Get the number of colors. 
+	u32 GetColorCount() const;
+
+	// Get the constraints of a given color.
+	const u32* GetColorConstraints(u32 color) const;
+
+	// Get the number of constraints of a given color.
+	u32 GetColorConstraintCount(u32 color) const;
+
+	// Get the constraints that couldn't be colored. 
+	// These must be solved serially.
+	const u32* GetOverflowConstraints() const;
+
+	// Get the number of constraints that couldn't be colored.
+	u32 GetOverflowConstraintCount() const;
+private:
+	b3StackAllocator* m_allocator;
+	
+	// The constraint indices sorted by color.
+	// The overflow constraints are stored after the last color.
+	u32* m_constraints;
+	u32 m_constraintCount;
+
+	// The constraints of color i are in [m_colorStarts[i], m_colorStarts[i + 1]).
+	u32 m_colorStarts[B3_MAX_COLORS + 1];
+	u32 m_colorCount;
+};
+
+inline u32 b3GraphColoring::GetColorCount() const
+{
+	return m_colorCount;
+}
+
+inline const u32* b3GraphColoring::GetColorConstraints(u32 color) const
+{
+	B3_ASSERT(color < m_colorCount);
+	return m_constraints + m_colorStarts[color];
+}
+
+inline u32 b3GraphColoring::GetColorConstraintCount(u32 color) const
+{
+	B3_ASSERT(color < m_colorCount);
+	return m_colorStarts[color + 1] - m_colorStarts[color];
+}
+
+inline const u32* b3GraphColoring::GetOverflowConstraints() const
+{
+	return m_constraints + m_colorStarts[m_colorCount];
+}
+
+inline u32 b3GraphColoring::GetOverflowConstraintCount() const
+{
+	return m_constraintCount - m_colorStarts[m_colorCount];
+}
+
+#endif
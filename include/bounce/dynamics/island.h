@@ -22,52 +22,83 @@
 #include <bounce/common/math/mat33.h>
 
 class b3StackAllocator;
+class b3TaskScheduler;
 class b3Contact;
 class b3Joint;
 class b3Body;
+class b3BodyStore;
 struct b3Velocity;
 struct b3Position;
 struct b3Profile;
 
+// An island is a set of bodies connected by contacts and joints.
+// The island doesn't own the body, contact, and joint arrays. 
+// It only allocates the solver buffers from the given stack allocator.
+// Islands that don't share non-static bodies can be solved concurrently 
+// using different stack allocators.
+// If a task scheduler is given then the constraints of the island are 
+// partitioned into colors and each color is solved in parallel.
 class b3Island 
 {
 public :
-	b3Island(b3StackAllocator* stack, u32 bodyCapacity, u32 contactCapacity, u32 jointCapacity);
+	b3Island(b3StackAllocator* allocator, b3TaskScheduler* scheduler, b3BodyStore* store, 
+		b3Body** bodies, u32 bodyCount, 
+		b3Contact** contacts, u32 contactCount, 
+		b3Joint** joints, u32 jointCount);
 	~b3Island();
 
-	void Clear();
-	
-	void Add(b3Body* body);
-	void Add(b3Contact* contact);
-	void Add(b3Joint* joint);
-	
-	void Solve(const b3Vec3& gravity, float32 dt, u32 velocityIterations, u32 positionIterations, u32 flags);
+	// Solve the island using the given number of solver iterations, 
+	// or the given number of substeps if it is greater than zero.
+	void Solve(const b3Vec3& gravity, float32 dt, u32 velocityIterations, u32 positionIterations, u32 subStepCount, u32 flags);
+
+	// Solve the island at a time of impact and move the bodies for the rest of the step. 
+	// The bodies must have been advanced to the time of impact.
+	void SolveTOI(float32 dt, u32 velocityIterations, u32 positionIterations);
+
+	// Get the minimum sleep time of the island bodies after solving. 
+	// This is B3_MAX_FLOAT if the island was put to sleep.
+	float32 GetSleepTime() const { return m_sleepTime; }
+
+	// Get the number of position iterations the last solve ran. 
+	// The iterations stop early if the position errors are small.
+	u32 GetPositionIterations() const { return m_positionIterations; }
 private :
 	enum b3IslandFlags
 	{
 		e_warmStartBit = 0x0001,
-		e_sleepBit = 0x0002
+		e_sleepBit = 0x0002,
+		e_wideBit = 0x0004
 	};
 
 	friend class b3World;
 
+	void IntegrateVelocities(const b3Vec3& gravity, float32 h);
+	void IntegratePositions(float32 h);
+
+	void SolveIterations(const b3Vec3& gravity, float32 dt, u32 velocityIterations, u32 positionIterations, u32 flags);
+	void SolveSubSteps(const b3Vec3& gravity, float32 dt, u32 subStepCount, u32 flags);
+
 	b3StackAllocator* m_allocator;
+	b3TaskScheduler* m_scheduler;
 	
+	// The store holding the body states.
+	b3BodyStore* m_store;
+
 	b3Body** m_bodies;
-	u32 m_bodyCapacity;
 	u32 m_bodyCount;
 
 	b3Contact** m_contacts;
-	u32 m_contactCapacity;
 	u32 m_contactCount;
 
 	b3Joint** m_joints;
-	u32 m_jointCapacity;
 	u32 m_jointCount;
 	
 	b3Position* m_positions;
 	b3Velocity* m_velocities;
 	b3Mat33* m_invInertias;
+
+	float32 m_sleepTime;
+	u32 m_positionIterations;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,147 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson https://irlanrobson.github.io
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#ifndef B3_ISLAND_MANAGER_H
+#define B3_ISLAND_MANAGER_H
+
+#include <bounce/common/memory/block_pool.h>
+#include <bounce/common/template/list.h>
+
+class b3StackAllocator;
+class b3Body;
+class b3Contact;
+class b3Joint;
+class b3ContactManager;
+
+// A persistent island is a set of non-static bodies connected by touching contacts 
+// and joints. It also holds the contacts and joints between its bodies and static 
+// bodies. Static bodies don't belong to islands to keep them small.
+// Islands are linked as soon as a constraint connects them and merged at the beginning 
+// of the next step. They are split lazily after constraints have been removed.
+struct b3PersistentIsland
+{
+	// If this is not NULL then this island has been linked to another island 
+	// and will be merged into it. 
+	b3PersistentIsland* parent;
+
+	b3Body* bodyHead;
+	b3Body* bodyTail;
+	u32 bodyCount;
+
+	b3Contact* contactHead;
+	b3Contact* contactTail;
+	u32 contactCount;
+
+	b3Joint* jointHead;
+	b3Joint* jointTail;
+	u32 jointCount;
+
+	// The number of constraints or bodies removed since this island was built. 
+	// If this is greater than zero then the island might be disconnected.
+	u32 constraintRemoveCount;
+
+	// Is this island on the awake island list?
+	bool awake;
+
+	b3PersistentIsland* m_prev;
+	b3PersistentIsland* m_next;
+};
+
+// Island delegator for b3World.
+// Only the awake islands are touched in a step.
+class b3IslandManager
+{
+public:
+	b3IslandManager();
+	~b3IslandManager();
+
+	// Add a non-static body to a new island.
+	void AddBody(b3Body* b);
+
+	// Remove a body from its island. 
+	// The contacts and joints of the body must have been removed.
+	void RemoveBody(b3Body* b);
+
+	// Add a touching contact to the island of its bodies. 
+	// This links the islands of the bodies.
+	void AddContact(b3Contact* c);
+	void RemoveContact(b3Contact* c);
+
+	// Add a joint to the island of its bodies. 
+	// This links the islands of the bodies.
+	void AddJoint(b3Joint* j);
+	void RemoveJoint(b3Joint* j);
+
+	// Move an island to the awake list. 
+	// This activates the contacts of the island bodies.
+	void WakeIsland(b3PersistentIsland* island);
+
+	// Move an island to the sleeping list. 
+	// This deactivates the contacts of the island bodies that 
+	// are not touching a body in an awake island.
+	void SleepIsland(b3PersistentIsland* island);
+
+	// Merge the islands that were linked since the last merge.
+	void MergeIslands();
+
+	// Split an island into its connected components.
+	// The new islands are awake.
+	void SplitIsland(b3PersistentIsland* island, b3StackAllocator* allocator);
+
+	b3BlockPool m_islandBlocks;
+	b3List2<b3PersistentIsland> m_awakeList;
+	b3List2<b3PersistentIsland> m_sleepingList;
+	
+	// The number of islands that have a parent.
+	u32 m_linkCount;
+
+	// The contact manager of the world.
+	b3ContactManager* m_contactMan;
+private:
+	friend class b3World;
+
+	b3PersistentIsland* CreateIsland(bool awake);
+	void DestroyIsland(b3PersistentIsland* island);
+
+	// Find the island an island will be merged into.
+	b3PersistentIsland* FindRoot(b3PersistentIsland* island);
+
+	// Link the islands of two bodies connected by a constraint and 
+	// return the island the constraint must be added to.
+	b3PersistentIsland* LinkIslands(b3Body* bodyA, b3Body* bodyB);
+
+	// Move the bodies and constraints of an island into another island.
+	void MergeIsland(b3PersistentIsland* root, b3PersistentIsland* island);
+
+	// Island list helpers.
+	template<class T>
+	static void PushLink(T*& head, T*& tail, T* link);
+
+	template<class T>
+	static void RemoveLink(T*& head, T*& tail, T* link);
+
+	template<class T>
+	static void AppendList(T*& head, T*& tail, T* otherHead, T* otherTail);
+
+	void PushBody(b3PersistentIsland* island, b3Body* b);
+	void PushContact(b3PersistentIsland* island, b3Contact* c);
+	void PushJoint(b3PersistentIsland* island, b3Joint* j);
+};
+
+#endif
@@ -23,6 +23,7 @@
 
 struct b3JointDef;
 class b3Joint;
+class b3IslandManager;
 
 // Joint delegator for b3World.
 class b3JointManager
@@ -34,6 +35,9 @@ public:
 	void Destroy(b3Joint* j);
 
 	b3List2<b3Joint> m_jointList;
+
+	// The island manager of the world.
+	b3IslandManager* m_islandMan;
 };
 
 #endif
\ No newline at end of file
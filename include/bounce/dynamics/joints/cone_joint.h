@@ -97,6 +97,9 @@ private:
 	virtual void SolveVelocityConstraints(const b3SolverData* data);
 	virtual bool SolvePositionConstraints(const b3SolverData* data);
 
+	virtual void WriteSnapshot(b3Snapshot* snapshot) const;
+	virtual void ReadSnapshot(b3SnapshotReader* reader);
+
 	// Solver shared
 	b3Transform m_localFrameA;
 	b3Transform m_localFrameB;
@@ -104,8 +107,6 @@ private:
 	bool m_enableLimit;
 
 	// Solver temp
-	u32 m_indexA;
-	u32 m_indexB;
 	float32 m_mA;
 	float32 m_mB;
 	b3Mat33 m_iA;
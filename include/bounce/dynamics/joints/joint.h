@@ -26,7 +26,10 @@
 
 class b3Body;
 class b3Joint;
+class b3Snapshot;
+class b3SnapshotReader;
 struct b3SolverData;
+struct b3PersistentIsland;
 
 enum b3JointType
 {
@@ -128,6 +131,7 @@ protected:
 	friend class b3Body;
 	friend class b3World;
 	friend class b3Island;
+	friend class b3IslandManager;
 	friend class b3JointManager;
 	friend class b3JointSolver;
 	friend class b3List2<b3Joint>;
@@ -135,7 +139,7 @@ protected:
 	static b3Joint* Create(const b3JointDef* def);
 	static void Destroy(b3Joint* j);
 
-	b3Joint() {	}
+	b3Joint() { m_recordID = B3_MAX_U32; }
 	virtual ~b3Joint() { }
 	
 	virtual void InitializeConstraints(const b3SolverData* data) = 0;
@@ -143,9 +147,14 @@ protected:
 	virtual void SolveVelocityConstraints(const b3SolverData* data) = 0;
 	virtual bool SolvePositionConstraints(const b3SolverData* data) = 0;
 
+	// Write the solver state kept between steps to a snapshot.
+	virtual void WriteSnapshot(b3Snapshot* snapshot) const = 0;
+
+	// Read the solver state written by WriteSnapshot.
+	virtual void ReadSnapshot(b3SnapshotReader* reader) = 0;
+
 	enum b3JointFlags 
 	{
-		e_islandFlag = 0x0001,
 		e_activeFlag = 0x0002
 	};
 	
@@ -156,9 +165,24 @@ protected:
 	void* m_userData;
 	bool m_collideLinked;
 
+	// The identifier of this joint in the world recorder.
+	u32 m_recordID;
+
+	// Indices of the bodies in the island solver buffers.
+	// These are set by the world when the joint is added to an island.
+	u32 m_indexA;
+	u32 m_indexB;
+
 	// Links to the world joint list.
 	b3Joint* m_prev;
 	b3Joint* m_next;
+
+	// The persistent island of this joint.
+	b3PersistentIsland* m_island;
+
+	// Links to the island joint list.
+	b3Joint* m_islandPrev;
+	b3Joint* m_islandNext;
 };
 
 inline b3JointType b3Joint::GetType() const 
@@ -22,6 +22,9 @@
 #include <bounce/dynamics/time_step.h>
 
 class b3Joint;
+class b3StackAllocator;
+class b3TaskScheduler;
+class b3GraphColoring;
 
 // A 1x12 Jacobian row.
 struct b3Jacobian
@@ -40,21 +43,44 @@ struct b3JointSolverDef
 	b3Position* positions;
 	b3Velocity* velocities;
 	b3Mat33* invInertias;
+	b3StackAllocator* allocator;
+
+	// If this is not NULL then the joints are partitioned into colors 
+	// and each color is solved in parallel using this scheduler.
+	b3TaskScheduler* scheduler;
 };
 
 class b3JointSolver 
 {
 public :
 	b3JointSolver(const b3JointSolverDef* def);
+	~b3JointSolver();
 
 	void InitializeConstraints();
 	void WarmStart();
 	void SolveVelocityConstraints();	
 	bool SolvePositionConstraints();
 private :
+	enum b3ColorTask
+	{
+		e_warmStartTask,
+		e_solveVelocityTask,
+		e_solvePositionTask
+	};
+
+	// Run a task over all colors and return true if all joints were solved.
+	bool SolveColors(u32 task);
+
+	// The parallel-for callback that runs a task for a range of joints in a color.
+	static void SolveColorRange(void* context, u32 begin, u32 end, u32 threadIndex);
+
 	b3SolverData m_solverData;
 	b3Joint** m_joints;
 	u32 m_count;
+	b3StackAllocator* m_allocator;
+	b3TaskScheduler* m_scheduler;
+	u32* m_colorBodies;
+	b3GraphColoring* m_coloring;
 };
 
 #endif
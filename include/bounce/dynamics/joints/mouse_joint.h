@@ -71,13 +71,15 @@ private:
 	virtual void SolveVelocityConstraints(const b3SolverData* data);
 	virtual bool SolvePositionConstraints(const b3SolverData* data);
 
+	virtual void WriteSnapshot(b3Snapshot* snapshot) const;
+	virtual void ReadSnapshot(b3SnapshotReader* reader);
+
 	// Solver shared
 	b3Vec3 m_worldTargetA;
 	b3Vec3 m_localAnchorB;
 	float32 m_maxForce;
 
 	// Solver temp
-	u32 m_indexB;
 	float32 m_mB;
 	b3Mat33 m_iB;
 	b3Vec3 m_localCenterB;
@@ -145,6 +145,9 @@ private:
 	virtual void SolveVelocityConstraints(const b3SolverData* data);
 	virtual bool SolvePositionConstraints(const b3SolverData* data);
 
+	virtual void WriteSnapshot(b3Snapshot* snapshot) const;
+	virtual void ReadSnapshot(b3SnapshotReader* reader);
+
 	// Solver shared
 	b3Quat m_referenceRotation;
 	
@@ -163,8 +166,6 @@ private:
 	float32 m_upperAngle;
 
 	// Solver temp
-	u32 m_indexA;
-	u32 m_indexB;
 	float32 m_mA;
 	float32 m_mB;
 	b3Mat33 m_iA;
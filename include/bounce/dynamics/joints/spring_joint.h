@@ -107,6 +107,9 @@ private:
 	void SolveVelocityConstraints(const b3SolverData* data);
 	bool SolvePositionConstraints(const b3SolverData* data);
 
+	void WriteSnapshot(b3Snapshot* snapshot) const;
+	void ReadSnapshot(b3SnapshotReader* reader);
+
 	// Solver shared
 	b3Vec3 m_localAnchorA;
 	b3Vec3 m_localAnchorB;
@@ -115,8 +118,6 @@ private:
 	float32 m_dampingRatio;
 
 	// Solver temp
-	u32 m_indexA;
-	u32 m_indexB;
 	float32 m_mA;
 	float32 m_mB;
 	b3Mat33 m_iA;
@@ -70,14 +70,15 @@ private:
 	virtual void SolveVelocityConstraints(const b3SolverData* data);
 	virtual bool SolvePositionConstraints(const b3SolverData* data);
 
+	virtual void WriteSnapshot(b3Snapshot* snapshot) const;
+	virtual void ReadSnapshot(b3SnapshotReader* reader);
+
 	// Solver shared
 	b3Vec3 m_localAnchorA;
 	b3Vec3 m_localAnchorB;
 	b3Quat m_referenceRotation;
 
 	// Solver temp
-	u32 m_indexA;
-	u32 m_indexB;
 	float32 m_mA;
 	float32 m_mB;
 	b3Mat33 m_iA;
@@ -0,0 +1,195 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson https://irlanrobson.github.io
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B3_RECORDER_H
+#define B3_RECORDER_H
+
+#include <bounce/common/memory/snapshot.h>
+#include <bounce/common/template/array.h>
+#include <bounce/common/math/transform.h>
+
+class b3World;
+class b3Shape;
+
+struct b3BodyDef;
+struct b3ShapeDef;
+struct b3JointDef;
+struct b3MassData;
+struct b3Hull;
+struct b3Mesh;
+struct b3Filter;
+
+// The identifier of a recorded log ("B3RL").
+#define B3_RECORDER_MAGIC (0x4C523342)
+
+// The version of the recorded log format.
+#define B3_RECORDER_VERSION (2)
+
+// The calls in a recorded log. 
+// Each call is a one byte type followed by its arguments.
+enum b3RecordType
+{
+	e_recordSettings,
+	e_recordStep,
+	e_recordCreateBody,
+	e_recordDestroyBody,
+	e_recordCreateHull,
+	e_recordCreateMesh,
+	e_recordCreateShape,
+	e_recordDestroyShape,
+	e_recordCreateJoint,
+	e_recordDestroyJoint,
+	e_recordSetType,
+	e_recordSetTransform,
+	e_recordSetLinearVelocity,
+	e_recordSetAngularVelocity,
+	e_recordApplyForce,
+	e_recordApplyForceToCenter,
+	e_recordApplyTorque,
+	e_recordApplyLinearImpulse,
+	e_recordApplyAngularImpulse,
+	e_recordSetMassData,
+	e_recordResetMass,
+	e_recordSetLinearDamping,
+	e_recordSetAngularDamping,
+	e_recordSetGravityScale,
+	e_recordSetBullet,
+	e_recordSetAwake,
+	e_recordSetTarget,
+	e_recordSetEnableLimit,
+	e_recordSetLimits,
+	e_recordSetEnableMotor,
+	e_recordSetMotorSpeed,
+	e_recordSetMaxMotorTorque,
+	e_recordSetLength,
+	e_recordSetFrequency,
+	e_recordSetDampingRatio,
+	e_recordSetConeAngle,
+	e_recordSetSensor,
+	e_recordSetFilter,
+	e_recordSetDensity,
+	e_recordSetRestitution,
+	e_recordSetFriction,
+	e_recordChecksum
+};
+
+// Compute a checksum of the transforms and velocities of the bodies in a world.
+u32 b3ComputeChecksum(const b3World* world);
+
+// A recorder captures the calls that change a world into a compact binary log.
+// A b3Replayer can drive a new world from the log in order to reproduce a session, 
+// for example to compare the performance of two builds on the same input.
+// Bodies, shapes and joints are referred to by their creation order. 
+// Hulls and meshes are written once, when the first shape referencing them is created.
+// The world settings, body creation and destruction, shapes, joints, 
+// body transforms, velocities, forces, impulses, masses, awake status, 
+// shape properties and joint properties are recorded. 
+// Snapshot restores, cloth and soft bodies aren't.
+// The checksum of the world is recorded after each step 
+// so that a replay can detect when it diverges from the recording.
+class b3Recorder
+{
+public:
+	b3Recorder();
+	~b3Recorder();
+
+	// Remove the recorded calls. 
+	// The recorder must not be attached to a world.
+	void Clear();
+
+	// Get the recorded log.
+	const void* GetData() const;
+
+	// Get the size of the recorded log in bytes.
+	u32 GetSize() const;
+
+	// Get the number of recorded steps.
+	u32 GetStepCount() const;
+
+	// Write the recorded log to a file. Return true if the file was written.
+	bool Save(const char* fileName) const;
+private:
+	friend class b3World;
+	friend class b3Body;
+	friend class b3Shape;
+	friend class b3MouseJoint;
+	friend class b3SpringJoint;
+	friend class b3RevoluteJoint;
+	friend class b3ConeJoint;
+
+	void RecordSettings(const b3World* world);
+	void RecordStep(float32 dt, u32 velocityIterations, u32 positionIterations);
+	u32 RecordCreateBody(const b3BodyDef& def);
+	void RecordDestroyBody(u32 body);
+	u32 RecordCreateShape(u32 body, const b3ShapeDef& def);
+	void RecordDestroyShape(u32 shape);
+	u32 RecordCreateJoint(u32 bodyA, u32 bodyB, const b3JointDef& def);
+	void RecordDestroyJoint(u32 joint);
+	void RecordSetType(u32 body, u32 type);
+	void RecordSetTransform(u32 body, const b3Vec3& position, const b3Vec3& axis, float32 angle);
+	void RecordBodyVector(b3RecordType type, u32 body, const b3Vec3& v);
+	void RecordBodyVectorWake(b3RecordType type, u32 body, const b3Vec3& v, bool wake);
+	void RecordBodyPointWake(b3RecordType type, u32 body, const b3Vec3& v, const b3Vec3& point, bool wake);
+	void RecordSetMassData(u32 body, const b3MassData* data);
+	void RecordResetMass(u32 body);
+	void RecordSetTarget(u32 joint, const b3Vec3& target);
+	void RecordSetLimits(u32 joint, float32 lower, float32 upper);
+	void RecordSetFilter(u32 shape, const b3Filter& filter);
+	void RecordChecksum(const b3World* world);
+
+	// Write a call that sets a value of a body, shape or joint.
+	void RecordScalar(b3RecordType type, u32 object, float32 value);
+	void RecordFlag(b3RecordType type, u32 object, bool flag);
+
+	// Write the hull or mesh of a shape if it wasn't written yet.
+	u32 RecordHull(const b3Hull* hull);
+	u32 RecordMesh(const b3Mesh* mesh);
+
+	void WriteHeader();
+
+	b3Snapshot m_log;
+	u32 m_stepCount;
+	
+	// The number of created bodies, shapes and joints. 
+	// These are the identifiers of the next objects.
+	u32 m_bodyCount;
+	u32 m_shapeCount;
+	u32 m_jointCount;
+
+	// The recorded hulls and meshes. 
+	// The identifier of a hull or mesh is its index.
+	b3StackArray<const b3Hull*, 32> m_hulls;
+	b3StackArray<const b3Mesh*, 8> m_meshes;
+};
+
+inline const void* b3Recorder::GetData() const
+{
+	return m_log.GetData();
+}
+
+inline u32 b3Recorder::GetSize() const
+{
+	return m_log.GetSize();
+}
+
+inline u32 b3Recorder::GetStepCount() const
+{
+	return m_stepCount;
+}
+
+#endif
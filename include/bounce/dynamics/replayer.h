@@ -0,0 +1,111 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson https://irlanrobson.github.io
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B3_REPLAYER_H
+#define B3_REPLAYER_H
+
+#include <bounce/common/template/array.h>
+
+class b3World;
+class b3Body;
+class b3Shape;
+class b3Joint;
+
+struct b3Hull;
+struct b3Mesh;
+
+// A replayer drives a world from a log written by a b3Recorder. 
+// It creates the hulls and meshes of the log and keeps them 
+// alive, so the world must be destroyed before the replayer.
+class b3Replayer
+{
+public:
+	b3Replayer();
+	~b3Replayer();
+
+	// Load a log from memory. The data is copied. 
+	// Return false if the data isn't a log of this version.
+	bool Load(const void* data, u32 size);
+	
+	// Load a log from a file. 
+	// Return false if the file couldn't be read or isn't a log of this version.
+	bool Load(const char* fileName);
+
+	// Replay the calls up to and including the next step into a world. 
+	// The world must be empty before the first call and 
+	// the same world must be passed to all calls.
+	// Return false if there are no more steps in the log.
+	bool Step(b3World* world);
+
+	// Compare a world with the recorded world after the last replayed step. 
+	// Return false if the replay diverged from the recording.
+	bool Verify(const b3World* world) const;
+
+	// Restart the log from the beginning. 
+	// This destroys the hulls and meshes, so the world must be destroyed first.
+	void Rewind();
+
+	// Get the number of replayed steps.
+	u32 GetStepCount() const;
+private:
+	// Read data from the log.
+	void Read(void* data, u32 size);
+
+	// Read a value from the log.
+	template<class T>
+	T Read()
+	{
+		T value;
+		Read(&value, sizeof(T));
+		return value;
+	}
+
+	void ReadSettings(b3World* world);
+	void ReadCreateBody(b3World* world);
+	void ReadCreateHull();
+	void ReadCreateMesh();
+	void ReadCreateShape();
+	void ReadCreateJoint(b3World* world);
+
+	// Remove the log and destroy the hulls and meshes.
+	void Destroy();
+
+	u8* m_data;
+	u32 m_size;
+	u32 m_offset;
+	u32 m_stepCount;
+
+	// The checksum of the recorded world after the last replayed step.
+	bool m_hasChecksum;
+	u32 m_checksum;
+
+	// The replayed objects. The identifier of an object is its index.
+	// Destroyed objects are set to NULL.
+	b3StackArray<b3Body*, 256> m_bodies;
+	b3StackArray<b3Shape*, 256> m_shapes;
+	b3StackArray<b3Joint*, 32> m_joints;
+	b3StackArray<b3Hull*, 32> m_hulls;
+	b3StackArray<b3Mesh*, 8> m_meshes;
+};
+
+inline u32 b3Replayer::GetStepCount() const
+{
+	return m_stepCount;
+}
+
+#endif
@@ -22,6 +22,7 @@
 #include <bounce/dynamics/shapes/shape.h>
 
 struct b3Mesh;
+struct b3RayPacket;
 
 class b3MeshShape : public b3Shape 
 {
@@ -47,6 +48,11 @@ public:
 
 	bool RayCast(b3RayCastOutput* output, const b3RayCastInput& input, const b3Transform& xf, u32 childIndex) const;
 
+	// Cast the rays of a packet given by a mask against this mesh. 
+	// The closest hit of each ray is written to the output with the same index.
+	// Return the mask of the rays that hit the mesh.
+	u32 RayCastPacket(b3RayCastOutput* outputs, const b3RayPacket* packet, u32 mask, const b3Transform& xf) const;
+
 	const b3Mesh* m_mesh;
 };
 
@@ -22,9 +22,12 @@
 #include <bounce/common/math/transform.h>
 #include <bounce/common/template/list.h>
 #include <bounce/collision/collision.h>
+#include <bounce/collision/broad_phase.h>
 #include <bounce/collision/shapes/sphere.h>
+#include <bounce/dynamics/recorder.h>
 
 struct b3ContactEdge;
+struct b3SensorEdge;
 
 class b3Body;
 class b3Shape;
@@ -63,6 +66,10 @@ struct b3ShapeDef
 	float32 density;
 	float32 restitution;
 	float32 friction;
+	
+	// The collision filter. 
+	// It is checked by the broad-phase before a contact is created.
+	b3Filter filter;
 };
 
 // This structure stores the mass-related data of a shape.
@@ -108,12 +115,21 @@ public:
 	// Compute the ray intersection point, normal of surface, and fraction.
 	virtual bool RayCast(b3RayCastOutput* output, const b3RayCastInput& input, const b3Transform& xf) const = 0;
 	
-	// Set if this shape is a sensor.
+	// Set if this shape is a sensor. 
+	// A sensor shape doesn't collide with other shapes. 
+	// It only reports the non-sensor shapes that begin and stop overlapping it.
 	void SetSensor(bool bit);
 
 	// Is this shape a sensor?
 	bool IsSensor() const;
 
+	// Get the collision filter of this shape.
+	const b3Filter& GetFilter() const;
+
+	// Set the collision filter of this shape. 
+	// The contacts that the new filter prevents are destroyed.
+	void SetFilter(const b3Filter& filter);
+
 	// Get the shape density.
 	float32 GetDensity() const;
 
@@ -154,19 +170,24 @@ public:
 protected:
 	friend class b3World;
 	friend class b3Body;
+	friend class b3IslandManager;
 	friend class b3Contact;
 	friend class b3ContactManager;
 	friend class b3MeshShape;
 	friend class b3MeshContact;
 	friend class b3ContactSolver;
+	friend struct b3SensorPair;
 	friend class b3List1<b3Shape>;
 
 	static b3Shape* Create(const b3ShapeDef& def);
 	static void Destroy(b3Shape* shape);
 
 	// Convenience function.
-	// Destroy the contacts associated with this shape.
+	// Destroy the contacts and sensor pairs associated with this shape.
 	void DestroyContacts();
+
+	// Record a call to this shape if the world of its body has a recorder.
+	void RecordScalar(b3RecordType type, float32 value);
 	
 	b3ShapeType m_type;
 	bool m_isSensor;
@@ -176,8 +197,14 @@ protected:
 	float32 m_friction;
 	u32 m_broadPhaseID;
 
+	// The identifier of this shape in the world recorder.
+	u32 m_recordID;
+
 	// Contact edges for this shape contact graph.
 	b3List2<b3ContactEdge> m_contactEdges;
+
+	// Sensor edges for this shape sensor graph.
+	b3List2<b3SensorEdge> m_sensorEdges;
 	
 	// The parent body of this shape.
 	b3Body* m_body;
@@ -198,6 +225,11 @@ inline float32 b3Shape::GetDensity() const
 
 inline void b3Shape::SetDensity(float32 density) 
 { 
+	if (m_body)
+	{
+		RecordScalar(e_recordSetDensity, density);
+	}
+
 	m_density = density; 
 }
 
@@ -208,6 +240,11 @@ inline float32 b3Shape::GetRestitution() const
 
 inline void b3Shape::SetRestitution(float32 restitution) 
 { 
+	if (m_body)
+	{
+		RecordScalar(e_recordSetRestitution, restitution);
+	}
+
 	m_restitution = restitution; 
 }
 
@@ -218,6 +255,11 @@ inline float32 b3Shape::GetFriction() const
 
 inline void b3Shape::SetFriction(float32 friction) 
 {
+	if (m_body)
+	{
+		RecordScalar(e_recordSetFriction, friction);
+	}
+
 	m_friction = friction;
 }
 
@@ -0,0 +1,96 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson https://irlanrobson.github.io
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B3_STEP_STATS_H
+#define B3_STEP_STATS_H
+
+#include <bounce/common/stats.h>
+
+// The statistics of the last step of a world. 
+// The counters and times stay zero if the statistics are compiled out.
+struct b3StepStats
+{
+	// Set all counters and times to zero.
+	void Reset()
+	{
+		pairCount = 0;
+		contactsCreated = 0;
+		contactsDestroyed = 0;
+		contactCount = 0;
+		updatedContactCount = 0;
+		manifoldCount = 0;
+		manifoldPointCount = 0;
+		sensorPairCount = 0;
+		updatedSensorPairCount = 0;
+		collision.Reset();
+		islandCount = 0;
+		islandBodyCount = 0;
+		maxIslandBodyCount = 0;
+		maxIslandContactCount = 0;
+		maxIslandJointCount = 0;
+		velocityIterations = 0;
+		positionIterations = 0;
+		toiCount = 0;
+		broadPhaseTime = 0.0;
+		collideTime = 0.0;
+		solveTime = 0.0;
+		solveTOITime = 0.0;
+		sensorTime = 0.0;
+		stepTime = 0.0;
+	}
+
+	// Contacts
+	u32 pairCount; // number of new shape pairs reported by the broad-phase
+	u32 contactsCreated; // number of contacts created
+	u32 contactsDestroyed; // number of contacts destroyed
+	u32 contactCount; // number of contacts at the end of the step
+	u32 updatedContactCount; // number of contacts updated by the narrow phase
+	u32 manifoldCount; // number of manifolds built by the narrow phase
+	u32 manifoldPointCount; // number of manifold points built by the narrow phase
+	u32 sensorPairCount; // number of sensor pairs at the end of the step
+	u32 updatedSensorPairCount; // number of sensor pairs tested
+	
+	// The collision counters summed over the threads. 
+	// Every scheduler thread that runs a task of the step is counted. 
+	// The number of allocations grows with the thread count because 
+	// each thread grows its own buffers.
+	// The cache hit rates are the number of hits over the number of calls.
+	b3CollisionStats collision;
+
+	// Islands
+	u32 islandCount; // number of solved islands
+	u32 islandBodyCount; // number of bodies in the solved islands
+	u32 maxIslandBodyCount; // number of bodies in the largest island
+	u32 maxIslandContactCount; // number of contacts in the largest island
+	u32 maxIslandJointCount; // number of joints in the largest island
+
+	// Solver
+	u32 velocityIterations; // velocity iterations or substeps summed over the islands
+	u32 positionIterations; // position iterations summed over the islands
+	u32 toiCount; // number of times of impact solved
+
+	// Times in milliseconds
+	float64 broadPhaseTime; // finding new contacts and moving the proxies
+	float64 collideTime; // updating the contacts
+	float64 solveTime; // building and solving the islands
+	float64 solveTOITime; // solving the times of impact
+	float64 sensorTime; // updating the sensor pairs
+	float64 stepTime; // the whole step
+};
+
+#endif
@@ -21,19 +21,27 @@
 
 #include <bounce/common/memory/stack_allocator.h>
 #include <bounce/common/memory/block_pool.h>
+#include <bounce/common/thread/task_scheduler.h>
 #include <bounce/common/template/list.h>
 #include <bounce/common/draw.h>
 #include <bounce/dynamics/time_step.h>
+#include <bounce/dynamics/body_store.h>
 #include <bounce/dynamics/joint_manager.h>
 #include <bounce/dynamics/contact_manager.h>
+#include <bounce/dynamics/island_manager.h>
+#include <bounce/dynamics/contacts/contact_events.h>
+#include <bounce/dynamics/step_stats.h>
+#include <bounce/dynamics/recorder.h>
 
 struct b3BodyDef;
 
 class b3Body;
 class b3QueryListener;
 class b3RayCastListener;
+class b3ShapeCastListener;
 class b3ContactListener;
 class b3ContactFilter;
+class b3Snapshot;
 
 struct b3RayCastSingleOutput
 {
@@ -43,6 +51,22 @@ struct b3RayCastSingleOutput
 	float32 fraction; // time of intersection on segment
 };
 
+struct b3ShapeCastSingleOutput
+{
+	b3Shape* shape; // shape
+	b3Vec3 point; // contact point on surface
+	b3Vec3 normal; // surface normal at the contact point
+	float32 fraction; // time of impact on translation
+};
+
+// A ray of a batched ray cast.
+struct b3RayCastBatchInput
+{
+	b3Vec3 p1; // first point on segment
+	b3Vec3 p2; // second point on segment
+	const b3Filter* filter; // optional filter
+};
+
 // Use a physics world to create/destroy rigid bodies, execute ray cast and volume queries.
 class b3World
 {
@@ -55,15 +79,106 @@ public:
 	void SetContactFilter(b3ContactFilter* filter);
 
 	// The listener passed will be notified when two body shapes begin/stays/ends
-	// touching with each other.
+	// touching with each other. 
+	// Sensor shapes don't have contacts. See GetSensorEvents.
 	void SetContactListener(b3ContactListener* listener);
+
+	// Enable the contact event buffers. 
+	// If enabled, the world records the contacts that begin and end touching, 
+	// and the impulses applied to each solved contact manifold, into plain arrays 
+	// during a step. The events can then be consumed in bulk after the step. 
+	// This can be used together with a contact listener. 
+	// The default is false.
+	void SetRecordContactEvents(bool flag);
+
+	// Are the contact event buffers enabled?
+	bool GetRecordContactEvents() const;
+
+	// Get the contact events recorded by the last step. 
+	// The events of the last step are removed at the beginning of the next step. 
+	// Contacts destroyed outside a step, for example by destroying a shape 
+	// or changing its filter, append end events that are kept by the next step.
+	const b3ContactEvents& GetContactEvents() const;
+
+	// Get the shapes that began and stopped overlapping a sensor shape 
+	// in the last step. 
+	// The sensor pairs are tested at the end of a step and only if one 
+	// of their shapes has moved. 
+	// The events of the last step are removed at the beginning of the next step. 
+	// Sensor pairs destroyed outside a step append end events that are kept by the next step.
+	const b3SensorEvents& GetSensorEvents() const;
+
+	// Get the statistics of the last step. 
+	// Set B3_ENABLE_STATS to zero to compile the counting out.
+	const b3StepStats& GetStepStats() const;
 	
 	// Enable body sleeping. This improves performance.
 	void SetSleeping(bool flag);
 
 	// Enable warm-starting for the constraint solvers. This improves stability significantly.
 	void SetWarmStart(bool flag);
+
+	// Set the task scheduler used to run the world in parallel. 
+	// The scheduler must outlive the world or be replaced before being destroyed. 
+	// Set to NULL to run the world on the thread that calls Step. This is the default.
+	// Each scheduler thread uses its own stack allocator. 
+	// The results don't depend on the number of threads.
+	void SetTaskScheduler(b3TaskScheduler* scheduler);
+
+	// Get the task scheduler used to run the world in parallel.
+	b3TaskScheduler* GetTaskScheduler();
+
+	// Enable graph coloring for the constraint solvers. 
+	// If enabled, the constraints of large islands are partitioned into colors 
+	// that don't share a body and each color is solved in parallel. 
+	// This improves performance of large piles when there are few islands.
+	// The results depend on whether this is enabled but not on the number of threads.
+	void SetGraphColoring(bool flag);
+
+	// Is graph coloring enabled?
+	bool GetGraphColoring() const;
+
+	// Enable the wide contact solver. 
+	// If enabled, the contact velocity constraints are packed into SIMD batches 
+	// of B3_SIMD_WIDTH contacts that don't share a body. 
+	// This improves performance of stacking scenes.
+	// The results depend on whether this is enabled but not on the number of threads.
+	void SetWideSolver(bool flag);
+
+	// Is the wide contact solver enabled?
+	bool GetWideSolver() const;
+
+	// Set the number of substeps. 
+	// If greater than zero, each step is split into this number of substeps, 
+	// and the constraints are solved with one biased and one relaxing iteration 
+	// per substep. The iteration counts passed to Step are then ignored.
+	// This gives stable stacks and joint chains at fewer total iterations. 
+	// The default is zero (disabled).
+	void SetSubStepCount(u32 count);
+
+	// Get the number of substeps.
+	u32 GetSubStepCount() const;
+
+	// Enable speculative contacts. 
+	// If enabled, contact points are also built for separated shapes that might 
+	// begin touching within a step. The solver only lets these points remove the 
+	// approaching velocity, which prevents fast bodies from overlapping 
+	// deeply without the cost of continuous collision.
+	// The default is false.
+	void SetSpeculativeContacts(bool flag);
+
+	// Are speculative contacts enabled?
+	bool GetSpeculativeContacts() const;
 	
+	// Record the calls that change this world into a recorder. 
+	// The world must not have bodies when a recorder is set, so that the log 
+	// can be replayed into a new world. Set to NULL to stop recording.
+	// The recorder must outlive the world or be removed before being destroyed.
+	void SetRecorder(b3Recorder* recorder);
+
+	// Get the recorder of this world.
+	b3Recorder* GetRecorder();
+
 	// Set the acceleration due to the gravity force between this world and each dynamic 
 	// body in the world. 
 	// The acceleration has units of m/s^2.
@@ -91,21 +206,68 @@ public:
 	// in the world. 
 	// The ray cast output is the intercepted shape, the intersection 
 	// point in world space, the face normal on the shape associated with the point, 
-	// and the intersection fraction.
-	void RayCast(b3RayCastListener* listener, const b3Vec3& p1, const b3Vec3& p2) const;
+	// and the intersection fraction. 
+	// If a filter is given then only the shapes that should collide with it are tested.
+	void RayCast(b3RayCastListener* listener, const b3Vec3& p1, const b3Vec3& p2, const b3Filter* filter = NULL) const;
 
 	// Perform a ray cast with the world.
 	// If the ray doesn't intersect with a shape in the world then return false.
 	// The ray cast output is the intercepted shape, the intersection 
 	// point in world space, the face normal on the shape associated with the point, 
-	// and the intersection fraction.
-	bool RayCastSingle(b3RayCastSingleOutput* output, const b3Vec3& p1, const b3Vec3& p2) const;
+	// and the intersection fraction. 
+	// If a filter is given then only the shapes that should collide with it are tested.
+	bool RayCastSingle(b3RayCastSingleOutput* output, const b3Vec3& p1, const b3Vec3& p2, const b3Filter* filter = NULL) const;
+
+	// Perform a batch of ray casts with the world and write the closest hit of 
+	// each ray into the output with the same index.
+	// The shape of an output is NULL if its ray doesn't intersect with a shape.
+	// The rays are sorted and traverse the world in packets, which is faster than 
+	// casting them one by one. If a task scheduler is set then the packets are cast in parallel.
+	// If a ray has a filter then only the shapes that should collide with it are tested.
+	// Return the number of rays that intersect with a shape.
+	u32 RayCastBatch(b3RayCastSingleOutput* outputs, const b3RayCastBatchInput* inputs, u32 count) const;
+
+	// Perform a shape cast with the world.
+	// The given shape is moved from a transform along a translation and the 
+	// shape cast listener is notified when it hits a shape in the world.
+	// The cast shape must be a sphere, capsule, or hull. It doesn't need to belong to a body.
+	// The shape cast output is the hit shape, the contact point in world space, 
+	// the surface normal of the hit shape at the point, and the fraction of the translation. 
+	// The closest triangle of a mesh shape is reported. 
+	// A shape that overlaps the cast shape at the initial transform is reported with 
+	// a zero fraction, a zero normal, and the point set to the transform position.
+	// If the translation is zero then only the overlapping shapes are reported.
+	// If a filter is given then only the shapes that should collide with it are tested.
+	void ShapeCast(b3ShapeCastListener* listener, const b3Shape* shape, const b3Transform& xf, const b3Vec3& translation, const b3Filter* filter = NULL) const;
+
+	// Perform a shape cast with the world.
+	// If the cast shape doesn't hit a shape in the world then return false.
+	// The shape cast output is the closest hit shape, the contact point in world space, 
+	// the surface normal of the hit shape at the point, and the fraction of the translation. 
+	// If the translation is zero then the output is a shape that overlaps the cast shape, 
+	// reported as an overlap at the initial transform.
+	// If a filter is given then only the shapes that should collide with it are tested.
+	bool ShapeCastSingle(b3ShapeCastSingleOutput* output, const b3Shape* shape, const b3Transform& xf, const b3Vec3& translation, const b3Filter* filter = NULL) const;
 
 	// Perform a AABB query with the world.
 	// The query listener will be notified when two shape AABBs are overlapping.
 	// If the listener returns false then the query is stopped immediately.
-	// Otherwise, it continues searching for new overlapping shape AABBs.
-	void QueryAABB(b3QueryListener* listener, const b3AABB3& aabb) const;
+	// Otherwise, it continues searching for new overlapping shape AABBs. 
+	// If a filter is given then only the shapes that should collide with it are reported.
+	void QueryAABB(b3QueryListener* listener, const b3AABB3& aabb, const b3Filter* filter = NULL) const;
+
+	// Save the simulation state of this world into a snapshot. 
+	// This is the state of the bodies, the broad-phase, the contacts with their 
+	// manifolds and collision caches, the sensor pairs, the islands, and the joint impulses.
+	// The snapshot memory is reused, so saving every step doesn't allocate once 
+	// the snapshot has grown.
+	void SaveSnapshot(b3Snapshot* snapshot) const;
+
+	// Restore the simulation state of this world from a snapshot saved by this world. 
+	// The steps taken after restoring are identical to the steps taken after saving. 
+	// No bodies, shapes or joints must have been created or destroyed in between, 
+	// since the snapshot refers to them by address. The contact listener is not notified.
+	void RestoreSnapshot(const b3Snapshot& snapshot);
 
 	// Get the list of bodies in this world.
 	const b3List2<b3Body>& GetBodyList() const;
@@ -135,6 +297,7 @@ private:
 	{
 		e_shapeAddedFlag = 0x0001,
 		e_clearForcesFlag = 0x0002,
+		e_lockedFlag = 0x0004,
 	};
 	
 	friend class b3Body;
@@ -143,19 +306,53 @@ private:
 	friend class b3ConvexContact;
 	friend class b3MeshContact;
 	friend class b3Joint;
+	friend class b3Recorder;
 
 	void Solve(float32 dt, u32 velocityIterations, u32 positionIterations);
+	void SolveTOI(float32 dt, u32 velocityIterations);
 
 	bool m_sleeping;
 	bool m_warmStarting;
+	bool m_graphColoring;
+	bool m_wideSolver;
+	u32 m_subStepCount;
+	bool m_speculativeContacts;
 	u32 m_flags;
 	b3Vec3 m_gravity;
 
+	// The time step of the current step.
+	float32 m_dt;
+
+	// The contact events of the current step.
+	bool m_recordContactEvents;
+	b3ContactEvents m_contactEvents;
+
+	// The number of end events recorded by the last step. 
+	// End events recorded between steps follow these in the buffers.
+	u32 m_stepContactEndEventCount;
+	u32 m_stepSensorEndEventCount;
+
+	// The statistics of the last step and the collision counters of each thread.
+	b3StepStats m_stepStats;
+	b3CollisionStats m_threadStats[B3_MAX_THREADS];
+
+	// The recorder of the calls that change this world.
+	b3Recorder* m_recorder;
+
 	b3StackAllocator m_stackAllocator;
 	
+	// Task scheduler and the stack allocators of its threads.
+	// Thread zero uses the world stack allocator.
+	b3SerialTaskScheduler m_serialTaskScheduler;
+	b3TaskScheduler* m_taskScheduler;
+	b3StackAllocator* m_stackAllocators[B3_MAX_THREADS];
+
 	// Pool of bodies
 	b3BlockPool m_bodyBlocks;
 
+	// The body state touched every step
+	b3BodyStore m_bodyStore;
+
 	// List of bodies
 	b3List2<b3Body> m_bodyList;
 	
@@ -164,6 +361,9 @@ private:
 	
 	// List of contacts
 	b3ContactManager m_contactMan;
+
+	// Persistent islands
+	b3IslandManager m_islandMan;
 };
 
 inline void b3World::SetContactListener(b3ContactListener* listener)
@@ -171,6 +371,32 @@ inline void b3World::SetContactListener(b3ContactListener* listener)
 	m_contactMan.m_contactListener = listener;
 }
 
+inline void b3World::SetRecordContactEvents(bool flag)
+{
+	m_recordContactEvents = flag;
+	m_contactMan.m_contactEvents = flag ? &m_contactEvents : NULL;
+}
+
+inline bool b3World::GetRecordContactEvents() const
+{
+	return m_recordContactEvents;
+}
+
+inline const b3ContactEvents& b3World::GetContactEvents() const
+{
+	return m_contactEvents;
+}
+
+inline const b3SensorEvents& b3World::GetSensorEvents() const
+{
+	return m_contactMan.m_sensorEvents;
+}
+
+inline const b3StepStats& b3World::GetStepStats() const
+{
+	return m_stepStats;
+}
+
 inline void b3World::SetContactFilter(b3ContactFilter* filter)
 {
 	m_contactMan.m_contactFilter = filter;
@@ -179,11 +405,91 @@ inline void b3World::SetContactFilter(b3ContactFilter* filter)
 inline void b3World::SetGravity(const b3Vec3& gravity)
 {
 	m_gravity = gravity;
+
+	if (m_recorder)
+	{
+		m_recorder->RecordSettings(this);
+	}
 }
 
 inline void b3World::SetWarmStart(bool flag)
 {
 	m_warmStarting = flag;
+
+	if (m_recorder)
+	{
+		m_recorder->RecordSettings(this);
+	}
+}
+
+inline b3Recorder* b3World::GetRecorder()
+{
+	return m_recorder;
+}
+
+inline b3TaskScheduler* b3World::GetTaskScheduler()
+{
+	return m_taskScheduler;
+}
+
+inline void b3World::SetGraphColoring(bool flag)
+{
+	m_graphColoring = flag;
+
+	if (m_recorder)
+	{
+		m_recorder->RecordSettings(this);
+	}
+}
+
+inline bool b3World::GetGraphColoring() const
+{
+	return m_graphColoring;
+}
+
+inline void b3World::SetWideSolver(bool flag)
+{
+	m_wideSolver = flag;
+
+	if (m_recorder)
+	{
+		m_recorder->RecordSettings(this);
+	}
+}
+
+inline bool b3World::GetWideSolver() const
+{
+	return m_wideSolver;
+}
+
+inline void b3World::SetSubStepCount(u32 count)
+{
+	m_subStepCount = count;
+
+	if (m_recorder)
+	{
+		m_recorder->RecordSettings(this);
+	}
+}
+
+inline u32 b3World::GetSubStepCount() const
+{
+	return m_subStepCount;
+}
+
+inline void b3World::SetSpeculativeContacts(bool flag)
+{
+	m_speculativeContacts = flag;
+
+	if (m_recorder)
+	{
+		m_recorder->RecordSettings(this);
+	}
+}
+
+inline bool b3World::GetSpeculativeContacts() const
+{
+	return m_speculativeContacts;
 }
 
 inline const b3List2<b3Body>& b3World::GetBodyList() const
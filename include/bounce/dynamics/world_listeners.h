@@ -48,6 +48,20 @@ public:
 	virtual float32 ReportShape(b3Shape* shape, const b3Vec3& point, const b3Vec3& normal, float32 fraction) = 0;
 };
 
+class b3ShapeCastListener 
+{
+public:	
+	// The user must return the new shape cast fraction.
+	// If fraction equals zero then the shape cast query will be canceled immediately.
+	virtual ~b3ShapeCastListener() { }
+
+	// Report that a shape was hit by the cast shape to this listener.
+	// The reported information are the shape hit by the cast shape, 
+	// the contact point on the shape, the surface normal of the shape at the point, and the 
+	// fraction of the translation at the time of impact.
+	virtual float32 ReportShape(b3Shape* shape, const b3Vec3& point, const b3Vec3& normal, float32 fraction) = 0;
+};
+
 class b3ContactListener 
 {
 public:
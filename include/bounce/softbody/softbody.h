@@ -24,6 +24,8 @@
 
 class b3World;
 
+class b3TaskScheduler;
+
 struct b3SoftBodyMesh;
 
 struct b3SoftBodyNode;
@@ -132,6 +134,13 @@ public:
 	const b3World* GetWorld() const;
 	b3World* GetWorld();
 
+	// Set the task scheduler used to run the force solver in parallel. 
+	// Set to NULL to run the soft body on the thread that calls Step. This is the default.
+	void SetTaskScheduler(b3TaskScheduler* scheduler);
+
+	// Get the task scheduler used to run the force solver in parallel.
+	b3TaskScheduler* GetTaskScheduler();
+
 	// Return the soft body mesh proxy.
 	const b3SoftBodyMesh* GetMesh() const;
 
@@ -144,6 +153,10 @@ public:
 	// Return the kinetic (or dynamic) energy in this system.
 	float32 GetEnergy() const;
 
+	// Return the number of MPCG iterations of the last step. 
+	// This is normally small when small time steps are taken.
+	u32 GetSolverIterations() const;
+
 	// Perform a time step. 
 	void Step(float32 dt, u32 velocityIterations, u32 positionIterations);
 
@@ -167,6 +180,9 @@ private:
 	// Gravity acceleration
 	b3Vec3 m_gravity;
 
+	// Number of MPCG iterations of the last step
+	u32 m_solverIterations;
+
 	// Proxy mesh
 	const b3SoftBodyMesh* m_mesh;
 
@@ -187,6 +203,9 @@ private:
 
 	// Attached world
 	b3World* m_world;
+
+	// Task scheduler
+	b3TaskScheduler* m_taskScheduler;
 };
 
 inline void b3SoftBody::SetGravity(const b3Vec3& gravity)
@@ -199,6 +218,11 @@ inline b3Vec3 b3SoftBody::GetGravity() const
 	return m_gravity;
 }
 
+inline u32 b3SoftBody::GetSolverIterations() const
+{
+	return m_solverIterations;
+}
+
 inline const b3World* b3SoftBody::GetWorld() const
 {
 	return m_world;
@@ -209,6 +233,16 @@ inline b3World* b3SoftBody::GetWorld()
 	return m_world;
 }
 
+inline void b3SoftBody::SetTaskScheduler(b3TaskScheduler* scheduler)
+{
+	m_taskScheduler = scheduler;
+}
+
+inline b3TaskScheduler* b3SoftBody::GetTaskScheduler()
+{
+	return m_taskScheduler;
+}
+
 inline const b3SoftBodyMesh* b3SoftBody::GetMesh() const
 {
 	return m_mesh;
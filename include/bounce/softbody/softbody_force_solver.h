@@ -23,6 +23,7 @@
 #include <bounce/common/math/mat33.h>
 
 class b3StackAllocator;
+class b3TaskScheduler;
 
 class b3SoftBody;
 class b3SoftBodyMesh;
@@ -45,6 +46,7 @@ public:
 private:
 	b3SoftBody* m_body;
 	b3StackAllocator* m_allocator;
+	b3TaskScheduler* m_scheduler;
 	const b3SoftBodyMesh* m_mesh;
 	b3SoftBodyNode* m_nodes;
 	b3SoftBodyElement* m_elements;
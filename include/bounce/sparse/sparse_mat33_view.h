@@ -20,6 +20,7 @@
 #define B3_SPARSE_MAT_33_VIEW_H
 
 #include <bounce/sparse/sparse_mat33.h>
+#include <bounce/common/thread/task_scheduler.h>
 
 struct b3ArrayRowValue
 {
@@ -100,16 +101,17 @@ inline const b3Mat33& b3SparseMat33View::operator()(u32 i, u32 j) const
 	return b3Mat33_zero;
 }
 
-inline void b3Mul(b3DenseVec3& out, const b3SparseMat33View& A, const b3DenseVec3& v)
+// Compute the rows [begin, end) of A * v.
+inline void b3Mul(b3DenseVec3& out, const b3SparseMat33View& A, const b3DenseVec3& v, u32 begin, u32 end)
 {
 	B3_ASSERT(A.rowCount == out.n);
+	B3_ASSERT(begin <= end && end <= A.rowCount);
 
-	out.SetZero();
-
-	for (u32 i = 0; i < A.rowCount; ++i)
+	for (u32 i = begin; i < end; ++i)
 	{
 		b3RowValueArray* rowArray = A.rows + i;
 
+		b3Vec3 sum(0.0f, 0.0f, 0.0f);
 		for (u32 c = 0; c < rowArray->count; ++c)
 		{
 			b3ArrayRowValue* rv = rowArray->values + c;
@@ -117,9 +119,51 @@ inline void b3Mul(b3DenseVec3& out, const b3SparseMat33View& A, const b3DenseVec
 			u32 j = rv->column;
 			b3Mat33 a = rv->value;
 
-			out[i] += a * v[j];
+			sum += a * v[j];
 		}
+		
+		out[i] = sum;
+	}
+}
+
+inline void b3Mul(b3DenseVec3& out, const b3SparseMat33View& A, const b3DenseVec3& v)
+{
+	b3Mul(out, A, v, 0, A.rowCount);
+}
+
+struct b3SparseMat33ViewMulContext
+{
+	b3DenseVec3* out;
+	const b3SparseMat33View* A;
+	const b3DenseVec3* v;
+};
+
+inline void b3SparseMat33ViewMulRows(void* data, u32 begin, u32 end, u32 threadIndex)
+{
+	B3_NOT_USED(threadIndex);
+	b3SparseMat33ViewMulContext* context = (b3SparseMat33ViewMulContext*)data;
+	b3Mul(*context->out, *context->A, *context->v, begin, end);
+}
+
+// Compute A * v splitting the rows between the threads of a task scheduler.
+// The rows are computed serially if the scheduler is NULL.
+inline void b3Mul(b3DenseVec3& out, const b3SparseMat33View& A, const b3DenseVec3& v, b3TaskScheduler* scheduler)
+{
+	if (scheduler == NULL)
+	{
+		b3Mul(out, A, v);
+		return;
 	}
+
+	b3SparseMat33ViewMulContext context;
+	context.out = &out;
+	context.A = &A;
+	context.v = &v;
+
+	// Rows per task
+	const u32 grainSize = 64;
+
+	scheduler->ParallelFor(A.rowCount, grainSize, b3SparseMat33ViewMulRows, &context);
 }
 
 inline b3DenseVec3 operator*(const b3SparseMat33View& A, const b3DenseVec3& v)
@@ -37,6 +37,31 @@ if not _OPTIONS["gfxapi"] then
    _OPTIONS["gfxapi"] = "opengl_4"
 end
 
+-- list of SIMD instruction sets
+newoption 
+{
+   trigger     = "simd",
+   value       = "ISA",
+   description = "Choose a SIMD instruction set for the wide contact solver",
+   allowed = 
+   {
+      { "sse2",    "SSE2 (4 lanes)" },
+      { "avx2",    "AVX2 (8 lanes)" }
+   }
+}
+
+-- defaults to SSE2
+if not _OPTIONS["simd"] then
+   _OPTIONS["simd"] = "sse2"
+end
+
+-- built-in profiler
+newoption 
+{
+   trigger     = "profiler",
+   description = "Record the profile scopes into the built-in profiler (b3_profiler)"
+}
+
 -- premake main
 workspace(solution_name)
 	configurations { "debug", "release" }
@@ -76,6 +101,17 @@ workspace(solution_name)
 		defines { "U_OPENGL_4" }
 	
 	filter {}
+	
+	filter "options:simd=sse2" 
+		vectorextensions "SSE2"
+	
+	filter "options:simd=avx2" 
+		vectorextensions "AVX2"
+	
+	filter "options:profiler" 
+		defines { "B3_ENABLE_PROFILER=1" }
+	
+	filter {}
 		
 	project "bounce"
 		kind "StaticLib"
@@ -333,6 +369,74 @@ workspace(solution_name)
 			examples_src_dir .. "/hello_world/**.cpp" 
 		}
 
+		filter "system:linux" 
+			links { "pthread" }
+		
+		filter {}
+		
+		links { "bounce" }
+
+	project "benchmark"
+		kind "ConsoleApp"
+		language "C++"
+		location ( solution_dir .. action )
+		includedirs { bounce_inc_dir, examples_inc_dir }
+		vpaths { ["Headers"] = "**.h", ["Sources"] = "**.cpp" }
+
+		files 
+		{ 
+			examples_inc_dir .. "/common/**.h", 
+			examples_inc_dir .. "/benchmark/**.h", 
+			examples_src_dir .. "/benchmark/**.cpp" 
+		}
+
+		filter "system:linux" 
+			links { "pthread" }
+		
+		filter {}
+		
+		links { "bounce" }
+
+	project "microbenchmark"
+		kind "ConsoleApp"
+		language "C++"
+		location ( solution_dir .. action )
+		includedirs { bounce_inc_dir, examples_inc_dir }
+		vpaths { ["Headers"] = "**.h", ["Sources"] = "**.cpp" }
+
+		files 
+		{ 
+			examples_inc_dir .. "/common/**.h", 
+			examples_inc_dir .. "/microbenchmark/**.h", 
+			examples_src_dir .. "/microbenchmark/**.cpp" 
+		}
+
+		filter "system:linux" 
+			links { "pthread" }
+		
+		filter {}
+		
+		links { "bounce" }
+
+	project "replay"
+		kind "ConsoleApp"
+		language "C++"
+		location ( solution_dir .. action )
+		includedirs { bounce_inc_dir, examples_inc_dir }
+		vpaths { ["Headers"] = "**.h", ["Sources"] = "**.cpp" }
+
+		files 
+		{ 
+			examples_inc_dir .. "/common/**.h", 
+			examples_inc_dir .. "/replay/**.h", 
+			examples_src_dir .. "/replay/**.cpp" 
+		}
+
+		filter "system:linux" 
+			links { "pthread" }
+		
+		filter {}
+		
 		links { "bounce" }
 
 -- build
@@ -262,7 +262,9 @@ b3Cloth::b3Cloth(const b3ClothDef& def) :
 	}
 
 	m_gravity.SetZero();
+	m_solverIterations = 0;
 	m_world = nullptr;
+	m_taskScheduler = nullptr;
 }
 
 b3Cloth::~b3Cloth()
@@ -511,6 +513,7 @@ void b3Cloth::Solve(float32 dt, const b3Vec3& gravity, u32 velocityIterations, u
 	// Solve
 	b3ClothSolverDef solverDef;
 	solverDef.stack = &m_stackAllocator;
+	solverDef.scheduler = m_taskScheduler;
 	solverDef.particleCapacity = m_particleList.m_count;
 	solverDef.forceCapacity = m_forceList.m_count;
 	solverDef.bodyContactCapacity = m_contactManager.m_particleBodyContactList.m_count;
@@ -545,7 +548,7 @@ void b3Cloth::Solve(float32 dt, const b3Vec3& gravity, u32 velocityIterations, u
 	}
 	
 	// Solve	
-	solver.Solve(dt, gravity, velocityIterations, positionIterations);
+	m_solverIterations = solver.Solve(dt, gravity, velocityIterations, positionIterations);
 }
 
 void b3Cloth::Step(float32 dt, u32 velocityIterations, u32 positionIterations)
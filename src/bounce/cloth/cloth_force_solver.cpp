@@ -32,11 +32,10 @@
 // Some improvements for the original MPCG algorithm are described in the paper:
 // "On the modified conjugate gradient method in cloth simulation - Uri M. Ascher, Eddy Boxerman".
 
-u32 b3_clothSolverIterations = 0;
-
 b3ClothForceSolver::b3ClothForceSolver(const b3ClothForceSolverDef& def)
 {
 	m_allocator = def.stack;
+	m_scheduler = def.scheduler;
 
 	m_particleCount = def.particleCount;
 	m_particles = def.particles;
@@ -57,11 +56,12 @@ void b3ClothForceSolver::ApplyForces()
 	}
 }
 
-// Solve Ax = b
-static void b3SolveMPCG(b3DenseVec3& x,
+// Solve Ax = b and return the number of iterations.
+static u32 b3SolveMPCG(b3DenseVec3& x,
 	const b3SparseMat33View& A, const b3DenseVec3& b,
 	const b3DiagMat33& S, const b3DenseVec3& z,
-	const b3DenseVec3& y, const b3DiagMat33& I, u32 maxIterations = 20)
+	const b3DenseVec3& y, const b3DiagMat33& I, 
+	b3TaskScheduler* scheduler, u32 maxIterations = 20)
 {
 	B3_PROFILE("Cloth Solve MPCG");
 
@@ -99,6 +99,8 @@ static void b3SolveMPCG(b3DenseVec3& x,
 
 	float32 delta_new = b3Dot(r, p);
 
+	b3DenseVec3 Ap(A.rowCount);
+
 	u32 iteration = 0;
 	for (;;)
 	{
@@ -112,7 +114,9 @@ static void b3SolveMPCG(b3DenseVec3& x,
 			break;
 		}
 
-		b3DenseVec3 s = S * (A * p);
+		b3Mul(Ap, A, p, scheduler);
+
+		b3DenseVec3 s = S * Ap;
 
 		float32 alpha = delta_new / b3Dot(p, s);
 
@@ -132,10 +136,10 @@ static void b3SolveMPCG(b3DenseVec3& x,
 		++iteration;
 	}
 
-	b3_clothSolverIterations = iteration;
+	return iteration;
 }
 
-void b3ClothForceSolver::Solve(float32 dt, const b3Vec3& gravity)
+u32 b3ClothForceSolver::Solve(float32 dt, const b3Vec3& gravity)
 {
 	float32 h = dt;
 
@@ -205,7 +209,7 @@ void b3ClothForceSolver::Solve(float32 dt, const b3Vec3& gravity)
 
 	// x
 	b3DenseVec3 x(m_particleCount);
-	b3SolveMPCG(x, viewA, b, S, sz, sx0, I);
+	u32 iterations = b3SolveMPCG(x, viewA, b, S, sz, sx0, I, m_scheduler);
 
 	// Velocity update
 	sv = sv + x;
@@ -220,4 +224,6 @@ void b3ClothForceSolver::Solve(float32 dt, const b3Vec3& gravity)
 		p->m_position = sx[i];
 		p->m_velocity = sv[i];
 	}
+
+	return iterations;
 }
\ No newline at end of file
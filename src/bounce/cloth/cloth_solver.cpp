@@ -28,6 +28,7 @@
 b3ClothSolver::b3ClothSolver(const b3ClothSolverDef& def)
 {
 	m_allocator = def.stack;
+	m_scheduler = def.scheduler;
 
 	m_particleCapacity = def.particleCapacity;
 	m_particleCount = 0;
@@ -75,12 +76,14 @@ void b3ClothSolver::Add(b3ParticleTriangleContact* c)
 	m_triangleContacts[m_triangleContactCount++] = c;
 }
 
-void b3ClothSolver::Solve(float32 dt, const b3Vec3& gravity, u32 velocityIterations, u32 positionIterations)
+u32 b3ClothSolver::Solve(float32 dt, const b3Vec3& gravity, u32 velocityIterations, u32 positionIterations)
 {
+	u32 iterations = 0;
 	{
 		// Solve internal dynamics
 		b3ClothForceSolverDef forceSolverDef;
 		forceSolverDef.stack = m_allocator;
+		forceSolverDef.scheduler = m_scheduler;
 		forceSolverDef.particleCount = m_particleCount;
 		forceSolverDef.particles = m_particles;
 		forceSolverDef.forceCount = m_forceCount;
@@ -88,7 +91,7 @@ void b3ClothSolver::Solve(float32 dt, const b3Vec3& gravity, u32 velocityIterati
 
 		b3ClothForceSolver forceSolver(forceSolverDef);
 
-		forceSolver.Solve(dt, gravity);
+		iterations = forceSolver.Solve(dt, gravity);
 	}
 	
 	// Copy particle state to state buffer
@@ -175,7 +178,7 @@ void b3ClothSolver::Solve(float32 dt, const b3Vec3& gravity, u32 velocityIterati
 
 			body->SynchronizeTransform();
 
-			body->m_worldInvI = b3RotateToFrame(body->m_invI, body->m_xf.rotation);
+			body->WorldInvI() = b3RotateToFrame(body->m_invI, body->Transform().rotation);
 
 			body->SynchronizeShapes();
 		}
@@ -190,4 +193,6 @@ void b3ClothSolver::Solve(float32 dt, const b3Vec3& gravity, u32 velocityIterati
 
 	m_allocator->Free(velocities);
 	m_allocator->Free(positions);
+
+	return iterations;
 }
\ No newline at end of file
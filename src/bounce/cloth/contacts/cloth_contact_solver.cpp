@@ -77,13 +77,13 @@ void b3ClothContactSolver::InitializeBodyContactConstraints()
 		pc->invMassB = vc->bodyB->m_invMass;
 
 		pc->invIA.SetZero();
-		pc->invIB = vc->bodyB->m_worldInvI;
+		pc->invIB = vc->bodyB->WorldInvI();
 
 		pc->radiusA = c->m_p1->m_radius;
 		pc->radiusB = c->m_s2->m_radius;
 
 		pc->localCenterA.SetZero();
-		pc->localCenterB = pc->bodyB->m_sweep.localCenter;
+		pc->localCenterB = pc->bodyB->Sweep().localCenter;
 
 		pc->normalA = c->m_normal1;
 		pc->localPointA = c->m_localPoint1;
@@ -106,10 +106,10 @@ void b3ClothContactSolver::InitializeBodyContactConstraints()
 		b3Mat33 iB = vc->invIB;
 
 		b3Vec3 xA = m_positions[indexA];
-		b3Vec3 xB = bodyB->m_sweep.worldCenter;
+		b3Vec3 xB = bodyB->Sweep().worldCenter;
 
 		b3Quat qA; qA.SetIdentity();
-		b3Quat qB = bodyB->m_sweep.orientation;
+		b3Quat qB = bodyB->Sweep().orientation;
 
 		b3Vec3 localCenterA = pc->localCenterA;
 		b3Vec3 localCenterB = pc->localCenterB;
@@ -663,8 +663,8 @@ bool b3ClothContactSolver::SolveBodyContactPositionConstraints()
 		b3Vec3 cA = m_positions[indexA];
 		b3Quat qA; qA.SetIdentity();
 
-		b3Vec3 cB = bodyB->m_sweep.worldCenter;
-		b3Quat qB = bodyB->m_sweep.orientation;
+		b3Vec3 cB = bodyB->Sweep().worldCenter;
+		b3Quat qB = bodyB->Sweep().orientation;
 
 		// Solve normal constraint
 		b3Transform xfA;
@@ -710,8 +710,8 @@ bool b3ClothContactSolver::SolveBodyContactPositionConstraints()
 
 		m_positions[indexA] = cA;
 
-		bodyB->m_sweep.worldCenter = cB;
-		bodyB->m_sweep.orientation = qB;
+		bodyB->Sweep().worldCenter = cB;
+		bodyB->Sweep().orientation = qB;
 	}
 
 	return minSeparation >= -3.0f * B3_LINEAR_SLOP;
@@ -17,11 +17,15 @@
 */
 
 #include <bounce/collision/broad_phase.h>
+#include <bounce/common/memory/snapshot.h>
 
 b3BroadPhase::b3BroadPhase() 
 {
 	m_proxyCount = 0;
 
+	m_filterCapacity = 0;
+	m_filters = NULL;
+
 	m_moveBufferCapacity = 16;
 	m_moveBuffer = (u32*)b3Alloc(m_moveBufferCapacity * sizeof(u32));
 	memset(m_moveBuffer, 0, m_moveBufferCapacity * sizeof(u32));
@@ -31,11 +35,32 @@ b3BroadPhase::b3BroadPhase()
 	m_pairs = (b3Pair*)b3Alloc(m_pairCapacity * sizeof(b3Pair));
 	memset(m_pairs, 0, m_pairCapacity * sizeof(b3Pair));
 	m_pairCount = 0;
+
+	m_sortPairs = (b3Pair*)b3Alloc(m_pairCapacity * sizeof(b3Pair));
+
+	for (u32 i = 0; i < B3_MAX_THREADS; ++i)
+	{
+		m_threadPairs[i].pairs = NULL;
+		m_threadPairs[i].count = 0;
+		m_threadPairs[i].capacity = 0;
+	}
+
+	m_threadStats = NULL;
 }
 
 b3BroadPhase::~b3BroadPhase() 
 {
+	for (u32 i = 0; i < B3_MAX_THREADS; ++i)
+	{
+		if (m_threadPairs[i].pairs)
+		{
+			b3Free(m_threadPairs[i].pairs);
+		}
+	}
+
+	b3Free(m_filters);
 	b3Free(m_moveBuffer);
+	b3Free(m_sortPairs);
 	b3Free(m_pairs);
 }
 
@@ -75,7 +100,7 @@ bool b3BroadPhase::TestOverlap(u32 proxy1, u32 proxy2) const
 	return m_tree.TestOverlap(proxy1, proxy2);
 }
 
-u32 b3BroadPhase::CreateProxy(const b3AABB3& aabb, void* userData) 
+u32 b3BroadPhase::CreateProxy(const b3AABB3& aabb, void* userData, const b3Filter& filter) 
 {
 	b3AABB3 fatAABB = aabb;
 	fatAABB.Extend(B3_AABB_EXTENSION);	
@@ -83,6 +108,23 @@ u32 b3BroadPhase::CreateProxy(const b3AABB3& aabb, void* userData)
 	u32 proxyId = m_tree.InsertNode(fatAABB, userData);
 	
 	++m_proxyCount;
+
+	// Check filter capacity.
+	if (proxyId >= m_filterCapacity)
+	{
+		u32 oldCapacity = m_filterCapacity;
+		b3Filter* oldFilters = m_filters;
+		
+		m_filterCapacity = b3Max(2 * m_filterCapacity, proxyId + 1);
+		m_filters = (b3Filter*)b3Alloc(m_filterCapacity * sizeof(b3Filter));
+		if (oldFilters)
+		{
+			memcpy(m_filters, oldFilters, oldCapacity * sizeof(b3Filter));
+			b3Free(oldFilters);
+		}
+	}
+
+	m_filters[proxyId] = filter;
 	
 	BufferMove(proxyId);
 
@@ -153,31 +195,269 @@ void b3BroadPhase::TouchProxy(u32 proxyId)
 	BufferMove(proxyId);
 }
 
-bool b3BroadPhase::Report(u32 proxyId) 
+void b3BroadPhase::SetFilter(u32 proxyId, const b3Filter& filter)
+{
+	B3_ASSERT(proxyId < m_filterCapacity);
+	m_filters[proxyId] = filter;
+	BufferMove(proxyId);
+}
+
+struct b3MoveQueryCallback
 {
-	if (proxyId == m_queryProxyId) 
+	// The client callback used to add an overlapping pair
+	// to the thread pair buffer.
+	bool Report(u32 proxyId)
 	{
-		// The proxy can't overlap with itself.
+		if (proxyId == queryProxyId)
+		{
+			// The proxy can't overlap with itself.
+			return true;
+		}
+
+		if (b3ShouldCollide(filters[proxyId], filters[queryProxyId]) == false)
+		{
+			// The filters prevent the collision.
+			return true;
+		}
+
+		// Check capacity.
+		if (buffer->count == buffer->capacity)
+		{
+			// Duplicate capacity.
+			buffer->capacity = b3Max(2 * buffer->capacity, 16u);
+
+			b3Pair* oldPairs = buffer->pairs;
+			buffer->pairs = (b3Pair*)b3Alloc(buffer->capacity * sizeof(b3Pair));
+			if (oldPairs)
+			{
+				memcpy(buffer->pairs, oldPairs, buffer->count * sizeof(b3Pair));
+				b3Free(oldPairs);
+			}
+		}
+
+		// Add overlapping pair to the pair buffer.
+		buffer->pairs[buffer->count].proxy1 = b3Min(proxyId, queryProxyId);
+		buffer->pairs[buffer->count].proxy2 = b3Max(proxyId, queryProxyId);
+		++buffer->count;
+
+		// Keep looking for overlapping pairs.
 		return true;
 	}
 
+	// The current proxy being queried for overlap with another proxies. 
+	// It is used to avoid a proxy overlap with itself.
+	u32 queryProxyId;
+	
+	// The proxy filters.
+	const b3Filter* filters;
+
+	b3PairBuffer* buffer;
+};
+
+void b3BroadPhase::QueryMoveBuffer(void* context, u32 begin, u32 end, u32 threadIndex)
+{
+	b3BroadPhase* broadPhase = (b3BroadPhase*)context;
+
+#if B3_ENABLE_STATS
+	// Count the allocations of this thread.
+	b3CollisionStats* oldStats = b3_threadStats;
+	if (broadPhase->m_threadStats)
+	{
+		b3SetThreadStats(broadPhase->m_threadStats + threadIndex);
+	}
+#endif
+	
+	b3MoveQueryCallback callback;
+	callback.filters = broadPhase->m_filters;
+	callback.buffer = broadPhase->m_threadPairs + threadIndex;
+
+	for (u32 i = begin; i < end; ++i)
+	{
+		callback.queryProxyId = broadPhase->m_moveBuffer[i];
+
+		if (callback.queryProxyId == B3_NULL_PROXY)
+		{
+			// Proxy was unbuffered
+			continue;
+		}
+
+		const b3AABB3& aabb = broadPhase->m_tree.GetAABB(callback.queryProxyId);
+		broadPhase->m_tree.QueryAABB(&callback, aabb);
+	}
+
+#if B3_ENABLE_STATS
+	b3SetThreadStats(oldStats);
+#endif
+}
+
+// Sort pairs by proxy 1 and then by proxy 2.
+// This is a least significant digit radix sort with 8-bit digits.
+// The number of passes depends on the largest proxy.
+static void b3SortPairs(b3Pair* pairs, b3Pair* temp, u32 count, u32 maxProxy)
+{
+	u32 digitCount = 0;
+	for (u32 x = maxProxy; x > 0; x >>= 8)
+	{
+		++digitCount;
+	}
+
+	b3Pair* src = pairs;
+	b3Pair* dst = temp;
+
+	// Sort by the least significant key first.
+	for (u32 key = 0; key < 2; ++key)
+	{
+		for (u32 digit = 0; digit < digitCount; ++digit)
+		{
+			u32 shift = 8 * digit;
+
+			u32 offsets[256];
+			memset(offsets, 0, sizeof(offsets));
+
+			for (u32 i = 0; i < count; ++i)
+			{
+				u32 proxy = key == 0 ? src[i].proxy2 : src[i].proxy1;
+				++offsets[(proxy >> shift) & 0xFF];
+			}
+
+			// Skip the pass if all pairs share this digit.
+			u32 firstProxy = key == 0 ? src[0].proxy2 : src[0].proxy1;
+			if (offsets[(firstProxy >> shift) & 0xFF] == count)
+			{
+				continue;
+			}
+
+			u32 sum = 0;
+			for (u32 i = 0; i < 256; ++i)
+			{
+				u32 n = offsets[i];
+				offsets[i] = sum;
+				sum += n;
+			}
+
+			for (u32 i = 0; i < count; ++i)
+			{
+				u32 proxy = key == 0 ? src[i].proxy2 : src[i].proxy1;
+				dst[offsets[(proxy >> shift) & 0xFF]++] = src[i];
+			}
+
+			b3Swap(src, dst);
+		}
+	}
+
+	if (src != pairs)
+	{
+		memcpy(pairs, src, count * sizeof(b3Pair));
+	}
+}
+
+void b3BroadPhase::UpdatePairs(b3TaskScheduler* scheduler)
+{
+	u32 threadCount = scheduler ? scheduler->GetThreadCount() : 1;
+	
+	for (u32 i = 0; i < threadCount; ++i)
+	{
+		m_threadPairs[i].count = 0;
+	}
+
+	// Get the (duplicated) overlapping pairs of each thread.
+	if (scheduler)
+	{
+		scheduler->ParallelFor(m_moveBufferCount, 64, QueryMoveBuffer, this);
+	}
+	else
+	{
+		QueryMoveBuffer(this, 0, m_moveBufferCount, 0);
+	}
+
+	// Reset the move buffer for the next step.
+	m_moveBufferCount = 0;
+
+	// Merge the thread buffers.
+	u32 pairCount = 0;
+	for (u32 i = 0; i < threadCount; ++i)
+	{
+		pairCount += m_threadPairs[i].count;
+	}
+
 	// Check capacity.
-	if (m_pairCount == m_pairCapacity) 
+	if (pairCount > m_pairCapacity)
 	{
-		// Duplicate capacity.
-		m_pairCapacity *= 2;
-		
-		b3Pair* oldPairs = m_pairs;
+		while (m_pairCapacity < pairCount)
+		{
+			m_pairCapacity *= 2;
+		}
+
+		// The old pairs don't need to be kept.
+		b3Free(m_sortPairs);
+		b3Free(m_pairs);
 		m_pairs = (b3Pair*)b3Alloc(m_pairCapacity * sizeof(b3Pair));
-		memcpy(m_pairs, oldPairs, m_pairCount * sizeof(b3Pair));
-		b3Free(oldPairs);
+		m_sortPairs = (b3Pair*)b3Alloc(m_pairCapacity * sizeof(b3Pair));
 	}
 
-	// Add overlapping pair to the pair buffer.
-	m_pairs[m_pairCount].proxy1 = b3Min(proxyId, m_queryProxyId);
-	m_pairs[m_pairCount].proxy2 = b3Max(proxyId, m_queryProxyId);
-	++m_pairCount;
+	u32 maxProxy = 0;
+	m_pairCount = 0;
+	for (u32 i = 0; i < threadCount; ++i)
+	{
+		const b3PairBuffer* buffer = m_threadPairs + i;
+		for (u32 j = 0; j < buffer->count; ++j)
+		{
+			// proxy1 < proxy2
+			maxProxy = b3Max(maxProxy, buffer->pairs[j].proxy2);
+			m_pairs[m_pairCount++] = buffer->pairs[j];
+		}
+	}
 
-	// Keep looking for overlapping pairs.
-	return true;
-}
\ No newline at end of file
+	if (m_pairCount == 0)
+	{
+		return;
+	}
+
+	// Sort the (duplicated) overlapping pair buffer to prune duplicated pairs.
+	b3SortPairs(m_pairs, m_sortPairs, m_pairCount, maxProxy);
+
+	// Skip duplicated overlapping pairs.
+	u32 uniqueCount = 1;
+	for (u32 i = 1; i < m_pairCount; ++i)
+	{
+		const b3Pair* primaryPair = m_pairs + uniqueCount - 1;
+		const b3Pair* pair = m_pairs + i;
+		if (pair->proxy1 != primaryPair->proxy1 || pair->proxy2 != primaryPair->proxy2)
+		{
+			m_pairs[uniqueCount++] = *pair;
+		}
+	}
+	m_pairCount = uniqueCount;
+}
+
+void b3BroadPhase::WriteSnapshot(b3Snapshot* snapshot) const
+{
+	m_tree.WriteSnapshot(snapshot);
+	
+	snapshot->Write(m_proxyCount);
+	snapshot->Write(m_moveBufferCount);
+	snapshot->Write(m_moveBuffer, m_moveBufferCount * sizeof(u32));
+}
+
+void b3BroadPhase::ReadSnapshot(b3SnapshotReader* reader)
+{
+	m_tree.ReadSnapshot(reader);
+
+	u32 proxyCount = reader->Read<u32>();
+	B3_ASSERT(proxyCount == m_proxyCount);
+	B3_NOT_USED(proxyCount);
+
+	u32 moveCount = reader->Read<u32>();
+	if (moveCount > m_moveBufferCapacity)
+	{
+		b3Free(m_moveBuffer);
+		while (m_moveBufferCapacity < moveCount)
+		{
+			m_moveBufferCapacity *= 2;
+		}
+		m_moveBuffer = (u32*)b3Alloc(m_moveBufferCapacity * sizeof(u32));
+	}
+	
+	m_moveBufferCount = moveCount;
+	reader->Read(m_moveBuffer, m_moveBufferCount * sizeof(u32));
+}
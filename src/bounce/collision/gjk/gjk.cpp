@@ -18,14 +18,13 @@
 
 #include <bounce/collision/gjk/gjk.h>
 #include <bounce/collision/gjk/gjk_proxy.h>
+#include <bounce/common/stats.h>
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 
 // Implementation of the GJK (Gilbert-Johnson-Keerthi) algorithm 
 // using Voronoi regions and Barycentric coordinates.
 
-u32 b3_gjkCalls = 0, b3_gjkIters = 0, b3_gjkMaxIters = 0;
-
 // Convert a point Q from Cartesian coordinates to Barycentric coordinates (u, v) 
 // with respect to a segment AB.
 // The last output value is the divisor.
@@ -580,8 +579,6 @@ b3GJKOutput b3GJK(const b3Transform& xf1, const b3GJKProxy& proxy1,
 	const b3Transform& xf2, const b3GJKProxy& proxy2,
 	bool applyRadius, b3SimplexCache* cache)
 {
-	++b3_gjkCalls;
-
 	// Initialize the simplex.
 	b3Simplex simplex;
 	simplex.ReadCache(cache, xf1, proxy1, xf2, proxy2);
@@ -670,7 +667,6 @@ b3GJKOutput b3GJK(const b3Transform& xf1, const b3GJKProxy& proxy1,
 
 		// Iteration count is equated to the number of support point calls.
 		++iter;
-		++b3_gjkIters;
 
 		// Check for duplicate support points. 
 		// This is the main termination criteria.
@@ -694,7 +690,14 @@ b3GJKOutput b3GJK(const b3Transform& xf1, const b3GJKProxy& proxy1,
 		++simplex.m_count;
 	}
 
-	b3_gjkMaxIters = b3Max(b3_gjkMaxIters, iter);
+#if B3_ENABLE_STATS
+	if (b3_threadStats)
+	{
+		++b3_threadStats->gjkCalls;
+		b3_threadStats->gjkIters += iter;
+		b3_threadStats->gjkMaxIters = b3Max(b3_threadStats->gjkMaxIters, iter);
+	}
+#endif
 
 	// Prepare result.
 	b3GJKOutput output;
@@ -737,7 +740,6 @@ b3GJKOutput b3GJK(const b3Transform& xf1, const b3GJKProxy& proxy1,
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
-u32 b3_gjkCacheHits = 0;
 
 // Implements b3Simplex routines for a cached simplex.
 void b3Simplex::ReadCache(const b3SimplexCache* cache,
@@ -773,7 +775,12 @@ void b3Simplex::ReadCache(const b3SimplexCache* cache,
 		}
 		else
 		{
-			++b3_gjkCacheHits;
+#if B3_ENABLE_STATS
+			if (b3_threadStats)
+			{
+				++b3_threadStats->gjkCacheHits;
+			}
+#endif
 		}
 	}
 
@@ -0,0 +1,159 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson https://irlanrobson.github.io
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <bounce/collision/pair_set.h>
+#include <bounce/common/math/math.h>
+
+// Proxy identifiers are never B3_MAX_U32, so no pair has this key.
+#define B3_NULL_PAIR_KEY (0xFFFFFFFFFFFFFFFFull)
+
+b3PairSet::b3PairSet()
+{
+	m_count = 0;
+	m_capacity = 0;
+	m_keys = NULL;
+}
+
+b3PairSet::~b3PairSet()
+{
+	b3Free(m_keys);
+}
+
+u64 b3PairSet::GetKey(u32 proxy1, u32 proxy2)
+{
+	if (proxy1 > proxy2)
+	{
+		b3Swap(proxy1, proxy2);
+	}
+	return (u64(proxy1) << 32) | u64(proxy2);
+}
+
+u32 b3PairSet::GetSlot(u64 key) const
+{
+	key ^= key >> 33;
+	key *= 0xff51afd7ed558ccdull;
+	key ^= key >> 33;
+	return u32(key) & (m_capacity - 1);
+}
+
+void b3PairSet::Grow()
+{
+	u64* oldKeys = m_keys;
+	u32 oldCapacity = m_capacity;
+
+	m_capacity = oldCapacity == 0 ? 256 : 2 * oldCapacity;
+	m_keys = (u64*)b3Alloc(m_capacity * sizeof(u64));
+	for (u32 i = 0; i < m_capacity; ++i)
+	{
+		m_keys[i] = B3_NULL_PAIR_KEY;
+	}
+
+	for (u32 i = 0; i < oldCapacity; ++i)
+	{
+		u64 key = oldKeys[i];
+		if (key == B3_NULL_PAIR_KEY)
+		{
+			continue;
+		}
+
+		u32 slot = GetSlot(key);
+		while (m_keys[slot] != B3_NULL_PAIR_KEY)
+		{
+			slot = (slot + 1) & (m_capacity - 1);
+		}
+		m_keys[slot] = key;
+	}
+
+	b3Free(oldKeys);
+}
+
+void b3PairSet::Add(u32 proxy1, u32 proxy2)
+{
+	// Keep the load factor at most one half.
+	if (2 * (m_count + 1) > m_capacity)
+	{
+		Grow();
+	}
+
+	u64 key = GetKey(proxy1, proxy2);
+	u32 slot = GetSlot(key);
+	while (m_keys[slot] != B3_NULL_PAIR_KEY)
+	{
+		B3_ASSERT(m_keys[slot] != key);
+		slot = (slot + 1) & (m_capacity - 1);
+	}
+
+	m_keys[slot] = key;
+	++m_count;
+}
+
+void b3PairSet::Remove(u32 proxy1, u32 proxy2)
+{
+	B3_ASSERT(m_count > 0);
+
+	u64 key = GetKey(proxy1, proxy2);
+	u32 slot = GetSlot(key);
+	while (m_keys[slot] != key)
+	{
+		B3_ASSERT(m_keys[slot] != B3_NULL_PAIR_KEY);
+		slot = (slot + 1) & (m_capacity - 1);
+	}
+
+	// Shift the following keys of the probe sequence back 
+	// so that no tombstones are needed.
+	u32 hole = slot;
+	u32 next = (hole + 1) & (m_capacity - 1);
+	while (m_keys[next] != B3_NULL_PAIR_KEY)
+	{
+		u32 home = GetSlot(m_keys[next]);
+		
+		// Move the key into the hole if its home slot 
+		// isn't cyclically in (hole, next].
+		bool move = hole <= next ? (home <= hole || home > next) : (home <= hole && home > next);
+		if (move)
+		{
+			m_keys[hole] = m_keys[next];
+			hole = next;
+		}
+
+		next = (next + 1) & (m_capacity - 1);
+	}
+
+	m_keys[hole] = B3_NULL_PAIR_KEY;
+	--m_count;
+}
+
+bool b3PairSet::Contains(u32 proxy1, u32 proxy2) const
+{
+	if (m_count == 0)
+	{
+		return false;
+	}
+
+	u64 key = GetKey(proxy1, proxy2);
+	u32 slot = GetSlot(key);
+	while (m_keys[slot] != B3_NULL_PAIR_KEY)
+	{
+		if (m_keys[slot] == key)
+		{
+			return true;
+		}
+		slot = (slot + 1) & (m_capacity - 1);
+	}
+	return false;
+}
@@ -0,0 +1,157 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson https://irlanrobson.github.io
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#include <bounce/collision/time_of_impact.h>
+#include <bounce/common/stats.h>
+
+// Get the maximum distance between a proxy vertex and the center of mass.
+static float32 b3ComputeSweepRadius(const b3GJKProxy& proxy, const b3Vec3& localCenter)
+{
+	float32 maxDistanceSquared = 0.0f;
+	for (u32 i = 0; i < proxy.vertexCount; ++i)
+	{
+		float32 distanceSquared = b3LengthSquared(proxy.vertices[i] - localCenter);
+		maxDistanceSquared = b3Max(maxDistanceSquared, distanceSquared);
+	}
+	return b3Sqrt(maxDistanceSquared);
+}
+
+// Get the maximum angular speed of a sweep over the interval [0, 1].
+static float32 b3ComputeSweepAngularSpeed(const b3Sweep& sweep)
+{
+	b3Quat q1 = sweep.orientation0;
+	b3Quat q2 = sweep.orientation;
+
+	float32 cosine = b3Min(b3Abs(b3Dot(q1, q2)) / (b3Length(q1) * b3Length(q2)), 1.0f);
+	
+	// The rotation angle of the sweep.
+	float32 angle = 2.0f * acos(cosine);
+
+	// The sweep interpolates the orientation linearly and normalizes it. 
+	// The angular speed is maximum at the middle of the interval, 
+	// where it is 4 * tan(angle / 4).
+	return 4.0f * tan(0.25f * angle);
+}
+
+void b3TimeOfImpact(b3TOIOutput* output, 
+	const b3Sweep& sweepA, const b3GJKProxy& proxyA, 
+	const b3Sweep& sweepB, const b3GJKProxy& proxyB, 
+	float32 tMax)
+{
+	output->state = b3TOIOutput::e_unknown;
+	output->t = tMax;
+	output->iterations = 0;
+
+	B3_ASSERT(sweepA.t0 == sweepB.t0);
+
+	// Stop when the core shapes are separated by the total radius minus a slop.
+	float32 totalRadius = proxyA.radius + proxyB.radius;
+	float32 target = b3Max(B3_LINEAR_SLOP, totalRadius - 3.0f * B3_LINEAR_SLOP);
+	float32 tolerance = 0.25f * B3_LINEAR_SLOP;
+	B3_ASSERT(target > tolerance);
+
+	// Bound the speed of the proxy vertices along any direction.
+	b3Vec3 dA = sweepA.worldCenter - sweepA.worldCenter0;
+	b3Vec3 dB = sweepB.worldCenter - sweepB.worldCenter0;
+
+	float32 angularBound = 
+		b3ComputeSweepAngularSpeed(sweepA) * b3ComputeSweepRadius(proxyA, sweepA.localCenter) + 
+		b3ComputeSweepAngularSpeed(sweepB) * b3ComputeSweepRadius(proxyB, sweepB.localCenter);
+
+	b3SimplexCache cache;
+	cache.count = 0;
+
+	float32 t = 0.0f;
+	
+	const u32 kMaxIters = B3_MAX_TOI_ITERATIONS;
+	u32 iter = 0;
+	for (;;)
+	{
+		b3Transform xfA = sweepA.GetTransform(t);
+		b3Transform xfB = sweepB.GetTransform(t);
+
+		// Get the distance between the core shapes.
+		b3GJKOutput query = b3GJK(xfA, proxyA, xfB, proxyB, false, &cache);
+
+		++iter;
+
+		// If the shapes are overlapping initially then the discrete solver handles them.
+		if (query.distance < target - tolerance && t == 0.0f)
+		{
+			output->state = b3TOIOutput::e_overlapped;
+			output->t = 0.0f;
+			break;
+		}
+
+		// Bound the approach speed along the separating axis.
+		b3Vec3 n = (query.point2 - query.point1) / query.distance;
+		float32 bound = b3Dot(dA - dB, n) + angularBound;
+		if (bound <= B3_EPSILON)
+		{
+			// The shapes are not approaching.
+			output->state = b3TOIOutput::e_separated;
+			output->t = tMax;
+			break;
+		}
+
+		if (query.distance < target + tolerance)
+		{
+			// Victory!
+			// Let the shapes overlap by up to a linear slop so that 
+			// the discrete collision finds contact points.
+			float32 separation = query.distance - totalRadius;
+			if (separation > -B3_LINEAR_SLOP)
+			{
+				t = b3Min(t + (separation + B3_LINEAR_SLOP) / bound, tMax);
+			}
+
+			output->state = b3TOIOutput::e_touching;
+			output->t = t;
+			break;
+		}
+
+		// Advance the sweeps conservatively.
+		t += (query.distance - target) / bound;
+		if (t >= tMax)
+		{
+			output->state = b3TOIOutput::e_separated;
+			output->t = tMax;
+			break;
+		}
+
+		if (iter == kMaxIters)
+		{
+			// Root finder got stuck. 
+			output->state = b3TOIOutput::e_failed;
+			output->t = t;
+			break;
+		}
+	}
+
+	output->iterations = iter;
+
+#if B3_ENABLE_STATS
+	if (b3_threadStats)
+	{
+		++b3_threadStats->toiCalls;
+		b3_threadStats->toiIters += iter;
+		b3_threadStats->toiMaxIters = b3Max(b3_threadStats->toiMaxIters, iter);
+	}
+#endif
+}
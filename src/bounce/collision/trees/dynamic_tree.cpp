@@ -18,6 +18,7 @@
 
 #include <bounce/collision/trees/dynamic_tree.h>
 #include <bounce/common/draw.h>
+#include <bounce/common/memory/snapshot.h>
 
 b3DynamicTree::b3DynamicTree() 
 {
@@ -400,3 +401,25 @@ void b3DynamicTree::Draw() const
 		}
 	}
 }
+
+void b3DynamicTree::WriteSnapshot(b3Snapshot* snapshot) const
+{
+	snapshot->Write(m_root);
+	snapshot->Write(m_nodeCount);
+	snapshot->Write(m_nodeCapacity);
+	snapshot->Write(m_freeList);
+	snapshot->Write(m_nodes, m_nodeCapacity * sizeof(b3Node));
+}
+
+void b3DynamicTree::ReadSnapshot(b3SnapshotReader* reader)
+{
+	reader->Read(m_root);
+	reader->Read(m_nodeCount);
+	
+	u32 capacity = reader->Read<u32>();
+	B3_ASSERT(capacity == m_nodeCapacity);
+	B3_NOT_USED(capacity);
+	
+	reader->Read(m_freeList);
+	reader->Read(m_nodes, m_nodeCapacity * sizeof(b3Node));
+}
@@ -0,0 +1,79 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson https://irlanrobson.github.io
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <bounce/common/memory/snapshot.h>
+#include <bounce/common/math/math.h>
+#include <string.h>
+
+b3Snapshot::b3Snapshot()
+{
+	m_data = NULL;
+	m_size = 0;
+	m_capacity = 0;
+}
+
+b3Snapshot::~b3Snapshot()
+{
+	if (m_data)
+	{
+		b3Free(m_data);
+	}
+}
+
+void b3Snapshot::Clear()
+{
+	m_size = 0;
+}
+
+void b3Snapshot::Write(const void* data, u32 size)
+{
+	if (m_size + size > m_capacity)
+	{
+		u32 capacity = b3Max(m_capacity, 256u);
+		while (capacity < m_size + size)
+		{
+			capacity *= 2;
+		}
+
+		u8* oldData = m_data;
+		m_data = (u8*)b3Alloc(capacity);
+		if (oldData)
+		{
+			memcpy(m_data, oldData, m_size);
+			b3Free(oldData);
+		}
+		m_capacity = capacity;
+	}
+
+	memcpy(m_data + m_size, data, size);
+	m_size += size;
+}
+
+b3SnapshotReader::b3SnapshotReader(const b3Snapshot& snapshot)
+{
+	m_data = (const u8*)snapshot.GetData();
+	m_size = snapshot.GetSize();
+	m_offset = 0;
+}
+
+void b3SnapshotReader::Read(void* data, u32 size)
+{
+	B3_ASSERT(m_offset + size <= m_size);
+	memcpy(data, m_data + m_offset, size);
+	m_offset += size;
+}
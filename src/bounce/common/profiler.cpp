@@ -0,0 +1,367 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson https://irlanrobson.github.io
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#include <bounce/common/profiler.h>
+#include <bounce/common/math/math.h>
+#include <stdio.h>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define B3_PROFILER_RDTSC (1)
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define B3_PROFILER_RDTSC (1)
+#else
+#include <chrono>
+#define B3_PROFILER_RDTSC (0)
+#endif
+
+b3Profiler* b3_profiler = NULL;
+
+void b3ProfilerBeginScope(const char* name)
+{
+	if (b3_profiler)
+	{
+		b3_profiler->BeginScope(name);
+	}
+}
+
+void b3ProfilerEndScope()
+{
+	if (b3_profiler)
+	{
+		b3_profiler->EndScope();
+	}
+}
+
+// Read the timestamp counter. 
+// The counter is converted to milliseconds using the elapsed time of a b3Time.
+static inline u64 b3ReadTicks()
+{
+#if B3_PROFILER_RDTSC
+	return __rdtsc();
+#else
+	return (u64)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+// The buffer of the calling thread and the profiler it belongs to.
+static thread_local u32 b3_threadProfilerId = 0;
+static thread_local void* b3_threadBuffer = NULL;
+
+// The next profiler identifier. Zero means no profiler.
+static std::atomic<u32> b3_nextProfilerId(1);
+
+b3Profiler::b3Profiler()
+{
+	m_id = b3_nextProfilerId.fetch_add(1, std::memory_order_relaxed);
+	
+	m_threadCount.store(0, std::memory_order_relaxed);
+	for (u32 i = 0; i < B3_PROFILER_MAX_THREADS; ++i)
+	{
+		m_threads[i].store(NULL, std::memory_order_relaxed);
+	}
+
+	m_ticks0 = b3ReadTicks();
+#if B3_PROFILER_RDTSC
+	m_milisPerTick = 0.0;
+#else
+	m_milisPerTick = 1.0e-6;
+#endif
+
+	m_frameTicks = m_ticks0;
+	m_frameTime = 0.0;
+	m_scopeCount = 0;
+}
+
+b3Profiler::~b3Profiler()
+{
+	u32 threadCount = b3Min(m_threadCount.load(std::memory_order_acquire), u32(B3_PROFILER_MAX_THREADS));
+	for (u32 i = 0; i < threadCount; ++i)
+	{
+		b3ThreadBuffer* buffer = m_threads[i].load(std::memory_order_acquire);
+		if (buffer)
+		{
+			buffer->~b3ThreadBuffer();
+			b3Free(buffer);
+		}
+	}
+}
+
+b3Profiler::b3ThreadBuffer* b3Profiler::GetThreadBuffer()
+{
+	if (b3_threadProfilerId == m_id)
+	{
+		return (b3ThreadBuffer*)b3_threadBuffer;
+	}
+
+	// Claim a buffer for the calling thread.
+	u32 index = m_threadCount.fetch_add(1, std::memory_order_relaxed);
+	
+	b3ThreadBuffer* buffer = NULL;
+	if (index < B3_PROFILER_MAX_THREADS)
+	{
+		void* block = b3Alloc(sizeof(b3ThreadBuffer));
+		buffer = new (block) b3ThreadBuffer();
+		buffer->head.store(0, std::memory_order_relaxed);
+		buffer->frameHead = 0;
+		
+		m_threads[index].store(buffer, std::memory_order_release);
+	}
+
+	// A thread that didn't get a buffer doesn't record.
+	b3_threadProfilerId = m_id;
+	b3_threadBuffer = buffer;
+
+	return buffer;
+}
+
+void b3Profiler::BeginScope(const char* name)
+{
+	b3ThreadBuffer* buffer = GetThreadBuffer();
+	if (buffer == NULL)
+	{
+		return;
+	}
+
+	u32 head = buffer->head.load(std::memory_order_relaxed);
+	
+	b3ProfilerEvent* event = buffer->events + (head & (B3_PROFILER_EVENT_CAPACITY - 1));
+	event->name = name;
+	event->ticks = b3ReadTicks();
+
+	buffer->head.store(head + 1, std::memory_order_release);
+}
+
+void b3Profiler::EndScope()
+{
+	b3ThreadBuffer* buffer = GetThreadBuffer();
+	if (buffer == NULL)
+	{
+		return;
+	}
+
+	u32 head = buffer->head.load(std::memory_order_relaxed);
+	
+	b3ProfilerEvent* event = buffer->events + (head & (B3_PROFILER_EVENT_CAPACITY - 1));
+	event->name = NULL;
+	event->ticks = b3ReadTicks();
+
+	buffer->head.store(head + 1, std::memory_order_release);
+}
+
+void b3Profiler::Calibrate()
+{
+#if B3_PROFILER_RDTSC
+	m_timer.Update();
+	
+	float64 time = m_timer.GetCurrentMilis();
+	u64 ticks = b3ReadTicks() - m_ticks0;
+	if (time > 0.0 && ticks > 0)
+	{
+		m_milisPerTick = time / float64(ticks);
+	}
+#endif
+}
+
+float64 b3Profiler::ToMilis(u64 ticks) const
+{
+	return m_milisPerTick * float64(ticks - m_ticks0);
+}
+
+void b3Profiler::BeginFrame()
+{
+	u32 threadCount = b3Min(m_threadCount.load(std::memory_order_acquire), u32(B3_PROFILER_MAX_THREADS));
+	for (u32 i = 0; i < threadCount; ++i)
+	{
+		b3ThreadBuffer* buffer = m_threads[i].load(std::memory_order_acquire);
+		if (buffer)
+		{
+			buffer->frameHead = buffer->head.load(std::memory_order_acquire);
+		}
+	}
+
+	m_frameTicks = b3ReadTicks();
+}
+
+void b3Profiler::EndFrame()
+{
+	u64 frameEndTicks = b3ReadTicks();
+
+	Calibrate();
+
+	m_frameTime = m_milisPerTick * float64(frameEndTicks - m_frameTicks);
+	m_scopeCount = 0;
+
+	// The scopes opened and not closed by a thread.
+	const u32 kMaxDepth = 64;
+	const char* names[kMaxDepth];
+	u64 ticks[kMaxDepth];
+
+	u32 threadCount = b3Min(m_threadCount.load(std::memory_order_acquire), u32(B3_PROFILER_MAX_THREADS));
+	for (u32 i = 0; i < threadCount; ++i)
+	{
+		b3ThreadBuffer* buffer = m_threads[i].load(std::memory_order_acquire);
+		if (buffer == NULL)
+		{
+			continue;
+		}
+
+		u32 head = buffer->head.load(std::memory_order_acquire);
+		u32 begin = buffer->frameHead;
+		if (head - begin > B3_PROFILER_EVENT_CAPACITY)
+		{
+			// The oldest events of the frame were overwritten.
+			begin = head - B3_PROFILER_EVENT_CAPACITY;
+		}
+
+		u32 depth = 0;
+		for (u32 j = begin; j != head; ++j)
+		{
+			const b3ProfilerEvent* event = buffer->events + (j & (B3_PROFILER_EVENT_CAPACITY - 1));
+			if (event->name)
+			{
+				if (depth < kMaxDepth)
+				{
+					names[depth] = event->name;
+					ticks[depth] = event->ticks;
+				}
+				++depth;
+				continue;
+			}
+
+			if (depth == 0)
+			{
+				// The scope was opened before the frame.
+				continue;
+			}
+
+			--depth;
+			if (depth >= kMaxDepth)
+			{
+				continue;
+			}
+
+			// Find the scope by name.
+			b3ProfilerScope* scope = NULL;
+			for (u32 k = 0; k < m_scopeCount; ++k)
+			{
+				if (m_scopes[k].name == names[depth])
+				{
+					scope = m_scopes + k;
+					break;
+				}
+			}
+
+			if (scope == NULL)
+			{
+				if (m_scopeCount == B3_PROFILER_MAX_SCOPES)
+				{
+					continue;
+				}
+
+				scope = m_scopes + m_scopeCount++;
+				scope->name = names[depth];
+				scope->callCount = 0;
+				scope->time = 0.0;
+			}
+
+			++scope->callCount;
+			scope->time += m_milisPerTick * float64(event->ticks - ticks[depth]);
+		}
+	}
+}
+
+bool b3Profiler::ExportChromeTrace(const char* fileName)
+{
+	FILE* file = fopen(fileName, "w");
+	if (file == NULL)
+	{
+		return false;
+	}
+
+	Calibrate();
+
+	fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+
+	bool first = true;
+
+	u32 threadCount = b3Min(m_threadCount.load(std::memory_order_acquire), u32(B3_PROFILER_MAX_THREADS));
+	for (u32 i = 0; i < threadCount; ++i)
+	{
+		b3ThreadBuffer* buffer = m_threads[i].load(std::memory_order_acquire);
+		if (buffer == NULL)
+		{
+			continue;
+		}
+
+		u32 head = buffer->head.load(std::memory_order_acquire);
+		u32 begin = head < B3_PROFILER_EVENT_CAPACITY ? 0 : head - B3_PROFILER_EVENT_CAPACITY;
+
+		// Skip the ends of the scopes that were overwritten.
+		u32 depth = 0;
+		for (u32 j = begin; j != head; ++j)
+		{
+			const b3ProfilerEvent* event = buffer->events + (j & (B3_PROFILER_EVENT_CAPACITY - 1));
+			
+			// The timestamps are in microseconds.
+			float64 ts = 1000.0 * ToMilis(event->ticks);
+
+			if (event->name)
+			{
+				fprintf(file, "%s\n{\"name\":\"%s\",\"cat\":\"bounce\",\"ph\":\"B\",\"pid\":0,\"tid\":%u,\"ts\":%.3f}", first ? "" : ",", event->name, i, ts);
+				++depth;
+			}
+			else
+			{
+				if (depth == 0)
+				{
+					continue;
+				}
+
+				fprintf(file, "%s\n{\"ph\":\"E\",\"pid\":0,\"tid\":%u,\"ts\":%.3f}", first ? "" : ",", i, ts);
+				--depth;
+			}
+
+			first = false;
+		}
+	}
+
+	fprintf(file, "\n]}\n");
+	fclose(file);
+
+	return true;
+}
+
+void b3Profiler::Clear()
+{
+	u32 threadCount = b3Min(m_threadCount.load(std::memory_order_acquire), u32(B3_PROFILER_MAX_THREADS));
+	for (u32 i = 0; i < threadCount; ++i)
+	{
+		b3ThreadBuffer* buffer = m_threads[i].load(std::memory_order_acquire);
+		if (buffer)
+		{
+			buffer->head.store(0, std::memory_order_relaxed);
+			buffer->frameHead = 0;
+		}
+	}
+
+	m_scopeCount = 0;
+	m_frameTime = 0.0;
+}
@@ -18,19 +18,23 @@
 
 #include <bounce/common/settings.h>
 #include <bounce/common/math/math.h>
+#include <bounce/common/stats.h>
 #include <stdio.h>
 #include <stdarg.h>
 #include <stdlib.h>
 
-u32 b3_allocCalls = 0;
-u32 b3_maxAllocCalls = 0;
+thread_local b3CollisionStats* b3_threadStats = NULL;
 
 b3Version b3_version = { 1, 0, 0 };
 
 void* b3Alloc(u32 size) 
 {
-	++b3_allocCalls;
-	b3_maxAllocCalls = b3Max(b3_maxAllocCalls, b3_allocCalls);
+#if B3_ENABLE_STATS
+	if (b3_threadStats)
+	{
+		++b3_threadStats->allocCalls;
+	}
+#endif
 	return malloc(size);
 }
 
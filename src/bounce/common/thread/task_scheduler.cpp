@@ -0,0 +1,114 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson https://irlanrobson.github.io
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#include <bounce/common/thread/task_scheduler.h>
+#include <bounce/common/math/math.h>
+
+// The maximum number of tasks a parallel-for is split into.
+#define B3_MAX_PARALLEL_FOR_TASKS (4 * B3_MAX_THREADS)
+
+struct b3ParallelForTask
+{
+	b3Task task;
+	b3ParallelForFcn fcn;
+	void* context;
+	u32 begin;
+	u32 end;
+};
+
+static void b3ExecuteParallelForTask(void* data, u32 threadIndex)
+{
+	b3ParallelForTask* task = (b3ParallelForTask*)data;
+	task->fcn(task->context, task->begin, task->end, threadIndex);
+}
+
+void b3TaskScheduler::ParallelFor(u32 count, u32 grainSize, b3ParallelForFcn fcn, void* context)
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	grainSize = b3Max(grainSize, 1u);
+	
+	if (GetThreadCount() == 1 || count <= grainSize)
+	{
+		fcn(context, 0, count, GetThreadIndex());
+		return;
+	}
+
+	u32 taskCount = b3Min((count + grainSize - 1) / grainSize, u32(B3_MAX_PARALLEL_FOR_TASKS));
+	u32 itemCount = count / taskCount;
+	u32 remainder = count % taskCount;
+
+	b3ParallelForTask tasks[B3_MAX_PARALLEL_FOR_TASKS];
+	b3TaskGroup group;
+
+	u32 begin = 0;
+	for (u32 i = 0; i < taskCount; ++i)
+	{
+		u32 end = begin + itemCount + (i < remainder ? 1 : 0);
+
+		b3ParallelForTask* task = tasks + i;
+		task->task.fcn = b3ExecuteParallelForTask;
+		task->task.context = task;
+		task->fcn = fcn;
+		task->context = context;
+		task->begin = begin;
+		task->end = end;
+
+		Submit(&group, &task->task);
+
+		begin = end;
+	}
+
+	B3_ASSERT(begin == count);
+
+	Wait(&group);
+}
+
+u32 b3SerialTaskScheduler::GetThreadCount() const
+{
+	return 1;
+}
+
+u32 b3SerialTaskScheduler::GetThreadIndex() const
+{
+	return 0;
+}
+
+void b3SerialTaskScheduler::Submit(b3TaskGroup* group, b3Task* task)
+{
+	task->group = group;
+	task->fcn(task->context, 0);
+}
+
+void b3SerialTaskScheduler::Wait(b3TaskGroup* group)
+{
+	B3_NOT_USED(group);
+}
+
+void b3SerialTaskScheduler::ParallelFor(u32 count, u32 grainSize, b3ParallelForFcn fcn, void* context)
+{
+	B3_NOT_USED(grainSize);
+	if (count > 0)
+	{
+		fcn(context, 0, count, 0);
+	}
+}
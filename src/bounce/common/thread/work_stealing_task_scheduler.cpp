@@ -0,0 +1,207 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson https://irlanrobson.github.io
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#include <bounce/common/thread/work_stealing_task_scheduler.h>
+#include <bounce/common/math/math.h>
+
+// The scheduler that owns the current thread and the index of the thread in it.
+// Threads that don't belong to a scheduler have index zero.
+static thread_local const b3WorkStealingTaskScheduler* b3_threadScheduler = nullptr;
+static thread_local u32 b3_threadIndex = 0;
+
+b3WorkStealingTaskScheduler::b3WorkStealingTaskScheduler(u32 threadCount)
+{
+	B3_ASSERT(threadCount > 0);
+	m_threadCount = b3Min(b3Max(threadCount, 1u), u32(B3_MAX_THREADS));
+	m_queuedCount = 0;
+	m_sleepingCount = 0;
+	m_exit = false;
+
+	for (u32 i = 0; i < m_threadCount; ++i)
+	{
+		m_queues[i].head = 0;
+		m_queues[i].count = 0;
+	}
+
+	// Thread zero is the thread that waits for the tasks.
+	m_threads[0] = nullptr;
+	for (u32 i = 1; i < m_threadCount; ++i)
+	{
+		m_threads[i] = new std::thread(&b3WorkStealingTaskScheduler::WorkerMain, this, i);
+	}
+}
+
+b3WorkStealingTaskScheduler::~b3WorkStealingTaskScheduler()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_sleepMutex);
+		m_exit = true;
+	}
+	m_sleepCondition.notify_all();
+
+	for (u32 i = 1; i < m_threadCount; ++i)
+	{
+		m_threads[i]->join();
+		delete m_threads[i];
+	}
+}
+
+u32 b3WorkStealingTaskScheduler::GetThreadIndex() const
+{
+	if (b3_threadScheduler == this)
+	{
+		return b3_threadIndex;
+	}
+	return 0;
+}
+
+void b3WorkStealingTaskScheduler::Execute(b3Task* task, u32 threadIndex)
+{
+	b3TaskGroup* group = task->group;
+	
+	task->fcn(task->context, threadIndex);
+	
+	// The task and the group may be destroyed as soon as the counter drops to zero.
+	group->pendingCount.fetch_sub(1, std::memory_order_release);
+}
+
+void b3WorkStealingTaskScheduler::Submit(b3TaskGroup* group, b3Task* task)
+{
+	task->group = group;
+	group->pendingCount.fetch_add(1, std::memory_order_relaxed);
+
+	u32 threadIndex = GetThreadIndex();
+	
+	b3TaskQueue* queue = m_queues + threadIndex;
+	{
+		std::lock_guard<std::mutex> lock(queue->mutex);
+		if (queue->count < B3_MAX_QUEUED_TASKS)
+		{
+			u32 index = (queue->head + queue->count) % B3_MAX_QUEUED_TASKS;
+			queue->tasks[index] = task;
+			++queue->count;
+			task = nullptr;
+		}
+	}
+
+	if (task)
+	{
+		// The queue is full.
+		Execute(task, threadIndex);
+		return;
+	}
+
+	m_queuedCount.fetch_add(1);
+
+	if (m_sleepingCount.load() > 0)
+	{
+		// Lock so the wake up can't be lost between the check and the wait of a worker.
+		{
+			std::lock_guard<std::mutex> lock(m_sleepMutex);
+		}
+		m_sleepCondition.notify_one();
+	}
+}
+
+b3Task* b3WorkStealingTaskScheduler::Pop(u32 threadIndex)
+{
+	if (m_queuedCount.load() == 0)
+	{
+		return nullptr;
+	}
+
+	// Pop the most recent task from the own queue.
+	{
+		b3TaskQueue* queue = m_queues + threadIndex;
+		std::lock_guard<std::mutex> lock(queue->mutex);
+		if (queue->count > 0)
+		{
+			--queue->count;
+			u32 index = (queue->head + queue->count) % B3_MAX_QUEUED_TASKS;
+			m_queuedCount.fetch_sub(1);
+			return queue->tasks[index];
+		}
+	}
+
+	// Steal the oldest task from another queue.
+	for (u32 i = 1; i < m_threadCount; ++i)
+	{
+		b3TaskQueue* queue = m_queues + (threadIndex + i) % m_threadCount;
+		std::lock_guard<std::mutex> lock(queue->mutex);
+		if (queue->count > 0)
+		{
+			b3Task* task = queue->tasks[queue->head];
+			queue->head = (queue->head + 1) % B3_MAX_QUEUED_TASKS;
+			--queue->count;
+			m_queuedCount.fetch_sub(1);
+			return task;
+		}
+	}
+
+	return nullptr;
+}
+
+void b3WorkStealingTaskScheduler::Wait(b3TaskGroup* group)
+{
+	u32 threadIndex = GetThreadIndex();
+
+	while (group->pendingCount.load(std::memory_order_acquire) > 0)
+	{
+		b3Task* task = Pop(threadIndex);
+		if (task)
+		{
+			Execute(task, threadIndex);
+		}
+		else
+		{
+			// The remaining tasks are running on other threads.
+			std::this_thread::yield();
+		}
+	}
+}
+
+void b3WorkStealingTaskScheduler::WorkerMain(u32 threadIndex)
+{
+	b3_threadScheduler = this;
+	b3_threadIndex = threadIndex;
+
+	for (;;)
+	{
+		b3Task* task = Pop(threadIndex);
+		if (task)
+		{
+			Execute(task, threadIndex);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(m_sleepMutex);
+		
+		m_sleepingCount.fetch_add(1);
+		while (m_exit == false && m_queuedCount.load() == 0)
+		{
+			m_sleepCondition.wait(lock);
+		}
+		m_sleepingCount.fetch_sub(1);
+
+		if (m_exit)
+		{
+			return;
+		}
+	}
+}
@@ -25,6 +25,7 @@
 b3Body::b3Body(const b3BodyDef& def, b3World* world) 
 {
 	m_world = world;
+	m_recordID = B3_MAX_U32;
 	m_type = def.type;
 	m_flags = 0;
 	
@@ -32,6 +33,11 @@ b3Body::b3Body(const b3BodyDef& def, b3World* world)
 	{
 		m_flags |= e_awakeFlag;
 	}
+
+	if (def.bullet)
+	{
+		m_flags |= e_bulletFlag;
+	}
 	
 	if (m_type == e_dynamicBody) 
 	{
@@ -61,35 +67,50 @@ b3Body::b3Body(const b3BodyDef& def, b3World* world)
 		
 	m_I.SetZero();
 	m_invI.SetZero();
-	m_worldInvI.SetZero();
 
-	m_force.SetZero();
-	m_torque.SetZero();
+	m_store = &world->m_bodyStore;
+	m_storeIndex = m_store->Add(this);
+
+	WorldInvI().SetZero();
+
+	Force().SetZero();
+	Torque().SetZero();
 	
-	m_linearVelocity = def.linearVelocity;
-	m_angularVelocity = def.angularVelocity;
-
-	m_sweep.localCenter.SetZero();
-	m_sweep.worldCenter = def.position;
-	m_sweep.orientation = def.orientation;
-	m_sweep.worldCenter0 = def.position;
-	m_sweep.orientation0 = def.orientation;
-	m_sweep.t0 = 0.0f;
-
-	m_xf.position = m_sweep.worldCenter;
-	m_xf.rotation = b3QuatMat33(m_sweep.orientation);
+	LinearVelocity() = def.linearVelocity;
+	AngularVelocity() = def.angularVelocity;
+
+	b3Sweep& sweep = Sweep();
+	sweep.localCenter.SetZero();
+	sweep.worldCenter = def.position;
+	sweep.orientation = def.orientation;
+	sweep.worldCenter0 = def.position;
+	sweep.orientation0 = def.orientation;
+	sweep.t0 = 0.0f;
+
+	Transform().position = sweep.worldCenter;
+	Transform().rotation = b3QuatMat33(sweep.orientation);
 	
 	m_linearDamping = def.linearDamping;
 	m_angularDamping = def.angularDamping;
 	m_gravityScale = def.gravityScale;
 	m_userData = def.userData;
 	m_sleepTime = 0.0f;
+
+	m_island = NULL;
+	m_islandPrev = NULL;
+	m_islandNext = NULL;
 }
 
 b3Shape* b3Body::CreateShape(const b3ShapeDef& def) 
 {
 	// Create the shape with the definition.
 	b3Shape* shape = b3Shape::Create(def);
+
+	if (m_world->m_recorder)
+	{
+		shape->m_recordID = m_world->m_recorder->RecordCreateShape(m_recordID, def);
+	}
+
 	shape->m_body = this;
 	shape->m_isSensor = def.isSensor;
 	shape->m_userData = def.userData;
@@ -104,15 +125,15 @@ b3Shape* b3Body::CreateShape(const b3ShapeDef& def)
 	// this body need to be recomputed.
 	if (shape->m_density > 0.0f) 
 	{
-		ResetMass();
+		UpdateMass();
 	}
 
 	// Compute the world AABB of the new shape and assign a broad-phase proxy to it.
-	b3Transform xf = m_xf;
+	b3Transform xf = Transform();
 	
 	b3AABB3 aabb;
 	shape->ComputeAABB(&aabb, xf);
-	shape->m_broadPhaseID = m_world->m_contactMan.m_broadPhase.CreateProxy(aabb, shape);
+	shape->m_broadPhaseID = m_world->m_contactMan.m_broadPhase.CreateProxy(aabb, shape, def.filter);
 
 	// Tell the world that a new shape was added so new contacts can be created.
 	m_world->m_flags |= b3World::e_shapeAddedFlag;
@@ -141,6 +162,11 @@ void b3Body::DestroyJoints()
 
 void b3Body::DestroyShape(b3Shape* shape) 
 {
+	if (m_world->m_recorder)
+	{
+		m_world->m_recorder->RecordDestroyShape(shape->m_recordID);
+	}
+
 	// Remove the shape from this body shape list.
 	B3_ASSERT(shape->m_body == this);
 	m_shapeList.Remove(shape);
@@ -155,7 +181,7 @@ void b3Body::DestroyShape(b3Shape* shape)
 	b3Shape::Destroy(shape);
 
 	// Recalculate the new inertial properties of this body.
-	ResetMass();
+	UpdateMass();
 }
 
 void b3Body::DestroyShapes() 
@@ -175,14 +201,25 @@ void b3Body::DestroyShapes()
 
 void b3Body::SynchronizeTransform()
 {
-	m_xf = m_sweep.GetTransform(1.0f);
+	Transform() = Sweep().GetTransform(1.0f);
+}
+
+void b3Body::Advance(float32 t)
+{
+	// Advance to the new safe time.
+	b3Sweep& sweep = Sweep();
+	sweep.Advance(t);
+	sweep.worldCenter = sweep.worldCenter0;
+	sweep.orientation = sweep.orientation0;
+	WorldInvI() = b3RotateToFrame(m_invI, sweep.orientation);
+	SynchronizeTransform();
 }
 
 void b3Body::SynchronizeShapes() 
 {
-	b3Transform xf1 = m_sweep.GetTransform(0.0f);
+	b3Transform xf1 = Sweep().GetTransform(0.0f);
 
-	b3Transform xf2 = m_xf;
+	b3Transform xf2 = Transform();
 	
 	b3Vec3 displacement = xf2.position - xf1.position;
 
@@ -198,6 +235,9 @@ void b3Body::SynchronizeShapes()
 		b3AABB3 aabb = b3Combine(aabb1, aabb2);
 
 		broadPhase->MoveProxy(s->m_broadPhaseID, aabb, displacement);
+
+		// The shape might have begun or stopped overlapping a sensor.
+		m_world->m_contactMan.TouchSensors(s);
 	}
 }
 
@@ -229,19 +269,33 @@ bool b3Body::ShouldCollide(const b3Body* other) const
 
 void b3Body::ResetMass() 
 {
+	if (m_world->m_recorder)
+	{
+		m_world->m_recorder->RecordResetMass(m_recordID);
+	}
+
+	UpdateMass();
+}
+
+void b3Body::UpdateMass() 
+{
+	b3Sweep& sweep = Sweep();
+	b3Mat33& worldInvI = WorldInvI();
+	const b3Transform& xf = Transform();
+
 	m_mass = 0.0f;
 	m_invMass = 0.0f;
 	m_I.SetZero();
 	m_invI.SetZero();
-	m_worldInvI.SetZero();
-	m_sweep.localCenter.SetZero();
+	worldInvI.SetZero();
+	sweep.localCenter.SetZero();
 
 	// Static and kinematic bodies have zero mass.
 	if (m_type == e_staticBody || m_type == e_kinematicBody)
 	{
-		m_sweep.worldCenter0 = m_xf.position;
-		m_sweep.worldCenter = m_xf.position;
-		m_sweep.orientation0 = m_sweep.orientation;
+		sweep.worldCenter0 = xf.position;
+		sweep.worldCenter = xf.position;
+		sweep.orientation0 = sweep.orientation;
 		return;
 	}
 
@@ -280,7 +334,7 @@ void b3Body::ResetMass()
 		m_invI = b3Inverse(m_I);
 
 		// Align the inverse inertia with the world frame of the body.
-		m_worldInvI = b3RotateToFrame(m_invI, m_xf.rotation);
+		worldInvI = b3RotateToFrame(m_invI, xf.rotation);
 
 		// Fix rotation.
 		if (m_flags & e_fixedRotationX)
@@ -290,10 +344,10 @@ void b3Body::ResetMass()
 			m_invI.y.z = 0.0f;
 			m_invI.z.z = 0.0f;
 
-			m_worldInvI.y.y = 0.0f;
-			m_worldInvI.z.y = 0.0f;
-			m_worldInvI.y.z = 0.0f;
-			m_worldInvI.z.z = 0.0f;
+			worldInvI.y.y = 0.0f;
+			worldInvI.z.y = 0.0f;
+			worldInvI.y.z = 0.0f;
+			worldInvI.z.z = 0.0f;
 		}
 
 		if (m_flags & e_fixedRotationY)
@@ -303,10 +357,10 @@ void b3Body::ResetMass()
 			m_invI.z.x = 0.0f;
 			m_invI.z.z = 0.0f;
 
-			m_worldInvI.x.x = 0.0f;
-			m_worldInvI.x.z = 0.0f;
-			m_worldInvI.z.x = 0.0f;
-			m_worldInvI.z.z = 0.0f;
+			worldInvI.x.x = 0.0f;
+			worldInvI.x.z = 0.0f;
+			worldInvI.z.x = 0.0f;
+			worldInvI.z.z = 0.0f;
 		}
 
 		if (m_flags & e_fixedRotationZ)
@@ -316,10 +370,10 @@ void b3Body::ResetMass()
 			m_invI.y.x = 0.0f;
 			m_invI.y.y = 0.0f;
 
-			m_worldInvI.x.x = 0.0f;
-			m_worldInvI.x.y = 0.0f;
-			m_worldInvI.y.x = 0.0f;
-			m_worldInvI.y.y = 0.0f;
+			worldInvI.x.x = 0.0f;
+			worldInvI.x.y = 0.0f;
+			worldInvI.y.x = 0.0f;
+			worldInvI.y.y = 0.0f;
 		}
 	}
 	else 
@@ -330,33 +384,42 @@ void b3Body::ResetMass()
 	}
 
 	// Move center of mass.
-	b3Vec3 oldCenter = m_sweep.worldCenter;
-	m_sweep.localCenter = localCenter;
-	m_sweep.worldCenter = b3Mul(m_xf, m_sweep.localCenter);
-	m_sweep.worldCenter0 = m_sweep.worldCenter;
+	b3Vec3 oldCenter = sweep.worldCenter;
+	sweep.localCenter = localCenter;
+	sweep.worldCenter = b3Mul(xf, sweep.localCenter);
+	sweep.worldCenter0 = sweep.worldCenter;
 
 	// Update center of mass velocity.
-	m_linearVelocity += b3Cross(m_angularVelocity, m_sweep.worldCenter - oldCenter);
+	LinearVelocity() += b3Cross(AngularVelocity(), sweep.worldCenter - oldCenter);
 }
 
 void b3Body::GetMassData(b3MassData* data) const
 {
 	data->mass = m_mass;
 	data->I = m_I;
-	data->center = m_sweep.localCenter;
+	data->center = Sweep().localCenter;
 }
 
 void b3Body::SetMassData(const b3MassData* massData)
 {
+	if (m_world->m_recorder)
+	{
+		m_world->m_recorder->RecordSetMassData(m_recordID, massData);
+	}
+
 	if (m_type != e_dynamicBody)
 	{
 		return;
 	}
 
+	b3Sweep& sweep = Sweep();
+	b3Mat33& worldInvI = WorldInvI();
+	const b3Transform& xf = Transform();
+
 	m_invMass = 0.0f;
 	m_I.SetZero();
 	m_invI.SetZero();
-	m_worldInvI.SetZero();
+	worldInvI.SetZero();
 
 	m_mass = massData->mass;
 	if (m_mass > 0.0f)
@@ -369,7 +432,7 @@ void b3Body::SetMassData(const b3MassData* massData)
 		B3_ASSERT(m_I.z.z > 0.0f);
 
 		m_invI = b3Inverse(m_I);
-		m_worldInvI = b3RotateToFrame(m_invI, m_xf.rotation);
+		worldInvI = b3RotateToFrame(m_invI, xf.rotation);
 
 		if (m_flags & e_fixedRotationX)
 		{
@@ -378,10 +441,10 @@ void b3Body::SetMassData(const b3MassData* massData)
 			m_invI.y.z = 0.0f;
 			m_invI.z.z = 0.0f;
 
-			m_worldInvI.y.y = 0.0f;
-			m_worldInvI.z.y = 0.0f;
-			m_worldInvI.y.z = 0.0f;
-			m_worldInvI.z.z = 0.0f;
+			worldInvI.y.y = 0.0f;
+			worldInvI.z.y = 0.0f;
+			worldInvI.y.z = 0.0f;
+			worldInvI.z.z = 0.0f;
 		}
 
 		if (m_flags & e_fixedRotationY)
@@ -391,10 +454,10 @@ void b3Body::SetMassData(const b3MassData* massData)
 			m_invI.z.x = 0.0f;
 			m_invI.z.z = 0.0f;
 
-			m_worldInvI.x.x = 0.0f;
-			m_worldInvI.x.z = 0.0f;
-			m_worldInvI.z.x = 0.0f;
-			m_worldInvI.z.z = 0.0f;
+			worldInvI.x.x = 0.0f;
+			worldInvI.x.z = 0.0f;
+			worldInvI.z.x = 0.0f;
+			worldInvI.z.z = 0.0f;
 		}
 
 		if (m_flags & e_fixedRotationZ)
@@ -404,10 +467,10 @@ void b3Body::SetMassData(const b3MassData* massData)
 			m_invI.y.x = 0.0f;
 			m_invI.y.y = 0.0f;
 
-			m_worldInvI.x.x = 0.0f;
-			m_worldInvI.x.y = 0.0f;
-			m_worldInvI.y.x = 0.0f;
-			m_worldInvI.y.y = 0.0f;
+			worldInvI.x.x = 0.0f;
+			worldInvI.x.y = 0.0f;
+			worldInvI.y.x = 0.0f;
+			worldInvI.y.y = 0.0f;
 		}
 	}
 	else
@@ -417,17 +480,55 @@ void b3Body::SetMassData(const b3MassData* massData)
 	}
 
 	// Move center of mass.
-	b3Vec3 oldCenter = m_sweep.worldCenter;
-	m_sweep.localCenter = massData->center;
-	m_sweep.worldCenter = b3Mul(m_xf, m_sweep.localCenter);
-	m_sweep.worldCenter0 = m_sweep.worldCenter;
+	b3Vec3 oldCenter = sweep.worldCenter;
+	sweep.localCenter = massData->center;
+	sweep.worldCenter = b3Mul(xf, sweep.localCenter);
+	sweep.worldCenter0 = sweep.worldCenter;
 
 	// Update center of mass velocity.
-	m_linearVelocity += b3Cross(m_angularVelocity, m_sweep.worldCenter - oldCenter);
+	LinearVelocity() += b3Cross(AngularVelocity(), sweep.worldCenter - oldCenter);
+}
+
+void b3Body::SetAwake(bool flag)
+{
+	// A step wakes and puts bodies to sleep by itself. The replayed step does the same.
+	if (m_world->m_recorder && (m_world->m_flags & b3World::e_lockedFlag) == 0)
+	{
+		RecordFlag(e_recordSetAwake, flag);
+	}
+
+	if (flag)
+	{
+		if (!IsAwake())
+		{
+			m_flags |= e_awakeFlag;
+			m_sleepTime = 0.0f;
+		}
+
+		// Wake the island so the body gets solved.
+		if (m_island && m_island->awake == false)
+		{
+			m_world->m_islandMan.WakeIsland(m_island);
+		}
+	}
+	else
+	{
+		m_flags &= ~e_awakeFlag;
+		m_sleepTime = 0.0f;
+		Force().SetZero();
+		Torque().SetZero();
+		LinearVelocity().SetZero();
+		AngularVelocity().SetZero();
+	}
 }
 
 void b3Body::SetType(b3BodyType type)
 {
+	if (m_world->m_recorder)
+	{
+		m_world->m_recorder->RecordSetType(m_recordID, type);
+	}
+
 	if (m_type == type)
 	{
 		return;
@@ -435,24 +536,43 @@ void b3Body::SetType(b3BodyType type)
 
 	m_type = type;
 
-	ResetMass();
+	UpdateMass();
 
-	m_force.SetZero();
-	m_torque.SetZero();
+	Force().SetZero();
+	Torque().SetZero();
 
 	if (m_type == e_staticBody)
 	{
-		m_linearVelocity.SetZero();
-		m_angularVelocity.SetZero();
-		m_sweep.worldCenter0 = m_sweep.worldCenter;
-		m_sweep.orientation0 = m_sweep.orientation;
+		LinearVelocity().SetZero();
+		AngularVelocity().SetZero();
+		Sweep().worldCenter0 = Sweep().worldCenter;
+		Sweep().orientation0 = Sweep().orientation;
 		SynchronizeShapes();
 	}
 
-	SetAwake(true);
-
 	DestroyContacts();
 
+	// Rebuild the island connectivity of this body.
+	b3IslandManager* islandMan = &m_world->m_islandMan;
+	for (b3JointEdge* je = m_jointEdges.m_head; je; je = je->m_next)
+	{
+		islandMan->RemoveJoint(je->joint);
+	}
+
+	islandMan->RemoveBody(this);
+	
+	if (m_type != e_staticBody)
+	{
+		islandMan->AddBody(this);
+	}
+
+	for (b3JointEdge* je = m_jointEdges.m_head; je; je = je->m_next)
+	{
+		islandMan->AddJoint(je->joint);
+	}
+
+	SetAwake(true);
+
 	// Move the shape proxies so new contacts can be created.
 	b3BroadPhase* phase = &m_world->m_contactMan.m_broadPhase;
 	for (b3Shape* s = m_shapeList.m_head; s; s = s->m_next)
@@ -461,19 +581,54 @@ void b3Body::SetType(b3BodyType type)
 	}
 }
 
+void b3Body::RecordSetTransform(const b3Vec3& position, const b3Vec3& axis, float32 angle)
+{
+	m_world->m_recorder->RecordSetTransform(m_recordID, position, axis, angle);
+}
+
+void b3Body::RecordVector(b3RecordType type, const b3Vec3& v)
+{
+	m_world->m_recorder->RecordBodyVector(type, m_recordID, v);
+}
+
+void b3Body::RecordVectorWake(b3RecordType type, const b3Vec3& v, bool wake)
+{
+	m_world->m_recorder->RecordBodyVectorWake(type, m_recordID, v, wake);
+}
+
+void b3Body::RecordPointWake(b3RecordType type, const b3Vec3& v, const b3Vec3& point, bool wake)
+{
+	m_world->m_recorder->RecordBodyPointWake(type, m_recordID, v, point, wake);
+}
+
+void b3Body::RecordScalar(b3RecordType type, float32 value)
+{
+	m_world->m_recorder->RecordScalar(type, m_recordID, value);
+}
+
+void b3Body::RecordFlag(b3RecordType type, bool flag)
+{
+	m_world->m_recorder->RecordFlag(type, m_recordID, flag);
+}
+
 void b3Body::Dump() const
 {
 	u32 bodyIndex = m_islandID;
 
+	const b3Sweep& sweep = Sweep();
+	const b3Vec3& v = LinearVelocity();
+	const b3Vec3& w = AngularVelocity();
+
 	b3Log("		{\n");
 	b3Log("		b3BodyDef bd;\n");
 	b3Log("		bd.type = (b3BodyType) %d;\n", m_type);
-	b3Log("		bd.position.Set(%f, %f, %f);\n", m_sweep.worldCenter.x, m_sweep.worldCenter.y, m_sweep.worldCenter.z);
-	b3Log("		bd.orientation.Set(%f, %f, %f, %f);\n", m_sweep.orientation.x, m_sweep.orientation.y, m_sweep.orientation.z, m_sweep.orientation.w);
-	b3Log("		bd.linearVelocity.Set(%f, %f, %f);\n", m_linearVelocity.x, m_linearVelocity.y, m_linearVelocity.z);
-	b3Log("		bd.angularVelocity.Set(%f, %f, %f);\n", m_angularVelocity.x, m_angularVelocity.y, m_angularVelocity.z);
+	b3Log("		bd.position.Set(%f, %f, %f);\n", sweep.worldCenter.x, sweep.worldCenter.y, sweep.worldCenter.z);
+	b3Log("		bd.orientation.Set(%f, %f, %f, %f);\n", sweep.orientation.x, sweep.orientation.y, sweep.orientation.z, sweep.orientation.w);
+	b3Log("		bd.linearVelocity.Set(%f, %f, %f);\n", v.x, v.y, v.z);
+	b3Log("		bd.angularVelocity.Set(%f, %f, %f);\n", w.x, w.y, w.z);
 	b3Log("		bd.gravityScale = %f;\n", m_gravityScale);
 	b3Log("		bd.awake = %d;\n", m_flags & e_awakeFlag);
+	b3Log("		bd.bullet = %d;\n", (m_flags & e_bulletFlag) != 0);
 	b3Log("		\n");
 	b3Log("		bodies[%d] = world.CreateBody(bd);\n");
 	b3Log("		\n");
@@ -0,0 +1,102 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson https://irlanrobson.github.io
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <bounce/dynamics/body_store.h>
+#include <bounce/dynamics/body.h>
+#include <bounce/common/template/array.h>
+
+b3BodyStore::b3BodyStore()
+{
+	m_count = 0;
+	m_capacity = 0;
+	m_bodies = NULL;
+	m_sweeps = NULL;
+	m_transforms = NULL;
+	m_linearVelocities = NULL;
+	m_angularVelocities = NULL;
+	m_worldInvInertias = NULL;
+	m_forces = NULL;
+	m_torques = NULL;
+
+	Reserve(64);
+}
+
+b3BodyStore::~b3BodyStore()
+{
+	b3Free(m_torques);
+	b3Free(m_forces);
+	b3Free(m_worldInvInertias);
+	b3Free(m_angularVelocities);
+	b3Free(m_linearVelocities);
+	b3Free(m_transforms);
+	b3Free(m_sweeps);
+	b3Free(m_bodies);
+}
+
+void b3BodyStore::Reserve(u32 capacity)
+{
+	B3_ASSERT(capacity > m_capacity);
+	
+	b3Grow(m_bodies, m_count, capacity);
+	b3Grow(m_sweeps, m_count, capacity);
+	b3Grow(m_transforms, m_count, capacity);
+	b3Grow(m_linearVelocities, m_count, capacity);
+	b3Grow(m_angularVelocities, m_count, capacity);
+	b3Grow(m_worldInvInertias, m_count, capacity);
+	b3Grow(m_forces, m_count, capacity);
+	b3Grow(m_torques, m_count, capacity);
+	
+	m_capacity = capacity;
+}
+
+u32 b3BodyStore::Add(b3Body* body)
+{
+	if (m_count == m_capacity)
+	{
+		Reserve(2 * m_capacity);
+	}
+
+	u32 index = m_count;
+	++m_count;
+
+	m_bodies[index] = body;
+	return index;
+}
+
+void b3BodyStore::Remove(u32 index)
+{
+	B3_ASSERT(index < m_count);
+	
+	u32 last = m_count - 1;
+	if (index != last)
+	{
+		b3Body* body = m_bodies[last];
+		body->m_storeIndex = index;
+
+		m_bodies[index] = body;
+		m_sweeps[index] = m_sweeps[last];
+		m_transforms[index] = m_transforms[last];
+		m_linearVelocities[index] = m_linearVelocities[last];
+		m_angularVelocities[index] = m_angularVelocities[last];
+		m_worldInvInertias[index] = m_worldInvInertias[last];
+		m_forces[index] = m_forces[last];
+		m_torques[index] = m_torques[last];
+	}
+
+	--m_count;
+}
@@ -17,18 +17,29 @@
 */
 
 #include <bounce/dynamics/contact_manager.h>
+#include <bounce/dynamics/island_manager.h>
 #include <bounce/dynamics/contacts/convex_contact.h>
 #include <bounce/dynamics/contacts/mesh_contact.h>
+#include <bounce/dynamics/contacts/sensor_pair.h>
 #include <bounce/dynamics/shapes/shape.h>
 #include <bounce/dynamics/body.h>
 #include <bounce/dynamics/world_listeners.h>
+#include <bounce/common/memory/stack_allocator.h>
+#include <bounce/common/thread/task_scheduler.h>
 
 b3ContactManager::b3ContactManager() : 
 	m_convexBlocks(sizeof(b3ConvexContact)),
-	m_meshBlocks(sizeof(b3MeshContact))
+	m_meshBlocks(sizeof(b3MeshContact)),
+	m_sensorBlocks(sizeof(b3SensorPair)),
+	m_convexStore(1, true),
+	m_meshStore(B3_MAX_MANIFOLDS, false)
 {
 	m_contactListener = NULL;
 	m_contactFilter = NULL;
+	m_contactEvents = NULL;
+	m_stats = NULL;
+	m_threadStats = NULL;
+	m_islandMan = NULL;
 }
 
 void b3ContactManager::AddPair(void* dataA, void* dataB) 
@@ -45,31 +56,15 @@ void b3ContactManager::AddPair(void* dataA, void* dataB)
 		return;
 	}
 
-	// Check if there is a contact between the two shapes.
-	// Search the list A or B. The shorter if possible.
-	for (b3ContactEdge* ce = shapeB->m_contactEdges.m_head; ce; ce = ce->m_next)
+	// Check if there is a contact or a sensor pair between the two shapes.
+	if (m_pairSet.Contains(shapeA->m_broadPhaseID, shapeB->m_broadPhaseID))
 	{
-		if (ce->other == shapeA)
-		{
-			b3Contact* c = ce->contact;
-			
-			b3Shape* sA = c->GetShapeA();
-			b3Shape* sB = c->GetShapeB();
-
-			if (sA == shapeA && sB == shapeB)
-			{
-				// A contact already exists.
-				return;
-			}
-
-			if (sB == shapeA && sA == shapeB)
-			{
-				// A contact already exists.
-				return;
-			}
-		}
+		// A pair already exists.
+		return;
 	}
 
+	B3_STAT(++m_stats->pairCount);
+
 	// Check if a joint prevents collision between the bodies.
 	if (bodyA->ShouldCollide(bodyB) == false)
 	{
@@ -86,6 +81,19 @@ void b3ContactManager::AddPair(void* dataA, void* dataB)
 		}
 	}
 
+	// Sensors only track overlaps.
+	if (shapeA->IsSensor() || shapeB->IsSensor())
+	{
+		if (shapeA->IsSensor() && shapeB->IsSensor())
+		{
+			// Sensors don't detect other sensors.
+			return;
+		}
+
+		CreateSensor(shapeA, shapeB);
+		return;
+	}
+
 	// Create contact.
 	b3Contact* c = Create(shapeA, shapeB);
 	if (c == NULL)
@@ -100,7 +108,11 @@ void b3ContactManager::AddPair(void* dataA, void* dataB)
 	bodyA = shapeA->GetBody();
 	bodyB = shapeB->GetBody();
 
-	c->m_flags = 0;
+	c->m_toi.t = 1.0f;
+	c->m_toi.count = 0;
+	c->m_island = NULL;
+	c->m_islandPrev = NULL;
+	c->m_islandNext = NULL;
 	b3OverlappingPair* pair = &c->m_pair;
 
 	// Initialize edge A
@@ -117,15 +129,24 @@ void b3ContactManager::AddPair(void* dataA, void* dataB)
 	// Add edge B to shape B's contact list.
 	shapeB->m_contactEdges.PushFront(&pair->edgeB);
 
-	// Awake the bodies if both are not sensors.
-	if (!shapeA->IsSensor() && !shapeB->IsSensor()) 
-	{
-		bodyA->SetAwake(true);
-		bodyB->SetAwake(true);
-	}
+	// Awake the bodies.
+	bodyA->SetAwake(true);
+	bodyB->SetAwake(true);
 
 	// Add the contact to the world contact list.
 	m_contactList.PushFront(c);
+
+	// The contact is active if one of the bodies is in an awake island.
+	// The contact might have been activated when the bodies were woken up.
+	if (c->IsActive() == false)
+	{
+		b3PersistentIsland* islandA = bodyA->m_island;
+		b3PersistentIsland* islandB = bodyB->m_island;
+		if ((islandA && islandA->awake) || (islandB && islandB->awake))
+		{
+			ActivateContact(c);
+		}
+	}
 	
 	if (c->m_type == e_meshContact)
 	{
@@ -143,91 +164,161 @@ void b3ContactManager::AddPair(void* dataA, void* dataB)
 
 void b3ContactManager::SynchronizeShapes()
 {
-	b3MeshContactLink* c = m_meshContactList.m_head;
-	while (c)
+	// Only the shapes of awake bodies can have moved.
+	for (u32 i = 0; i < m_meshStore.GetActiveCount(); ++i)
 	{
-		c->m_c->SynchronizeShapes();
-		c = c->m_next;
+		b3MeshContact* mc = (b3MeshContact*)m_meshStore.m_contacts[i];
+		mc->SynchronizeShapes();
 	}
 }
 
 // Find potentially overlapping shape pairs.
-void b3ContactManager::FindNewContacts()
+void b3ContactManager::FindNewContacts(b3TaskScheduler* scheduler)
+{
+	m_broadPhase.FindPairs(this, scheduler);
+
+	for (u32 i = 0; i < m_meshStore.GetActiveCount(); ++i)
+	{
+		b3MeshContact* mc = (b3MeshContact*)m_meshStore.m_contacts[i];
+		mc->FindNewPairs();
+	}
+}
+
+struct b3UpdateContactsContext
 {
-	m_broadPhase.FindPairs(this);
+	b3StackAllocator** allocators;
+	b3Contact** contacts;
+	b3CollisionStats* threadStats;
+};
 
-	b3MeshContactLink* c = m_meshContactList.m_head;
-	while (c)
+void b3ContactManager::UpdateContactRange(void* data, u32 begin, u32 end, u32 threadIndex)
+{
+	b3UpdateContactsContext* context = (b3UpdateContactsContext*)data;
+	b3StackAllocator* allocator = context->allocators[threadIndex];
+
+#if B3_ENABLE_STATS
+	// Count the collision routines of this thread.
+	b3CollisionStats* oldStats = b3SetThreadStats(context->threadStats + threadIndex);
+#endif
+
+	for (u32 i = begin; i < end; ++i)
 	{
-		c->m_c->FindNewPairs();
-		c = c->m_next;
+		context->contacts[i]->Update(allocator);
 	}
+
+#if B3_ENABLE_STATS
+	b3SetThreadStats(oldStats);
+#endif
 }
 
-void b3ContactManager::UpdateContacts() 
+void b3ContactManager::UpdateContacts(b3TaskScheduler* scheduler, b3StackAllocator** allocators)
 {	
 	B3_PROFILE("Update Contacts");
 	
-	// Update the state of all contacts.
-	b3Contact* c = m_contactList.m_head;
-	while (c)
+	b3StackAllocator* allocator = allocators[0];
+
+	// Contacts that need to be updated.
+	u32 contactCount = 0;
+	u32 activeCount = m_convexStore.GetActiveCount() + m_meshStore.GetActiveCount();
+	b3Contact** contacts = (b3Contact**)allocator->Allocate(activeCount * sizeof(b3Contact*));
+
+	// Filter the active contacts of each store. 
+	// The contacts are gathered in store order so that 
+	// their state is streamed from the store arrays when they are updated.
+	b3ContactStore* stores[2] = { &m_convexStore, &m_meshStore };
+	for (u32 i = 0; i < 2; ++i)
 	{
-		b3OverlappingPair* pair = &c->m_pair;
+		b3ContactStore* store = stores[i];
 
-		b3Shape* shapeA = pair->shapeA;
-		u32 proxyA = shapeA->m_broadPhaseID;
-		b3Body* bodyA = shapeA->m_body;
-		
-		b3Shape* shapeB = pair->shapeB;
-		u32 proxyB = shapeB->m_broadPhaseID;
-		b3Body* bodyB = shapeB->m_body;
-		
-		// Check if the bodies must not collide with each other.
-		if (bodyA->ShouldCollide(bodyB) == false)
+		// Destroying a contact moves the last active contact into its index.
+		u32 index = 0;
+		while (index < store->GetActiveCount())
 		{
-			b3Contact* quack = c;
-			c = c->m_next;
-			Destroy(quack);
-			continue;
-		}
+			b3Contact* c = store->m_contacts[index];
 
-		// Check for external filtering.
-		if (m_contactFilter)
-		{
-			if (m_contactFilter->ShouldCollide(shapeA, shapeB) == false)
+			b3OverlappingPair* pair = &c->m_pair;
+
+			b3Shape* shapeA = pair->shapeA;
+			u32 proxyA = shapeA->m_broadPhaseID;
+			b3Body* bodyA = shapeA->m_body;
+
+			b3Shape* shapeB = pair->shapeB;
+			u32 proxyB = shapeB->m_broadPhaseID;
+			b3Body* bodyB = shapeB->m_body;
+
+			// Check if the bodies must not collide with each other.
+			if (bodyA->ShouldCollide(bodyB) == false)
 			{
-				// The user has stopped the contact.
-				b3Contact* quack = c;
-				c = c->m_next;
-				Destroy(quack);
+				Destroy(c);
 				continue;
 			}
-		}
 
-		// At least one body must be dynamic or kinematic.
-		bool activeA = bodyA->IsAwake() && bodyA->m_type != e_staticBody;
-		bool activeB = bodyB->IsAwake() && bodyB->m_type != e_staticBody;
-		if (activeA == false && activeB == false) 
-		{
-			c = c->m_next;
-			continue;
+			// Check for external filtering.
+			if (m_contactFilter)
+			{
+				if (m_contactFilter->ShouldCollide(shapeA, shapeB) == false)
+				{
+					// The user has stopped the contact.
+					Destroy(c);
+					continue;
+				}
+			}
+
+			// At least one body must be dynamic or kinematic.
+			bool activeA = bodyA->IsAwake() && bodyA->m_type != e_staticBody;
+			bool activeB = bodyB->IsAwake() && bodyB->m_type != e_staticBody;
+			if (activeA == false && activeB == false) 
+			{
+				++index;
+				continue;
+			}
+
+			// Destroy the contact if the shape AABBs are not overlapping.
+			bool overlap = m_broadPhase.TestOverlap(proxyA, proxyB);
+			if (overlap == false)
+			{
+				Destroy(c);
+				continue;
+			}
+
+			// The contact persists.
+			contacts[contactCount++] = c;
+
+			++index;
 		}
+	}
 
-		// Destroy the contact if the shape AABBs are not overlapping.
-		bool overlap = m_broadPhase.TestOverlap(proxyA, proxyB);
-		if (overlap == false)
+	{
+		B3_PROFILE("Collide");
+
+		b3UpdateContactsContext context;
+		context.allocators = allocators;
+		context.contacts = contacts;
+		context.threadStats = m_threadStats;
+
+		// Each contact only writes to its own index in the stores.
+		scheduler->ParallelFor(contactCount, 16, UpdateContactRange, &context);
+	}
+
+	// Report the new contact states in store order.
+	for (u32 i = 0; i < contactCount; ++i)
+	{
+		b3Contact* c = contacts[i];
+
+#if B3_ENABLE_STATS
+		m_stats->manifoldCount += c->GetManifoldCount();
+		for (u32 j = 0; j < c->GetManifoldCount(); ++j)
 		{
-			b3Contact* quack = c;
-			c = c->m_next;
-			Destroy(quack);
-			continue;
+			m_stats->manifoldPointCount += c->GetManifold(j)->pointCount;
 		}
+#endif
 
-		// The contact persists.
-		c->Update(m_contactListener);
-
-		c = c->m_next;
+		ReportContact(c);
 	}
+
+	B3_STAT(m_stats->updatedContactCount += contactCount);
+
+	allocator->Free(contacts);
 }
 
 b3Contact* b3ContactManager::Create(b3Shape* shapeA, b3Shape* shapeB) 
@@ -268,9 +359,227 @@ b3Contact* b3ContactManager::Create(b3Shape* shapeA, b3Shape* shapeB)
 	// The shapes might be swapped.
 	c->m_pair.shapeA = shapeA;
 	c->m_pair.shapeB = shapeB;
+
+	// Add the contact state to the store of the contact type.
+	b3ContactStore* store = c->m_type == e_convexContact ? &m_convexStore : &m_meshStore;
+	c->m_store = store;
+	c->m_storeIndex = store->Add(c);
+
+	m_pairSet.Add(shapeA->m_broadPhaseID, shapeB->m_broadPhaseID);
+
+	B3_STAT(++m_stats->contactsCreated);
+
 	return c;
 }
 
+void b3ContactManager::ReportContact(b3Contact* c)
+{
+	c->Report(m_contactListener, m_contactEvents);
+
+	// Only touching or speculative contacts connect islands.
+	bool link = c->IsOverlapping() || c->IsSpeculative();
+	bool linked = c->m_island != NULL;
+	if (link && linked == false)
+	{
+		m_islandMan->AddContact(c);
+	}
+	
+	if (link == false && linked)
+	{
+		m_islandMan->RemoveContact(c);
+	}
+}
+
+b3SensorPair* b3ContactManager::CreateSensor(b3Shape* shapeA, b3Shape* shapeB)
+{
+	b3ShapeType typeA = shapeA->GetType();
+	b3ShapeType typeB = shapeB->GetType();
+
+	// The mesh is always the shape B.
+	if (typeA > typeB) 
+	{
+		b3Swap(typeA, typeB);
+		b3Swap(shapeA, shapeB);
+	}
+
+	if (typeA == e_meshShape)
+	{
+		// Overlaps between meshes are not implemented.
+		return NULL;
+	}
+
+	void* block = m_sensorBlocks.Allocate();
+	b3SensorPair* pair = (b3SensorPair*)block;
+	pair->shapeA = shapeA;
+	pair->shapeB = shapeB;
+	pair->flags = 0;
+	pair->cache.simplexCache.count = 0;
+	pair->cache.featureCache.m_featurePair.state = b3SATCacheType::e_empty;
+	pair->dirtyIndex = B3_MAX_U32;
+
+	// Initialize edge A
+	pair->edgeA.pair = pair;
+	pair->edgeA.other = shapeB;
+
+	// Add edge A to shape A's sensor list.
+	shapeA->m_sensorEdges.PushFront(&pair->edgeA);
+
+	// Initialize edge B
+	pair->edgeB.pair = pair;
+	pair->edgeB.other = shapeA;
+
+	// Add edge B to shape B's sensor list.
+	shapeB->m_sensorEdges.PushFront(&pair->edgeB);
+
+	// Add the pair to the world sensor pair list.
+	m_sensorList.PushFront(pair);
+
+	m_pairSet.Add(shapeA->m_broadPhaseID, shapeB->m_broadPhaseID);
+
+	// Test the new pair in the next update.
+	pair->dirtyIndex = m_dirtySensors.Count();
+	m_dirtySensors.PushBack(pair);
+
+	return pair;
+}
+
+void b3ContactManager::DestroySensor(b3SensorPair* pair)
+{
+	// Report the overlap has ended.
+	if (pair->flags & b3SensorPair::e_overlapFlag)
+	{
+		b3SensorEndEvent event;
+		event.sensorShape = pair->GetSensorShape();
+		event.visitorShape = pair->GetVisitorShape();
+		m_sensorEvents.endEvents.PushBack(event);
+	}
+
+	// Remove the pair from the dirty sensor pair array.
+	if (pair->dirtyIndex != B3_MAX_U32)
+	{
+		b3SensorPair* last = m_dirtySensors.Back();
+		m_dirtySensors[pair->dirtyIndex] = last;
+		last->dirtyIndex = pair->dirtyIndex;
+		m_dirtySensors.PopBack();
+	}
+
+	b3Shape* shapeA = pair->shapeA;
+	b3Shape* shapeB = pair->shapeB;
+
+	shapeA->m_sensorEdges.Remove(&pair->edgeA);
+	shapeB->m_sensorEdges.Remove(&pair->edgeB);
+
+	m_pairSet.Remove(shapeA->m_broadPhaseID, shapeB->m_broadPhaseID);
+
+	// Remove the pair from the world sensor pair list.
+	m_sensorList.Remove(pair);
+
+	m_sensorBlocks.Free(pair);
+}
+
+void b3ContactManager::TouchSensors(b3Shape* shape)
+{
+	for (b3SensorEdge* se = shape->m_sensorEdges.m_head; se; se = se->m_next)
+	{
+		b3SensorPair* pair = se->pair;
+		if (pair->dirtyIndex == B3_MAX_U32)
+		{
+			pair->dirtyIndex = m_dirtySensors.Count();
+			m_dirtySensors.PushBack(pair);
+		}
+	}
+}
+
+void b3ContactManager::UpdateSensors()
+{
+	B3_PROFILE("Update Sensors");
+
+	// The pairs are tested in the order they were marked. 
+	// Unmark them first so that destroying a pair doesn't reorder the array.
+	u32 dirtyCount = m_dirtySensors.Count();
+	for (u32 i = 0; i < dirtyCount; ++i)
+	{
+		m_dirtySensors[i]->dirtyIndex = B3_MAX_U32;
+	}
+
+	B3_STAT(m_stats->updatedSensorPairCount += dirtyCount);
+
+	for (u32 i = 0; i < dirtyCount; ++i)
+	{
+		b3SensorPair* pair = m_dirtySensors[i];
+
+		b3Shape* shapeA = pair->shapeA;
+		b3Body* bodyA = shapeA->m_body;
+
+		b3Shape* shapeB = pair->shapeB;
+		b3Body* bodyB = shapeB->m_body;
+
+		// Check if the bodies must not collide with each other.
+		if (bodyA->ShouldCollide(bodyB) == false)
+		{
+			DestroySensor(pair);
+			continue;
+		}
+
+		// Check for external filtering.
+		if (m_contactFilter)
+		{
+			if (m_contactFilter->ShouldCollide(shapeA, shapeB) == false)
+			{
+				DestroySensor(pair);
+				continue;
+			}
+		}
+
+		// Destroy the pair if the shape AABBs are not overlapping.
+		bool overlap = m_broadPhase.TestOverlap(shapeA->m_broadPhaseID, shapeB->m_broadPhaseID);
+		if (overlap == false)
+		{
+			DestroySensor(pair);
+			continue;
+		}
+
+		bool wasOverlapping = (pair->flags & b3SensorPair::e_overlapFlag) != 0;
+		bool isOverlapping = pair->TestOverlap();
+
+		if (wasOverlapping == false && isOverlapping == true)
+		{
+			pair->flags |= b3SensorPair::e_overlapFlag;
+
+			b3SensorBeginEvent event;
+			event.sensorShape = pair->GetSensorShape();
+			event.visitorShape = pair->GetVisitorShape();
+			m_sensorEvents.beginEvents.PushBack(event);
+		}
+
+		if (wasOverlapping == true && isOverlapping == false)
+		{
+			pair->flags &= ~b3SensorPair::e_overlapFlag;
+
+			b3SensorEndEvent event;
+			event.sensorShape = pair->GetSensorShape();
+			event.visitorShape = pair->GetVisitorShape();
+			m_sensorEvents.endEvents.PushBack(event);
+		}
+	}
+
+	m_dirtySensors.Resize(0);
+}
+
+void b3ContactManager::ActivateContact(b3Contact* c)
+{
+	B3_ASSERT(c->IsActive() == false);
+	c->m_store->Activate(c->m_storeIndex);
+}
+
+void b3ContactManager::DeactivateContact(b3Contact* c)
+{
+	B3_ASSERT(c->IsActive());
+	
+	// Move the last active contact into the free index.
+	c->m_store->Deactivate(c->m_storeIndex);
+}
+
 void b3ContactManager::Destroy(b3Contact* c) 
 {
 	// Report to the contact listener the contact will be destroyed.
@@ -281,7 +590,32 @@ void b3ContactManager::Destroy(b3Contact* c)
 			m_contactListener->EndContact(c);
 		}
 	}
+
+	// The contact won't exist when the event is consumed.
+	if (m_contactEvents)
+	{
+		if (c->IsOverlapping())
+		{
+			b3ContactEndEvent event;
+			event.shapeA = c->GetShapeA();
+			event.shapeB = c->GetShapeB();
+			m_contactEvents->endEvents.PushBack(event);
+		}
+	}
 	
+	B3_STAT(++m_stats->contactsDestroyed);
+
+	// Remove the contact from its island.
+	m_islandMan->RemoveContact(c);
+
+	// Remove the contact from its store.
+	if (c->IsActive())
+	{
+		DeactivateContact(c);
+	}
+
+	c->m_store->Remove(c->m_storeIndex);
+
 	b3OverlappingPair* pair = &c->m_pair;
 	
 	b3Shape* shapeA = c->GetShapeA();
@@ -290,6 +624,8 @@ void b3ContactManager::Destroy(b3Contact* c)
 	shapeA->m_contactEdges.Remove(&pair->edgeA);
 	shapeB->m_contactEdges.Remove(&pair->edgeB);
 
+	m_pairSet.Remove(shapeA->m_broadPhaseID, shapeB->m_broadPhaseID);
+
 	// Remove the contact from the world contact list.
 	m_contactList.Remove(c);
 
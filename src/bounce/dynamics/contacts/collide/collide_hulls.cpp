@@ -22,6 +22,7 @@
 #include <bounce/dynamics/contacts/contact_cluster.h>
 #include <bounce/dynamics/shapes/hull_shape.h>
 #include <bounce/collision/shapes/hull.h>
+#include <bounce/common/stats.h>
 
 void b3BuildEdgeContact(b3Manifold& manifold,
 	const b3Transform& xf1, u32 index1, const b3HullShape* s1,
@@ -289,7 +290,6 @@ void b3CollideHulls(b3Manifold& manifold,
 }
 
 bool b3_convexCache = true;
-u32 b3_convexCalls = 0, b3_convexCacheHits = 0;
 
 void b3CollideHulls(b3Manifold& manifold,
 	const b3Transform& xf1, const b3HullShape* s1,
@@ -301,7 +301,12 @@ void b3CollideHullAndHull(b3Manifold& manifold,
 	const b3Transform& xf2, const b3HullShape* s2,
 	b3ConvexCache* cache)
 {
-	++b3_convexCalls;
+#if B3_ENABLE_STATS
+	if (b3_threadStats)
+	{
+		++b3_threadStats->satCalls;
+	}
+#endif
 
 	if (b3_convexCache)
 	{
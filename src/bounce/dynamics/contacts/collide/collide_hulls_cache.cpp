@@ -22,6 +22,7 @@
 #include <bounce/dynamics/shapes/hull_shape.h>
 #include <bounce/dynamics/body.h>
 #include <bounce/collision/shapes/hull.h>
+#include <bounce/common/stats.h>
 
 void b3BuildEdgeContact(b3Manifold& manifold,
 	const b3Transform& xf1, u32 index1, const b3HullShape* s1,
@@ -274,8 +275,6 @@ void b3CollideCache(b3Manifold& manifold,
 	cache->m_featurePair = b3MakeFeaturePair(b3SATCacheType::e_overlap, b3SATFeatureType::e_edge1, edgeQuery.index1, edgeQuery.index2);
 }
 
-extern u32 b3_convexCacheHits;
-
 void b3CollideHulls(b3Manifold& manifold,
 	const b3Transform& xf1, const b3HullShape* s1,
 	const b3Transform& xf2, const b3HullShape* s2,
@@ -297,7 +296,12 @@ void b3CollideHulls(b3Manifold& manifold,
 		state1 == b3SATCacheType::e_separation)
 	{
 		// Separation cache hit.
-		++b3_convexCacheHits;
+#if B3_ENABLE_STATS
+		if (b3_threadStats)
+		{
+			++b3_threadStats->satCacheHits;
+		}
+#endif
 		return;
 	}
 
@@ -331,7 +335,12 @@ void b3CollideHulls(b3Manifold& manifold,
 		if (manifold.pointCount > 0)
 		{
 			// Overlap cache hit.
-			++b3_convexCacheHits;
+#if B3_ENABLE_STATS
+			if (b3_threadStats)
+			{
+				++b3_threadStats->satCacheHits;
+			}
+#endif
 			return;
 		}
 	}
@@ -17,15 +17,19 @@
 */
 
 #include <bounce/dynamics/contacts/contact.h>
+#include <bounce/dynamics/contacts/contact_events.h>
+#include <bounce/dynamics/contacts/convex_contact.h>
+#include <bounce/dynamics/contacts/mesh_contact.h>
 #include <bounce/dynamics/shapes/shape.h>
 #include <bounce/dynamics/body.h>
 #include <bounce/dynamics/world.h>
 #include <bounce/dynamics/world_listeners.h>
+#include <bounce/dynamics/contacts/collide/collide.h>
 
 void b3Contact::GetWorldManifold(b3WorldManifold* out, u32 index) const
 {
-	B3_ASSERT(index < m_manifoldCount);
-	b3Manifold* m = m_manifolds + index;
+	B3_ASSERT(index < ManifoldCount());
+	const b3Manifold* m = Manifolds() + index;
 	
 	const b3Shape* shapeA = GetShapeA();
 	const b3Body* bodyA = shapeA->GetBody();
@@ -38,85 +42,276 @@ void b3Contact::GetWorldManifold(b3WorldManifold* out, u32 index) const
 	out->Initialize(m, shapeA->m_radius, xfA, shapeB->m_radius, xfB);
 }
 
-void b3Contact::Update(b3ContactListener* listener)
+bool b3Contact::TestOverlap()
+{
+	switch (m_type)
+	{
+	case e_convexContact:
+		return ((b3ConvexContact*)this)->TestOverlap();
+	case e_meshContact:
+		return ((b3MeshContact*)this)->TestOverlap();
+	default:
+		B3_ASSERT(false);
+		return false;
+	}
+}
+
+void b3Contact::Collide(b3StackAllocator* allocator)
+{
+	switch (m_type)
+	{
+	case e_convexContact:
+		((b3ConvexContact*)this)->Collide(allocator);
+		break;
+	case e_meshContact:
+		((b3MeshContact*)this)->Collide(allocator);
+		break;
+	default:
+		B3_ASSERT(false);
+		break;
+	}
+}
+
+float32 b3Contact::ComputeTOI(const b3Sweep& sweepA, const b3Sweep& sweepB)
+{
+	switch (m_type)
+	{
+	case e_convexContact:
+		return ((b3ConvexContact*)this)->ComputeTOI(sweepA, sweepB);
+	case e_meshContact:
+		return ((b3MeshContact*)this)->ComputeTOI(sweepA, sweepB);
+	default:
+		B3_ASSERT(false);
+		return 1.0f;
+	}
+}
+
+void b3Contact::CollideSpeculative(float32 dt)
+{
+	switch (m_type)
+	{
+	case e_convexContact:
+		((b3ConvexContact*)this)->CollideSpeculative(dt);
+		break;
+	case e_meshContact:
+		((b3MeshContact*)this)->CollideSpeculative(dt);
+		break;
+	default:
+		B3_ASSERT(false);
+		break;
+	}
+}
+
+void b3Contact::Update(b3StackAllocator* allocator)
 {
 	b3Shape* shapeA = GetShapeA();
 	b3Body* bodyA = shapeA->GetBody();
-	b3Transform xfA = bodyA->GetTransform();
-
-	b3Shape* shapeB = GetShapeB();
-	b3Body* bodyB = shapeB->GetBody();
-	b3Transform xfB = bodyB->GetTransform();
 
 	b3World* world = bodyA->GetWorld();
 
+	// The contact state is read and written in the contact store.
+	u32& flags = Flags();
+	b3Manifold* manifolds = Manifolds();
+	u32& manifoldCount = ManifoldCount();
+
 	bool wasOverlapping = IsOverlapping();
 	bool isOverlapping = false;
-	bool isSensorContact = shapeA->IsSensor() || shapeB->IsSensor();
+	bool isSpeculative = false;
 
-	if (isSensorContact == true)
+	// Copy the old contact points.
+	b3Manifold oldManifolds[B3_MAX_MANIFOLDS];
+	u32 oldManifoldCount = manifoldCount;
+	memcpy(oldManifolds, manifolds, oldManifoldCount * sizeof(b3Manifold));
+
+	// Clear all contact points.
+	manifoldCount = 0;
+	for (u32 i = 0; i < m_store->m_manifoldCapacity; ++i)
 	{
-		isOverlapping = TestOverlap();
-		m_manifoldCount = 0;
+		manifolds[i].Initialize();
 	}
-	else
-	{
-		// Copy the old contact points.
-		b3Manifold oldManifolds[B3_MAX_MANIFOLDS];
-		u32 oldManifoldCount = m_manifoldCount;
-		memcpy(oldManifolds, m_manifolds, oldManifoldCount * sizeof(b3Manifold));
 
-		// Clear all contact points.
-		m_manifoldCount = 0;
-		for (u32 i = 0; i < m_manifoldCapacity; ++i)
-		{
-			m_manifolds[i].Initialize();
-		}
+	// Generate new contact points for the solver.
+	Collide(allocator);
 
-		// Generate new contact points for the solver.
-		Collide();
-
-		// Initialize the new built contact points for warm starting the solver.
-		if (world->m_warmStarting == true)
+	// Initialize the new built contact points for warm starting the solver.
+	if (world->m_warmStarting == true)
+	{
+		for (u32 i = 0; i < manifoldCount; ++i)
 		{
-			for (u32 i = 0; i < m_manifoldCount; ++i)
+			b3Manifold* m2 = manifolds + i;
+			for (u32 j = 0; j < oldManifoldCount; ++j)
 			{
-				b3Manifold* m2 = m_manifolds + i;
-				for (u32 j = 0; j < oldManifoldCount; ++j)
-				{
-					const b3Manifold* m1 = oldManifolds + j;
-					m2->Initialize(*m1);
-				}
+				const b3Manifold* m1 = oldManifolds + j;
+				m2->Initialize(*m1);
 			}
 		}
+	}
 
-		// The shapes are overlapping if at least one contact 
-		// point was built.
-		for (u32 i = 0; i < m_manifoldCount; ++i)
+	// The shapes are overlapping if at least one contact 
+	// point was built.
+	for (u32 i = 0; i < manifoldCount; ++i)
+	{
+		if (manifolds[i].pointCount > 0)
 		{
-			if (m_manifolds[i].pointCount > 0)
-			{
-				isOverlapping = true;
-				break;
-			}
+			isOverlapping = true;
+			break;
 		}
 	}
 
-	// Wake the bodies associated with the shapes if the contact has began.
-	if (isOverlapping != wasOverlapping)
+	if (isOverlapping == false && world->m_speculativeContacts == true)
 	{
-		bodyA->SetAwake(true);
-		bodyB->SetAwake(true);
+		// The shapes are separated but might begin touching in this step.
+		manifoldCount = 0;
+		CollideSpeculative(world->m_dt);
+		isSpeculative = manifoldCount > 0;
 	}
 
 	// Update the contact state.
+	if (wasOverlapping == true)
+	{
+		flags |= e_wasOverlapFlag;
+	}
+	else
+	{
+		flags &= ~e_wasOverlapFlag;
+	}
+
 	if (isOverlapping == true)
 	{
-		m_flags |= e_overlapFlag;
+		flags |= e_overlapFlag;
+	}
+	else
+	{
+		flags &= ~e_overlapFlag;
+	}
+
+	if (isSpeculative == true)
+	{
+		flags |= e_speculativeFlag;
 	}
 	else
 	{
-		m_flags &= ~e_overlapFlag;;
+		flags &= ~e_speculativeFlag;
+	}
+}
+
+void b3Contact::CollideTOI()
+{
+	B3_ASSERT(IsOverlapping() == false);
+
+	b3GJKOutput output;
+	float32 separation = ComputeClosestPoints(&output, m_toi.index);
+
+	// The time of impact leaves the core shapes separated by about a linear slop.
+	if (separation > 4.0f * B3_LINEAR_SLOP)
+	{
+		return;
+	}
+
+	BuildClosestPointManifold(output, m_toi.index);
+
+	Flags() |= e_overlapFlag;
+	Flags() &= ~e_speculativeFlag;
+}
+
+float32 b3Contact::ComputeClosestPoints(b3GJKOutput* output, u32 index) const
+{
+	const b3Shape* shapeA = GetShapeA();
+	b3Transform xfA = shapeA->GetBody()->GetTransform();
+
+	const b3Shape* shapeB = GetShapeB();
+	b3Transform xfB = shapeB->GetBody()->GetTransform();
+
+	b3ShapeGJKProxy proxyA(shapeA, 0);
+	b3ShapeGJKProxy proxyB(shapeB, index);
+
+	b3SimplexCache cache;
+	cache.count = 0;
+
+	*output = b3GJK(xfA, proxyA, xfB, proxyB, false, &cache);
+
+	if (output->distance < B3_EPSILON)
+	{
+		// The closest points don't define a normal.
+		return B3_MAX_FLOAT;
+	}
+
+	return output->distance - proxyA.radius - proxyB.radius;
+}
+
+float32 b3Contact::GetSpeculativeSeparation(const b3GJKOutput& output, float32 dt) const
+{
+	const b3Body* bodyA = GetShapeA()->GetBody();
+	const b3Body* bodyB = GetShapeB()->GetBody();
+
+	b3Vec3 normal = (output.point2 - output.point1) / output.distance;
+
+	// Compute the velocities of the closest points.
+	b3Vec3 vA = bodyA->LinearVelocity() + b3Cross(bodyA->AngularVelocity(), output.point1 - bodyA->Sweep().worldCenter);
+	b3Vec3 vB = bodyB->LinearVelocity() + b3Cross(bodyB->AngularVelocity(), output.point2 - bodyB->Sweep().worldCenter);
+
+	float32 approachSpeed = b3Dot(vA - vB, normal);
+
+	return B3_SPECULATIVE_DISTANCE + dt * b3Max(approachSpeed, 0.0f);
+}
+
+void b3Contact::BuildClosestPointManifold(const b3GJKOutput& output, u32 index)
+{
+	b3Transform xfA = GetShapeA()->GetBody()->GetTransform();
+	b3Transform xfB = GetShapeB()->GetBody()->GetTransform();
+
+	b3Vec3 normal = (output.point2 - output.point1) / output.distance;
+
+	ManifoldCount() = 1;
+
+	b3Manifold* m = Manifolds();
+	m->Initialize();
+	m->pointCount = 1;
+	m->points[0].localNormal1 = b3MulT(xfA.rotation, normal);
+	m->points[0].localPoint1 = b3MulT(xfA, output.point1);
+	m->points[0].localPoint2 = b3MulT(xfB, output.point2);
+	m->points[0].key.triangleKey = m_type == e_meshContact ? index : B3_NULL_TRIANGLE;
+	m->points[0].key.key1 = 0;
+	m->points[0].key.key2 = 0;
+}
+
+void b3Contact::Report(b3ContactListener* listener, b3ContactEvents* events)
+{
+	b3Shape* shapeA = GetShapeA();
+	b3Body* bodyA = shapeA->GetBody();
+
+	b3Shape* shapeB = GetShapeB();
+	b3Body* bodyB = shapeB->GetBody();
+
+	bool wasOverlapping = (Flags() & e_wasOverlapFlag) != 0;
+	bool isOverlapping = IsOverlapping();
+
+	// Wake the bodies associated with the shapes if the contact has began.
+	if (isOverlapping != wasOverlapping)
+	{
+		bodyA->SetAwake(true);
+		bodyB->SetAwake(true);
+	}
+
+	// Record the new contact state.
+	if (events != NULL)
+	{
+		if (wasOverlapping == false && isOverlapping == true)
+		{
+			b3ContactBeginEvent event;
+			event.contact = this;
+			event.shapeA = shapeA;
+			event.shapeB = shapeB;
+			events->beginEvents.PushBack(event);
+		}
+
+		if (wasOverlapping == true && isOverlapping == false)
+		{
+			b3ContactEndEvent event;
+			event.shapeA = shapeA;
+			event.shapeB = shapeB;
+			events->endEvents.PushBack(event);
+		}
 	}
 
 	// Notify the contact listener the new contact state.
@@ -132,9 +327,33 @@ void b3Contact::Update(b3ContactListener* listener)
 			listener->EndContact(this);
 		}
 
-		if (isSensorContact == false && isOverlapping == true)
+		if (isOverlapping == true)
 		{
 			listener->PreSolve(this);
 		}
 	}
 }
+
+void b3Contact::RecordPostSolve(b3ContactEvents* events)
+{
+	const b3Manifold* manifolds = Manifolds();
+	for (u32 i = 0; i < ManifoldCount(); ++i)
+	{
+		const b3Manifold* m = manifolds + i;
+
+		b3ContactPostSolveEvent event;
+		event.contact = this;
+		event.shapeA = GetShapeA();
+		event.shapeB = GetShapeB();
+		event.manifoldIndex = i;
+		event.pointCount = m->pointCount;
+		for (u32 j = 0; j < m->pointCount; ++j)
+		{
+			event.normalImpulses[j] = m->points[j].normalImpulse;
+		}
+		event.tangentImpulse = m->tangentImpulse;
+		event.motorImpulse = m->motorImpulse;
+		
+		events->postSolveEvents.PushBack(event);
+	}
+}
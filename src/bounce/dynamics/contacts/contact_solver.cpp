@@ -22,9 +22,14 @@
 #include <bounce/dynamics/body.h>
 #include <bounce/common/memory/stack_allocator.h>
 #include <bounce/common/math/mat.h>
+#include <bounce/common/thread/task_scheduler.h>
+#include <bounce/dynamics/graph_coloring.h>
+#include <stdint.h>
 
 // This solver implements PGS for solving velocity constraints and 
 // NGS for solving position constraints.
+// When substepping the contacts are soft and the overlap is 
+// resolved in the velocity constraints (TGS soft). 
 
 b3ContactSolver::b3ContactSolver(const b3ContactSolverDef* def)
 {
@@ -38,10 +43,44 @@ b3ContactSolver::b3ContactSolver(const b3ContactSolverDef* def)
 	m_velocityConstraints = (b3ContactVelocityConstraint*)m_allocator->Allocate(m_count * sizeof(b3ContactVelocityConstraint));
 	m_dt = def->dt;
 	m_invDt = m_dt != 0.0f ? 1.0f / m_dt : 0.0f;
+	m_scheduler = def->scheduler;
+	m_coloring = NULL;
+	m_colorBodies = NULL;
+	m_subStepping = def->subStepping;
+	m_wide = def->wide && m_subStepping == false && m_count >= B3_SIMD_WIDTH;
+	m_wideColors = NULL;
+	m_wideContacts = NULL;
+	m_wideBlock = NULL;
+	m_wideConstraints = NULL;
+	m_wideConstraintCount = 0;
+
+	// Compute the soft contact coefficients for the substep.
+	float32 hertz = b3Min(B3_CONTACT_HERTZ, 0.25f * m_invDt);
+	float32 omega = 2.0f * B3_PI * hertz;
+	float32 a1 = 2.0f * B3_CONTACT_DAMPING_RATIO + m_dt * omega;
+	float32 a2 = m_dt * omega * a1;
+	float32 a3 = 1.0f / (1.0f + a2);
+	m_biasRate = omega / a1;
+	m_massScale = a2 * a3;
+	m_impulseScale = a3;
 }
 
 b3ContactSolver::~b3ContactSolver()
 {
+	if (m_wideColors)
+	{
+		m_allocator->Free(m_wideBlock);
+		m_allocator->Free(m_wideContacts);
+		m_allocator->Free(m_wideColors);
+	}
+
+	if (m_coloring)
+	{
+		m_coloring->~b3GraphColoring();
+		m_allocator->Free(m_coloring);
+		m_allocator->Free(m_colorBodies);
+	}
+
 	// Reverse free.
 	for (u32 index1 = m_count; index1 > 0; --index1)
 	{
@@ -79,32 +118,32 @@ void b3ContactSolver::InitializeConstraints()
 		b3Body* bodyA = shapeA->GetBody();
 		b3Body* bodyB = shapeB->GetBody();
 
-		u32 manifoldCount = c->m_manifoldCount;
-		b3Manifold* manifolds = c->m_manifolds;
+		u32 manifoldCount = c->ManifoldCount();
+		b3Manifold* manifolds = c->Manifolds();
 
 		b3ContactPositionConstraint* pc = m_positionConstraints + i;
 		b3ContactVelocityConstraint* vc = m_velocityConstraints + i;
 
-		pc->indexA = bodyA->m_islandID;
+		pc->indexA = c->m_indexA;
 		pc->invMassA = bodyA->m_invMass;
 		pc->localInvIA = bodyA->m_invI;
-		pc->localCenterA = bodyA->m_sweep.localCenter;
+		pc->localCenterA = bodyA->Sweep().localCenter;
 		pc->radiusA = shapeA->m_radius;
 
-		pc->indexB = bodyB->m_islandID;
+		pc->indexB = c->m_indexB;
 		pc->invMassB = bodyB->m_invMass;
 		pc->localInvIB = bodyB->m_invI;
-		pc->localCenterB = bodyB->m_sweep.localCenter;
+		pc->localCenterB = bodyB->Sweep().localCenter;
 		pc->radiusB = shapeB->m_radius;
 
 		pc->manifoldCount = manifoldCount;
 		pc->manifolds = (b3PositionConstraintManifold*)m_allocator->Allocate(manifoldCount * sizeof(b3PositionConstraintManifold));
 
-		vc->indexA = bodyA->m_islandID;
+		vc->indexA = c->m_indexA;
 		vc->invMassA = bodyA->m_invMass;
 		vc->invIA = m_inertias[vc->indexA];
 
-		vc->indexB = bodyB->m_islandID;
+		vc->indexB = c->m_indexB;
 		vc->invMassB = bodyB->m_invMass;
 		vc->invIB = m_inertias[vc->indexB];
 
@@ -147,7 +186,7 @@ void b3ContactSolver::InitializeConstraints()
 	for (u32 i = 0; i < m_count; ++i)
 	{
 		b3Contact* c = m_contacts[i];
-		u32 manifoldCount = c->m_manifoldCount;
+		u32 manifoldCount = c->ManifoldCount();
 
 		b3ContactPositionConstraint* pc = m_positionConstraints + i;
 		b3ContactVelocityConstraint* vc = m_velocityConstraints + i;
@@ -186,7 +225,7 @@ void b3ContactSolver::InitializeConstraints()
 
 		for (u32 j = 0; j < manifoldCount; ++j)
 		{
-			b3Manifold* m = c->m_manifolds + j;
+			b3Manifold* m = c->Manifolds() + j;
 			b3VelocityConstraintManifold* vcm = vc->manifolds + j;
 
 			b3WorldManifold wm;
@@ -227,10 +266,22 @@ void b3ContactSolver::InitializeConstraints()
 					b3Vec3 dv = vB + b3Cross(wB, rB) - vA - b3Cross(wA, rA);
 					float32 vn = b3Dot(normal, dv);
 					vcp->velocityBias = 0.0f;
-					if (vn < -B3_VELOCITY_THRESHOLD)
+					if (c->IsSpeculative())
+					{
+						// Only remove the approaching velocity that would close the gap in the step.
+						vcp->velocityBias = -b3Max(mp->separation, 0.0f) * m_invDt;
+					}
+					else if (vn < -B3_VELOCITY_THRESHOLD)
 					{
 						vcp->velocityBias = -vc->restitution * vn;
 					}
+
+					// The substeps track the separation using the anchors. 
+					// Both anchors start at the contact point.
+					vcp->localAnchorA = b3MulT(qA, rA);
+					vcp->localAnchorB = b3MulT(qB, rB);
+					vcp->baseSeparation = mp->separation;
+					vcp->relativeVelocity = vn;
 				}
 			}
 
@@ -275,187 +326,502 @@ void b3ContactSolver::InitializeConstraints()
 			}
 		}
 	}
+
+	if (m_scheduler || m_wide)
+	{
+		BuildColoring();
+	}
+
+	if (m_wide)
+	{
+		BuildWideConstraints();
+	}
 }
 
-void b3ContactSolver::WarmStart()
+void b3ContactSolver::BuildColoring()
 {
+	B3_PROFILE("Color Contacts");
+
+	// Bodies with zero mass are ignored because they are never written.
+	// This way a ground body doesn't serialize all contacts.
+	m_colorBodies = (u32*)m_allocator->Allocate(2 * m_count * sizeof(u32));
+	u32 bodyCount = 0;
 	for (u32 i = 0; i < m_count; ++i)
 	{
 		b3ContactVelocityConstraint* vc = m_velocityConstraints + i;
 
-		u32 indexA = vc->indexA;
-		float32 mA = vc->invMassA;
-		b3Mat33 iA = vc->invIA;
+		m_colorBodies[2 * i + 0] = vc->invMassA > 0.0f ? vc->indexA : B3_NULL_COLOR_BODY;
+		m_colorBodies[2 * i + 1] = vc->invMassB > 0.0f ? vc->indexB : B3_NULL_COLOR_BODY;
 
-		u32 indexB = vc->indexB;
-		float32 mB = vc->invMassB;
-		b3Mat33 iB = vc->invIB;
+		bodyCount = b3Max(bodyCount, b3Max(vc->indexA, vc->indexB) + 1);
+	}
 
-		u32 manifoldCount = vc->manifoldCount;
+	void* block = m_allocator->Allocate(sizeof(b3GraphColoring));
+	m_coloring = new (block) b3GraphColoring(m_allocator, m_colorBodies, m_count, bodyCount);
+}
 
-		b3Vec3 vA = m_velocities[indexA].v;
-		b3Vec3 wA = m_velocities[indexA].w;
-		b3Vec3 vB = m_velocities[indexB].v;
-		b3Vec3 wB = m_velocities[indexB].w;
+void b3ContactSolver::BuildWideConstraints()
+{
+	B3_PROFILE("Pack Wide Contacts");
 
-		for (u32 j = 0; j < manifoldCount; ++j)
-		{
-			b3VelocityConstraintManifold* vcm = vc->manifolds + j;
-			u32 pointCount = vcm->pointCount;
+	B3_ASSERT(m_coloring);
 
-			for (u32 k = 0; k < pointCount; ++k)
-			{
-				b3VelocityConstraintPoint* vcp = vcm->points + k;
+	u32 colorCount = m_coloring->GetColorCount();
 
-				b3Vec3 P = vcp->normalImpulse * vcp->normal;
-				
-				vA -= mA * P;
-				wA -= iA * b3Cross(vcp->rA, P);
+	m_wideColors = (b3WideColor*)m_allocator->Allocate(colorCount * sizeof(b3WideColor));
+	m_wideContacts = (u32*)m_allocator->Allocate(m_count * sizeof(u32));
 
-				vB += mB * P;
-				wB += iB * b3Cross(vcp->rB, P);
+	// Only contacts with a single manifold are packed. 
+	// Each color packs full batches and leaves the remaining contacts to the scalar solver.
+	u32 batchCount = 0;
+	u32 contactCount = 0;
+	for (u32 i = 0; i < colorCount; ++i)
+	{
+		const u32* constraints = m_coloring->GetColorConstraints(i);
+		u32 constraintCount = m_coloring->GetColorConstraintCount(i);
+
+		u32 packCount = 0;
+		for (u32 j = 0; j < constraintCount; ++j)
+		{
+			if (m_velocityConstraints[constraints[j]].manifoldCount == 1)
+			{
+				++packCount;
 			}
+		}
+
+		b3WideColor* color = m_wideColors + i;
+		color->batchStart = batchCount;
+		color->batchCount = packCount / B3_SIMD_WIDTH;
+		color->contactStart = contactCount;
+		color->contactCount = constraintCount - color->batchCount * B3_SIMD_WIDTH;
+
+		batchCount += color->batchCount;
+		contactCount += color->contactCount;
+	}
+
+	// The stack allocator doesn't align memory to the size of a SIMD register.
+	const u32 alignment = sizeof(b3FloatW);
+	m_wideBlock = m_allocator->Allocate(batchCount * sizeof(b3WideContactVelocityConstraint) + alignment);
+	uintptr_t address = ((uintptr_t)m_wideBlock + alignment - 1) & ~((uintptr_t)alignment - 1);
+	m_wideConstraints = (b3WideContactVelocityConstraint*)address;
+	m_wideConstraintCount = batchCount;
+
+	memset(m_wideConstraints, 0, batchCount * sizeof(b3WideContactVelocityConstraint));
+
+	for (u32 i = 0; i < colorCount; ++i)
+	{
+		const u32* constraints = m_coloring->GetColorConstraints(i);
+		u32 constraintCount = m_coloring->GetColorConstraintCount(i);
+
+		b3WideColor* color = m_wideColors + i;
+		u32 packCount = color->batchCount * B3_SIMD_WIDTH;
+		u32 packIndex = 0;
+		u32 contactIndex = 0;
+
+		for (u32 j = 0; j < constraintCount; ++j)
+		{
+			u32 index = constraints[j];
+			b3ContactVelocityConstraint* vc = m_velocityConstraints + index;
 
-			if (pointCount > 0)
+			if (vc->manifoldCount != 1 || packIndex == packCount)
 			{
-				b3Vec3 P1 = vcm->tangentImpulse.x * vcm->tangent1;
-				b3Vec3 P2 = vcm->tangentImpulse.y * vcm->tangent2;
-				b3Vec3 P3 = vcm->motorImpulse * vcm->normal;
-				
-				vA -= mA * (P1 + P2);
-				wA -= iA * (b3Cross(vcm->rA, P1 + P2) + P3);
+				m_wideContacts[color->contactStart + contactIndex] = index;
+				++contactIndex;
+				continue;
+			}
 
-				vB += mB * (P1 + P2);
-				wB += iB * (b3Cross(vcm->rB, P1 + P2) + P3);
+			b3WideContactVelocityConstraint* wc = m_wideConstraints + color->batchStart + packIndex / B3_SIMD_WIDTH;
+			u32 lane = packIndex % B3_SIMD_WIDTH;
+			++packIndex;
+
+			b3VelocityConstraintManifold* vcm = vc->manifolds;
+
+			wc->contacts[lane] = index;
+			wc->indexA[lane] = vc->indexA;
+			wc->indexB[lane] = vc->indexB;
+			wc->pointCount = b3Max(wc->pointCount, vcm->pointCount);
+
+			b3SetLaneW(wc->invMassA, lane, vc->invMassA);
+			b3SetLaneW(wc->invIA, lane, vc->invIA);
+			b3SetLaneW(wc->invMassB, lane, vc->invMassB);
+			b3SetLaneW(wc->invIB, lane, vc->invIB);
+			b3SetLaneW(wc->friction, lane, vc->friction);
+
+			b3SetLaneW(wc->rA, lane, vcm->rA);
+			b3SetLaneW(wc->rB, lane, vcm->rB);
+			b3SetLaneW(wc->normal, lane, vcm->normal);
+			b3SetLaneW(wc->tangent1, lane, vcm->tangent1);
+			b3SetLaneW(wc->tangent2, lane, vcm->tangent2);
+
+			b3SetLaneW(wc->tangentMassXX, lane, vcm->tangentMass.x.x);
+			b3SetLaneW(wc->tangentMassXY, lane, vcm->tangentMass.x.y);
+			b3SetLaneW(wc->tangentMassYX, lane, vcm->tangentMass.y.x);
+			b3SetLaneW(wc->tangentMassYY, lane, vcm->tangentMass.y.y);
+			b3SetLaneW(wc->tangentImpulseX, lane, vcm->tangentImpulse.x);
+			b3SetLaneW(wc->tangentImpulseY, lane, vcm->tangentImpulse.y);
+			b3SetLaneW(wc->motorImpulse, lane, vcm->motorImpulse);
+			b3SetLaneW(wc->motorMass, lane, vcm->motorMass);
+
+			for (u32 k = 0; k < vcm->pointCount; ++k)
+			{
+				b3VelocityConstraintPoint* vcp = vcm->points + k;
+				b3WideVelocityConstraintPoint* wcp = wc->points + k;
+
+				b3SetLaneW(wcp->rA, lane, vcp->rA);
+				b3SetLaneW(wcp->rB, lane, vcp->rB);
+				b3SetLaneW(wcp->normal, lane, vcp->normal);
+				b3SetLaneW(wcp->normalMass, lane, vcp->normalMass);
+				b3SetLaneW(wcp->normalImpulse, lane, vcp->normalImpulse);
+				b3SetLaneW(wcp->velocityBias, lane, vcp->velocityBias);
 			}
 		}
 
+		B3_ASSERT(packIndex == packCount);
+		B3_ASSERT(contactIndex == color->contactCount);
+	}
+}
+
+void b3ContactSolver::WarmStart(u32 i)
+{
+	b3ContactVelocityConstraint* vc = m_velocityConstraints + i;
+
+	u32 indexA = vc->indexA;
+	float32 mA = vc->invMassA;
+	b3Mat33 iA = vc->invIA;
+
+	u32 indexB = vc->indexB;
+	float32 mB = vc->invMassB;
+	b3Mat33 iB = vc->invIB;
+
+	u32 manifoldCount = vc->manifoldCount;
+
+	b3Vec3 vA = m_velocities[indexA].v;
+	b3Vec3 wA = m_velocities[indexA].w;
+	b3Vec3 vB = m_velocities[indexB].v;
+	b3Vec3 wB = m_velocities[indexB].w;
+
+	for (u32 j = 0; j < manifoldCount; ++j)
+	{
+		b3VelocityConstraintManifold* vcm = vc->manifolds + j;
+		u32 pointCount = vcm->pointCount;
+
+		for (u32 k = 0; k < pointCount; ++k)
+		{
+			b3VelocityConstraintPoint* vcp = vcm->points + k;
+
+			b3Vec3 P = vcp->normalImpulse * vcp->normal;
+			
+			vA -= mA * P;
+			wA -= iA * b3Cross(vcp->rA, P);
+
+			vB += mB * P;
+			wB += iB * b3Cross(vcp->rB, P);
+		}
+
+		if (pointCount > 0)
+		{
+			b3Vec3 P1 = vcm->tangentImpulse.x * vcm->tangent1;
+			b3Vec3 P2 = vcm->tangentImpulse.y * vcm->tangent2;
+			b3Vec3 P3 = vcm->motorImpulse * vcm->normal;
+			
+			vA -= mA * (P1 + P2);
+			wA -= iA * (b3Cross(vcm->rA, P1 + P2) + P3);
+
+			vB += mB * (P1 + P2);
+			wB += iB * (b3Cross(vcm->rB, P1 + P2) + P3);
+		}
+	}
+
+	// Bodies with zero mass are never written. 
+	// This allows the graph coloring to ignore them.
+	if (mA > 0.0f)
+	{
 		m_velocities[indexA].v = vA;
 		m_velocities[indexA].w = wA;
+	}
+
+	if (mB > 0.0f)
+	{
 		m_velocities[indexB].v = vB;
 		m_velocities[indexB].w = wB;
 	}
 }
 
-void b3ContactSolver::SolveVelocityConstraints()
+void b3ContactSolver::SolveVelocityConstraint(u32 i)
 {
-	for (u32 i = 0; i < m_count; ++i)
-	{
-		b3ContactVelocityConstraint* vc = m_velocityConstraints + i;
-		u32 manifoldCount = vc->manifoldCount;
+	b3ContactVelocityConstraint* vc = m_velocityConstraints + i;
+	u32 manifoldCount = vc->manifoldCount;
 
-		u32 indexA = vc->indexA;
-		float32 mA = vc->invMassA;
-		b3Mat33 iA = vc->invIA;
+	u32 indexA = vc->indexA;
+	float32 mA = vc->invMassA;
+	b3Mat33 iA = vc->invIA;
 
-		u32 indexB = vc->indexB;
-		float32 mB = vc->invMassB;
-		b3Mat33 iB = vc->invIB;
+	u32 indexB = vc->indexB;
+	float32 mB = vc->invMassB;
+	b3Mat33 iB = vc->invIB;
 
-		b3Vec3 vA = m_velocities[indexA].v;
-		b3Vec3 wA = m_velocities[indexA].w;
-		b3Vec3 vB = m_velocities[indexB].v;
-		b3Vec3 wB = m_velocities[indexB].w;
+	b3Vec3 vA = m_velocities[indexA].v;
+	b3Vec3 wA = m_velocities[indexA].w;
+	b3Vec3 vB = m_velocities[indexB].v;
+	b3Vec3 wB = m_velocities[indexB].w;
 
-		for (u32 j = 0; j < manifoldCount; ++j)
+	for (u32 j = 0; j < manifoldCount; ++j)
+	{
+		b3VelocityConstraintManifold* vcm = vc->manifolds + j;
+		u32 pointCount = vcm->pointCount;
+
+		float32 normalImpulse = 0.0f;
+		for (u32 k = 0; k < pointCount; ++k)
 		{
-			b3VelocityConstraintManifold* vcm = vc->manifolds + j;
-			u32 pointCount = vcm->pointCount;
+			b3VelocityConstraintPoint* vcp = vcm->points + k;
+			B3_ASSERT(vcp->normalImpulse >= 0.0f);
 
-			float32 normalImpulse = 0.0f;
-			for (u32 k = 0; k < pointCount; ++k)
+			// Solve normal constraints.
 			{
-				b3VelocityConstraintPoint* vcp = vcm->points + k;
-				B3_ASSERT(vcp->normalImpulse >= 0.0f);
+				b3Vec3 dv = vB + b3Cross(wB, vcp->rB) - vA - b3Cross(wA, vcp->rA);
+				float32 Cdot = b3Dot(vcp->normal, dv);
 
-				// Solve normal constraints.
-				{
-					b3Vec3 dv = vB + b3Cross(wB, vcp->rB) - vA - b3Cross(wA, vcp->rA);
-					float32 Cdot = b3Dot(vcp->normal, dv);
-
-					float32 impulse = -vcp->normalMass * (Cdot - vcp->velocityBias);
+				float32 impulse = -vcp->normalMass * (Cdot - vcp->velocityBias);
 
-					float32 oldImpulse = vcp->normalImpulse;
-					vcp->normalImpulse = b3Max(vcp->normalImpulse + impulse, 0.0f);
-					impulse = vcp->normalImpulse - oldImpulse;
+				float32 oldImpulse = vcp->normalImpulse;
+				vcp->normalImpulse = b3Max(vcp->normalImpulse + impulse, 0.0f);
+				impulse = vcp->normalImpulse - oldImpulse;
 
-					b3Vec3 P = impulse * vcp->normal;
+				b3Vec3 P = impulse * vcp->normal;
 
-					vA -= mA * P;
-					wA -= iA * b3Cross(vcp->rA, P);
+				vA -= mA * P;
+				wA -= iA * b3Cross(vcp->rA, P);
 
-					vB += mB * P;
-					wB += iB * b3Cross(vcp->rB, P);
+				vB += mB * P;
+				wB += iB * b3Cross(vcp->rB, P);
 
-					normalImpulse += vcp->normalImpulse;
-				}
+				normalImpulse += vcp->normalImpulse;
 			}
-			
-			if (pointCount > 0)
+		}
+		
+		if (pointCount > 0)
+		{
+			// Solve tangent constraints.
 			{
-				// Solve tangent constraints.
-				{
-					b3Vec3 dv = vB + b3Cross(wB, vcm->rB) - vA - b3Cross(wA, vcm->rA);
-					
-					b3Vec2 Cdot;
-					Cdot.x = b3Dot(dv, vcm->tangent1);
-					Cdot.y = b3Dot(dv, vcm->tangent2);
+				b3Vec3 dv = vB + b3Cross(wB, vcm->rB) - vA - b3Cross(wA, vcm->rA);
+				
+				b3Vec2 Cdot;
+				Cdot.x = b3Dot(dv, vcm->tangent1);
+				Cdot.y = b3Dot(dv, vcm->tangent2);
 
-					b3Vec2 impulse = vcm->tangentMass * -Cdot;
-					b3Vec2 oldImpulse = vcm->tangentImpulse;
-					vcm->tangentImpulse += impulse;
-					
-					float32 maxImpulse = vc->friction * normalImpulse;
-					if (b3Dot(vcm->tangentImpulse, vcm->tangentImpulse) > maxImpulse * maxImpulse)
-					{
-						vcm->tangentImpulse.Normalize();
-						vcm->tangentImpulse *= maxImpulse;
-					}
-					
-					impulse = vcm->tangentImpulse - oldImpulse;
+				b3Vec2 impulse = vcm->tangentMass * -Cdot;
+				b3Vec2 oldImpulse = vcm->tangentImpulse;
+				vcm->tangentImpulse += impulse;
+				
+				float32 maxImpulse = vc->friction * normalImpulse;
+				if (b3Dot(vcm->tangentImpulse, vcm->tangentImpulse) > maxImpulse * maxImpulse)
+				{
+					vcm->tangentImpulse.Normalize();
+					vcm->tangentImpulse *= maxImpulse;
+				}
+				
+				impulse = vcm->tangentImpulse - oldImpulse;
 
-					b3Vec3 P1 = impulse.x * vcm->tangent1;
-					b3Vec3 P2 = impulse.y * vcm->tangent2;
-					b3Vec3 P = P1 + P2;
+				b3Vec3 P1 = impulse.x * vcm->tangent1;
+				b3Vec3 P2 = impulse.y * vcm->tangent2;
+				b3Vec3 P = P1 + P2;
 
-					vA -= mA * P;
-					wA -= iA * b3Cross(vcm->rA, P);
+				vA -= mA * P;
+				wA -= iA * b3Cross(vcm->rA, P);
 
-					vB += mB * P;
-					wB += iB * b3Cross(vcm->rB, P);
-				}
+				vB += mB * P;
+				wB += iB * b3Cross(vcm->rB, P);
+			}
 
-				// Solve motor constraint.
-				{
-					float32 Cdot = b3Dot(vcm->normal, wB - wA);
-					float32 impulse = -vcm->motorMass * Cdot;
-					float32 oldImpulse = vcm->motorImpulse;
-					float32 maxImpulse = vc->friction * normalImpulse;
-					vcm->motorImpulse = b3Clamp(vcm->motorImpulse + impulse, -maxImpulse, maxImpulse);
-					impulse = vcm->motorImpulse - oldImpulse;
+			// Solve motor constraint.
+			{
+				float32 Cdot = b3Dot(vcm->normal, wB - wA);
+				float32 impulse = -vcm->motorMass * Cdot;
+				float32 oldImpulse = vcm->motorImpulse;
+				float32 maxImpulse = vc->friction * normalImpulse;
+				vcm->motorImpulse = b3Clamp(vcm->motorImpulse + impulse, -maxImpulse, maxImpulse);
+				impulse = vcm->motorImpulse - oldImpulse;
 
-					b3Vec3 P = impulse * vcm->normal;
+				b3Vec3 P = impulse * vcm->normal;
 
-					wA -= iA * P;
-					wB += iB * P;
-				}
+				wA -= iA * P;
+				wB += iB * P;
 			}
 		}
+	}
 
+	// Bodies with zero mass are never written. 
+	// This allows the graph coloring to ignore them.
+	if (mA > 0.0f)
+	{
 		m_velocities[indexA].v = vA;
 		m_velocities[indexA].w = wA;
+	}
+
+	if (mB > 0.0f)
+	{
 		m_velocities[indexB].v = vB;
 		m_velocities[indexB].w = wB;
 	}
 }
 
+// This is the same as SolveVelocityConstraint but solves B3_SIMD_WIDTH contacts at once.
+void b3ContactSolver::SolveWideVelocityConstraint(u32 index)
+{
+	b3WideContactVelocityConstraint* wc = m_wideConstraints + index;
+
+	b3FloatW mA = wc->invMassA;
+	b3Mat33W iA = wc->invIA;
+
+	b3FloatW mB = wc->invMassB;
+	b3Mat33W iB = wc->invIB;
+
+	b3Vec3W vA, wA, vB, wB;
+	for (u32 i = 0; i < B3_SIMD_WIDTH; ++i)
+	{
+		b3SetLaneW(vA, i, m_velocities[wc->indexA[i]].v);
+		b3SetLaneW(wA, i, m_velocities[wc->indexA[i]].w);
+		b3SetLaneW(vB, i, m_velocities[wc->indexB[i]].v);
+		b3SetLaneW(wB, i, m_velocities[wc->indexB[i]].w);
+	}
+
+	b3FloatW normalImpulse = b3ZeroW();
+	for (u32 k = 0; k < wc->pointCount; ++k)
+	{
+		b3WideVelocityConstraintPoint* vcp = wc->points + k;
+
+		// Solve normal constraints.
+		{
+			b3Vec3W dv = vB + b3Cross(wB, vcp->rB) - vA - b3Cross(wA, vcp->rA);
+			b3FloatW Cdot = b3Dot(vcp->normal, dv);
+
+			b3FloatW impulse = -vcp->normalMass * (Cdot - vcp->velocityBias);
+
+			b3FloatW oldImpulse = vcp->normalImpulse;
+			vcp->normalImpulse = b3MaxW(vcp->normalImpulse + impulse, b3ZeroW());
+			impulse = vcp->normalImpulse - oldImpulse;
+
+			b3Vec3W P = impulse * vcp->normal;
+
+			vA -= mA * P;
+			wA -= iA * b3Cross(vcp->rA, P);
+
+			vB += mB * P;
+			wB += iB * b3Cross(vcp->rB, P);
+
+			normalImpulse = normalImpulse + vcp->normalImpulse;
+		}
+	}
+
+	// Solve tangent constraints.
+	{
+		b3Vec3W dv = vB + b3Cross(wB, wc->rB) - vA - b3Cross(wA, wc->rA);
+
+		b3FloatW CdotX = b3Dot(dv, wc->tangent1);
+		b3FloatW CdotY = b3Dot(dv, wc->tangent2);
+
+		b3FloatW impulseX = -CdotX * wc->tangentMassXX + -CdotY * wc->tangentMassYX;
+		b3FloatW impulseY = -CdotX * wc->tangentMassXY + -CdotY * wc->tangentMassYY;
+
+		b3FloatW oldImpulseX = wc->tangentImpulseX;
+		b3FloatW oldImpulseY = wc->tangentImpulseY;
+		b3FloatW tangentImpulseX = oldImpulseX + impulseX;
+		b3FloatW tangentImpulseY = oldImpulseY + impulseY;
+
+		// Clamp the lanes whose impulse is outside the friction cone.
+		b3FloatW maxImpulse = wc->friction * normalImpulse;
+		b3FloatW lengthSq = tangentImpulseX * tangentImpulseX + tangentImpulseY * tangentImpulseY;
+		b3FloatW clampMask = b3GreaterW(lengthSq, maxImpulse * maxImpulse);
+
+		b3FloatW length = b3SqrtW(lengthSq);
+		b3FloatW normalizeMask = b3GreaterW(length, b3SplatW(B3_EPSILON));
+		b3FloatW clampedX = b3SelectW(normalizeMask, tangentImpulseX / length, tangentImpulseX) * maxImpulse;
+		b3FloatW clampedY = b3SelectW(normalizeMask, tangentImpulseY / length, tangentImpulseY) * maxImpulse;
+
+		wc->tangentImpulseX = b3SelectW(clampMask, clampedX, tangentImpulseX);
+		wc->tangentImpulseY = b3SelectW(clampMask, clampedY, tangentImpulseY);
+
+		impulseX = wc->tangentImpulseX - oldImpulseX;
+		impulseY = wc->tangentImpulseY - oldImpulseY;
+
+		b3Vec3W P1 = impulseX * wc->tangent1;
+		b3Vec3W P2 = impulseY * wc->tangent2;
+		b3Vec3W P = P1 + P2;
+
+		vA -= mA * P;
+		wA -= iA * b3Cross(wc->rA, P);
+
+		vB += mB * P;
+		wB += iB * b3Cross(wc->rB, P);
+	}
+
+	// Solve motor constraint.
+	{
+		b3FloatW Cdot = b3Dot(wc->normal, wB - wA);
+		b3FloatW impulse = -wc->motorMass * Cdot;
+		b3FloatW oldImpulse = wc->motorImpulse;
+		b3FloatW maxImpulse = wc->friction * normalImpulse;
+		wc->motorImpulse = b3ClampW(wc->motorImpulse + impulse, -maxImpulse, maxImpulse);
+		impulse = wc->motorImpulse - oldImpulse;
+
+		b3Vec3W P = impulse * wc->normal;
+
+		wA -= iA * P;
+		wB += iB * P;
+	}
+
+	// Bodies with zero mass are never written. 
+	for (u32 i = 0; i < B3_SIMD_WIDTH; ++i)
+	{
+		if (b3GetLaneW(mA, i) > 0.0f)
+		{
+			m_velocities[wc->indexA[i]].v = b3GetLaneW(vA, i);
+			m_velocities[wc->indexA[i]].w = b3GetLaneW(wA, i);
+		}
+
+		if (b3GetLaneW(mB, i) > 0.0f)
+		{
+			m_velocities[wc->indexB[i]].v = b3GetLaneW(vB, i);
+			m_velocities[wc->indexB[i]].w = b3GetLaneW(wB, i);
+		}
+	}
+}
+
+void b3ContactSolver::UnpackWideImpulses()
+{
+	for (u32 i = 0; i < m_wideConstraintCount; ++i)
+	{
+		b3WideContactVelocityConstraint* wc = m_wideConstraints + i;
+
+		for (u32 lane = 0; lane < B3_SIMD_WIDTH; ++lane)
+		{
+			b3ContactVelocityConstraint* vc = m_velocityConstraints + wc->contacts[lane];
+			b3VelocityConstraintManifold* vcm = vc->manifolds;
+
+			vcm->tangentImpulse.x = b3GetLaneW(wc->tangentImpulseX, lane);
+			vcm->tangentImpulse.y = b3GetLaneW(wc->tangentImpulseY, lane);
+			vcm->motorImpulse = b3GetLaneW(wc->motorImpulse, lane);
+
+			for (u32 k = 0; k < vcm->pointCount; ++k)
+			{
+				vcm->points[k].normalImpulse = b3GetLaneW(wc->points[k].normalImpulse, lane);
+			}
+		}
+	}
+}
+
 void b3ContactSolver::StoreImpulses()
 {
+	if (m_wide)
+	{
+		UnpackWideImpulses();
+	}
+
 	for (u32 i = 0; i < m_count; ++i)
 	{
 		b3Contact* c = m_contacts[i];
-		b3Manifold* manifolds = c->m_manifolds;
-		u32 manifoldCount = c->m_manifoldCount;
+		b3Manifold* manifolds = c->Manifolds();
+		u32 manifoldCount = c->ManifoldCount();
 
 		b3ContactVelocityConstraint* vc = m_velocityConstraints + i;
 
@@ -478,6 +844,216 @@ void b3ContactSolver::StoreImpulses()
 	}
 }
 
+void b3ContactSolver::SolveSubStepConstraint(u32 i, bool useBias)
+{
+	b3ContactVelocityConstraint* vc = m_velocityConstraints + i;
+	u32 manifoldCount = vc->manifoldCount;
+
+	u32 indexA = vc->indexA;
+	float32 mA = vc->invMassA;
+	b3Mat33 iA = vc->invIA;
+
+	u32 indexB = vc->indexB;
+	float32 mB = vc->invMassB;
+	b3Mat33 iB = vc->invIB;
+
+	b3Vec3 vA = m_velocities[indexA].v;
+	b3Vec3 wA = m_velocities[indexA].w;
+	b3Vec3 vB = m_velocities[indexB].v;
+	b3Vec3 wB = m_velocities[indexB].w;
+
+	b3Vec3 cA = m_positions[indexA].x;
+	b3Mat33 RA = b3QuatMat33(m_positions[indexA].q);
+	b3Vec3 cB = m_positions[indexB].x;
+	b3Mat33 RB = b3QuatMat33(m_positions[indexB].q);
+
+	for (u32 j = 0; j < manifoldCount; ++j)
+	{
+		b3VelocityConstraintManifold* vcm = vc->manifolds + j;
+		u32 pointCount = vcm->pointCount;
+
+		float32 normalImpulse = 0.0f;
+		for (u32 k = 0; k < pointCount; ++k)
+		{
+			b3VelocityConstraintPoint* vcp = vcm->points + k;
+			B3_ASSERT(vcp->normalImpulse >= 0.0f);
+
+			// Compute the current separation from the anchors. 
+			// The normal and the lever arms are kept fixed during the step.
+			b3Vec3 pA = cA + RA * vcp->localAnchorA;
+			b3Vec3 pB = cB + RB * vcp->localAnchorB;
+			float32 separation = b3Dot(pB - pA, vcp->normal) + vcp->baseSeparation;
+
+			float32 bias = 0.0f;
+			float32 massScale = 1.0f;
+			float32 impulseScale = 0.0f;
+			if (separation > 0.0f)
+			{
+				// Allow the shapes to approach.
+				bias = separation * m_invDt;
+			}
+			else if (useBias)
+			{
+				// Push the shapes apart softly and allow some slop.
+				float32 C = b3Min(separation + B3_LINEAR_SLOP, 0.0f);
+				bias = b3Max(m_biasRate * C, -B3_MAX_CONTACT_PUSH_SPEED);
+				massScale = m_massScale;
+				impulseScale = m_impulseScale;
+			}
+
+			b3Vec3 dv = vB + b3Cross(wB, vcp->rB) - vA - b3Cross(wA, vcp->rA);
+			float32 Cdot = b3Dot(vcp->normal, dv);
+
+			float32 impulse = -vcp->normalMass * massScale * (Cdot + bias) - impulseScale * vcp->normalImpulse;
+
+			float32 oldImpulse = vcp->normalImpulse;
+			vcp->normalImpulse = b3Max(vcp->normalImpulse + impulse, 0.0f);
+			impulse = vcp->normalImpulse - oldImpulse;
+
+			b3Vec3 P = impulse * vcp->normal;
+
+			vA -= mA * P;
+			wA -= iA * b3Cross(vcp->rA, P);
+
+			vB += mB * P;
+			wB += iB * b3Cross(vcp->rB, P);
+
+			normalImpulse += vcp->normalImpulse;
+		}
+
+		if (pointCount > 0)
+		{
+			// Solve tangent constraints.
+			{
+				b3Vec3 dv = vB + b3Cross(wB, vcm->rB) - vA - b3Cross(wA, vcm->rA);
+
+				b3Vec2 Cdot;
+				Cdot.x = b3Dot(dv, vcm->tangent1);
+				Cdot.y = b3Dot(dv, vcm->tangent2);
+
+				b3Vec2 impulse = vcm->tangentMass * -Cdot;
+				b3Vec2 oldImpulse = vcm->tangentImpulse;
+				vcm->tangentImpulse += impulse;
+
+				float32 maxImpulse = vc->friction * normalImpulse;
+				if (b3Dot(vcm->tangentImpulse, vcm->tangentImpulse) > maxImpulse * maxImpulse)
+				{
+					vcm->tangentImpulse.Normalize();
+					vcm->tangentImpulse *= maxImpulse;
+				}
+
+				impulse = vcm->tangentImpulse - oldImpulse;
+
+				b3Vec3 P1 = impulse.x * vcm->tangent1;
+				b3Vec3 P2 = impulse.y * vcm->tangent2;
+				b3Vec3 P = P1 + P2;
+
+				vA -= mA * P;
+				wA -= iA * b3Cross(vcm->rA, P);
+
+				vB += mB * P;
+				wB += iB * b3Cross(vcm->rB, P);
+			}
+
+			// Solve motor constraint.
+			{
+				float32 Cdot = b3Dot(vcm->normal, wB - wA);
+				float32 impulse = -vcm->motorMass * Cdot;
+				float32 oldImpulse = vcm->motorImpulse;
+				float32 maxImpulse = vc->friction * normalImpulse;
+				vcm->motorImpulse = b3Clamp(vcm->motorImpulse + impulse, -maxImpulse, maxImpulse);
+				impulse = vcm->motorImpulse - oldImpulse;
+
+				b3Vec3 P = impulse * vcm->normal;
+
+				wA -= iA * P;
+				wB += iB * P;
+			}
+		}
+	}
+
+	if (mA > 0.0f)
+	{
+		m_velocities[indexA].v = vA;
+		m_velocities[indexA].w = wA;
+	}
+
+	if (mB > 0.0f)
+	{
+		m_velocities[indexB].v = vB;
+		m_velocities[indexB].w = wB;
+	}
+}
+
+void b3ContactSolver::ApplyRestitution(u32 i)
+{
+	b3ContactVelocityConstraint* vc = m_velocityConstraints + i;
+	if (vc->restitution == 0.0f)
+	{
+		return;
+	}
+
+	u32 manifoldCount = vc->manifoldCount;
+
+	u32 indexA = vc->indexA;
+	float32 mA = vc->invMassA;
+	b3Mat33 iA = vc->invIA;
+
+	u32 indexB = vc->indexB;
+	float32 mB = vc->invMassB;
+	b3Mat33 iB = vc->invIB;
+
+	b3Vec3 vA = m_velocities[indexA].v;
+	b3Vec3 wA = m_velocities[indexA].w;
+	b3Vec3 vB = m_velocities[indexB].v;
+	b3Vec3 wB = m_velocities[indexB].w;
+
+	for (u32 j = 0; j < manifoldCount; ++j)
+	{
+		b3VelocityConstraintManifold* vcm = vc->manifolds + j;
+		
+		for (u32 k = 0; k < vcm->pointCount; ++k)
+		{
+			b3VelocityConstraintPoint* vcp = vcm->points + k;
+			
+			// Only bounce the points that were approaching fast and are touching.
+			if (vcp->relativeVelocity > -B3_VELOCITY_THRESHOLD || vcp->normalImpulse == 0.0f)
+			{
+				continue;
+			}
+
+			b3Vec3 dv = vB + b3Cross(wB, vcp->rB) - vA - b3Cross(wA, vcp->rA);
+			float32 Cdot = b3Dot(vcp->normal, dv);
+
+			float32 impulse = -vcp->normalMass * (Cdot + vc->restitution * vcp->relativeVelocity);
+
+			float32 oldImpulse = vcp->normalImpulse;
+			vcp->normalImpulse = b3Max(vcp->normalImpulse + impulse, 0.0f);
+			impulse = vcp->normalImpulse - oldImpulse;
+
+			b3Vec3 P = impulse * vcp->normal;
+
+			vA -= mA * P;
+			wA -= iA * b3Cross(vcp->rA, P);
+
+			vB += mB * P;
+			wB += iB * b3Cross(vcp->rB, P);
+		}
+	}
+
+	if (mA > 0.0f)
+	{
+		m_velocities[indexA].v = vA;
+		m_velocities[indexA].w = wA;
+	}
+
+	if (mB > 0.0f)
+	{
+		m_velocities[indexB].v = vB;
+		m_velocities[indexB].w = wB;
+	}
+}
+
 struct b3ContactPositionSolverPoint
 {
 	void Initialize(const b3ContactPositionConstraint* pc, const b3PositionConstraintPoint* pcp, const b3Transform& xfA, const b3Transform& xfB)
@@ -494,95 +1070,334 @@ struct b3ContactPositionSolverPoint
 	float32 separation;
 };
 
-bool b3ContactSolver::SolvePositionConstraints()
+float32 b3ContactSolver::SolvePositionConstraint(u32 i, float32 baumgarte, bool toi)
 {
 	float32 minSeparation = 0.0f;
 
-	for (u32 i = 0; i < m_count; ++i)
-	{
-		b3ContactPositionConstraint* pc = m_positionConstraints + i;
+	b3ContactPositionConstraint* pc = m_positionConstraints + i;
 
-		u32 indexA = pc->indexA;
-		float32 mA = pc->invMassA;
-		b3Vec3 localCenterA = pc->localCenterA;
+	u32 indexA = pc->indexA;
+	float32 mA = pc->invMassA;
+	b3Vec3 localCenterA = pc->localCenterA;
 
-		u32 indexB = pc->indexB;
-		float32 mB = pc->invMassB;
-		b3Vec3 localCenterB = pc->localCenterB;
+	u32 indexB = pc->indexB;
+	float32 mB = pc->invMassB;
+	b3Vec3 localCenterB = pc->localCenterB;
 
-		b3Vec3 cA = m_positions[indexA].x;
-		b3Quat qA = m_positions[indexA].q;
-		b3Mat33 iA = m_inertias[indexA];
+	b3Vec3 cA = m_positions[indexA].x;
+	b3Quat qA = m_positions[indexA].q;
+	b3Mat33 iA = m_inertias[indexA];
 
-		b3Vec3 cB = m_positions[indexB].x;
-		b3Quat qB = m_positions[indexB].q;
-		b3Mat33 iB = m_inertias[indexB];
+	b3Vec3 cB = m_positions[indexB].x;
+	b3Quat qB = m_positions[indexB].q;
+	b3Mat33 iB = m_inertias[indexB];
 
-		u32 manifoldCount = pc->manifoldCount;
+	// The target separation of the contact points.
+	float32 target = -B3_LINEAR_SLOP;
+	if (toi)
+	{
+		// Keep the core shapes of a time of impact separated by a slop.
+		target = b3Max(target, 2.0f * B3_LINEAR_SLOP - pc->radiusA - pc->radiusB);
+	}
 
-		for (u32 j = 0; j < manifoldCount; ++j)
-		{
-			b3PositionConstraintManifold* pcm = pc->manifolds + j;
-			u32 pointCount = pcm->pointCount;
+	u32 manifoldCount = pc->manifoldCount;
 
-			// Solve normal constraints
-			for (u32 k = 0; k < pointCount; ++k)
-			{
-				b3PositionConstraintPoint* pcp = pcm->points + k;
+	for (u32 j = 0; j < manifoldCount; ++j)
+	{
+		b3PositionConstraintManifold* pcm = pc->manifolds + j;
+		u32 pointCount = pcm->pointCount;
 
-				b3Transform xfA;
-				xfA.rotation = b3QuatMat33(qA);
-				xfA.position = cA - b3Mul(xfA.rotation, localCenterA);
+		// Solve normal constraints
+		for (u32 k = 0; k < pointCount; ++k)
+		{
+			b3PositionConstraintPoint* pcp = pcm->points + k;
 
-				b3Transform xfB;
-				xfB.rotation = b3QuatMat33(qB);
-				xfB.position = cB - b3Mul(xfB.rotation, localCenterB);
+			b3Transform xfA;
+			xfA.rotation = b3QuatMat33(qA);
+			xfA.position = cA - b3Mul(xfA.rotation, localCenterA);
 
-				b3ContactPositionSolverPoint cpcp;
-				cpcp.Initialize(pc, pcp, xfA, xfB);
+			b3Transform xfB;
+			xfB.rotation = b3QuatMat33(qB);
+			xfB.position = cB - b3Mul(xfB.rotation, localCenterB);
 
-				b3Vec3 normal = cpcp.normal;
-				b3Vec3 point = cpcp.point;
-				float32 separation = cpcp.separation;
+			b3ContactPositionSolverPoint cpcp;
+			cpcp.Initialize(pc, pcp, xfA, xfB);
 
-				// Update max constraint error.
-				minSeparation = b3Min(minSeparation, separation);
+			b3Vec3 normal = cpcp.normal;
+			b3Vec3 point = cpcp.point;
+			float32 separation = cpcp.separation;
 
-				// Allow some slop and prevent large corrections.
-				float32 C = b3Clamp(B3_BAUMGARTE * (separation + B3_LINEAR_SLOP), -B3_MAX_LINEAR_CORRECTION, 0.0f);
+			// Update max constraint error relative to the target separation.
+			minSeparation = b3Min(minSeparation, separation - target - B3_LINEAR_SLOP);
 
-				// Compute effective mass.
-				b3Vec3 rA = point - cA;
-				b3Vec3 rB = point - cB;
-				
-				b3Vec3 rnA = b3Cross(rA, normal);
-				b3Vec3 rnB = b3Cross(rB, normal);
-				float32 K = mA + mB + b3Dot(rnA, iA * rnA) + b3Dot(rnB, iB * rnB);
-
-				// Compute normal impulse.
-				float32 impulse = K > 0.0f ? -C / K : 0.0f;
-				b3Vec3 P = impulse * normal;
-
-				cA -= mA * P;
-				qA -= b3Derivative(qA, iA * b3Cross(rA, P));
-				qA.Normalize();
-				iA = b3RotateToFrame(pc->localInvIA, qA);
-
-				cB += mB * P;
-				qB += b3Derivative(qB, iB * b3Cross(rB, P));
-				qB.Normalize();
-				iB = b3RotateToFrame(pc->localInvIB, qB);
-			}
+			// Allow some slop and prevent large corrections.
+			float32 C = b3Clamp(baumgarte * (separation - target), -B3_MAX_LINEAR_CORRECTION, 0.0f);
+
+			// Compute effective mass.
+			b3Vec3 rA = point - cA;
+			b3Vec3 rB = point - cB;
+			
+			b3Vec3 rnA = b3Cross(rA, normal);
+			b3Vec3 rnB = b3Cross(rB, normal);
+			float32 K = mA + mB + b3Dot(rnA, iA * rnA) + b3Dot(rnB, iB * rnB);
+
+			// Compute normal impulse.
+			float32 impulse = K > 0.0f ? -C / K : 0.0f;
+			b3Vec3 P = impulse * normal;
+
+			cA -= mA * P;
+			qA -= b3Derivative(qA, iA * b3Cross(rA, P));
+			qA.Normalize();
+			iA = b3RotateToFrame(pc->localInvIA, qA);
+
+			cB += mB * P;
+			qB += b3Derivative(qB, iB * b3Cross(rB, P));
+			qB.Normalize();
+			iB = b3RotateToFrame(pc->localInvIB, qB);
 		}
+	}
 
+	if (mA > 0.0f)
+	{
 		m_positions[indexA].x = cA;
 		m_positions[indexA].q = qA;
 		m_inertias[indexA] = iA;
+	}
 
+	if (mB > 0.0f)
+	{
 		m_positions[indexB].x = cB;
 		m_positions[indexB].q = qB;
 		m_inertias[indexB] = iB;
 	}
 
+	return minSeparation;
+}
+
+struct b3ContactColorContext
+{
+	b3ContactSolver* solver;
+	const u32* constraints;
+	const b3WideColor* wideColor;
+	u32 task;
+	float32 minSeparations[B3_MAX_THREADS];
+};
+
+void b3ContactSolver::SolveColorRange(void* data, u32 begin, u32 end, u32 threadIndex)
+{
+	b3ContactColorContext* context = (b3ContactColorContext*)data;
+	b3ContactSolver* solver = context->solver;
+
+	for (u32 i = begin; i < end; ++i)
+	{
+		u32 index = context->constraints[i];
+
+		switch (context->task)
+		{
+		case e_warmStartTask:
+		{
+			solver->WarmStart(index);
+			break;
+		}
+		case e_solveVelocityTask:
+		{
+			solver->SolveVelocityConstraint(index);
+			break;
+		}
+		case e_solvePositionTask:
+		{
+			float32 separation = solver->SolvePositionConstraint(index, B3_BAUMGARTE, false);
+			context->minSeparations[threadIndex] = b3Min(context->minSeparations[threadIndex], separation);
+			break;
+		}
+		case e_solveSubStepTask:
+		{
+			solver->SolveSubStepConstraint(index, true);
+			break;
+		}
+		case e_relaxSubStepTask:
+		{
+			solver->SolveSubStepConstraint(index, false);
+			break;
+		}
+		case e_restitutionTask:
+		{
+			solver->ApplyRestitution(index);
+			break;
+		}
+		default:
+		{
+			B3_ASSERT(false);
+			break;
+		}
+		}
+	}
+}
+
+void b3ContactSolver::SolveWideColorRange(void* data, u32 begin, u32 end, u32 threadIndex)
+{
+	B3_NOT_USED(threadIndex);
+
+	b3ContactColorContext* context = (b3ContactColorContext*)data;
+	b3ContactSolver* solver = context->solver;
+	const b3WideColor* color = context->wideColor;
+
+	// The batches are followed by the remaining contacts.
+	for (u32 i = begin; i < end; ++i)
+	{
+		if (i < color->batchCount)
+		{
+			solver->SolveWideVelocityConstraint(color->batchStart + i);
+		}
+		else
+		{
+			u32 index = solver->m_wideContacts[color->contactStart + i - color->batchCount];
+			solver->SolveVelocityConstraint(index);
+		}
+	}
+}
+
+float32 b3ContactSolver::SolveColors(u32 task)
+{
+	B3_ASSERT(m_coloring);
+
+	b3ContactColorContext context;
+	context.solver = this;
+	context.task = task;
+	for (u32 i = 0; i < B3_MAX_THREADS; ++i)
+	{
+		context.minSeparations[i] = 0.0f;
+	}
+
+	u32 threadIndex = m_scheduler ? m_scheduler->GetThreadIndex() : 0;
+
+	// Solve the colors in order. 
+	// The contacts of a color don't share a body with non-zero mass.
+	for (u32 i = 0; i < m_coloring->GetColorCount(); ++i)
+	{
+		u32 count = m_coloring->GetColorConstraintCount(i);
+		u32 grainSize = B3_COLOR_GRAIN_SIZE;
+		b3ParallelForFcn fcn = SolveColorRange;
+
+		context.constraints = m_coloring->GetColorConstraints(i);
+
+		if (task == e_solveVelocityTask && m_wide)
+		{
+			context.wideColor = m_wideColors + i;
+			count = context.wideColor->batchCount + context.wideColor->contactCount;
+			grainSize = B3_COLOR_GRAIN_SIZE / B3_SIMD_WIDTH;
+			fcn = SolveWideColorRange;
+		}
+
+		if (m_scheduler)
+		{
+			m_scheduler->ParallelFor(count, grainSize, fcn, &context);
+		}
+		else
+		{
+			fcn(&context, 0, count, threadIndex);
+		}
+	}
+
+	// Solve the remaining contacts on this thread.
+	context.constraints = m_coloring->GetOverflowConstraints();
+	SolveColorRange(&context, 0, m_coloring->GetOverflowConstraintCount(), threadIndex);
+
+	float32 minSeparation = 0.0f;
+	for (u32 i = 0; i < B3_MAX_THREADS; ++i)
+	{
+		minSeparation = b3Min(minSeparation, context.minSeparations[i]);
+	}
+	return minSeparation;
+}
+
+void b3ContactSolver::WarmStart()
+{
+	if (m_coloring)
+	{
+		SolveColors(e_warmStartTask);
+		return;
+	}
+
+	for (u32 i = 0; i < m_count; ++i)
+	{
+		WarmStart(i);
+	}
+}
+
+void b3ContactSolver::SolveVelocityConstraints()
+{
+	if (m_coloring)
+	{
+		SolveColors(e_solveVelocityTask);
+		return;
+	}
+
+	for (u32 i = 0; i < m_count; ++i)
+	{
+		SolveVelocityConstraint(i);
+	}
+}
+
+bool b3ContactSolver::SolvePositionConstraints()
+{
+	float32 minSeparation = 0.0f;
+
+	if (m_coloring)
+	{
+		minSeparation = SolveColors(e_solvePositionTask);
+	}
+	else
+	{
+		for (u32 i = 0; i < m_count; ++i)
+		{
+			minSeparation = b3Min(minSeparation, SolvePositionConstraint(i, B3_BAUMGARTE, false));
+		}
+	}
+
 	return minSeparation >= -3.0f * B3_LINEAR_SLOP;
 }
+
+bool b3ContactSolver::SolveTOIPositionConstraints()
+{
+	float32 minSeparation = 0.0f;
+	for (u32 i = 0; i < m_count; ++i)
+	{
+		minSeparation = b3Min(minSeparation, SolvePositionConstraint(i, B3_TOI_BAUMGARTE, true));
+	}
+
+	// Stop when the contact points are within half a slop of the target separation.
+	return minSeparation >= -1.5f * B3_LINEAR_SLOP;
+}
+
+void b3ContactSolver::SolveSubStep(bool useBias)
+{
+	B3_ASSERT(m_subStepping);
+
+	if (m_coloring)
+	{
+		SolveColors(useBias ? e_solveSubStepTask : e_relaxSubStepTask);
+		return;
+	}
+
+	for (u32 i = 0; i < m_count; ++i)
+	{
+		SolveSubStepConstraint(i, useBias);
+	}
+}
+
+void b3ContactSolver::ApplyRestitution()
+{
+	B3_ASSERT(m_subStepping);
+
+	if (m_coloring)
+	{
+		SolveColors(e_restitutionTask);
+		return;
+	}
+
+	for (u32 i = 0; i < m_count; ++i)
+	{
+		ApplyRestitution(i);
+	}
+}
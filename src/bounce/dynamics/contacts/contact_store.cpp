@@ -0,0 +1,153 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson https://irlanrobson.github.io
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#include <bounce/dynamics/contacts/contact_store.h>
+#include <bounce/dynamics/contacts/contact.h>
+#include <bounce/common/template/array.h>
+
+b3ContactStore::b3ContactStore(u32 manifoldCapacity, bool hasCache)
+{
+	m_count = 0;
+	m_capacity = 0;
+	m_activeCount = 0;
+	m_manifoldCapacity = manifoldCapacity;
+	m_contacts = NULL;
+	m_flags = NULL;
+	m_manifoldCounts = NULL;
+	m_manifolds = NULL;
+	m_caches = NULL;
+	m_hasCache = hasCache;
+
+	Reserve(64);
+}
+
+b3ContactStore::~b3ContactStore()
+{
+	b3Free(m_caches);
+	b3Free(m_manifolds);
+	b3Free(m_manifoldCounts);
+	b3Free(m_flags);
+	b3Free(m_contacts);
+}
+
+void b3ContactStore::Reserve(u32 capacity)
+{
+	B3_ASSERT(capacity > m_capacity);
+
+	// Allocate one more slot for swapping two contacts.
+	u32 slotCount = capacity + 1;
+
+	b3Grow(m_contacts, m_count, slotCount);
+	b3Grow(m_flags, m_count, slotCount);
+	b3Grow(m_manifoldCounts, m_count, slotCount);
+	b3Grow(m_manifolds, m_count * m_manifoldCapacity, slotCount * m_manifoldCapacity);
+	
+	if (m_hasCache)
+	{
+		b3Grow(m_caches, m_count, slotCount);
+	}
+
+	m_capacity = capacity;
+}
+
+u32 b3ContactStore::Add(b3Contact* contact)
+{
+	if (m_count == m_capacity)
+	{
+		Reserve(2 * m_capacity);
+	}
+
+	u32 index = m_count;
+	++m_count;
+
+	m_contacts[index] = contact;
+	m_flags[index] = 0;
+	m_manifoldCounts[index] = 0;
+
+	if (m_caches)
+	{
+		b3ConvexCache* cache = m_caches + index;
+		cache->simplexCache.count = 0;
+		cache->featureCache.m_featurePair.state = b3SATCacheType::e_empty;
+	}
+
+	return index;
+}
+
+void b3ContactStore::Move(u32 dst, u32 src)
+{
+	b3Contact* contact = m_contacts[src];
+	contact->m_storeIndex = dst;
+
+	m_contacts[dst] = contact;
+	m_flags[dst] = m_flags[src];
+	m_manifoldCounts[dst] = m_manifoldCounts[src];
+	
+	// Only the used manifolds are copied.
+	memcpy(m_manifolds + dst * m_manifoldCapacity, m_manifolds + src * m_manifoldCapacity, m_manifoldCounts[src] * sizeof(b3Manifold));
+
+	if (m_caches)
+	{
+		m_caches[dst] = m_caches[src];
+	}
+}
+
+void b3ContactStore::Remove(u32 index)
+{
+	B3_ASSERT(m_activeCount <= index && index < m_count);
+
+	u32 last = m_count - 1;
+	if (index != last)
+	{
+		Move(index, last);
+	}
+
+	--m_count;
+}
+
+void b3ContactStore::Swap(u32 index1, u32 index2)
+{
+	B3_ASSERT(index1 < m_count && index2 < m_count);
+
+	if (index1 == index2)
+	{
+		return;
+	}
+
+	// Use the slot past the capacity as a temporary. 
+	// This doesn't grow the arrays so the store can be reordered 
+	// while the contacts are reported.
+	Move(m_capacity, index1);
+	Move(index1, index2);
+	Move(index2, m_capacity);
+}
+
+void b3ContactStore::Activate(u32 index)
+{
+	B3_ASSERT(m_activeCount <= index && index < m_count);
+	Swap(m_activeCount, index);
+	++m_activeCount;
+}
+
+void b3ContactStore::Deactivate(u32 index)
+{
+	B3_ASSERT(index < m_activeCount);
+	--m_activeCount;
+	Swap(index, m_activeCount);
+}
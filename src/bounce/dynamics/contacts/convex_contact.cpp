@@ -20,6 +20,7 @@
 #include <bounce/dynamics/shapes/shape.h>
 #include <bounce/dynamics/body.h>
 #include <bounce/dynamics/world.h>
+#include <bounce/collision/time_of_impact.h>
 
 b3ConvexContact::b3ConvexContact(b3Shape* shapeA, b3Shape* shapeB)
 {
@@ -27,13 +28,6 @@ b3ConvexContact::b3ConvexContact(b3Shape* shapeA, b3Shape* shapeB)
     B3_NOT_USED(shapeB);
 
 	m_type = e_convexContact;
-
-	m_manifoldCapacity = 1;
-	m_manifolds = &m_stackManifold;
-	m_manifoldCount = 0;
-
-	m_cache.simplexCache.count = 0;
-	m_cache.featureCache.m_featurePair.state = b3SATCacheType::e_empty;
 }
 
 bool b3ConvexContact::TestOverlap()
@@ -44,11 +38,13 @@ bool b3ConvexContact::TestOverlap()
 	b3Shape* shapeB = GetShapeB();
 	b3Transform xfB = shapeB->GetBody()->GetTransform();
 
-	return b3TestOverlap(xfA, 0, shapeA, xfB, 0, shapeB, &m_cache);
+	return b3TestOverlap(xfA, 0, shapeA, xfB, 0, shapeB, &Cache());
 }
 
-void b3ConvexContact::Collide()
+void b3ConvexContact::Collide(b3StackAllocator* allocator)
 {
+	B3_NOT_USED(allocator);
+
 	b3Shape* shapeA = GetShapeA();
 	b3Body* bodyA = shapeA->GetBody();
 	b3Transform xfA = bodyA->GetTransform();
@@ -57,7 +53,40 @@ void b3ConvexContact::Collide()
 	b3Body* bodyB = shapeB->GetBody();
 	b3Transform xfB = bodyB->GetTransform();
 
-	B3_ASSERT(m_manifoldCount == 0);
-	b3CollideShapeAndShape(m_stackManifold, xfA, shapeA, xfB, shapeB, &m_cache);
-	m_manifoldCount = 1;
-}
\ No newline at end of file
+	B3_ASSERT(ManifoldCount() == 0);
+	b3CollideShapeAndShape(*Manifolds(), xfA, shapeA, xfB, shapeB, &Cache());
+	ManifoldCount() = 1;
+}
+
+float32 b3ConvexContact::ComputeTOI(const b3Sweep& sweepA, const b3Sweep& sweepB)
+{
+	b3ShapeGJKProxy proxyA(GetShapeA(), 0);
+	b3ShapeGJKProxy proxyB(GetShapeB(), 0);
+
+	b3TOIOutput output;
+	b3TimeOfImpact(&output, sweepA, proxyA, sweepB, proxyB, 1.0f);
+
+	m_toi.index = 0;
+
+	if (output.state == b3TOIOutput::e_touching || output.state == b3TOIOutput::e_failed)
+	{
+		return output.t;
+	}
+
+	return 1.0f;
+}
+
+void b3ConvexContact::CollideSpeculative(float32 dt)
+{
+	b3GJKOutput output;
+	float32 separation = ComputeClosestPoints(&output, 0);
+	if (separation == B3_MAX_FLOAT)
+	{
+		return;
+	}
+
+	if (separation <= GetSpeculativeSeparation(output, dt))
+	{
+		BuildClosestPointManifold(output, 0);
+	}
+}
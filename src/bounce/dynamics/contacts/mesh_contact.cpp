@@ -25,16 +25,13 @@
 #include <bounce/dynamics/shapes/hull_shape.h>
 #include <bounce/collision/shapes/mesh.h>
 #include <bounce/collision/shapes/triangle_hull.h>
+#include <bounce/collision/time_of_impact.h>
 #include <bounce/common/memory/stack_allocator.h>
 
 b3MeshContact::b3MeshContact(b3Shape* shapeA, b3Shape* shapeB)
 {
 	m_type = e_meshContact;
 
-	m_manifoldCapacity = B3_MAX_MANIFOLDS;
-	m_manifolds = m_stackManifolds;
-	m_manifoldCount = 0;
-
 	b3Transform xfA = shapeA->GetBody()->GetTransform();
 	b3Transform xfB = shapeB->GetBody()->GetTransform();
 
@@ -63,13 +60,13 @@ void b3MeshContact::SynchronizeShapes()
 {
 	b3Shape* shapeA = GetShapeA();
 	b3Body* bodyA = shapeA->GetBody();
-	b3Transform xfA = bodyA->m_xf;
+	b3Transform xfA = bodyA->Transform();
 
 	b3Shape* shapeB = GetShapeB();
 	b3Body* bodyB = shapeB->GetBody();
 	b3Transform xfB = bodyB->GetTransform();
 
-	b3Sweep* sweepA = &bodyA->m_sweep;
+	b3Sweep* sweepA = &bodyA->Sweep();
 	b3Transform xfA0;
 	xfA0.position = sweepA->worldCenter0;
 	xfA0.rotation = b3QuatMat33(sweepA->orientation0);
@@ -214,9 +211,103 @@ bool b3MeshContact::TestOverlap()
 	return false;
 }
 
-void b3MeshContact::Collide()
+// Static tree callback that finds the first time of impact 
+// between a shape and the triangles of a mesh.
+struct b3MeshTOICallback
 {
-	B3_ASSERT(m_manifoldCount == 0);
+	bool Report(u32 proxyId)
+	{
+		u32 triangleIndex = meshShapeB->m_mesh->tree.GetUserData(proxyId);
+
+		b3ShapeGJKProxy proxyB(meshShapeB, triangleIndex);
+
+		b3TOIOutput output;
+		b3TimeOfImpact(&output, *sweepA, *proxyA, *sweepB, proxyB, t);
+
+		if ((output.state == b3TOIOutput::e_touching || output.state == b3TOIOutput::e_failed) && output.t < t)
+		{
+			t = output.t;
+			index = triangleIndex;
+		}
+
+		// Keep looking for triangles.
+		return true;
+	}
+
+	const b3Sweep* sweepA;
+	const b3GJKProxy* proxyA;
+	const b3Sweep* sweepB;
+	const b3MeshShape* meshShapeB;
+	float32 t;
+	u32 index;
+};
+
+float32 b3MeshContact::ComputeTOI(const b3Sweep& sweepA, const b3Sweep& sweepB)
+{
+	b3Shape* shapeA = GetShapeA();
+	b3MeshShape* meshShapeB = (b3MeshShape*)GetShapeB();
+
+	// Compute the swept AABB of the shape A relative to shape B's frame.
+	b3Transform xf1 = b3MulT(sweepB.GetTransform(0.0f), sweepA.GetTransform(0.0f));
+	b3Transform xf2 = b3MulT(sweepB.GetTransform(1.0f), sweepA.GetTransform(1.0f));
+
+	b3AABB3 aabb1, aabb2;
+	shapeA->ComputeAABB(&aabb1, xf1);
+	shapeA->ComputeAABB(&aabb2, xf2);
+
+	b3ShapeGJKProxy proxyA(shapeA, 0);
+
+	b3MeshTOICallback callback;
+	callback.sweepA = &sweepA;
+	callback.proxyA = &proxyA;
+	callback.sweepB = &sweepB;
+	callback.meshShapeB = meshShapeB;
+	callback.t = 1.0f;
+	callback.index = 0;
+
+	meshShapeB->m_mesh->tree.QueryAABB(&callback, b3Combine(aabb1, aabb2));
+
+	m_toi.index = callback.index;
+
+	return callback.t;
+}
+
+void b3MeshContact::CollideSpeculative(float32 dt)
+{
+	// Find the triangle that is closest to begin touching.
+	b3GJKOutput bestOutput;
+	u32 bestIndex = B3_MAX_U32;
+	float32 bestMargin = 0.0f;
+
+	for (u32 i = 0; i < m_triangleCount; ++i)
+	{
+		u32 triangleIndex = m_triangles[i].index;
+
+		b3GJKOutput output;
+		float32 separation = ComputeClosestPoints(&output, triangleIndex);
+		if (separation == B3_MAX_FLOAT)
+		{
+			continue;
+		}
+
+		float32 margin = separation - GetSpeculativeSeparation(output, dt);
+		if (margin <= bestMargin)
+		{
+			bestOutput = output;
+			bestIndex = triangleIndex;
+			bestMargin = margin;
+		}
+	}
+
+	if (bestIndex != B3_MAX_U32)
+	{
+		BuildClosestPointManifold(bestOutput, bestIndex);
+	}
+}
+
+void b3MeshContact::Collide(b3StackAllocator* allocator)
+{
+	B3_ASSERT(ManifoldCount() == 0);
 
 	b3Shape* shapeA = GetShapeA();
 	b3Body* bodyA = shapeA->GetBody();
@@ -227,9 +318,6 @@ void b3MeshContact::Collide()
 	b3MeshShape* meshShapeB = (b3MeshShape*)shapeB;
 	b3Transform xfB = bodyB->GetTransform();
 
-	b3World* world = bodyA->GetWorld();
-	b3StackAllocator* allocator = &world->m_stackAllocator;
-
 	// Create one manifold per triangle.
 	b3Manifold* tempManifolds = (b3Manifold*)allocator->Allocate(m_triangleCount * sizeof(b3Manifold));
 	u32 tempCount = 0;
@@ -266,10 +354,10 @@ void b3MeshContact::Collide()
 	}
 
 	// Send contact manifolds for clustering. This is an important optimization.
-	B3_ASSERT(m_manifoldCount == 0);
+	B3_ASSERT(ManifoldCount() == 0);
 	
 	b3ClusterSolver clusterSolver;
-	clusterSolver.Run(m_stackManifolds, m_manifoldCount, tempManifolds, tempCount, xfA, shapeA->m_radius, xfB, B3_HULL_RADIUS);
+	clusterSolver.Run(Manifolds(), ManifoldCount(), tempManifolds, tempCount, xfA, shapeA->m_radius, xfB, B3_HULL_RADIUS);
 	
 	allocator->Free(tempManifolds);
 }
\ No newline at end of file
@@ -0,0 +1,90 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson https://irlanrobson.github.io
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#include <bounce/dynamics/contacts/sensor_pair.h>
+#include <bounce/dynamics/shapes/shape.h>
+#include <bounce/dynamics/shapes/mesh_shape.h>
+#include <bounce/dynamics/body.h>
+#include <bounce/collision/shapes/mesh.h>
+
+b3Shape* b3SensorPair::GetSensorShape()
+{
+	return shapeA->IsSensor() ? shapeA : shapeB;
+}
+
+b3Shape* b3SensorPair::GetVisitorShape()
+{
+	return shapeA->IsSensor() ? shapeB : shapeA;
+}
+
+// Static tree callback that stops at the first triangle 
+// overlapping the shape A.
+struct b3SensorMeshOverlapCallback
+{
+	bool Report(u32 proxyId)
+	{
+		u32 triangleIndex = meshShapeB->m_mesh->tree.GetUserData(proxyId);
+
+		b3ConvexCache cache;
+		cache.simplexCache.count = 0;
+
+		if (b3TestOverlap(xfA, 0, shapeA, xfB, triangleIndex, meshShapeB, &cache))
+		{
+			overlap = true;
+			
+			// Stop the query.
+			return false;
+		}
+
+		// Keep looking for triangles.
+		return true;
+	}
+
+	b3Transform xfA;
+	const b3Shape* shapeA;
+	b3Transform xfB;
+	const b3MeshShape* meshShapeB;
+	bool overlap;
+};
+
+bool b3SensorPair::TestOverlap()
+{
+	b3Transform xfA = shapeA->GetBody()->GetTransform();
+	b3Transform xfB = shapeB->GetBody()->GetTransform();
+
+	if (shapeB->GetType() != e_meshShape)
+	{
+		return b3TestOverlap(xfA, 0, shapeA, xfB, 0, shapeB, &cache);
+	}
+
+	// Compute the AABB of the shape A in the reference frame of the mesh.
+	b3AABB3 aabbA;
+	shapeA->ComputeAABB(&aabbA, b3MulT(xfB, xfA));
+
+	b3SensorMeshOverlapCallback callback;
+	callback.xfA = xfA;
+	callback.shapeA = shapeA;
+	callback.xfB = xfB;
+	callback.meshShapeB = (b3MeshShape*)shapeB;
+	callback.overlap = false;
+
+	callback.meshShapeB->m_mesh->tree.QueryAABB(&callback, aabbA);
+
+	return callback.overlap;
+}
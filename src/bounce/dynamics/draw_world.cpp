@@ -38,8 +38,8 @@ void b3World::Draw() const
 	{
 		for (b3Body* b = m_bodyList.m_head; b; b = b->m_next)
 		{
-			b3Transform xf = b->m_xf;
-			xf.position = b->m_sweep.worldCenter;
+			b3Transform xf = b->Transform();
+			xf.position = b->Sweep().worldCenter;
 			b3Draw_draw->DrawTransform(xf);
 		}
 	}
@@ -78,8 +78,8 @@ void b3World::Draw() const
 
 	for (b3Contact* c = m_contactMan.m_contactList.m_head; c; c = c->m_next)
 	{
-		u32 manifoldCount = c->m_manifoldCount;
-		const b3Manifold* manifolds = c->m_manifolds;
+		u32 manifoldCount = c->GetManifoldCount();
+		const b3Manifold* manifolds = c->Manifolds();
 
 		for (u32 i = 0; i < manifoldCount; ++i)
 		{
@@ -0,0 +1,126 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson https://irlanrobson.github.io
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#include <bounce/dynamics/graph_coloring.h>
+#include <bounce/common/memory/stack_allocator.h>
+#include <bounce/common/math/math.h>
+
+B3_STATIC_ASSERT(B3_MAX_COLORS <= 64);
+
+b3GraphColoring::b3GraphColoring(b3StackAllocator* allocator, const u32* bodies, u32 constraintCount, u32 bodyCount)
+{
+	m_allocator = allocator;
+	m_constraintCount = constraintCount;
+	m_constraints = (u32*)m_allocator->Allocate(m_constraintCount * sizeof(u32));
+
+	// The colors used by each body.
+	u64* bodyColors = (u64*)m_allocator->Allocate(bodyCount * sizeof(u64));
+	memset(bodyColors, 0, bodyCount * sizeof(u64));
+	
+	// The color of each constraint.
+	u32* colors = (u32*)m_allocator->Allocate(m_constraintCount * sizeof(u32));
+
+	u32 counts[B3_MAX_COLORS + 1];
+	memset(counts, 0, sizeof(counts));
+
+	m_colorCount = 0;
+
+	for (u32 i = 0; i < m_constraintCount; ++i)
+	{
+		u32 indexA = bodies[2 * i + 0];
+		u32 indexB = bodies[2 * i + 1];
+
+		u64 usedColors = 0;
+		if (indexA != B3_NULL_COLOR_BODY)
+		{
+			B3_ASSERT(indexA < bodyCount);
+			usedColors |= bodyColors[indexA];
+		}
+
+		if (indexB != B3_NULL_COLOR_BODY)
+		{
+			B3_ASSERT(indexB < bodyCount);
+			usedColors |= bodyColors[indexB];
+		}
+
+		// Find the first color not used by the bodies.
+		u32 color = B3_MAX_COLORS;
+		for (u32 j = 0; j < B3_MAX_COLORS; ++j)
+		{
+			u64 bit = u64(1) << j;
+			if ((usedColors & bit) == 0)
+			{
+				color = j;
+				break;
+			}
+		}
+
+		if (color < B3_MAX_COLORS)
+		{
+			u64 bit = u64(1) << color;
+			
+			if (indexA != B3_NULL_COLOR_BODY)
+			{
+				bodyColors[indexA] |= bit;
+			}
+
+			if (indexB != B3_NULL_COLOR_BODY)
+			{
+				bodyColors[indexB] |= bit;
+			}
+
+			m_colorCount = b3Max(m_colorCount, color + 1);
+		}
+
+		colors[i] = color;
+		++counts[color];
+	}
+
+	// Move the overflow constraints after the last used color.
+	counts[m_colorCount] = counts[B3_MAX_COLORS];
+	for (u32 i = 0; i < m_constraintCount; ++i)
+	{
+		if (colors[i] == B3_MAX_COLORS)
+		{
+			colors[i] = m_colorCount;
+		}
+	}
+
+	// Sort the constraints by color keeping their order within a color.
+	u32 offset = 0;
+	for (u32 i = 0; i <= m_colorCount; ++i)
+	{
+		m_colorStarts[i] = offset;
+		offset += counts[i];
+		counts[i] = m_colorStarts[i];
+	}
+
+	for (u32 i = 0; i < m_constraintCount; ++i)
+	{
+		m_constraints[counts[colors[i]]++] = i;
+	}
+
+	m_allocator->Free(colors);
+	m_allocator->Free(bodyColors);
+}
+
+b3GraphColoring::~b3GraphColoring()
+{
+	m_allocator->Free(m_constraints);
+}
@@ -25,63 +25,38 @@
 #include <bounce/dynamics/contacts/contact_solver.h>
 #include <bounce/common/memory/stack_allocator.h>
 
-b3Island::b3Island(b3StackAllocator* allocator, u32 bodyCapacity, u32 contactCapacity, u32 jointCapacity) 
+b3Island::b3Island(b3StackAllocator* allocator, b3TaskScheduler* scheduler, b3BodyStore* store, 
+	b3Body** bodies, u32 bodyCount, 
+	b3Contact** contacts, u32 contactCount, 
+	b3Joint** joints, u32 jointCount) 
 {
 	m_allocator = allocator;
-	m_bodyCapacity = bodyCapacity;
-	m_contactCapacity = contactCapacity;
-	m_jointCapacity = jointCapacity;
+	m_scheduler = scheduler;
+	m_store = store;
 	
-	m_bodies = (b3Body**)m_allocator->Allocate(m_bodyCapacity * sizeof(b3Body*));
-	m_velocities = (b3Velocity*)m_allocator->Allocate(m_bodyCapacity * sizeof(b3Velocity));
-	m_positions = (b3Position*)m_allocator->Allocate(m_bodyCapacity * sizeof(b3Position));
-	m_invInertias = (b3Mat33*)m_allocator->Allocate(m_bodyCapacity * sizeof(b3Mat33));
-	m_contacts = (b3Contact**)m_allocator->Allocate(m_contactCapacity * sizeof(b3Contact*));
-	m_joints = (b3Joint**)m_allocator->Allocate(m_jointCapacity * sizeof(b3Joint*));
-
-	m_bodyCount = 0;
-	m_contactCount = 0;
-	m_jointCount = 0;
+	m_bodies = bodies;
+	m_bodyCount = bodyCount;
+	
+	m_contacts = contacts;
+	m_contactCount = contactCount;
+	
+	m_joints = joints;
+	m_jointCount = jointCount;
+
+	m_sleepTime = 0.0f;
+	m_positionIterations = 0;
+
+	m_velocities = (b3Velocity*)m_allocator->Allocate(m_bodyCount * sizeof(b3Velocity));
+	m_positions = (b3Position*)m_allocator->Allocate(m_bodyCount * sizeof(b3Position));
+	m_invInertias = (b3Mat33*)m_allocator->Allocate(m_bodyCount * sizeof(b3Mat33));
 }
 
 b3Island::~b3Island() 
 {
 	// @note Reverse order of construction.
-	m_allocator->Free(m_joints);
-	m_allocator->Free(m_contacts);
 	m_allocator->Free(m_invInertias);
 	m_allocator->Free(m_positions);
 	m_allocator->Free(m_velocities);
-	m_allocator->Free(m_bodies);
-}
-
-void b3Island::Clear() 
-{
-	m_bodyCount = 0;
-	m_contactCount = 0;
-	m_jointCount = 0;
-}
-
-void b3Island::Add(b3Body* b) 
-{
-	B3_ASSERT(m_bodyCount < m_bodyCapacity);
-	b->m_islandID = m_bodyCount;
-	m_bodies[m_bodyCount] = b;
-	++m_bodyCount;
-}
-
-void b3Island::Add(b3Contact* c) 
-{
-	B3_ASSERT(m_contactCount < m_contactCapacity);
-	m_contacts[m_contactCount] = c;
-	++m_contactCount;
-}
-
-void b3Island::Add(b3Joint* j) 
-{
-	B3_ASSERT(m_jointCount < m_jointCapacity);
-	m_joints[m_jointCount] = j;
-	++m_jointCount;
 }
 
 // Box2D
@@ -106,75 +81,107 @@ static B3_FORCE_INLINE b3Vec3 b3SolveGyro(const b3Quat& q, const b3Mat33& Ib, co
 	return w2;
 }
 
-void b3Island::Solve(const b3Vec3& gravity, float32 dt, u32 velocityIterations, u32 positionIterations, u32 flags)
+void b3Island::IntegrateVelocities(const b3Vec3& gravity, float32 h)
 {
-	float32 h = dt;
-
-	// 1. Integrate velocities
 	for (u32 i = 0; i < m_bodyCount; ++i) 
 	{
 		b3Body* b = m_bodies[i];
+		if (b->m_type != e_dynamicBody) 
+		{
+			continue;
+		}
 
-		b3Vec3 v = b->m_linearVelocity;
-		b3Vec3 w = b->m_angularVelocity;
-		b3Vec3 x = b->m_sweep.worldCenter;
-		b3Quat q = b->m_sweep.orientation;
+		b3Vec3 v = m_velocities[i].v;
+		b3Vec3 w = m_velocities[i].w;
+		b3Quat q = m_positions[i].q;
 
-		// Remember the positions for CCD
-		b->m_sweep.worldCenter0 = b->m_sweep.worldCenter;
-		b->m_sweep.orientation0 = b->m_sweep.orientation;
+		// Integrate forces
+		v += h * (b->m_gravityScale * gravity + b->m_invMass * m_store->m_forces[b->m_storeIndex]);
+		
+		// Integrate torques
+		
+		// Superposition Principle
+		// w2 - w1 = dw1 + dw2 
+		// w2 - w1 = h * I^1 * bt + h * I^1 * -gt
+		// w2 = w1 + dw1 + dw2
+					
+		// Explicit Euler on current inertia and applied torque
+		// w2 = w1 + h * I1^1 * bt1
+		b3Vec3 dw1 = h * m_invInertias[i] * m_store->m_torques[b->m_storeIndex];
+		
+		// Implicit Euler on next inertia and angular velocity
+		// w2 = w1 - h * I2^1 * cross(w2, I2 * w2)
+		// w2 - w1 = -I2^1 * h * cross(w2, I2 * w2)
+		// I2 * (w2 - w1) = -h * cross(w2, I2 * w2)
+		// I2 * (w2 - w1) + h * cross(w2, I2 * w2) = 0
+		// Toss out I2 from f using local I2 (constant) and local w1 
+		// to remove its time dependency.
+		b3Vec3 w2 = b3SolveGyro(q, b->m_I, w, h);
+		b3Vec3 dw2 = w2 - w;
+
+		w += dw1 + dw2;
+		
+		// Apply local damping.
+		// ODE: dv/dt + c * v = 0
+		// Solution: v(t) = v0 * exp(-c * t)
+		// Step: v(t + dt) = v0 * exp(-c * (t + dt)) = v0 * exp(-c * t) * exp(-c * dt) = v * exp(-c * dt)
+		// v2 = exp(-c * dt) * v1
+		// Padé approximation:
+		// 1 / (1 + c * dt) 
+		v *= 1.0f / (1.0f + h * b->m_linearDamping);
+		w *= 1.0f / (1.0f + h * b->m_angularDamping);
 
-		if (b->m_type == e_dynamicBody) 
+		m_velocities[i].v = v;
+		m_velocities[i].w = w;
+	}
+}
+
+void b3Island::IntegratePositions(float32 h)
+{
+	for (u32 i = 0; i < m_bodyCount; ++i) 
+	{
+		b3Body* b = m_bodies[i];
+		
+		b3Vec3 x = m_positions[i].x;
+		b3Quat q = m_positions[i].q;
+		b3Vec3 v = m_velocities[i].v;
+		b3Vec3 w = m_velocities[i].w;
+		b3Mat33 invI = m_invInertias[i];
+
+		// Prevent numerical instability due to large velocity changes.		
+		b3Vec3 translation = h * v;
+		if (b3Dot(translation, translation) > B3_MAX_TRANSLATION_SQUARED)
 		{
-			// Integrate forces
-			v += h * (b->m_gravityScale * gravity + b->m_invMass * b->m_force);
-			
-			// Clear forces
-			b->m_force.SetZero();
-			
-			// Integrate torques
-			
-			// Superposition Principle
-			// w2 - w1 = dw1 + dw2 
-			// w2 - w1 = h * I^1 * bt + h * I^1 * -gt
-			// w2 = w1 + dw1 + dw2
-						
-			// Explicit Euler on current inertia and applied torque
-			// w2 = w1 + h * I1^1 * bt1
-			b3Vec3 dw1 = h * b->m_worldInvI * b->m_torque;
-			
-			// Implicit Euler on next inertia and angular velocity
-			// w2 = w1 - h * I2^1 * cross(w2, I2 * w2)
-			// w2 - w1 = -I2^1 * h * cross(w2, I2 * w2)
-			// I2 * (w2 - w1) = -h * cross(w2, I2 * w2)
-			// I2 * (w2 - w1) + h * cross(w2, I2 * w2) = 0
-			// Toss out I2 from f using local I2 (constant) and local w1 
-			// to remove its time dependency.
-			b3Vec3 w2 = b3SolveGyro(q, b->m_I, w, h);
-			b3Vec3 dw2 = w2 - w;
-
-			w += dw1 + dw2;
-			
-			// Clear torques
-			b->m_torque.SetZero();
-			
-			// Apply local damping.
-			// ODE: dv/dt + c * v = 0
-			// Solution: v(t) = v0 * exp(-c * t)
-			// Step: v(t + dt) = v0 * exp(-c * (t + dt)) = v0 * exp(-c * t) * exp(-c * dt) = v * exp(-c * dt)
-			// v2 = exp(-c * dt) * v1
-			// Padé approximation:
-			// 1 / (1 + c * dt) 
-			v *= 1.0f / (1.0f + h * b->m_linearDamping);
-			w *= 1.0f / (1.0f + h * b->m_angularDamping);
+			float32 ratio = B3_MAX_TRANSLATION / b3Length(translation);
+			v *= ratio;
 		}
 
-		m_velocities[i].v = v;
-		m_velocities[i].w = w;
+		b3Vec3 rotation = h * w;
+		if (b3Dot(rotation, rotation) > B3_MAX_ROTATION_SQUARED)
+		{
+			float32 ratio = B3_MAX_ROTATION / b3Length(rotation);
+			w *= ratio;
+		}
+
+		// Integrate
+		x += h * v;
+		q = b3Integrate(q, w, h);
+		invI = b3RotateToFrame(b->m_invI, q);
+
 		m_positions[i].x = x;
 		m_positions[i].q = q;
-		m_invInertias[i] = b->m_worldInvI;
+		m_velocities[i].v = v;
+		m_velocities[i].w = w;
+		m_invInertias[i] = invI;
 	}
+}
+
+void b3Island::SolveIterations(const b3Vec3& gravity, float32 dt, u32 velocityIterations, u32 positionIterations, u32 flags)
+{
+	float32 h = dt;
+
+	// 1. Integrate velocities
+	IntegrateVelocities(gravity, h);
 
 	b3JointSolverDef jointSolverDef;
 	jointSolverDef.joints = m_joints;
@@ -183,6 +190,8 @@ void b3Island::Solve(const b3Vec3& gravity, float32 dt, u32 velocityIterations,
 	jointSolverDef.velocities = m_velocities;
 	jointSolverDef.invInertias = m_invInertias;
 	jointSolverDef.dt = h;
+	jointSolverDef.allocator = m_allocator;
+	jointSolverDef.scheduler = m_scheduler;
 	b3JointSolver jointSolver(&jointSolverDef);
 
 	b3ContactSolverDef contactSolverDef;
@@ -193,6 +202,9 @@ void b3Island::Solve(const b3Vec3& gravity, float32 dt, u32 velocityIterations,
 	contactSolverDef.velocities = m_velocities;
 	contactSolverDef.invInertias = m_invInertias;
 	contactSolverDef.dt = h;
+	contactSolverDef.scheduler = m_scheduler;
+	contactSolverDef.wide = (flags & e_wideBit) != 0;
+	contactSolverDef.subStepping = false;
 	b3ContactSolver contactSolver(&contactSolverDef);
 
 	// 2. Initialize constraints
@@ -231,73 +243,249 @@ void b3Island::Solve(const b3Vec3& gravity, float32 dt, u32 velocityIterations,
 	}
 
 	// 4. Integrate positions
-	for (u32 i = 0; i < m_bodyCount; ++i) 
-	{
-		b3Body* b = m_bodies[i];
-		
-		b3Vec3 x = m_positions[i].x;
-		b3Quat q = m_positions[i].q;
-		b3Vec3 v = m_velocities[i].v;
-		b3Vec3 w = m_velocities[i].w;
-		b3Mat33 invI = m_invInertias[i];
-
-		// Prevent numerical instability due to large velocity changes.		
-		b3Vec3 translation = h * v;
-		if (b3Dot(translation, translation) > B3_MAX_TRANSLATION_SQUARED)
-		{
-			float32 ratio = B3_MAX_TRANSLATION / b3Length(translation);
-			v *= ratio;
-		}
-
-		b3Vec3 rotation = h * w;
-		if (b3Dot(rotation, rotation) > B3_MAX_ROTATION_SQUARED)
-		{
-			float32 ratio = B3_MAX_ROTATION / b3Length(rotation);
-			w *= ratio;
-		}
-
-		// Integrate
-		x += h * v;
-		q = b3Integrate(q, w, h);
-		invI = b3RotateToFrame(b->m_invI, q);
-
-		m_positions[i].x = x;
-		m_positions[i].q = q;
-		m_velocities[i].v = v;
-		m_velocities[i].w = w;
-		m_invInertias[i] = invI;
-	}
+	IntegratePositions(h);
 
 	// 5. Solve position constraints
 	{
 		B3_PROFILE("Solve Position Constraints");
 		
-		bool positionsSolved = false;
 		for (u32 i = 0; i < positionIterations; ++i) 
 		{
+			++m_positionIterations;
+
 			bool contactsSolved = contactSolver.SolvePositionConstraints();
 			bool jointsSolved = jointSolver.SolvePositionConstraints();
 			if (contactsSolved && jointsSolved)
 			{
 				// Early out if the position errors are small.
-				positionsSolved = true;
 				break;
 			}
 		}
 	}
+}
+
+void b3Island::SolveSubSteps(const b3Vec3& gravity, float32 dt, u32 subStepCount, u32 flags)
+{
+	// The constraints are prepared once and solved with a single 
+	// biased and a single relaxing iteration per substep.
+	float32 h = dt / float32(subStepCount);
+
+	b3JointSolverDef jointSolverDef;
+	jointSolverDef.joints = m_joints;
+	jointSolverDef.count = m_jointCount;
+	jointSolverDef.positions = m_positions;
+	jointSolverDef.velocities = m_velocities;
+	jointSolverDef.invInertias = m_invInertias;
+	jointSolverDef.dt = h;
+	jointSolverDef.allocator = m_allocator;
+	jointSolverDef.scheduler = m_scheduler;
+	b3JointSolver jointSolver(&jointSolverDef);
+
+	b3ContactSolverDef contactSolverDef;
+	contactSolverDef.allocator = m_allocator;
+	contactSolverDef.contacts = m_contacts;
+	contactSolverDef.count = m_contactCount;
+	contactSolverDef.positions = m_positions;
+	contactSolverDef.velocities = m_velocities;
+	contactSolverDef.invInertias = m_invInertias;
+	contactSolverDef.dt = h;
+	contactSolverDef.scheduler = m_scheduler;
+	contactSolverDef.wide = false;
+	contactSolverDef.subStepping = true;
+	b3ContactSolver contactSolver(&contactSolverDef);
+
+	// 2. Initialize constraints
+	{
+		B3_PROFILE("Initialize Constraints");
+
+		contactSolver.InitializeConstraints();
+		jointSolver.InitializeConstraints();
+	}
+
+	// 3. Solve substeps
+	{
+		B3_PROFILE("Solve Substeps");
+
+		for (u32 i = 0; i < subStepCount; ++i)
+		{
+			IntegrateVelocities(gravity, h);
+
+			// The accumulated impulses are the impulses of the last substep.
+			// They must always be applied because the impulses are clamped against them.
+			// Only the impulses carried from the last step depend on warm starting.
+			if (i > 0 || (flags & e_warmStartBit))
+			{
+				jointSolver.WarmStart();
+				contactSolver.WarmStart();
+			}
+
+			jointSolver.SolveVelocityConstraints();
+			contactSolver.SolveSubStep(true);
+
+			IntegratePositions(h);
+
+			// Joints don't have a velocity bias. 
+			// Remove their drift with one position iteration per substep.
+			jointSolver.SolvePositionConstraints();
+			++m_positionIterations;
+
+			// Remove the velocity added by the contact bias.
+			jointSolver.SolveVelocityConstraints();
+			contactSolver.SolveSubStep(false);
+		}
+
+		contactSolver.ApplyRestitution();
+
+		if (flags & e_warmStartBit)
+		{
+			contactSolver.StoreImpulses();
+		}
+	}
+}
+
+void b3Island::SolveTOI(float32 dt, u32 velocityIterations, u32 positionIterations)
+{
+	// 1. Copy the body states at the time of impact to the solver buffers
+	for (u32 i = 0; i < m_bodyCount; ++i) 
+	{
+		u32 index = m_bodies[i]->m_storeIndex;
+		const b3Sweep& sweep = m_store->m_sweeps[index];
+
+		m_velocities[i].v = m_store->m_linearVelocities[index];
+		m_velocities[i].w = m_store->m_angularVelocities[index];
+		m_positions[i].x = sweep.worldCenter;
+		m_positions[i].q = sweep.orientation;
+		m_invInertias[i] = m_store->m_worldInvInertias[index];
+	}
+
+	b3ContactSolverDef contactSolverDef;
+	contactSolverDef.allocator = m_allocator;
+	contactSolverDef.contacts = m_contacts;
+	contactSolverDef.count = m_contactCount;
+	contactSolverDef.positions = m_positions;
+	contactSolverDef.velocities = m_velocities;
+	contactSolverDef.invInertias = m_invInertias;
+	contactSolverDef.dt = dt;
+	contactSolverDef.scheduler = NULL;
+	contactSolverDef.wide = false;
+	contactSolverDef.subStepping = false;
+	b3ContactSolver contactSolver(&contactSolverDef);
+
+	contactSolver.InitializeConstraints();
+
+	// 2. Push the bodies apart at the time of impact
+	for (u32 i = 0; i < positionIterations; ++i)
+	{
+		if (contactSolver.SolveTOIPositionConstraints())
+		{
+			break;
+		}
+	}
+
+	// The sweeps begin at the corrected positions.
+	for (u32 i = 0; i < m_bodyCount; ++i)
+	{
+		b3Body* b = m_bodies[i];
+		if (b->m_type == e_staticBody)
+		{
+			continue;
+		}
+
+		b3Sweep& sweep = m_store->m_sweeps[b->m_storeIndex];
+		sweep.worldCenter0 = m_positions[i].x;
+		sweep.orientation0 = m_positions[i].q;
+	}
+
+	// 3. Solve velocity constraints
+	// The impulses are not stored for warm starting because they can be quite large.
+	for (u32 i = 0; i < velocityIterations; ++i)
+	{
+		contactSolver.SolveVelocityConstraints();
+	}
+
+	// 4. Integrate positions for the rest of the step
+	IntegratePositions(dt);
+
+	// 5. Copy state buffers back to the bodies
+	for (u32 i = 0; i < m_bodyCount; ++i) 
+	{
+		b3Body* b = m_bodies[i];
+		if (b->m_type == e_staticBody)
+		{
+			continue;
+		}
+
+		u32 index = b->m_storeIndex;
+		b3Sweep& sweep = m_store->m_sweeps[index];
+		sweep.worldCenter = m_positions[i].x;
+		sweep.orientation = m_positions[i].q;
+		sweep.orientation.Normalize();
+		m_store->m_linearVelocities[index] = m_velocities[i].v;
+		m_store->m_angularVelocities[index] = m_velocities[i].w;	
+		m_store->m_worldInvInertias[index] = m_invInertias[i];
+		m_store->m_transforms[index] = sweep.GetTransform(1.0f);
+	}
+}
+
+void b3Island::Solve(const b3Vec3& gravity, float32 dt, u32 velocityIterations, u32 positionIterations, u32 subStepCount, u32 flags)
+{
+	float32 h = dt;
+
+	// 1. Copy the body states to the solver buffers
+	for (u32 i = 0; i < m_bodyCount; ++i) 
+	{
+		b3Body* b = m_bodies[i];
+		u32 index = b->m_storeIndex;
+		b3Sweep& sweep = m_store->m_sweeps[index];
+
+		// Static bodies can be shared by many islands. 
+		// Therefore they must not be written by the island.
+		if (b->m_type != e_staticBody)
+		{
+			// Remember the positions for CCD
+			sweep.worldCenter0 = sweep.worldCenter;
+			sweep.orientation0 = sweep.orientation;
+			sweep.t0 = 0.0f;
+		}
+
+		m_velocities[i].v = m_store->m_linearVelocities[index];
+		m_velocities[i].w = m_store->m_angularVelocities[index];
+		m_positions[i].x = sweep.worldCenter;
+		m_positions[i].q = sweep.orientation;
+		m_invInertias[i] = m_store->m_worldInvInertias[index];
+	}
+
+	if (subStepCount > 0)
+	{
+		SolveSubSteps(gravity, dt, subStepCount, flags);
+	}
+	else
+	{
+		SolveIterations(gravity, dt, velocityIterations, positionIterations, flags);
+	}
 
 	// 6. Copy state buffers back to the bodies
 	for (u32 i = 0; i < m_bodyCount; ++i) 
 	{
 		b3Body* b = m_bodies[i];
-		b->m_sweep.worldCenter = m_positions[i].x;
-		b->m_sweep.orientation = m_positions[i].q;
-		b->m_sweep.orientation.Normalize();
-		b->m_linearVelocity = m_velocities[i].v;
-		b->m_angularVelocity = m_velocities[i].w;	
-		b->m_worldInvI = m_invInertias[i];
+		if (b->m_type == e_staticBody)
+		{
+			continue;
+		}
+
+		u32 index = b->m_storeIndex;
+		b3Sweep& sweep = m_store->m_sweeps[index];
+		sweep.worldCenter = m_positions[i].x;
+		sweep.orientation = m_positions[i].q;
+		sweep.orientation.Normalize();
+		m_store->m_linearVelocities[index] = m_velocities[i].v;
+		m_store->m_angularVelocities[index] = m_velocities[i].w;	
+		m_store->m_worldInvInertias[index] = m_invInertias[i];
+		m_store->m_transforms[index] = sweep.GetTransform(1.0f);
 		
-		b->SynchronizeTransform();
+		// Clear forces and torques
+		m_store->m_forces[index].SetZero();
+		m_store->m_torques[index].SetZero();
 	}
 
 	// 7. Put bodies under unconsiderable motion to sleep
@@ -313,8 +501,8 @@ void b3Island::Solve(const b3Vec3& gravity, float32 dt, u32 velocityIterations,
 			}
 
 			// Compute the linear and angular speed of the body.
-			float32 sqrLinVel = b3Dot(b->m_linearVelocity, b->m_linearVelocity);
-			float32 sqrAngVel = b3Dot(b->m_angularVelocity, b->m_angularVelocity);
+			float32 sqrLinVel = b3Dot(m_velocities[i].v, m_velocities[i].v);
+			float32 sqrAngVel = b3Dot(m_velocities[i].w, m_velocities[i].w);
 
 			if (sqrLinVel > B3_SLEEP_LINEAR_TOL || sqrAngVel > B3_SLEEP_ANGULAR_TOL) 
 			{
@@ -328,13 +516,23 @@ void b3Island::Solve(const b3Vec3& gravity, float32 dt, u32 velocityIterations,
 			}
 		}
 
+		m_sleepTime = minSleepTime;
+
 		// Put the island to sleep so long as the minimum found sleep time
 		// is below the threshold. 
 		if (minSleepTime >= B3_TIME_TO_SLEEP) 
 		{
+			m_sleepTime = B3_MAX_FLOAT;
+
 			for (u32 i = 0; i < m_bodyCount; ++i) 
 			{
-				m_bodies[i]->SetAwake(false);
+				b3Body* b = m_bodies[i];
+				if (b->m_type == e_staticBody)
+				{
+					continue;
+				}
+
+				b->SetAwake(false);
 			}
 		}
 	}
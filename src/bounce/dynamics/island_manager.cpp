@@ -0,0 +1,569 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson https://irlanrobson.github.io
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#include <bounce/dynamics/island_manager.h>
+#include <bounce/dynamics/contact_manager.h>
+#include <bounce/dynamics/body.h>
+#include <bounce/dynamics/shapes/shape.h>
+#include <bounce/dynamics/contacts/contact.h>
+#include <bounce/dynamics/joints/joint.h>
+#include <bounce/common/memory/stack_allocator.h>
+
+// Append an element to an island list.
+template<class T>
+inline void b3IslandManager::PushLink(T*& head, T*& tail, T* link)
+{
+	link->m_islandPrev = tail;
+	link->m_islandNext = NULL;
+	if (tail)
+	{
+		tail->m_islandNext = link;
+	}
+	else
+	{
+		head = link;
+	}
+	tail = link;
+}
+
+// Remove an element from an island list.
+template<class T>
+inline void b3IslandManager::RemoveLink(T*& head, T*& tail, T* link)
+{
+	if (link->m_islandPrev)
+	{
+		link->m_islandPrev->m_islandNext = link->m_islandNext;
+	}
+	else
+	{
+		head = link->m_islandNext;
+	}
+
+	if (link->m_islandNext)
+	{
+		link->m_islandNext->m_islandPrev = link->m_islandPrev;
+	}
+	else
+	{
+		tail = link->m_islandPrev;
+	}
+
+	link->m_islandPrev = NULL;
+	link->m_islandNext = NULL;
+}
+
+// Append an island list to another island list.
+template<class T>
+inline void b3IslandManager::AppendList(T*& head, T*& tail, T* otherHead, T* otherTail)
+{
+	if (otherHead == NULL)
+	{
+		return;
+	}
+
+	if (tail)
+	{
+		tail->m_islandNext = otherHead;
+		otherHead->m_islandPrev = tail;
+	}
+	else
+	{
+		head = otherHead;
+	}
+	tail = otherTail;
+}
+
+b3IslandManager::b3IslandManager() : m_islandBlocks(sizeof(b3PersistentIsland))
+{
+	m_linkCount = 0;
+	m_contactMan = NULL;
+}
+
+b3IslandManager::~b3IslandManager()
+{
+	// The islands are freed by the block pool.
+}
+
+b3PersistentIsland* b3IslandManager::CreateIsland(bool awake)
+{
+	void* mem = m_islandBlocks.Allocate();
+	b3PersistentIsland* island = (b3PersistentIsland*)mem;
+	
+	island->parent = NULL;
+	
+	island->bodyHead = NULL;
+	island->bodyTail = NULL;
+	island->bodyCount = 0;
+	
+	island->contactHead = NULL;
+	island->contactTail = NULL;
+	island->contactCount = 0;
+	
+	island->jointHead = NULL;
+	island->jointTail = NULL;
+	island->jointCount = 0;
+	
+	island->constraintRemoveCount = 0;
+	island->awake = awake;
+
+	if (awake)
+	{
+		m_awakeList.PushFront(island);
+	}
+	else
+	{
+		m_sleepingList.PushFront(island);
+	}
+
+	return island;
+}
+
+void b3IslandManager::DestroyIsland(b3PersistentIsland* island)
+{
+	if (island->awake)
+	{
+		m_awakeList.Remove(island);
+	}
+	else
+	{
+		m_sleepingList.Remove(island);
+	}
+
+	m_islandBlocks.Free(island);
+}
+
+void b3IslandManager::PushBody(b3PersistentIsland* island, b3Body* b)
+{
+	PushLink(island->bodyHead, island->bodyTail, b);
+	b->m_island = island;
+	++island->bodyCount;
+}
+
+void b3IslandManager::PushContact(b3PersistentIsland* island, b3Contact* c)
+{
+	PushLink(island->contactHead, island->contactTail, c);
+	c->m_island = island;
+	++island->contactCount;
+}
+
+void b3IslandManager::PushJoint(b3PersistentIsland* island, b3Joint* j)
+{
+	PushLink(island->jointHead, island->jointTail, j);
+	j->m_island = island;
+	++island->jointCount;
+}
+
+void b3IslandManager::AddBody(b3Body* b)
+{
+	B3_ASSERT(b->m_type != e_staticBody);
+	B3_ASSERT(b->m_island == NULL);
+
+	b3PersistentIsland* island = CreateIsland(b->IsAwake());
+	PushBody(island, b);
+}
+
+void b3IslandManager::RemoveBody(b3Body* b)
+{
+	if (b->m_island == NULL)
+	{
+		return;
+	}
+
+	// The island might be the root of linked islands. 
+	// Merge them so the island can be destroyed safely.
+	MergeIslands();
+
+	b3PersistentIsland* island = b->m_island;
+	RemoveLink(island->bodyHead, island->bodyTail, b);
+	--island->bodyCount;
+	b->m_island = NULL;
+
+	if (island->bodyCount == 0)
+	{
+		B3_ASSERT(island->contactCount == 0);
+		B3_ASSERT(island->jointCount == 0);
+		DestroyIsland(island);
+	}
+	else
+	{
+		++island->constraintRemoveCount;
+	}
+}
+
+b3PersistentIsland* b3IslandManager::FindRoot(b3PersistentIsland* island)
+{
+	b3PersistentIsland* root = island;
+	while (root->parent)
+	{
+		root = root->parent;
+	}
+
+	// Compress the path.
+	while (island != root)
+	{
+		b3PersistentIsland* parent = island->parent;
+		island->parent = root;
+		island = parent;
+	}
+
+	return root;
+}
+
+b3PersistentIsland* b3IslandManager::LinkIslands(b3Body* bodyA, b3Body* bodyB)
+{
+	b3PersistentIsland* islandA = bodyA->m_island;
+	b3PersistentIsland* islandB = bodyB->m_island;
+
+	B3_ASSERT(islandA != NULL || islandB != NULL);
+
+	// Static bodies don't link islands.
+	if (islandA == NULL)
+	{
+		return FindRoot(islandB);
+	}
+
+	if (islandB == NULL)
+	{
+		return FindRoot(islandA);
+	}
+
+	b3PersistentIsland* rootA = FindRoot(islandA);
+	b3PersistentIsland* rootB = FindRoot(islandB);
+	
+	if (rootA == rootB)
+	{
+		return rootA;
+	}
+
+	// Keep the larger island.
+	if (rootA->bodyCount < rootB->bodyCount)
+	{
+		b3Swap(rootA, rootB);
+	}
+
+	if (rootA->awake == false && rootB->awake == false)
+	{
+		// Sleeping islands are not linked to other islands. 
+		// Merge them now so they don't need to be woken.
+		MergeIsland(rootA, rootB);
+		DestroyIsland(rootB);
+		return rootA;
+	}
+
+	// Linked islands must be awake so they are merged in the next step.
+	WakeIsland(rootA);
+	WakeIsland(rootB);
+
+	rootB->parent = rootA;
+	++m_linkCount;
+
+	return rootA;
+}
+
+void b3IslandManager::AddContact(b3Contact* c)
+{
+	B3_ASSERT(c->m_island == NULL);
+
+	b3Body* bodyA = c->GetShapeA()->GetBody();
+	b3Body* bodyB = c->GetShapeB()->GetBody();
+
+	b3PersistentIsland* island = LinkIslands(bodyA, bodyB);
+	PushContact(island, c);
+}
+
+void b3IslandManager::RemoveContact(b3Contact* c)
+{
+	b3PersistentIsland* island = c->m_island;
+	if (island == NULL)
+	{
+		return;
+	}
+
+	RemoveLink(island->contactHead, island->contactTail, c);
+	--island->contactCount;
+	c->m_island = NULL;
+
+	// Only contacts between non-static bodies connect the island.
+	b3Body* bodyA = c->GetShapeA()->GetBody();
+	b3Body* bodyB = c->GetShapeB()->GetBody();
+	if (bodyA->m_island && bodyB->m_island)
+	{
+		++island->constraintRemoveCount;
+	}
+}
+
+void b3IslandManager::AddJoint(b3Joint* j)
+{
+	B3_ASSERT(j->m_island == NULL);
+
+	b3Body* bodyA = j->GetBodyA();
+	b3Body* bodyB = j->GetBodyB();
+
+	// Joints between static bodies are not solved.
+	if (bodyA->m_island == NULL && bodyB->m_island == NULL)
+	{
+		return;
+	}
+
+	b3PersistentIsland* island = LinkIslands(bodyA, bodyB);
+	PushJoint(island, j);
+}
+
+void b3IslandManager::RemoveJoint(b3Joint* j)
+{
+	b3PersistentIsland* island = j->m_island;
+	if (island == NULL)
+	{
+		return;
+	}
+
+	RemoveLink(island->jointHead, island->jointTail, j);
+	--island->jointCount;
+	j->m_island = NULL;
+
+	// Only joints between non-static bodies connect the island.
+	if (j->GetBodyA()->m_island && j->GetBodyB()->m_island)
+	{
+		++island->constraintRemoveCount;
+	}
+}
+
+void b3IslandManager::WakeIsland(b3PersistentIsland* island)
+{
+	if (island->awake)
+	{
+		return;
+	}
+
+	m_sleepingList.Remove(island);
+	m_awakeList.PushFront(island);
+	island->awake = true;
+
+	// Activate the contacts of the island bodies.
+	for (b3Body* b = island->bodyHead; b; b = b->m_islandNext)
+	{
+		for (b3Shape* s = b->m_shapeList.m_head; s; s = s->m_next)
+		{
+			for (b3ContactEdge* ce = s->m_contactEdges.m_head; ce; ce = ce->m_next)
+			{
+				b3Contact* c = ce->contact;
+				if (c->IsActive() == false)
+				{
+					m_contactMan->ActivateContact(c);
+				}
+			}
+		}
+	}
+}
+
+void b3IslandManager::SleepIsland(b3PersistentIsland* island)
+{
+	B3_ASSERT(island->parent == NULL);
+
+	if (island->awake == false)
+	{
+		return;
+	}
+
+	m_awakeList.Remove(island);
+	m_sleepingList.PushFront(island);
+	island->awake = false;
+
+	// Deactivate the contacts of the island bodies. 
+	// A contact stays active if the other body is in an awake island.
+	for (b3Body* b = island->bodyHead; b; b = b->m_islandNext)
+	{
+		for (b3Shape* s = b->m_shapeList.m_head; s; s = s->m_next)
+		{
+			for (b3ContactEdge* ce = s->m_contactEdges.m_head; ce; ce = ce->m_next)
+			{
+				b3Contact* c = ce->contact;
+				if (c->IsActive() == false)
+				{
+					continue;
+				}
+
+				b3PersistentIsland* other = ce->other->GetBody()->m_island;
+				if (other && other->awake)
+				{
+					continue;
+				}
+
+				m_contactMan->DeactivateContact(c);
+			}
+		}
+	}
+}
+
+void b3IslandManager::MergeIsland(b3PersistentIsland* root, b3PersistentIsland* island)
+{
+	for (b3Body* b = island->bodyHead; b; b = b->m_islandNext)
+	{
+		b->m_island = root;
+	}
+
+	for (b3Contact* c = island->contactHead; c; c = c->m_islandNext)
+	{
+		c->m_island = root;
+	}
+
+	for (b3Joint* j = island->jointHead; j; j = j->m_islandNext)
+	{
+		j->m_island = root;
+	}
+
+	AppendList(root->bodyHead, root->bodyTail, island->bodyHead, island->bodyTail);
+	AppendList(root->contactHead, root->contactTail, island->contactHead, island->contactTail);
+	AppendList(root->jointHead, root->jointTail, island->jointHead, island->jointTail);
+
+	root->bodyCount += island->bodyCount;
+	root->contactCount += island->contactCount;
+	root->jointCount += island->jointCount;
+	root->constraintRemoveCount += island->constraintRemoveCount;
+}
+
+void b3IslandManager::MergeIslands()
+{
+	if (m_linkCount == 0)
+	{
+		return;
+	}
+
+	// Linked islands are awake. 
+	// Point them directly to their roots before any island is destroyed.
+	for (b3PersistentIsland* island = m_awakeList.m_head; island; island = island->m_next)
+	{
+		if (island->parent)
+		{
+			FindRoot(island);
+		}
+	}
+
+	b3PersistentIsland* island = m_awakeList.m_head;
+	while (island)
+	{
+		b3PersistentIsland* next = island->m_next;
+
+		if (island->parent)
+		{
+			b3PersistentIsland* root = island->parent;
+			B3_ASSERT(root->parent == NULL);
+			
+			MergeIsland(root, island);
+			DestroyIsland(island);
+		}
+
+		island = next;
+	}
+
+	m_linkCount = 0;
+}
+
+void b3IslandManager::SplitIsland(b3PersistentIsland* island, b3StackAllocator* allocator)
+{
+	B3_PROFILE("Split Island");
+
+	B3_ASSERT(island->parent == NULL);
+	B3_ASSERT(island->awake);
+
+	u32 bodyCount = island->bodyCount;
+	b3Body** bodies = (b3Body**)allocator->Allocate(bodyCount * sizeof(b3Body*));
+	b3Body** stack = (b3Body**)allocator->Allocate(bodyCount * sizeof(b3Body*));
+
+	u32 index = 0;
+	for (b3Body* b = island->bodyHead; b; b = b->m_islandNext)
+	{
+		bodies[index++] = b;
+	}
+
+	// Perform a depth first search from each body that wasn't reached yet. 
+	// An element is marked as visited when it is moved to its new island.
+	for (u32 i = 0; i < bodyCount; ++i)
+	{
+		b3Body* seed = bodies[i];
+		if (seed->m_island != island)
+		{
+			continue;
+		}
+
+		b3PersistentIsland* newIsland = CreateIsland(true);
+		
+		u32 stackCount = 0;
+		PushBody(newIsland, seed);
+		stack[stackCount++] = seed;
+
+		while (stackCount > 0)
+		{
+			b3Body* b = stack[--stackCount];
+
+			// Search all contacts of this island connected to this body.
+			for (b3Shape* s = b->m_shapeList.m_head; s; s = s->m_next)
+			{
+				for (b3ContactEdge* ce = s->m_contactEdges.m_head; ce; ce = ce->m_next)
+				{
+					b3Contact* contact = ce->contact;
+					if (contact->m_island != island)
+					{
+						continue;
+					}
+
+					PushContact(newIsland, contact);
+
+					b3Body* other = ce->other->GetBody();
+					if (other->m_island != island)
+					{
+						continue;
+					}
+
+					B3_ASSERT(stackCount < bodyCount);
+					PushBody(newIsland, other);
+					stack[stackCount++] = other;
+				}
+			}
+
+			// Search all joints of this island connected to this body.
+			for (b3JointEdge* je = b->m_jointEdges.m_head; je; je = je->m_next)
+			{
+				b3Joint* joint = je->joint;
+				if (joint->m_island != island)
+				{
+					continue;
+				}
+
+				PushJoint(newIsland, joint);
+
+				b3Body* other = je->other;
+				if (other->m_island != island)
+				{
+					continue;
+				}
+
+				B3_ASSERT(stackCount < bodyCount);
+				PushBody(newIsland, other);
+				stack[stackCount++] = other;
+			}
+		}
+	}
+
+	allocator->Free(stack);
+	allocator->Free(bodies);
+
+	// All elements were moved to the new islands.
+	DestroyIsland(island);
+}
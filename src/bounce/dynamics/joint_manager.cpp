@@ -17,11 +17,13 @@
 */
 
 #include <bounce/dynamics/joint_manager.h>
+#include <bounce/dynamics/island_manager.h>
 #include <bounce/dynamics/joints/joint.h>
 #include <bounce/dynamics/body.h>
 
 b3JointManager::b3JointManager() 
 {
+	m_islandMan = NULL;
 }
 
 b3Joint* b3JointManager::Create(const b3JointDef* def) 
@@ -57,6 +59,12 @@ b3Joint* b3JointManager::Create(const b3JointDef* def)
 	// Add the joint to the world joint list
 	m_jointList.PushFront(j);
 
+	// Link the islands of the bodies.
+	j->m_island = NULL;
+	j->m_islandPrev = NULL;
+	j->m_islandNext = NULL;
+	m_islandMan->AddJoint(j);
+
 	// Creating a joint doesn't awake the bodies.
 
 	return j;
@@ -67,6 +75,9 @@ void b3JointManager::Destroy(b3Joint* j)
 	b3Body* bodyA = j->GetBodyA();
 	b3Body* bodyB = j->GetBodyB();
 
+	// Remove the joint from its island.
+	m_islandMan->RemoveJoint(j);
+
 	// Remove the joint from body A's joint list.
 	bodyA->m_jointEdges.Remove(&j->m_pair.edgeA);
 
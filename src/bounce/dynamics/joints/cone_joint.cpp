@@ -18,7 +18,9 @@
 
 #include <bounce/dynamics/joints/cone_joint.h>
 #include <bounce/dynamics/body.h>
+#include <bounce/dynamics/world.h>
 #include <bounce/common/draw.h>
+#include <bounce/common/memory/snapshot.h>
 
 // C = dot(u2, u1) - cos(angle / 2) > 0
 // Cdot = dot(u2, omega1 x u1) + dot(u1, omega2 x u2)
@@ -66,14 +68,11 @@ void b3ConeJoint::InitializeConstraints(const b3SolverData* data)
 	b3Body* m_bodyA = GetBodyA();
 	b3Body* m_bodyB = GetBodyB();
 
-	m_indexA = m_bodyA->m_islandID;
-	m_indexB = m_bodyB->m_islandID;
-
 	m_mA = m_bodyA->m_invMass;
 	m_mB = m_bodyB->m_invMass;
 
-	m_localCenterA = m_bodyA->m_sweep.localCenter;
-	m_localCenterB = m_bodyB->m_sweep.localCenter;
+	m_localCenterA = m_bodyA->Sweep().localCenter;
+	m_localCenterB = m_bodyB->Sweep().localCenter;
 
 	m_localInvIA = m_bodyA->m_invI;
 	m_localInvIB = m_bodyB->m_invI;
@@ -329,6 +328,12 @@ bool b3ConeJoint::IsLimitEnabled() const
 
 void b3ConeJoint::SetEnableLimit(bool bit)
 {
+	b3Recorder* recorder = GetBodyA()->GetWorld()->GetRecorder();
+	if (recorder)
+	{
+		recorder->RecordFlag(e_recordSetEnableLimit, m_recordID, bit);
+	}
+
 	if (bit != m_enableLimit)
 	{
 		GetBodyA()->SetAwake(true);
@@ -346,6 +351,12 @@ float32 b3ConeJoint::GetConeAngle() const
 
 void b3ConeJoint::SetConeAngle(float32 angle)
 {
+	b3Recorder* recorder = GetBodyA()->GetWorld()->GetRecorder();
+	if (recorder)
+	{
+		recorder->RecordScalar(e_recordSetConeAngle, m_recordID, angle);
+	}
+
 	if (angle != m_coneAngle)
 	{
 		GetBodyA()->SetAwake(true);
@@ -361,4 +372,18 @@ void b3ConeJoint::Draw() const
 	b3Draw_draw->DrawTransform(xfA);
 	b3Transform xfB = GetFrameB();
 	b3Draw_draw->DrawTransform(xfB);
-}
\ No newline at end of file
+}
+
+void b3ConeJoint::WriteSnapshot(b3Snapshot* snapshot) const
+{
+	snapshot->Write(m_impulse);
+	snapshot->Write(m_limitState);
+	snapshot->Write(m_limitImpulse);
+}
+
+void b3ConeJoint::ReadSnapshot(b3SnapshotReader* reader)
+{
+	reader->Read(m_impulse);
+	reader->Read(m_limitState);
+	reader->Read(m_limitImpulse);
+}
@@ -18,6 +18,9 @@
 
 #include <bounce/dynamics/joints/joint_solver.h>
 #include <bounce/dynamics/joints/joint.h>
+#include <bounce/dynamics/graph_coloring.h>
+#include <bounce/common/memory/stack_allocator.h>
+#include <bounce/common/thread/task_scheduler.h>
 
 b3JointSolver::b3JointSolver(const b3JointSolverDef* def) 
 {
@@ -28,6 +31,119 @@ b3JointSolver::b3JointSolver(const b3JointSolverDef* def)
 	m_solverData.positions = def->positions;
 	m_solverData.velocities = def->velocities;
 	m_solverData.invInertias = def->invInertias;
+	m_allocator = def->allocator;
+	m_scheduler = def->scheduler;
+	m_colorBodies = NULL;
+	m_coloring = NULL;
+
+	if (m_scheduler)
+	{
+		B3_PROFILE("Color Joints");
+
+		// Joints don't skip bodies with zero mass. 
+		// Therefore all bodies are used for coloring.
+		m_colorBodies = (u32*)m_allocator->Allocate(2 * m_count * sizeof(u32));
+		u32 bodyCount = 0;
+		for (u32 i = 0; i < m_count; ++i)
+		{
+			b3Joint* j = m_joints[i];
+			m_colorBodies[2 * i + 0] = j->m_indexA;
+			m_colorBodies[2 * i + 1] = j->m_indexB;
+			bodyCount = b3Max(bodyCount, b3Max(j->m_indexA, j->m_indexB) + 1);
+		}
+
+		void* block = m_allocator->Allocate(sizeof(b3GraphColoring));
+		m_coloring = new (block) b3GraphColoring(m_allocator, m_colorBodies, m_count, bodyCount);
+	}
+}
+
+b3JointSolver::~b3JointSolver()
+{
+	if (m_coloring)
+	{
+		m_coloring->~b3GraphColoring();
+		m_allocator->Free(m_coloring);
+		m_allocator->Free(m_colorBodies);
+	}
+}
+
+struct b3JointColorContext
+{
+	b3JointSolver* solver;
+	const b3SolverData* solverData;
+	b3Joint** joints;
+	const u32* constraints;
+	u32 task;
+	bool solved[B3_MAX_THREADS];
+};
+
+void b3JointSolver::SolveColorRange(void* data, u32 begin, u32 end, u32 threadIndex)
+{
+	b3JointColorContext* context = (b3JointColorContext*)data;
+
+	for (u32 i = begin; i < end; ++i)
+	{
+		b3Joint* j = context->joints[context->constraints[i]];
+
+		switch (context->task)
+		{
+		case e_warmStartTask:
+		{
+			j->WarmStart(context->solverData);
+			break;
+		}
+		case e_solveVelocityTask:
+		{
+			j->SolveVelocityConstraints(context->solverData);
+			break;
+		}
+		case e_solvePositionTask:
+		{
+			bool jointSolved = j->SolvePositionConstraints(context->solverData);
+			context->solved[threadIndex] = context->solved[threadIndex] && jointSolved;
+			break;
+		}
+		default:
+		{
+			B3_ASSERT(false);
+			break;
+		}
+		}
+	}
+}
+
+bool b3JointSolver::SolveColors(u32 task)
+{
+	B3_ASSERT(m_coloring);
+
+	b3JointColorContext context;
+	context.solver = this;
+	context.solverData = &m_solverData;
+	context.joints = m_joints;
+	context.task = task;
+	for (u32 i = 0; i < B3_MAX_THREADS; ++i)
+	{
+		context.solved[i] = true;
+	}
+
+	// Solve the colors in order. 
+	// The joints of a color don't share a body.
+	for (u32 i = 0; i < m_coloring->GetColorCount(); ++i)
+	{
+		context.constraints = m_coloring->GetColorConstraints(i);
+		m_scheduler->ParallelFor(m_coloring->GetColorConstraintCount(i), B3_COLOR_GRAIN_SIZE, SolveColorRange, &context);
+	}
+
+	// Solve the remaining joints on this thread.
+	context.constraints = m_coloring->GetOverflowConstraints();
+	SolveColorRange(&context, 0, m_coloring->GetOverflowConstraintCount(), m_scheduler->GetThreadIndex());
+
+	bool solved = true;
+	for (u32 i = 0; i < B3_MAX_THREADS; ++i)
+	{
+		solved = solved && context.solved[i];
+	}
+	return solved;
 }
 
 void b3JointSolver::InitializeConstraints() 
@@ -41,6 +157,12 @@ void b3JointSolver::InitializeConstraints()
 
 void b3JointSolver::WarmStart() 
 {
+	if (m_coloring)
+	{
+		SolveColors(e_warmStartTask);
+		return;
+	}
+
 	for (u32 i = 0; i < m_count; ++i) 
 	{
 		b3Joint* j = m_joints[i];
@@ -50,6 +172,12 @@ void b3JointSolver::WarmStart()
 
 void b3JointSolver::SolveVelocityConstraints() 
 {
+	if (m_coloring)
+	{
+		SolveColors(e_solveVelocityTask);
+		return;
+	}
+
 	for (u32 i = 0; i < m_count; ++i) 
 	{
 		b3Joint* j = m_joints[i];
@@ -59,6 +187,11 @@ void b3JointSolver::SolveVelocityConstraints()
 
 bool b3JointSolver::SolvePositionConstraints() 
 {
+	if (m_coloring)
+	{
+		return SolveColors(e_solvePositionTask);
+	}
+
 	bool jointsSolved = true;
 	for (u32 i = 0; i < m_count; ++i) 
 	{
@@ -18,7 +18,9 @@
 
 #include <bounce/dynamics/joints/mouse_joint.h>
 #include <bounce/dynamics/body.h>
+#include <bounce/dynamics/world.h>
 #include <bounce/common/draw.h>
+#include <bounce/common/memory/snapshot.h>
 
 b3MouseJoint::b3MouseJoint(const b3MouseJointDef* def) 
 {
@@ -33,10 +35,9 @@ void b3MouseJoint::InitializeConstraints(const b3SolverData* data)
 {
 	b3Body* m_bodyB = GetBodyB();
 
-	m_indexB = m_bodyB->m_islandID;
 	m_mB = m_bodyB->m_invMass;
-	m_iB = m_bodyB->m_worldInvI;
-	m_localCenterB = m_bodyB->m_sweep.localCenter;
+	m_iB = m_bodyB->WorldInvI();
+	m_localCenterB = m_bodyB->Sweep().localCenter;
 
 	b3Vec3 xB = data->positions[m_indexB].x;
 	b3Quat qB = data->positions[m_indexB].q;
@@ -105,6 +106,12 @@ const b3Vec3& b3MouseJoint::GetTarget() const
 
 void b3MouseJoint::SetTarget(const b3Vec3& target)
 {
+	b3Recorder* recorder = GetBodyB()->GetWorld()->GetRecorder();
+	if (recorder)
+	{
+		recorder->RecordSetTarget(m_recordID, target);
+	}
+
 	m_worldTargetA = target;
 	GetBodyB()->SetAwake(true);
 }
@@ -117,4 +124,14 @@ void b3MouseJoint::Draw() const
 	b3Draw_draw->DrawPoint(a, 4.0f, b3Color_green);
 	b3Draw_draw->DrawPoint(b, 4.0f, b3Color_red);
 	b3Draw_draw->DrawSegment(a, b, b3Color_yellow);
-}
\ No newline at end of file
+}
+
+void b3MouseJoint::WriteSnapshot(b3Snapshot* snapshot) const
+{
+	snapshot->Write(m_impulse);
+}
+
+void b3MouseJoint::ReadSnapshot(b3SnapshotReader* reader)
+{
+	reader->Read(m_impulse);
+}
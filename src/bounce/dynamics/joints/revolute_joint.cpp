@@ -18,7 +18,9 @@
 
 #include <bounce/dynamics/joints/revolute_joint.h>
 #include <bounce/dynamics/body.h>
+#include <bounce/dynamics/world.h>
 #include <bounce/common/draw.h>
+#include <bounce/common/memory/snapshot.h>
 
 /*
 
@@ -233,12 +235,10 @@ void b3RevoluteJoint::InitializeConstraints(const b3SolverData* data)
 	b3Body* m_bodyA = GetBodyA();
 	b3Body* m_bodyB = GetBodyB();
 
-	m_indexA = m_bodyA->m_islandID;
-	m_indexB = m_bodyB->m_islandID;
 	m_mA = m_bodyA->m_invMass;
 	m_mB = m_bodyB->m_invMass;
-	m_localCenterA = m_bodyA->m_sweep.localCenter;
-	m_localCenterB = m_bodyB->m_sweep.localCenter;
+	m_localCenterA = m_bodyA->Sweep().localCenter;
+	m_localCenterB = m_bodyB->Sweep().localCenter;
 	m_localInvIA = m_bodyA->m_invI;
 	m_localInvIB = m_bodyB->m_invI;
 	
@@ -693,6 +693,12 @@ bool b3RevoluteJoint::IsLimitEnabled() const
 
 void b3RevoluteJoint::SetEnableLimit(bool bit)
 {
+	b3Recorder* recorder = GetBodyA()->GetWorld()->GetRecorder();
+	if (recorder)
+	{
+		recorder->RecordFlag(e_recordSetEnableLimit, m_recordID, bit);
+	}
+
 	if (bit != m_enableLimit)
 	{
 		GetBodyA()->SetAwake(true);
@@ -715,6 +721,12 @@ float32 b3RevoluteJoint::GetUpperLimit() const
 
 void b3RevoluteJoint::SetLimits(float32 lower, float32 upper)
 {
+	b3Recorder* recorder = GetBodyA()->GetWorld()->GetRecorder();
+	if (recorder)
+	{
+		recorder->RecordSetLimits(m_recordID, lower, upper);
+	}
+
 	B3_ASSERT(lower <= upper);
 	if (lower != m_lowerAngle || upper != m_upperAngle)
 	{
@@ -733,6 +745,12 @@ bool b3RevoluteJoint::IsMotorEnabled() const
 
 void b3RevoluteJoint::SetEnableMotor(bool bit)
 {
+	b3Recorder* recorder = GetBodyA()->GetWorld()->GetRecorder();
+	if (recorder)
+	{
+		recorder->RecordFlag(e_recordSetEnableMotor, m_recordID, bit);
+	}
+
 	if (bit != m_enableMotor)
 	{
 		GetBodyA()->SetAwake(true);
@@ -749,6 +767,12 @@ float32 b3RevoluteJoint::GetMotorSpeed() const
 
 void b3RevoluteJoint::SetMotorSpeed(float32 speed)
 {
+	b3Recorder* recorder = GetBodyA()->GetWorld()->GetRecorder();
+	if (recorder)
+	{
+		recorder->RecordScalar(e_recordSetMotorSpeed, m_recordID, speed);
+	}
+
 	GetBodyA()->SetAwake(true);
 	GetBodyB()->SetAwake(true);
 	m_motorSpeed = speed;
@@ -761,6 +785,12 @@ float32 b3RevoluteJoint::GetMaxMotorTorque() const
 
 void b3RevoluteJoint::SetMaxMotorTorque(float32 torque)
 {
+	b3Recorder* recorder = GetBodyA()->GetWorld()->GetRecorder();
+	if (recorder)
+	{
+		recorder->RecordScalar(e_recordSetMaxMotorTorque, m_recordID, torque);
+	}
+
 	GetBodyA()->SetAwake(true);
 	GetBodyB()->SetAwake(true);
 	m_maxMotorTorque = torque;
@@ -773,4 +803,22 @@ void b3RevoluteJoint::Draw() const
 	
 	b3Transform xfB = GetFrameB();
 	b3Draw_draw->DrawTransform(xfB);
-}
\ No newline at end of file
+}
+
+void b3RevoluteJoint::WriteSnapshot(b3Snapshot* snapshot) const
+{
+	snapshot->Write(m_motorImpulse);
+	snapshot->Write(m_limitState);
+	snapshot->Write(m_limitImpulse);
+	snapshot->Write(m_impulse);
+	snapshot->Write(m_axisImpulse);
+}
+
+void b3RevoluteJoint::ReadSnapshot(b3SnapshotReader* reader)
+{
+	reader->Read(m_motorImpulse);
+	reader->Read(m_limitState);
+	reader->Read(m_limitImpulse);
+	reader->Read(m_impulse);
+	reader->Read(m_axisImpulse);
+}
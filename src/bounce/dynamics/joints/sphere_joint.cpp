@@ -19,6 +19,7 @@
 #include <bounce/dynamics/joints/sphere_joint.h>
 #include <bounce/dynamics/body.h>
 #include <bounce/common/draw.h>
+#include <bounce/common/memory/snapshot.h>
 
 void b3SphereJointDef::Initialize(b3Body* bA, b3Body* bB, const b3Vec3& anchor)
 {
@@ -41,12 +42,10 @@ void b3SphereJoint::InitializeConstraints(const b3SolverData* data)
 	b3Body* m_bodyA = GetBodyA();
 	b3Body* m_bodyB = GetBodyB();
 
-	m_indexA = m_bodyA->m_islandID;
-	m_indexB = m_bodyB->m_islandID;
 	m_mA = m_bodyA->m_invMass;
 	m_mB = m_bodyB->m_invMass;
-	m_localCenterA = m_bodyA->m_sweep.localCenter;
-	m_localCenterB = m_bodyB->m_sweep.localCenter;
+	m_localCenterA = m_bodyA->Sweep().localCenter;
+	m_localCenterB = m_bodyB->Sweep().localCenter;
 	m_localInvIA = m_bodyA->m_invI;
 	m_localInvIB = m_bodyB->m_invI;
 	m_iA = data->invInertias[m_indexA];
@@ -176,3 +175,13 @@ void b3SphereJoint::Draw() const
 	
 	b3Draw_draw->DrawSegment(a, b, b3Color_yellow);
 }
+
+void b3SphereJoint::WriteSnapshot(b3Snapshot* snapshot) const
+{
+	snapshot->Write(m_impulse);
+}
+
+void b3SphereJoint::ReadSnapshot(b3SnapshotReader* reader)
+{
+	reader->Read(m_impulse);
+}
@@ -18,7 +18,9 @@
 
 #include <bounce/dynamics/joints/spring_joint.h>
 #include <bounce/dynamics/body.h>
+#include <bounce/dynamics/world.h>
 #include <bounce/common/draw.h>
+#include <bounce/common/memory/snapshot.h>
 
 // C = ||x2 + r2 - x1 - r1|| - length
 // Cdot = dot(n, v2 + w2 x r2 - v1 - w1 x r1)
@@ -71,6 +73,12 @@ float32 b3SpringJoint::GetLength() const
 
 void b3SpringJoint::SetLength(float32 length)
 {
+	b3Recorder* recorder = GetBodyA()->GetWorld()->GetRecorder();
+	if (recorder)
+	{
+		recorder->RecordScalar(e_recordSetLength, m_recordID, length);
+	}
+
 	m_length = length;
 }
 
@@ -81,6 +89,12 @@ float32 b3SpringJoint::GetFrequency() const
 
 void b3SpringJoint::SetFrequency(float32 frequency)
 {
+	b3Recorder* recorder = GetBodyA()->GetWorld()->GetRecorder();
+	if (recorder)
+	{
+		recorder->RecordScalar(e_recordSetFrequency, m_recordID, frequency);
+	}
+
 	m_frequencyHz = frequency;
 }
 
@@ -91,6 +105,12 @@ float32 b3SpringJoint::GetDampingRatio() const
 
 void b3SpringJoint::SetDampingRatio(float32 ratio)
 {
+	b3Recorder* recorder = GetBodyA()->GetWorld()->GetRecorder();
+	if (recorder)
+	{
+		recorder->RecordScalar(e_recordSetDampingRatio, m_recordID, ratio);
+	}
+
 	m_dampingRatio = ratio;
 }
 
@@ -99,14 +119,11 @@ void b3SpringJoint::InitializeConstraints(const b3SolverData* data)
 	b3Body* m_bodyA = GetBodyA();
 	b3Body* m_bodyB = GetBodyB();
 
-	m_indexA = m_bodyA->m_islandID;
-	m_indexB = m_bodyB->m_islandID;
-
 	m_mA = m_bodyA->m_invMass;
 	m_mB = m_bodyB->m_invMass;
 
-	m_localCenterA = m_bodyA->m_sweep.localCenter;
-	m_localCenterB = m_bodyB->m_sweep.localCenter;
+	m_localCenterA = m_bodyA->Sweep().localCenter;
+	m_localCenterB = m_bodyB->Sweep().localCenter;
 
 	m_localInvIA = m_bodyA->m_invI;
 	m_localInvIB = m_bodyB->m_invI;
@@ -272,4 +289,14 @@ void b3SpringJoint::Draw() const
 	b3Draw_draw->DrawPoint(b, 4.0f, b3Color_green);
 
 	b3Draw_draw->DrawSegment(a, b, b3Color_yellow);
-}
\ No newline at end of file
+}
+
+void b3SpringJoint::WriteSnapshot(b3Snapshot* snapshot) const
+{
+	snapshot->Write(m_impulse);
+}
+
+void b3SpringJoint::ReadSnapshot(b3SnapshotReader* reader)
+{
+	reader->Read(m_impulse);
+}
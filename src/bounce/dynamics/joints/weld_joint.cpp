@@ -19,6 +19,7 @@
 #include <bounce/dynamics/joints/weld_joint.h>
 #include <bounce/dynamics/body.h>
 #include <bounce/common/draw.h>
+#include <bounce/common/memory/snapshot.h>
 
 /*
 P = [0 1 0 0]
@@ -118,14 +119,12 @@ void b3WeldJoint::InitializeConstraints(const b3SolverData* data)
 	b3Body* m_bodyA = GetBodyA();
 	b3Body* m_bodyB = GetBodyB();
 
-	m_indexA = m_bodyA->m_islandID;
-	m_indexB = m_bodyB->m_islandID;
 	m_mA = m_bodyA->m_invMass;
 	m_mB = m_bodyB->m_invMass;
-	m_iA = m_bodyA->m_worldInvI;
-	m_iB = m_bodyB->m_worldInvI;
-	m_localCenterA = m_bodyA->m_sweep.localCenter;
-	m_localCenterB = m_bodyB->m_sweep.localCenter;
+	m_iA = m_bodyA->WorldInvI();
+	m_iB = m_bodyB->WorldInvI();
+	m_localCenterA = m_bodyA->Sweep().localCenter;
+	m_localCenterB = m_bodyB->Sweep().localCenter;
 
 	b3Quat qA = data->positions[m_indexA].q;
 	b3Quat qB = data->positions[m_indexB].q;
@@ -320,4 +319,16 @@ void b3WeldJoint::Draw() const
 	b3Draw_draw->DrawPoint(b, 4.0f, b3Color_green);
 	
 	b3Draw_draw->DrawSegment(a, b, b3Color_yellow);
-}
\ No newline at end of file
+}
+
+void b3WeldJoint::WriteSnapshot(b3Snapshot* snapshot) const
+{
+	snapshot->Write(m_impulse);
+	snapshot->Write(m_axisImpulse);
+}
+
+void b3WeldJoint::ReadSnapshot(b3SnapshotReader* reader)
+{
+	reader->Read(m_impulse);
+	reader->Read(m_axisImpulse);
+}
@@ -0,0 +1,442 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson https://irlanrobson.github.io
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <bounce/dynamics/recorder.h>
+#include <bounce/dynamics/world.h>
+#include <bounce/dynamics/body.h>
+#include <bounce/dynamics/shapes/sphere_shape.h>
+#include <bounce/dynamics/shapes/capsule_shape.h>
+#include <bounce/dynamics/shapes/hull_shape.h>
+#include <bounce/dynamics/shapes/mesh_shape.h>
+#include <bounce/dynamics/joints/mouse_joint.h>
+#include <bounce/dynamics/joints/spring_joint.h>
+#include <bounce/dynamics/joints/weld_joint.h>
+#include <bounce/dynamics/joints/revolute_joint.h>
+#include <bounce/dynamics/joints/sphere_joint.h>
+#include <bounce/dynamics/joints/cone_joint.h>
+#include <bounce/collision/shapes/hull.h>
+#include <bounce/collision/shapes/mesh.h>
+#include <stdio.h>
+
+b3Recorder::b3Recorder()
+{
+	WriteHeader();
+}
+
+b3Recorder::~b3Recorder()
+{
+}
+
+void b3Recorder::Clear()
+{
+	m_log.Clear();
+	m_hulls.Resize(0);
+	m_meshes.Resize(0);
+	WriteHeader();
+}
+
+void b3Recorder::WriteHeader()
+{
+	m_log.Write<u32>(B3_RECORDER_MAGIC);
+	m_log.Write<u32>(B3_RECORDER_VERSION);
+	m_stepCount = 0;
+	m_bodyCount = 0;
+	m_shapeCount = 0;
+	m_jointCount = 0;
+}
+
+bool b3Recorder::Save(const char* fileName) const
+{
+	FILE* file = fopen(fileName, "wb");
+	if (file == NULL)
+	{
+		return false;
+	}
+
+	size_t size = m_log.GetSize();
+	bool written = fwrite(m_log.GetData(), 1, size, file) == size;
+	
+	fclose(file);
+
+	return written;
+}
+
+void b3Recorder::RecordSettings(const b3World* world)
+{
+	m_log.Write<u8>(e_recordSettings);
+	m_log.Write(world->m_gravity);
+	m_log.Write(world->m_sleeping);
+	m_log.Write(world->m_warmStarting);
+	m_log.Write(world->m_graphColoring);
+	m_log.Write(world->m_wideSolver);
+	m_log.Write(world->m_subStepCount);
+	m_log.Write(world->m_speculativeContacts);
+}
+
+void b3Recorder::RecordStep(float32 dt, u32 velocityIterations, u32 positionIterations)
+{
+	m_log.Write<u8>(e_recordStep);
+	m_log.Write(dt);
+	m_log.Write(velocityIterations);
+	m_log.Write(positionIterations);
+	++m_stepCount;
+}
+
+u32 b3Recorder::RecordCreateBody(const b3BodyDef& def)
+{
+	m_log.Write<u8>(e_recordCreateBody);
+	m_log.Write<u32>(def.type);
+	m_log.Write(def.awake);
+	m_log.Write(def.bullet);
+	m_log.Write(def.fixedRotationX);
+	m_log.Write(def.fixedRotationY);
+	m_log.Write(def.fixedRotationZ);
+	m_log.Write(def.position);
+	m_log.Write(def.orientation);
+	m_log.Write(def.linearVelocity);
+	m_log.Write(def.angularVelocity);
+	m_log.Write(def.linearDamping);
+	m_log.Write(def.angularDamping);
+	m_log.Write(def.gravityScale);
+	return m_bodyCount++;
+}
+
+void b3Recorder::RecordDestroyBody(u32 body)
+{
+	m_log.Write<u8>(e_recordDestroyBody);
+	m_log.Write(body);
+}
+
+u32 b3Recorder::RecordHull(const b3Hull* hull)
+{
+	for (u32 i = 0; i < m_hulls.Count(); ++i)
+	{
+		if (m_hulls[i] == hull)
+		{
+			return i;
+		}
+	}
+
+	m_log.Write<u8>(e_recordCreateHull);
+	m_log.Write(hull->centroid);
+	m_log.Write(hull->vertexCount);
+	m_log.Write(hull->vertices, hull->vertexCount * sizeof(b3Vec3));
+	m_log.Write(hull->edgeCount);
+	m_log.Write(hull->edges, hull->edgeCount * sizeof(b3HalfEdge));
+	m_log.Write(hull->faceCount);
+	m_log.Write(hull->faces, hull->faceCount * sizeof(b3Face));
+	m_log.Write(hull->planes, hull->faceCount * sizeof(b3Plane));
+
+	m_hulls.PushBack(hull);
+	return m_hulls.Count() - 1;
+}
+
+u32 b3Recorder::RecordMesh(const b3Mesh* mesh)
+{
+	for (u32 i = 0; i < m_meshes.Count(); ++i)
+	{
+		if (m_meshes[i] == mesh)
+		{
+			return i;
+		}
+	}
+
+	// The tree is rebuilt by the replayer.
+	m_log.Write<u8>(e_recordCreateMesh);
+	m_log.Write(mesh->vertexCount);
+	m_log.Write(mesh->vertices, mesh->vertexCount * sizeof(b3Vec3));
+	m_log.Write(mesh->triangleCount);
+	m_log.Write(mesh->triangles, mesh->triangleCount * sizeof(b3Triangle));
+
+	m_meshes.PushBack(mesh);
+	return m_meshes.Count() - 1;
+}
+
+u32 b3Recorder::RecordCreateShape(u32 body, const b3ShapeDef& def)
+{
+	const b3Shape* shape = def.shape;
+
+	// The geometry must be written before the call that references it.
+	u32 geometry = B3_MAX_U32;
+	if (shape->GetType() == e_hullShape)
+	{
+		geometry = RecordHull(((b3HullShape*)shape)->m_hull);
+	}
+	else if (shape->GetType() == e_meshShape)
+	{
+		geometry = RecordMesh(((b3MeshShape*)shape)->m_mesh);
+	}
+
+	m_log.Write<u8>(e_recordCreateShape);
+	m_log.Write(body);
+	m_log.Write(def.isSensor);
+	m_log.Write(def.density);
+	m_log.Write(def.restitution);
+	m_log.Write(def.friction);
+	m_log.Write(def.filter.categoryBits);
+	m_log.Write(def.filter.maskBits);
+	m_log.Write(def.filter.groupIndex);
+	m_log.Write<u32>(shape->GetType());
+	m_log.Write(shape->m_radius);
+
+	switch (shape->GetType())
+	{
+	case e_sphereShape:
+	{
+		const b3SphereShape* sphere = (b3SphereShape*)shape;
+		m_log.Write(sphere->m_center);
+		break;
+	}
+	case e_capsuleShape:
+	{
+		const b3CapsuleShape* capsule = (b3CapsuleShape*)shape;
+		m_log.Write(capsule->m_centers[0]);
+		m_log.Write(capsule->m_centers[1]);
+		break;
+	}
+	case e_hullShape:
+	case e_meshShape:
+	{
+		m_log.Write(geometry);
+		break;
+	}
+	default:
+	{
+		B3_ASSERT(false);
+		break;
+	}
+	}
+
+	return m_shapeCount++;
+}
+
+void b3Recorder::RecordDestroyShape(u32 shape)
+{
+	m_log.Write<u8>(e_recordDestroyShape);
+	m_log.Write(shape);
+}
+
+u32 b3Recorder::RecordCreateJoint(u32 bodyA, u32 bodyB, const b3JointDef& def)
+{
+	m_log.Write<u8>(e_recordCreateJoint);
+	m_log.Write<u32>(def.type);
+	m_log.Write(bodyA);
+	m_log.Write(bodyB);
+	m_log.Write(def.collideLinked);
+
+	switch (def.type)
+	{
+	case e_mouseJoint:
+	{
+		const b3MouseJointDef& jd = (const b3MouseJointDef&)def;
+		m_log.Write(jd.target);
+		m_log.Write(jd.maxForce);
+		break;
+	}
+	case e_springJoint:
+	{
+		const b3SpringJointDef& jd = (const b3SpringJointDef&)def;
+		m_log.Write(jd.localAnchorA);
+		m_log.Write(jd.localAnchorB);
+		m_log.Write(jd.length);
+		m_log.Write(jd.frequencyHz);
+		m_log.Write(jd.dampingRatio);
+		break;
+	}
+	case e_weldJoint:
+	{
+		const b3WeldJointDef& jd = (const b3WeldJointDef&)def;
+		m_log.Write(jd.localAnchorA);
+		m_log.Write(jd.localAnchorB);
+		m_log.Write(jd.referenceRotation);
+		break;
+	}
+	case e_revoluteJoint:
+	{
+		const b3RevoluteJointDef& jd = (const b3RevoluteJointDef&)def;
+		m_log.Write(jd.localAnchorA);
+		m_log.Write(jd.localRotationA);
+		m_log.Write(jd.localAnchorB);
+		m_log.Write(jd.localRotationB);
+		m_log.Write(jd.referenceRotation);
+		m_log.Write(jd.enableLimit);
+		m_log.Write(jd.lowerAngle);
+		m_log.Write(jd.upperAngle);
+		m_log.Write(jd.enableMotor);
+		m_log.Write(jd.motorSpeed);
+		m_log.Write(jd.maxMotorTorque);
+		break;
+	}
+	case e_sphereJoint:
+	{
+		const b3SphereJointDef& jd = (const b3SphereJointDef&)def;
+		m_log.Write(jd.localAnchorA);
+		m_log.Write(jd.localAnchorB);
+		break;
+	}
+	case e_coneJoint:
+	{
+		const b3ConeJointDef& jd = (const b3ConeJointDef&)def;
+		m_log.Write(jd.localFrameA);
+		m_log.Write(jd.localFrameB);
+		m_log.Write(jd.enableLimit);
+		m_log.Write(jd.coneAngle);
+		break;
+	}
+	default:
+	{
+		B3_ASSERT(false);
+		break;
+	}
+	}
+
+	return m_jointCount++;
+}
+
+void b3Recorder::RecordDestroyJoint(u32 joint)
+{
+	m_log.Write<u8>(e_recordDestroyJoint);
+	m_log.Write(joint);
+}
+
+void b3Recorder::RecordSetType(u32 body, u32 type)
+{
+	m_log.Write<u8>(e_recordSetType);
+	m_log.Write(body);
+	m_log.Write(type);
+}
+
+void b3Recorder::RecordSetTransform(u32 body, const b3Vec3& position, const b3Vec3& axis, float32 angle)
+{
+	m_log.Write<u8>(e_recordSetTransform);
+	m_log.Write(body);
+	m_log.Write(position);
+	m_log.Write(axis);
+	m_log.Write(angle);
+}
+
+void b3Recorder::RecordBodyVector(b3RecordType type, u32 body, const b3Vec3& v)
+{
+	m_log.Write<u8>(type);
+	m_log.Write(body);
+	m_log.Write(v);
+}
+
+void b3Recorder::RecordBodyVectorWake(b3RecordType type, u32 body, const b3Vec3& v, bool wake)
+{
+	m_log.Write<u8>(type);
+	m_log.Write(body);
+	m_log.Write(v);
+	m_log.Write(wake);
+}
+
+void b3Recorder::RecordBodyPointWake(b3RecordType type, u32 body, const b3Vec3& v, const b3Vec3& point, bool wake)
+{
+	m_log.Write<u8>(type);
+	m_log.Write(body);
+	m_log.Write(v);
+	m_log.Write(point);
+	m_log.Write(wake);
+}
+
+void b3Recorder::RecordSetMassData(u32 body, const b3MassData* data)
+{
+	m_log.Write<u8>(e_recordSetMassData);
+	m_log.Write(body);
+	m_log.Write(data->center);
+	m_log.Write(data->mass);
+	m_log.Write(data->I);
+}
+
+void b3Recorder::RecordResetMass(u32 body)
+{
+	m_log.Write<u8>(e_recordResetMass);
+	m_log.Write(body);
+}
+
+void b3Recorder::RecordScalar(b3RecordType type, u32 object, float32 value)
+{
+	m_log.Write<u8>(type);
+	m_log.Write(object);
+	m_log.Write(value);
+}
+
+void b3Recorder::RecordFlag(b3RecordType type, u32 object, bool flag)
+{
+	m_log.Write<u8>(type);
+	m_log.Write(object);
+	m_log.Write(flag);
+}
+
+void b3Recorder::RecordSetTarget(u32 joint, const b3Vec3& target)
+{
+	m_log.Write<u8>(e_recordSetTarget);
+	m_log.Write(joint);
+	m_log.Write(target);
+}
+
+void b3Recorder::RecordSetLimits(u32 joint, float32 lower, float32 upper)
+{
+	m_log.Write<u8>(e_recordSetLimits);
+	m_log.Write(joint);
+	m_log.Write(lower);
+	m_log.Write(upper);
+}
+
+void b3Recorder::RecordSetFilter(u32 shape, const b3Filter& filter)
+{
+	m_log.Write<u8>(e_recordSetFilter);
+	m_log.Write(shape);
+	m_log.Write(filter.categoryBits);
+	m_log.Write(filter.maskBits);
+	m_log.Write(filter.groupIndex);
+}
+
+void b3Recorder::RecordChecksum(const b3World* world)
+{
+	m_log.Write<u8>(e_recordChecksum);
+	m_log.Write(b3ComputeChecksum(world));
+}
+
+// Hash bytes with FNV-1a.
+static inline u32 b3HashBytes(u32 hash, const void* data, u32 size)
+{
+	const u8* bytes = (const u8*)data;
+	for (u32 i = 0; i < size; ++i)
+	{
+		hash ^= bytes[i];
+		hash *= 16777619;
+	}
+	return hash;
+}
+
+u32 b3ComputeChecksum(const b3World* world)
+{
+	u32 hash = 2166136261;
+	for (const b3Body* b = world->GetBodyList().m_head; b; b = b->GetNext())
+	{
+		b3Transform xf = b->GetTransform();
+		b3Vec3 v = b->GetLinearVelocity();
+		b3Vec3 w = b->GetAngularVelocity();
+
+		hash = b3HashBytes(hash, &xf, sizeof(b3Transform));
+		hash = b3HashBytes(hash, &v, sizeof(b3Vec3));
+		hash = b3HashBytes(hash, &w, sizeof(b3Vec3));
+	}
+	return hash;
+}
@@ -0,0 +1,751 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson https://irlanrobson.github.io
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <bounce/dynamics/replayer.h>
+#include <bounce/dynamics/recorder.h>
+#include <bounce/dynamics/world.h>
+#include <bounce/dynamics/body.h>
+#include <bounce/dynamics/shapes/sphere_shape.h>
+#include <bounce/dynamics/shapes/capsule_shape.h>
+#include <bounce/dynamics/shapes/hull_shape.h>
+#include <bounce/dynamics/shapes/mesh_shape.h>
+#include <bounce/dynamics/joints/mouse_joint.h>
+#include <bounce/dynamics/joints/spring_joint.h>
+#include <bounce/dynamics/joints/weld_joint.h>
+#include <bounce/dynamics/joints/revolute_joint.h>
+#include <bounce/dynamics/joints/sphere_joint.h>
+#include <bounce/dynamics/joints/cone_joint.h>
+#include <bounce/collision/shapes/hull.h>
+#include <bounce/collision/shapes/mesh.h>
+#include <stdio.h>
+#include <string.h>
+
+b3Replayer::b3Replayer()
+{
+	m_data = NULL;
+	m_size = 0;
+	m_offset = 0;
+	m_stepCount = 0;
+	m_hasChecksum = false;
+	m_checksum = 0;
+}
+
+b3Replayer::~b3Replayer()
+{
+	Destroy();
+}
+
+void b3Replayer::Destroy()
+{
+	Rewind();
+
+	if (m_data)
+	{
+		b3Free(m_data);
+		m_data = NULL;
+	}
+	m_size = 0;
+	m_offset = 0;
+}
+
+void b3Replayer::Rewind()
+{
+	// Skip the header.
+	m_offset = m_data ? 2 * sizeof(u32) : 0;
+	m_stepCount = 0;
+	m_hasChecksum = false;
+
+	for (u32 i = 0; i < m_hulls.Count(); ++i)
+	{
+		b3Free(m_hulls[i]);
+	}
+	m_hulls.Resize(0);
+
+	for (u32 i = 0; i < m_meshes.Count(); ++i)
+	{
+		b3Mesh* mesh = m_meshes[i];
+		b3Free(mesh->vertices);
+		b3Free(mesh->triangles);
+		mesh->~b3Mesh();
+		b3Free(mesh);
+	}
+	m_meshes.Resize(0);
+
+	m_bodies.Resize(0);
+	m_shapes.Resize(0);
+	m_joints.Resize(0);
+}
+
+bool b3Replayer::Load(const void* data, u32 size)
+{
+	Destroy();
+
+	if (size < 2 * sizeof(u32))
+	{
+		return false;
+	}
+
+	u32 header[2];
+	memcpy(header, data, sizeof(header));
+	if (header[0] != B3_RECORDER_MAGIC || header[1] != B3_RECORDER_VERSION)
+	{
+		return false;
+	}
+
+	m_data = (u8*)b3Alloc(size);
+	memcpy(m_data, data, size);
+	m_size = size;
+	m_offset = sizeof(header);
+
+	return true;
+}
+
+bool b3Replayer::Load(const char* fileName)
+{
+	FILE* file = fopen(fileName, "rb");
+	if (file == NULL)
+	{
+		return false;
+	}
+
+	fseek(file, 0, SEEK_END);
+	long size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	if (size <= 0)
+	{
+		fclose(file);
+		return false;
+	}
+
+	void* data = b3Alloc(u32(size));
+	bool read = fread(data, 1, size_t(size), file) == size_t(size);
+	fclose(file);
+
+	bool loaded = read && Load(data, u32(size));
+	
+	b3Free(data);
+
+	return loaded;
+}
+
+void b3Replayer::Read(void* data, u32 size)
+{
+	B3_ASSERT(m_offset + size <= m_size);
+	memcpy(data, m_data + m_offset, size);
+	m_offset += size;
+}
+
+bool b3Replayer::Step(b3World* world)
+{
+	while (m_offset < m_size)
+	{
+		b3RecordType type = b3RecordType(Read<u8>());
+
+		switch (type)
+		{
+		case e_recordSettings:
+		{
+			ReadSettings(world);
+			break;
+		}
+		case e_recordStep:
+		{
+			float32 dt = Read<float32>();
+			u32 velocityIterations = Read<u32>();
+			u32 positionIterations = Read<u32>();
+			
+			world->Step(dt, velocityIterations, positionIterations);
+			
+			// The checksum of the world follows the step.
+			m_hasChecksum = false;
+			if (m_offset < m_size && m_data[m_offset] == e_recordChecksum)
+			{
+				++m_offset;
+				m_checksum = Read<u32>();
+				m_hasChecksum = true;
+			}
+
+			++m_stepCount;
+			return true;
+		}
+		case e_recordCreateBody:
+		{
+			ReadCreateBody(world);
+			break;
+		}
+		case e_recordDestroyBody:
+		{
+			u32 id = Read<u32>();
+			b3Body* body = m_bodies[id];
+
+			// The shapes and joints of the body are destroyed along with it.
+			for (u32 i = 0; i < m_shapes.Count(); ++i)
+			{
+				b3Shape* s = m_shapes[i];
+				if (s && s->GetBody() == body)
+				{
+					m_shapes[i] = NULL;
+				}
+			}
+
+			for (u32 i = 0; i < m_joints.Count(); ++i)
+			{
+				b3Joint* j = m_joints[i];
+				if (j && (j->GetBodyA() == body || j->GetBodyB() == body))
+				{
+					m_joints[i] = NULL;
+				}
+			}
+
+			world->DestroyBody(body);
+			m_bodies[id] = NULL;
+			break;
+		}
+		case e_recordCreateHull:
+		{
+			ReadCreateHull();
+			break;
+		}
+		case e_recordCreateMesh:
+		{
+			ReadCreateMesh();
+			break;
+		}
+		case e_recordCreateShape:
+		{
+			ReadCreateShape();
+			break;
+		}
+		case e_recordDestroyShape:
+		{
+			u32 id = Read<u32>();
+			b3Shape* shape = m_shapes[id];
+			shape->GetBody()->DestroyShape(shape);
+			m_shapes[id] = NULL;
+			break;
+		}
+		case e_recordCreateJoint:
+		{
+			ReadCreateJoint(world);
+			break;
+		}
+		case e_recordDestroyJoint:
+		{
+			u32 id = Read<u32>();
+			world->DestroyJoint(m_joints[id]);
+			m_joints[id] = NULL;
+			break;
+		}
+		case e_recordSetType:
+		{
+			b3Body* body = m_bodies[Read<u32>()];
+			body->SetType(b3BodyType(Read<u32>()));
+			break;
+		}
+		case e_recordSetTransform:
+		{
+			b3Body* body = m_bodies[Read<u32>()];
+			b3Vec3 position = Read<b3Vec3>();
+			b3Vec3 axis = Read<b3Vec3>();
+			float32 angle = Read<float32>();
+			body->SetTransform(position, axis, angle);
+			break;
+		}
+		case e_recordSetLinearVelocity:
+		{
+			b3Body* body = m_bodies[Read<u32>()];
+			body->SetLinearVelocity(Read<b3Vec3>());
+			break;
+		}
+		case e_recordSetAngularVelocity:
+		{
+			b3Body* body = m_bodies[Read<u32>()];
+			body->SetAngularVelocity(Read<b3Vec3>());
+			break;
+		}
+		case e_recordApplyForce:
+		{
+			b3Body* body = m_bodies[Read<u32>()];
+			b3Vec3 force = Read<b3Vec3>();
+			b3Vec3 point = Read<b3Vec3>();
+			bool wake = Read<bool>();
+			body->ApplyForce(force, point, wake);
+			break;
+		}
+		case e_recordApplyForceToCenter:
+		{
+			b3Body* body = m_bodies[Read<u32>()];
+			b3Vec3 force = Read<b3Vec3>();
+			bool wake = Read<bool>();
+			body->ApplyForceToCenter(force, wake);
+			break;
+		}
+		case e_recordApplyTorque:
+		{
+			b3Body* body = m_bodies[Read<u32>()];
+			b3Vec3 torque = Read<b3Vec3>();
+			bool wake = Read<bool>();
+			body->ApplyTorque(torque, wake);
+			break;
+		}
+		case e_recordApplyLinearImpulse:
+		{
+			b3Body* body = m_bodies[Read<u32>()];
+			b3Vec3 impulse = Read<b3Vec3>();
+			b3Vec3 point = Read<b3Vec3>();
+			bool wake = Read<bool>();
+			body->ApplyLinearImpulse(impulse, point, wake);
+			break;
+		}
+		case e_recordApplyAngularImpulse:
+		{
+			b3Body* body = m_bodies[Read<u32>()];
+			b3Vec3 impulse = Read<b3Vec3>();
+			bool wake = Read<bool>();
+			body->ApplyAngularImpulse(impulse, wake);
+			break;
+		}
+		case e_recordSetMassData:
+		{
+			b3Body* body = m_bodies[Read<u32>()];
+			b3MassData data;
+			data.center = Read<b3Vec3>();
+			data.mass = Read<float32>();
+			data.I = Read<b3Mat33>();
+			body->SetMassData(&data);
+			break;
+		}
+		case e_recordResetMass:
+		{
+			b3Body* body = m_bodies[Read<u32>()];
+			body->ResetMass();
+			break;
+		}
+		case e_recordSetLinearDamping:
+		{
+			b3Body* body = m_bodies[Read<u32>()];
+			body->SetLinearDamping(Read<float32>());
+			break;
+		}
+		case e_recordSetAngularDamping:
+		{
+			b3Body* body = m_bodies[Read<u32>()];
+			body->SetAngularDamping(Read<float32>());
+			break;
+		}
+		case e_recordSetGravityScale:
+		{
+			b3Body* body = m_bodies[Read<u32>()];
+			body->SetGravityScale(Read<float32>());
+			break;
+		}
+		case e_recordSetBullet:
+		{
+			b3Body* body = m_bodies[Read<u32>()];
+			body->SetBullet(Read<bool>());
+			break;
+		}
+		case e_recordSetAwake:
+		{
+			b3Body* body = m_bodies[Read<u32>()];
+			body->SetAwake(Read<bool>());
+			break;
+		}
+		case e_recordSetTarget:
+		{
+			b3MouseJoint* joint = (b3MouseJoint*)m_joints[Read<u32>()];
+			joint->SetTarget(Read<b3Vec3>());
+			break;
+		}
+		case e_recordSetEnableLimit:
+		{
+			b3Joint* joint = m_joints[Read<u32>()];
+			bool flag = Read<bool>();
+			if (joint->GetType() == e_revoluteJoint)
+			{
+				((b3RevoluteJoint*)joint)->SetEnableLimit(flag);
+			}
+			else
+			{
+				B3_ASSERT(joint->GetType() == e_coneJoint);
+				((b3ConeJoint*)joint)->SetEnableLimit(flag);
+			}
+			break;
+		}
+		case e_recordSetLimits:
+		{
+			b3RevoluteJoint* joint = (b3RevoluteJoint*)m_joints[Read<u32>()];
+			float32 lower = Read<float32>();
+			float32 upper = Read<float32>();
+			joint->SetLimits(lower, upper);
+			break;
+		}
+		case e_recordSetEnableMotor:
+		{
+			b3RevoluteJoint* joint = (b3RevoluteJoint*)m_joints[Read<u32>()];
+			joint->SetEnableMotor(Read<bool>());
+			break;
+		}
+		case e_recordSetMotorSpeed:
+		{
+			b3RevoluteJoint* joint = (b3RevoluteJoint*)m_joints[Read<u32>()];
+			joint->SetMotorSpeed(Read<float32>());
+			break;
+		}
+		case e_recordSetMaxMotorTorque:
+		{
+			b3RevoluteJoint* joint = (b3RevoluteJoint*)m_joints[Read<u32>()];
+			joint->SetMaxMotorTorque(Read<float32>());
+			break;
+		}
+		case e_recordSetLength:
+		{
+			b3SpringJoint* joint = (b3SpringJoint*)m_joints[Read<u32>()];
+			joint->SetLength(Read<float32>());
+			break;
+		}
+		case e_recordSetFrequency:
+		{
+			b3SpringJoint* joint = (b3SpringJoint*)m_joints[Read<u32>()];
+			joint->SetFrequency(Read<float32>());
+			break;
+		}
+		case e_recordSetDampingRatio:
+		{
+			b3SpringJoint* joint = (b3SpringJoint*)m_joints[Read<u32>()];
+			joint->SetDampingRatio(Read<float32>());
+			break;
+		}
+		case e_recordSetConeAngle:
+		{
+			b3ConeJoint* joint = (b3ConeJoint*)m_joints[Read<u32>()];
+			joint->SetConeAngle(Read<float32>());
+			break;
+		}
+		case e_recordSetSensor:
+		{
+			b3Shape* shape = m_shapes[Read<u32>()];
+			shape->SetSensor(Read<bool>());
+			break;
+		}
+		case e_recordSetFilter:
+		{
+			b3Shape* shape = m_shapes[Read<u32>()];
+			b3Filter filter;
+			filter.categoryBits = Read<u32>();
+			filter.maskBits = Read<u32>();
+			filter.groupIndex = Read<i32>();
+			shape->SetFilter(filter);
+			break;
+		}
+		case e_recordSetDensity:
+		{
+			b3Shape* shape = m_shapes[Read<u32>()];
+			shape->SetDensity(Read<float32>());
+			break;
+		}
+		case e_recordSetRestitution:
+		{
+			b3Shape* shape = m_shapes[Read<u32>()];
+			shape->SetRestitution(Read<float32>());
+			break;
+		}
+		case e_recordSetFriction:
+		{
+			b3Shape* shape = m_shapes[Read<u32>()];
+			shape->SetFriction(Read<float32>());
+			break;
+		}
+		default:
+		{
+			// Unknown call. The log is corrupt.
+			B3_ASSERT(false);
+			m_offset = m_size;
+			break;
+		}
+		}
+	}
+
+	return false;
+}
+
+bool b3Replayer::Verify(const b3World* world) const
+{
+	if (m_hasChecksum == false)
+	{
+		return true;
+	}
+
+	return b3ComputeChecksum(world) == m_checksum;
+}
+
+void b3Replayer::ReadSettings(b3World* world)
+{
+	world->SetGravity(Read<b3Vec3>());
+	world->SetSleeping(Read<bool>());
+	world->SetWarmStart(Read<bool>());
+	world->SetGraphColoring(Read<bool>());
+	world->SetWideSolver(Read<bool>());
+	world->SetSubStepCount(Read<u32>());
+	world->SetSpeculativeContacts(Read<bool>());
+}
+
+void b3Replayer::ReadCreateBody(b3World* world)
+{
+	b3BodyDef def;
+	def.type = b3BodyType(Read<u32>());
+	def.awake = Read<bool>();
+	def.bullet = Read<bool>();
+	def.fixedRotationX = Read<bool>();
+	def.fixedRotationY = Read<bool>();
+	def.fixedRotationZ = Read<bool>();
+	def.position = Read<b3Vec3>();
+	def.orientation = Read<b3Quat>();
+	def.linearVelocity = Read<b3Vec3>();
+	def.angularVelocity = Read<b3Vec3>();
+	def.linearDamping = Read<float32>();
+	def.angularDamping = Read<float32>();
+	def.gravityScale = Read<float32>();
+
+	m_bodies.PushBack(world->CreateBody(def));
+}
+
+void b3Replayer::ReadCreateHull()
+{
+	b3Vec3 centroid = Read<b3Vec3>();
+	
+	u32 vertexCount = Read<u32>();
+	u32 vertexOffset = m_offset;
+	m_offset += vertexCount * sizeof(b3Vec3);
+	
+	u32 edgeCount = Read<u32>();
+	u32 edgeOffset = m_offset;
+	m_offset += edgeCount * sizeof(b3HalfEdge);
+
+	u32 faceCount = Read<u32>();
+
+	// Allocate the hull and its arrays in a single block.
+	u32 size = sizeof(b3Hull);
+	size += vertexCount * sizeof(b3Vec3);
+	size += edgeCount * sizeof(b3HalfEdge);
+	size += faceCount * sizeof(b3Face);
+	size += faceCount * sizeof(b3Plane);
+
+	u8* marker = (u8*)b3Alloc(size);
+
+	b3Hull* hull = (b3Hull*)marker;
+	marker += sizeof(b3Hull);
+	hull->vertices = (b3Vec3*)marker;
+	marker += vertexCount * sizeof(b3Vec3);
+	hull->edges = (b3HalfEdge*)marker;
+	marker += edgeCount * sizeof(b3HalfEdge);
+	hull->faces = (b3Face*)marker;
+	marker += faceCount * sizeof(b3Face);
+	hull->planes = (b3Plane*)marker;
+
+	hull->centroid = centroid;
+	hull->vertexCount = vertexCount;
+	hull->edgeCount = edgeCount;
+	hull->faceCount = faceCount;
+
+	memcpy(hull->vertices, m_data + vertexOffset, vertexCount * sizeof(b3Vec3));
+	memcpy(hull->edges, m_data + edgeOffset, edgeCount * sizeof(b3HalfEdge));
+	Read(hull->faces, faceCount * sizeof(b3Face));
+	Read(hull->planes, faceCount * sizeof(b3Plane));
+
+	m_hulls.PushBack(hull);
+}
+
+void b3Replayer::ReadCreateMesh()
+{
+	b3Mesh* mesh = (b3Mesh*)b3Alloc(sizeof(b3Mesh));
+	new (mesh) b3Mesh();
+
+	mesh->vertexCount = Read<u32>();
+	mesh->vertices = (b3Vec3*)b3Alloc(mesh->vertexCount * sizeof(b3Vec3));
+	Read(mesh->vertices, mesh->vertexCount * sizeof(b3Vec3));
+
+	mesh->triangleCount = Read<u32>();
+	mesh->triangles = (b3Triangle*)b3Alloc(mesh->triangleCount * sizeof(b3Triangle));
+	Read(mesh->triangles, mesh->triangleCount * sizeof(b3Triangle));
+
+	mesh->BuildTree();
+
+	m_meshes.PushBack(mesh);
+}
+
+void b3Replayer::ReadCreateShape()
+{
+	b3Body* body = m_bodies[Read<u32>()];
+
+	b3ShapeDef def;
+	def.isSensor = Read<bool>();
+	def.density = Read<float32>();
+	def.restitution = Read<float32>();
+	def.friction = Read<float32>();
+	def.filter.categoryBits = Read<u32>();
+	def.filter.maskBits = Read<u32>();
+	def.filter.groupIndex = Read<i32>();
+
+	b3ShapeType type = b3ShapeType(Read<u32>());
+	float32 radius = Read<float32>();
+
+	b3Shape* shape = NULL;
+	switch (type)
+	{
+	case e_sphereShape:
+	{
+		b3SphereShape sphere;
+		sphere.m_radius = radius;
+		sphere.m_center = Read<b3Vec3>();
+		
+		def.shape = &sphere;
+		shape = body->CreateShape(def);
+		break;
+	}
+	case e_capsuleShape:
+	{
+		b3CapsuleShape capsule;
+		capsule.m_radius = radius;
+		capsule.m_centers[0] = Read<b3Vec3>();
+		capsule.m_centers[1] = Read<b3Vec3>();
+
+		def.shape = &capsule;
+		shape = body->CreateShape(def);
+		break;
+	}
+	case e_hullShape:
+	{
+		b3HullShape hs;
+		hs.m_radius = radius;
+		hs.m_hull = m_hulls[Read<u32>()];
+
+		def.shape = &hs;
+		shape = body->CreateShape(def);
+		break;
+	}
+	case e_meshShape:
+	{
+		b3MeshShape ms;
+		ms.m_radius = radius;
+		ms.m_mesh = m_meshes[Read<u32>()];
+
+		def.shape = &ms;
+		shape = body->CreateShape(def);
+		break;
+	}
+	default:
+	{
+		B3_ASSERT(false);
+		break;
+	}
+	}
+
+	m_shapes.PushBack(shape);
+}
+
+void b3Replayer::ReadCreateJoint(b3World* world)
+{
+	b3JointType type = b3JointType(Read<u32>());
+	b3Body* bodyA = m_bodies[Read<u32>()];
+	b3Body* bodyB = m_bodies[Read<u32>()];
+	bool collideLinked = Read<bool>();
+
+	b3MouseJointDef mouseDef;
+	b3SpringJointDef springDef;
+	b3WeldJointDef weldDef;
+	b3RevoluteJointDef revoluteDef;
+	b3SphereJointDef sphereDef;
+	b3ConeJointDef coneDef;
+
+	b3JointDef* def = NULL;
+
+	switch (type)
+	{
+	case e_mouseJoint:
+	{
+		mouseDef.target = Read<b3Vec3>();
+		mouseDef.maxForce = Read<float32>();
+		def = &mouseDef;
+		break;
+	}
+	case e_springJoint:
+	{
+		springDef.localAnchorA = Read<b3Vec3>();
+		springDef.localAnchorB = Read<b3Vec3>();
+		springDef.length = Read<float32>();
+		springDef.frequencyHz = Read<float32>();
+		springDef.dampingRatio = Read<float32>();
+		def = &springDef;
+		break;
+	}
+	case e_weldJoint:
+	{
+		weldDef.localAnchorA = Read<b3Vec3>();
+		weldDef.localAnchorB = Read<b3Vec3>();
+		weldDef.referenceRotation = Read<b3Quat>();
+		def = &weldDef;
+		break;
+	}
+	case e_revoluteJoint:
+	{
+		revoluteDef.localAnchorA = Read<b3Vec3>();
+		revoluteDef.localRotationA = Read<b3Quat>();
+		revoluteDef.localAnchorB = Read<b3Vec3>();
+		revoluteDef.localRotationB = Read<b3Quat>();
+		revoluteDef.referenceRotation = Read<b3Quat>();
+		revoluteDef.enableLimit = Read<bool>();
+		revoluteDef.lowerAngle = Read<float32>();
+		revoluteDef.upperAngle = Read<float32>();
+		revoluteDef.enableMotor = Read<bool>();
+		revoluteDef.motorSpeed = Read<float32>();
+		revoluteDef.maxMotorTorque = Read<float32>();
+		def = &revoluteDef;
+		break;
+	}
+	case e_sphereJoint:
+	{
+		sphereDef.localAnchorA = Read<b3Vec3>();
+		sphereDef.localAnchorB = Read<b3Vec3>();
+		def = &sphereDef;
+		break;
+	}
+	case e_coneJoint:
+	{
+		coneDef.localFrameA = Read<b3Transform>();
+		coneDef.localFrameB = Read<b3Transform>();
+		coneDef.enableLimit = Read<bool>();
+		coneDef.coneAngle = Read<float32>();
+		def = &coneDef;
+		break;
+	}
+	default:
+	{
+		B3_ASSERT(false);
+		m_joints.PushBack(NULL);
+		return;
+	}
+	}
+
+	def->bodyA = bodyA;
+	def->bodyB = bodyB;
+	def->collideLinked = collideLinked;
+
+	m_joints.PushBack(world->CreateJoint(*def));
+}
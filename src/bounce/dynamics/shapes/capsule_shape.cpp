@@ -364,7 +364,7 @@ bool b3CapsuleShape::RayCast(b3RayCastOutput* output, const b3RayCastInput& inpu
 	t /= a;
 
 	// Is the intersection on the segment?
-	if (t < 0.0f || t > 1.0f)
+	if (t < 0.0f || t > input.maxFraction)
 	{
 		return false;
 	}
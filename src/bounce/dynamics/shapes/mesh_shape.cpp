@@ -130,12 +130,14 @@ struct b3MeshShapeRayCastCallback
 {
 	float32 Report(const b3RayCastInput& subInput, u32 proxyId)
 	{
-		B3_NOT_USED(subInput);
-
 		u32 childIndex = mesh->m_mesh->tree.GetUserData(proxyId);
 		
+		// Only look for hits closer than the closest hit so far.
+		b3RayCastInput childInput = input;
+		childInput.maxFraction = subInput.maxFraction;
+
 		b3RayCastOutput childOutput;
-		if (mesh->RayCast(&childOutput, input, xf, childIndex))
+		if (mesh->RayCast(&childOutput, childInput, xf, childIndex))
 		{
 			// Track minimum time of impact to require less memory.
 			if (childOutput.fraction < output.fraction)
@@ -143,9 +145,12 @@ struct b3MeshShapeRayCastCallback
 				hit = true;
 				output = childOutput;
 			}
+
+			// Clip the ray.
+			return childOutput.fraction;
 		}
 		
-		return 1.0f;
+		return subInput.maxFraction;
 	}
 
 	b3RayCastInput input;
@@ -175,4 +180,82 @@ bool b3MeshShape::RayCast(b3RayCastOutput* output, const b3RayCastInput& input,
 	output->normal = callback.output.normal;
 
 	return callback.hit;
-}
\ No newline at end of file
+}
+
+struct b3MeshShapeRayCastPacketCallback
+{
+	void Report(u32 mask, u32 proxyId)
+	{
+		u32 childIndex = mesh->m_mesh->tree.GetUserData(proxyId);
+		const b3Triangle* triangle = mesh->m_mesh->triangles + childIndex;
+
+		b3Vec3 v1 = mesh->m_mesh->vertices[triangle->v1];
+		b3Vec3 v2 = mesh->m_mesh->vertices[triangle->v2];
+		b3Vec3 v3 = mesh->m_mesh->vertices[triangle->v3];
+
+		for (u32 i = 0; i < packet.count; ++i)
+		{
+			u32 bit = 1 << i;
+			if ((mask & bit) == 0)
+			{
+				continue;
+			}
+
+			// The ray is already clipped to the closest hit so far.
+			b3RayCastInput* input = inputs + i;
+
+			b3RayCastOutput childOutput;
+			if (b3RayCast(&childOutput, input, v1, v2, v3))
+			{
+				input->maxFraction = childOutput.fraction;
+
+				outputs[i].fraction = childOutput.fraction;
+				outputs[i].normal = childOutput.normal;
+
+				hitMask |= bit;
+			}
+		}
+	}
+
+	const b3MeshShape* mesh;
+	
+	// The rays in the mesh's frame of reference.
+	b3RayCastInput inputs[B3_MAX_RAY_PACKET];
+	b3RayPacket packet;
+
+	b3RayCastOutput* outputs;
+	u32 hitMask;
+};
+
+u32 b3MeshShape::RayCastPacket(b3RayCastOutput* outputs, const b3RayPacket* packet, u32 mask, const b3Transform& xf) const
+{
+	b3MeshShapeRayCastPacketCallback callback;
+	callback.mesh = this;
+	callback.outputs = outputs;
+	callback.hitMask = 0;
+
+	// Put the rays into the mesh's frame of reference.
+	for (u32 i = 0; i < packet->count; ++i)
+	{
+		const b3RayCastInput& input = packet->inputs[i];
+
+		callback.inputs[i].p1 = b3MulT(xf, input.p1);
+		callback.inputs[i].p2 = b3MulT(xf, input.p2);
+		callback.inputs[i].maxFraction = input.maxFraction;
+	}
+
+	callback.packet.Set(callback.inputs, packet->count);
+
+	m_mesh->tree.RayCastPacket(&callback, &callback.packet, mask);
+
+	// Put the normals into world space.
+	for (u32 i = 0; i < packet->count; ++i)
+	{
+		if (callback.hitMask & (1 << i))
+		{
+			outputs[i].normal = xf.rotation * outputs[i].normal;
+		}
+	}
+
+	return callback.hitMask;
+}
@@ -24,6 +24,7 @@
 #include <bounce/dynamics/body.h>
 #include <bounce/dynamics/world.h>
 #include <bounce/dynamics/contacts/contact.h>
+#include <bounce/dynamics/contacts/sensor_pair.h>
 #include <bounce/collision/shapes/sphere.h>
 #include <bounce/collision/shapes/capsule.h>
 #include <bounce/collision/shapes/hull.h>
@@ -39,17 +40,89 @@ b3Shape::b3Shape()
 	m_userData = nullptr;
 
 	m_body = nullptr;
+	m_recordID = B3_MAX_U32;
+}
+
+void b3Shape::RecordScalar(b3RecordType type, float32 value)
+{
+	b3Recorder* recorder = m_body->GetWorld()->GetRecorder();
+	if (recorder)
+	{
+		recorder->RecordScalar(type, m_recordID, value);
+	}
 }
 
 void b3Shape::SetSensor(bool flag)
 {
+	if (m_body && m_body->GetWorld()->m_recorder)
+	{
+		m_body->GetWorld()->m_recorder->RecordFlag(e_recordSetSensor, m_recordID, flag);
+	}
+
 	if (flag != m_isSensor)
 	{
+		m_isSensor = flag;
+
 		if (m_body)
 		{
 			m_body->SetAwake(true);
+
+			// Sensors don't have contacts and other shapes don't have sensor pairs.
+			DestroyContacts();
+
+			// Buffer the proxy so that the new pairs are found.
+			b3World* world = m_body->GetWorld();
+			world->m_contactMan.m_broadPhase.TouchProxy(m_broadPhaseID);
+			world->m_flags |= b3World::e_shapeAddedFlag;
+		}
+	}
+}
+
+const b3Filter& b3Shape::GetFilter() const
+{
+	return m_body->GetWorld()->m_contactMan.m_broadPhase.GetFilter(m_broadPhaseID);
+}
+
+void b3Shape::SetFilter(const b3Filter& filter)
+{
+	b3World* world = m_body->GetWorld();
+	if (world->m_recorder)
+	{
+		world->m_recorder->RecordSetFilter(m_recordID, filter);
+	}
+
+	b3BroadPhase* broadPhase = &world->m_contactMan.m_broadPhase;
+	
+	// Buffer the proxy so that the next step creates the new contacts.
+	broadPhase->SetFilter(m_broadPhaseID, filter);
+	world->m_flags |= b3World::e_shapeAddedFlag;
+
+	// Destroy the contacts that are now filtered out.
+	b3ContactEdge* ce = m_contactEdges.m_head;
+	while (ce)
+	{
+		b3ContactEdge* tmp = ce;
+		ce = ce->m_next;
+		
+		const b3Filter& otherFilter = broadPhase->GetFilter(tmp->other->m_broadPhaseID);
+		if (b3ShouldCollide(filter, otherFilter) == false)
+		{
+			world->m_contactMan.Destroy(tmp->contact);
+		}
+	}
+
+	// Destroy the sensor pairs that are now filtered out.
+	b3SensorEdge* se = m_sensorEdges.m_head;
+	while (se)
+	{
+		b3SensorEdge* tmp = se;
+		se = se->m_next;
+
+		const b3Filter& otherFilter = broadPhase->GetFilter(tmp->other->m_broadPhaseID);
+		if (b3ShouldCollide(filter, otherFilter) == false)
+		{
+			world->m_contactMan.DestroySensor(tmp->pair);
 		}
-		m_isSensor = flag;
 	}
 }
 
@@ -63,6 +136,14 @@ void b3Shape::DestroyContacts()
 		ce = ce->m_next;
 		world->m_contactMan.Destroy(tmp->contact);
 	}
+
+	b3SensorEdge* se = m_sensorEdges.m_head;
+	while (se)
+	{
+		b3SensorEdge* tmp = se;
+		se = se->m_next;
+		world->m_contactMan.DestroySensor(tmp->pair);
+	}
 }
 
 const b3AABB3& b3Shape::GetAABB() const
@@ -201,6 +282,9 @@ void b3Shape::Dump(u32 bodyIndex) const
 	b3Log("		sd.restitution = %f;\n", m_restitution);
 	b3Log("		sd.friction = %f;\n", m_friction);
 	b3Log("		sd.sensor = %d;\n", m_isSensor);
+	b3Log("		sd.filter.categoryBits = 0x%x;\n", GetFilter().categoryBits);
+	b3Log("		sd.filter.maskBits = 0x%x;\n", GetFilter().maskBits);
+	b3Log("		sd.filter.groupIndex = %d;\n", GetFilter().groupIndex);
 	b3Log("		\n");
 	b3Log("		bodies[%d]->CreateShape(sd);\n", bodyIndex);
 }
@@ -21,33 +21,56 @@
 #include <bounce/dynamics/island.h>
 #include <bounce/dynamics/world_listeners.h>
 #include <bounce/dynamics/shapes/shape.h>
+#include <bounce/dynamics/shapes/mesh_shape.h>
 #include <bounce/dynamics/contacts/contact.h>
+#include <bounce/dynamics/contacts/mesh_contact.h>
+#include <bounce/dynamics/contacts/collide/collide.h>
+#include <bounce/collision/shapes/mesh.h>
 #include <bounce/dynamics/joints/joint.h>
 #include <bounce/dynamics/time_step.h>
+#include <bounce/common/time.h>
 
-extern u32 b3_allocCalls, b3_maxAllocCalls;
-extern u32 b3_convexCalls, b3_convexCacheHits;
-extern u32 b3_gjkCalls, b3_gjkIters, b3_gjkMaxIters;
 extern bool b3_convexCache;
 
 b3World::b3World() : 
 	m_bodyBlocks(sizeof(b3Body))
 {
-	b3_allocCalls = 0;
-	b3_maxAllocCalls = 0;
-	
-	b3_gjkCalls = 0;
-	b3_gjkIters = 0;
-
-	b3_convexCalls = 0;
-	b3_convexCacheHits = 0;
-
 	b3_convexCache = true;
 	
 	m_flags = e_clearForcesFlag;
 	m_sleeping = false;
 	m_warmStarting = true;
+	m_graphColoring = false;
+	m_wideSolver = false;
+	m_subStepCount = 0;
+	m_speculativeContacts = false;
 	m_gravity.Set(0.0f, -9.8f, 0.0f);
+	m_dt = 0.0f;
+	m_recordContactEvents = false;
+	m_stepContactEndEventCount = 0;
+	m_stepSensorEndEventCount = 0;
+
+	m_stepStats.Reset();
+	for (u32 i = 0; i < B3_MAX_THREADS; ++i)
+	{
+		m_threadStats[i].Reset();
+	}
+
+	m_jointMan.m_islandMan = &m_islandMan;
+	m_contactMan.m_islandMan = &m_islandMan;
+	m_contactMan.m_stats = &m_stepStats;
+	m_contactMan.m_threadStats = m_threadStats;
+	m_contactMan.m_broadPhase.SetThreadStats(m_threadStats);
+	m_islandMan.m_contactMan = &m_contactMan;
+
+	m_recorder = NULL;
+
+	m_taskScheduler = &m_serialTaskScheduler;
+	m_stackAllocators[0] = &m_stackAllocator;
+	for (u32 i = 1; i < B3_MAX_THREADS; ++i)
+	{
+		m_stackAllocators[i] = NULL;
+	}
 }
 
 b3World::~b3World()
@@ -60,15 +83,9 @@ b3World::~b3World()
 		b->DestroyJoints();
 		b = b->m_next;
 	}
-	
-	b3_allocCalls = 0;
-	b3_maxAllocCalls = 0;
 
-	b3_gjkCalls = 0;
-	b3_gjkIters = 0;
-
-	b3_convexCalls = 0;
-	b3_convexCacheHits = 0;
+	// Destroy the thread stack allocators.
+	SetTaskScheduler(NULL);
 }
 
 void b3World::SetSleeping(bool flag)
@@ -81,34 +98,110 @@ void b3World::SetSleeping(bool flag)
 			b->SetAwake(true);
 		}
 	}
+
+	if (m_recorder)
+	{
+		m_recorder->RecordSettings(this);
+	}
+}
+
+void b3World::SetRecorder(b3Recorder* recorder)
+{
+	B3_ASSERT(recorder == NULL || m_bodyList.m_count == 0);
+	
+	m_recorder = recorder;
+
+	if (m_recorder)
+	{
+		m_recorder->RecordSettings(this);
+	}
+}
+
+void b3World::SetTaskScheduler(b3TaskScheduler* scheduler)
+{
+	if (scheduler == NULL)
+	{
+		scheduler = &m_serialTaskScheduler;
+	}
+
+	u32 oldCount = m_taskScheduler->GetThreadCount();
+	u32 newCount = scheduler->GetThreadCount();
+	B3_ASSERT(newCount > 0 && newCount <= B3_MAX_THREADS);
+
+	m_taskScheduler = scheduler;
+
+	for (u32 i = newCount; i < oldCount; ++i)
+	{
+		m_stackAllocators[i]->~b3StackAllocator();
+		b3Free(m_stackAllocators[i]);
+		m_stackAllocators[i] = NULL;
+	}
+
+	for (u32 i = oldCount; i < newCount; ++i)
+	{
+		void* block = b3Alloc(sizeof(b3StackAllocator));
+		m_stackAllocators[i] = new (block) b3StackAllocator();
+	}
 }
 
 b3Body* b3World::CreateBody(const b3BodyDef& def)
 {
 	void* mem = m_bodyBlocks.Allocate();
 	b3Body* b = new(mem) b3Body(def, this);
-	m_bodyList.PushFront(b);	
+	m_bodyList.PushFront(b);
+
+	if (m_recorder)
+	{
+		b->m_recordID = m_recorder->RecordCreateBody(def);
+	}
+	
+	// Static bodies don't belong to islands.
+	if (b->m_type != e_staticBody)
+	{
+		m_islandMan.AddBody(b);
+	}
+
 	return b;
 }
 
 void b3World::DestroyBody(b3Body* b)
 {
+	if (m_recorder)
+	{
+		m_recorder->RecordDestroyBody(b->m_recordID);
+	}
+
 	b->DestroyShapes();
 	b->DestroyJoints();
 	b->DestroyContacts();
 	
+	m_islandMan.RemoveBody(b);
+
 	m_bodyList.Remove(b);
+	m_bodyStore.Remove(b->m_storeIndex);
 	b->~b3Body();
 	m_bodyBlocks.Free(b);
 }
 
 b3Joint* b3World::CreateJoint(const b3JointDef& def)
 {
-	return m_jointMan.Create(&def);
+	b3Joint* j = m_jointMan.Create(&def);
+
+	if (m_recorder && j)
+	{
+		j->m_recordID = m_recorder->RecordCreateJoint(def.bodyA->m_recordID, def.bodyB->m_recordID, def);
+	}
+
+	return j;
 }
 
 void b3World::DestroyJoint(b3Joint* j)
 {
+	if (m_recorder)
+	{
+		m_recorder->RecordDestroyJoint(j->m_recordID);
+	}
+
 	m_jointMan.Destroy(j);
 }
 
@@ -116,270 +209,866 @@ void b3World::Step(float32 dt, u32 velocityIterations, u32 positionIterations)
 {
 	B3_PROFILE("Step");
 
-	// Clear statistics
-	b3_allocCalls = 0;
+	if (m_recorder)
+	{
+		m_recorder->RecordStep(dt, velocityIterations, positionIterations);
+	}
+
+	m_flags |= e_lockedFlag;
+
+	// Clear the statistics of the last step.
+	m_stepStats.Reset();
+	
+	u32 threadCount = m_taskScheduler->GetThreadCount();
+	for (u32 i = 0; i < threadCount; ++i)
+	{
+		m_threadStats[i].Reset();
+	}
+
+#if B3_ENABLE_STATS
+	// The calling thread counts as thread zero.
+	b3CollisionStats* oldStats = b3SetThreadStats(m_threadStats);
 	
-	b3_convexCalls = 0;
-	b3_convexCacheHits = 0;
+	b3Time stepTimer;
+	b3Time timer;
+#endif
 
-	b3_gjkCalls = 0;
-	b3_gjkIters = 0;
-	b3_gjkMaxIters = 0;
+	// The events of the last step have been consumed. 
+	// Keep the end events recorded since then.
+	m_contactEvents.ClearStep(m_stepContactEndEventCount);
+	m_contactMan.m_sensorEvents.ClearStep(m_stepSensorEndEventCount);
 
 	if (m_flags & e_shapeAddedFlag)
 	{
 		// If new shapes were added new contacts might be created.
-		m_contactMan.FindNewContacts();
+		m_contactMan.FindNewContacts(m_taskScheduler);
 		m_flags &= ~e_shapeAddedFlag;
 	}
 
+	B3_STAT(timer.Update(); m_stepStats.broadPhaseTime += timer.GetElapsedMilis());
+
+	// Speculative contacts are predicted over this step.
+	m_dt = dt;
+
 	// Update contacts. This is where some contacts might be destroyed.
-	m_contactMan.UpdateContacts();
+	m_contactMan.UpdateContacts(m_taskScheduler, m_stackAllocators);
+
+	B3_STAT(timer.Update(); m_stepStats.collideTime += timer.GetElapsedMilis());
 
 	// Integrate velocities, clear forces and torques, solve constraints, integrate positions.
 	if (dt > 0.0f)
 	{
 		Solve(dt, velocityIterations, positionIterations);
+
+		// Move the bullets to their first times of impact to prevent tunneling.
+		u32 toiVelocityIterations = m_subStepCount > 0 ? m_subStepCount : velocityIterations;
+		B3_STAT(timer.Update());
+
+		SolveTOI(dt, toiVelocityIterations);
+		
+		B3_STAT(timer.Update(); m_stepStats.solveTOITime += timer.GetElapsedMilis());
+	}
+
+	// Test the sensor pairs of the shapes that have moved or were found in this step.
+	m_contactMan.UpdateSensors();
+
+	m_stepContactEndEventCount = m_contactEvents.endEvents.Count();
+	m_stepSensorEndEventCount = m_contactMan.m_sensorEvents.endEvents.Count();
+
+	m_flags &= ~e_lockedFlag;
+
+#if B3_ENABLE_STATS
+	timer.Update();
+	m_stepStats.sensorTime += timer.GetElapsedMilis();
+
+	stepTimer.Update();
+	m_stepStats.stepTime = stepTimer.GetElapsedMilis();
+
+	b3SetThreadStats(oldStats);
+
+	// Sum the collision counters of the threads.
+	for (u32 i = 0; i < threadCount; ++i)
+	{
+		m_stepStats.collision.Add(m_threadStats[i]);
+	}
+
+	m_stepStats.contactCount = m_contactMan.m_contactList.m_count;
+	m_stepStats.sensorPairCount = m_contactMan.m_sensorList.m_count;
+#endif
+
+	if (m_recorder)
+	{
+		m_recorder->RecordChecksum(this);
 	}
 }
 
-void b3World::Solve(float32 dt, u32 velocityIterations, u32 positionIterations)
+// The range of an island in the island buffers.
+struct b3IslandRange
 {
-	B3_PROFILE("Solve");
+	u32 bodyStart;
+	u32 bodyCount;
+	u32 contactStart;
+	u32 contactCount;
+	u32 jointStart;
+	u32 jointCount;
+
+	// The persistent island of this range.
+	b3PersistentIsland* island;
+
+	// The minimum sleep time of the island bodies after solving it. 
+	// This is B3_MAX_FLOAT if the island went to sleep.
+	float32 sleepTime;
+
+	// The number of position iterations the island ran.
+	u32 positionIterations;
+};
+
+struct b3SolveIslandsContext
+{
+	b3StackAllocator** allocators;
+	b3TaskScheduler* scheduler;
+	b3BodyStore* store;
+	b3IslandRange* islands;
+	b3Body** bodies;
+	b3Contact** contacts;
+	b3Joint** joints;
+	b3Vec3 gravity;
+	float32 dt;
+	u32 velocityIterations;
+	u32 positionIterations;
+	u32 subStepCount;
+	u32 flags;
+	b3CollisionStats* threadStats;
+};
+
+static void b3SolveIslands(void* data, u32 begin, u32 end, u32 threadIndex)
+{
+	b3SolveIslandsContext* context = (b3SolveIslandsContext*)data;
+
+#if B3_ENABLE_STATS
+	// Count the allocations of this thread.
+	b3CollisionStats* oldStats = b3SetThreadStats(context->threadStats + threadIndex);
+#endif
 	
-	// Clear all visited flags for the depth first search.
-	for (b3Body* b = m_bodyList.m_head; b; b = b->m_next)
+	for (u32 i = begin; i < end; ++i)
 	{
-		b->m_flags &= ~b3Body::e_islandFlag;
-	}
+		b3IslandRange* range = context->islands + i;
 
-	for (b3Joint* j = m_jointMan.m_jointList.m_head; j; j = j->m_next)
-	{
-		j->m_flags &= ~b3Joint::e_islandFlag;
+		// Only color islands that have enough constraints to amortize the coloring.
+		b3TaskScheduler* scheduler = NULL;
+		if (range->contactCount + range->jointCount >= B3_GRAPH_COLORING_THRESHOLD)
+		{
+			scheduler = context->scheduler;
+		}
+
+		b3Island island(context->allocators[threadIndex], scheduler, context->store,
+			context->bodies + range->bodyStart, range->bodyCount,
+			context->contacts + range->contactStart, range->contactCount,
+			context->joints + range->jointStart, range->jointCount);
+
+		// Integrate velocities, clear forces and torques, solve constraints, integrate positions.
+		island.Solve(context->gravity, context->dt, context->velocityIterations, context->positionIterations, context->subStepCount, context->flags);
+
+		// Remember how long the island has been resting.
+		range->sleepTime = island.GetSleepTime();
+		range->positionIterations = island.GetPositionIterations();
 	}
 
-	for (b3Contact* c = m_contactMan.m_contactList.m_head; c; c = c->m_next)
+#if B3_ENABLE_STATS
+	b3SetThreadStats(oldStats);
+#endif
+}
+
+struct b3SynchronizeShapesContext
+{
+	b3Shape** shapes;
+	b3AABB3* aabbs;
+	b3Vec3* displacements;
+	b3CollisionStats* threadStats;
+};
+
+static void b3ComputeSweptAABBs(void* data, u32 begin, u32 end, u32 threadIndex)
+{
+	B3_NOT_USED(threadIndex);
+	b3SynchronizeShapesContext* context = (b3SynchronizeShapesContext*)data;
+
+#if B3_ENABLE_STATS
+	// Count the allocations of this thread.
+	b3CollisionStats* oldStats = b3SetThreadStats(context->threadStats + threadIndex);
+#endif
+
+	for (u32 i = begin; i < end; ++i)
 	{
-		c->m_flags &= ~b3Contact::e_islandFlag;
+		const b3Shape* shape = context->shapes[i];
+		const b3Body* body = shape->GetBody();
+
+		b3Transform xf1 = body->GetSweep().GetTransform(0.0f);
+		b3Transform xf2 = body->GetTransform();
+
+		// Compute an AABB that encloses the swept shape AABB.
+		b3AABB3 aabb1, aabb2;
+		shape->ComputeAABB(&aabb1, xf1);
+		shape->ComputeAABB(&aabb2, xf2);
+
+		context->aabbs[i] = b3Combine(aabb1, aabb2);
+		context->displacements[i] = xf2.position - xf1.position;
 	}
 
+#if B3_ENABLE_STATS
+	b3SetThreadStats(oldStats);
+#endif
+}
+
+void b3World::Solve(float32 dt, u32 velocityIterations, u32 positionIterations)
+{
+	B3_PROFILE("Solve");
+	
+	B3_STAT(b3Time timer);
+
+	// Merge the islands linked since the last step.
+	m_islandMan.MergeIslands();
+
 	u32 islandFlags = 0;
 	islandFlags |= m_warmStarting * b3Island::e_warmStartBit;
 	islandFlags |= m_sleeping * b3Island::e_sleepBit;
+	islandFlags |= m_wideSolver * b3Island::e_wideBit;
+
+	// Only the awake islands are solved.
+	// A static body can be added to more than one island. 
+	// Each additional reference is caused by a different contact or joint. 
+	u32 bodyCapacity = 0;
+	u32 contactCapacity = 0;
+	u32 jointCapacity = 0;
+	u32 islandCapacity = 0;
+	for (b3PersistentIsland* island = m_islandMan.m_awakeList.m_head; island; island = island->m_next)
+	{
+		bodyCapacity += island->bodyCount + island->contactCount + island->jointCount;
+		contactCapacity += island->contactCount;
+		jointCapacity += island->jointCount;
+		++islandCapacity;
+	}
 
-	b3Vec3 externalForce = m_gravity;
-
-	// Create a worst case island.
-	b3Island island(&m_stackAllocator, m_bodyList.m_count, m_contactMan.m_contactList.m_count, m_jointMan.m_jointList.m_count);
+	// Gather all awake islands into contiguous buffers before solving them.
+	b3Body** bodies = (b3Body**)m_stackAllocator.Allocate(bodyCapacity * sizeof(b3Body*));
+	b3Contact** contacts = (b3Contact**)m_stackAllocator.Allocate(contactCapacity * sizeof(b3Contact*));
+	b3Joint** joints = (b3Joint**)m_stackAllocator.Allocate(jointCapacity * sizeof(b3Joint*));
+	b3IslandRange* islands = (b3IslandRange*)m_stackAllocator.Allocate(islandCapacity * sizeof(b3IslandRange));
+	
+	u32 bodyCount = 0;
+	u32 contactCount = 0;
+	u32 jointCount = 0;
+	u32 islandCount = 0;
 
-	// Build and simulate awake islands.
-	u32 stackSize = m_bodyList.m_count;
-	b3Body** stack = (b3Body**)m_stackAllocator.Allocate(stackSize * sizeof(b3Body*));
-	for (b3Body* seed = m_bodyList.m_head; seed; seed = seed->m_next)
 	{
-		// The seed must not be on an island.
-		if (seed->m_flags & b3Body::e_islandFlag)
-		{
-			continue;
-		}
-
-		// Bodies that are sleeping are not solved for performance.
-		if (!(seed->m_flags & b3Body::e_awakeFlag))
-		{
-			continue;
-		}
+		B3_PROFILE("Build Islands");
 
-		// The seed must be dynamic or kinematic.
-		if (seed->m_type == e_staticBody)
+		b3PersistentIsland* persistentIsland = m_islandMan.m_awakeList.m_head;
+		while (persistentIsland)
 		{
-			continue;
-		}
+			b3PersistentIsland* next = persistentIsland->m_next;
 
-		// Perform a depth first search on this body constraint graph.
-		island.Clear();
-		u32 stackCount = 0;
-		stack[stackCount++] = seed;
-		seed->m_flags |= b3Body::e_islandFlag;
-
-		while (stackCount > 0)
-		{
-			// Add this body to the island.
-			b3Body* b = stack[--stackCount];
-			island.Add(b);
-			
-			// This body must be awake.
-			b->m_flags |= b3Body::e_awakeFlag;
+			// An island that was woken up must have at least one awake body 
+			// to be solved. Otherwise it was woken up by a link that has been removed.
+			bool awake = false;
+			for (b3Body* b = persistentIsland->bodyHead; b; b = b->m_islandNext)
+			{
+				if (b->m_flags & b3Body::e_awakeFlag)
+				{
+					awake = true;
+					break;
+				}
+			}
 
-			// Don't propagate islands across static bodies to keep them small.
-			if (b->m_type == e_staticBody)
+			if (awake == false)
 			{
+				m_islandMan.SleepIsland(persistentIsland);
+				persistentIsland = next;
 				continue;
 			}
 
-			// Search all contacts connected to this body.
-			for (b3Shape* s = b->m_shapeList.m_head; s; s = s->m_next)
-			{
-				for (b3ContactEdge* ce = s->m_contactEdges.m_head; ce; ce = ce->m_next)
-				{
-					b3Contact* contact = ce->contact;
+			b3IslandRange* island = islands + islandCount;
+			island->bodyStart = bodyCount;
+			island->contactStart = contactCount;
+			island->jointStart = jointCount;
+			island->island = persistentIsland;
+			island->sleepTime = 0.0f;
+			island->positionIterations = 0;
 
-					// The contact must not be on an island.
-					if (contact->m_flags & b3Contact::e_islandFlag)
-					{
-						continue;
-					}
+			// Add the island bodies.
+			for (b3Body* b = persistentIsland->bodyHead; b; b = b->m_islandNext)
+			{
+				B3_ASSERT(bodyCount < bodyCapacity);
+				b->m_islandID = bodyCount - island->bodyStart;
+				bodies[bodyCount++] = b;
 
-					// The contact must be overlapping.
-					if (!(contact->m_flags & b3Contact::e_overlapFlag))
-					{
-						continue;
-					}
+				// This body must be awake.
+				b->m_flags |= b3Body::e_awakeFlag;
+			}
 
-					// A sensor can't respond to contacts. 
-					bool sensorA = contact->GetShapeA()->m_isSensor;
-					bool sensorB = contact->GetShapeB()->m_isSensor;
-					if (sensorA || sensorB)
-					{
-						continue;
-					}
+			// Add the static bodies referenced by a constraint once.
+			for (b3Contact* c = persistentIsland->contactHead; c; c = c->m_islandNext)
+			{
+				contacts[contactCount++] = c;
 
-					// Add contact to the island and mark it.
-					island.Add(contact);
-					contact->m_flags |= b3Contact::e_islandFlag;
+				b3Body* bodyA = c->GetShapeA()->GetBody();
+				b3Body* bodyB = c->GetShapeB()->GetBody();
+				
+				b3Body* staticBody = bodyA->m_type == e_staticBody ? bodyA : bodyB;
+				if (staticBody->m_type == e_staticBody && (staticBody->m_flags & b3Body::e_islandFlag) == 0)
+				{
+					B3_ASSERT(bodyCount < bodyCapacity);
+					staticBody->m_islandID = bodyCount - island->bodyStart;
+					staticBody->m_flags |= b3Body::e_islandFlag;
+					bodies[bodyCount++] = staticBody;
+				}
+			}
 
-					b3Body* other = ce->other->GetBody();
+			for (b3Joint* j = persistentIsland->jointHead; j; j = j->m_islandNext)
+			{
+				joints[jointCount++] = j;
 
-					// Skip adjacent vertex if it was visited.
-					if (other->m_flags & b3Body::e_islandFlag)
-					{
-						continue;
-					}
+				b3Body* bodyA = j->GetBodyA();
+				b3Body* bodyB = j->GetBodyB();
 
-					// Add the other body to the island and propagate through it.
-					B3_ASSERT(stackCount < stackSize);
-					stack[stackCount++] = other;
-					other->m_flags |= b3Body::e_islandFlag;
+				b3Body* staticBody = bodyA->m_type == e_staticBody ? bodyA : bodyB;
+				if (staticBody->m_type == e_staticBody && (staticBody->m_flags & b3Body::e_islandFlag) == 0)
+				{
+					B3_ASSERT(bodyCount < bodyCapacity);
+					staticBody->m_islandID = bodyCount - island->bodyStart;
+					staticBody->m_flags |= b3Body::e_islandFlag;
+					bodies[bodyCount++] = staticBody;
 				}
 			}
 
-			// Search all joints connected to this body.
-			for (b3JointEdge* je = b->m_jointEdges.m_head; je; je = je->m_next)
+			island->bodyCount = bodyCount - island->bodyStart;
+			island->contactCount = contactCount - island->contactStart;
+			island->jointCount = jointCount - island->jointStart;
+			++islandCount;
+
+			// Give the constraints the solver indices of their bodies.
+			// This must be done now because a static body has a different 
+			// index in each island it belongs to.
+			for (u32 i = island->contactStart; i < contactCount; ++i)
+			{
+				b3Contact* c = contacts[i];
+				c->m_indexA = c->GetShapeA()->GetBody()->m_islandID;
+				c->m_indexB = c->GetShapeB()->GetBody()->m_islandID;
+			}
+
+			for (u32 i = island->jointStart; i < jointCount; ++i)
 			{
-				b3Joint* joint = je->joint;
+				b3Joint* j = joints[i];
+				j->m_indexA = j->GetBodyA()->m_islandID;
+				j->m_indexB = j->GetBodyB()->m_islandID;
+			}
 
-				// The joint must not be on an island.
-				if (joint->m_flags & b3Joint::e_islandFlag)
+			// Allow static bodies to participate in other islands.
+			for (u32 i = island->bodyStart; i < bodyCount; ++i)
+			{
+				b3Body* b = bodies[i];
+				if (b->m_type == e_staticBody)
 				{
-					continue;
+					b->m_flags &= ~b3Body::e_islandFlag;
 				}
+			}
+
+			persistentIsland = next;
+		}
+	}
 
-				// Add joint to the island and mark it.
-				island.Add(joint);
-				joint->m_flags |= b3Joint::e_islandFlag;
+	{
+		B3_PROFILE("Solve Islands");
+
+		b3SolveIslandsContext context;
+		context.allocators = m_stackAllocators;
+		context.scheduler = m_graphColoring ? m_taskScheduler : NULL;
+		context.store = &m_bodyStore;
+		context.islands = islands;
+		context.bodies = bodies;
+		context.contacts = contacts;
+		context.joints = joints;
+		context.gravity = m_gravity;
+		context.dt = dt;
+		context.velocityIterations = velocityIterations;
+		context.positionIterations = positionIterations;
+		context.subStepCount = m_subStepCount;
+		context.flags = islandFlags;
+		context.threadStats = m_threadStats;
+
+		// The islands don't share non-static bodies, contacts, or joints.
+		// Therefore they can be solved in any order.
+		m_taskScheduler->ParallelFor(islandCount, 1, b3SolveIslands, &context);
+	}
 
-				b3Body* other = je->other;
+#if B3_ENABLE_STATS
+	m_stepStats.islandCount += islandCount;
+	m_stepStats.islandBodyCount += bodyCount;
+	for (u32 i = 0; i < islandCount; ++i)
+	{
+		const b3IslandRange* island = islands + i;
+		m_stepStats.maxIslandBodyCount = b3Max(m_stepStats.maxIslandBodyCount, island->bodyCount);
+		m_stepStats.maxIslandContactCount = b3Max(m_stepStats.maxIslandContactCount, island->contactCount);
+		m_stepStats.maxIslandJointCount = b3Max(m_stepStats.maxIslandJointCount, island->jointCount);
+		m_stepStats.velocityIterations += m_subStepCount > 0 ? m_subStepCount : velocityIterations;
+		m_stepStats.positionIterations += island->positionIterations;
+	}
+#endif
 
-				// The other body must not be on an island.
-				if (other->m_flags & b3Body::e_islandFlag)
-				{
-					continue;
-				}
+	if (m_recordContactEvents)
+	{
+		// Record the solved impulses in island order.
+		for (u32 i = 0; i < contactCount; ++i)
+		{
+			contacts[i]->RecordPostSolve(&m_contactEvents);
+		}
+	}
+
+	{
+		B3_PROFILE("Update Islands");
+
+		// Split at most one island per step. Prefer the island that is closest 
+		// to sleep so islands can sleep independently, then the largest island.
+		b3IslandRange* splitCandidate = NULL;
+		for (u32 i = 0; i < islandCount; ++i)
+		{
+			b3IslandRange* island = islands + i;
+			if (island->island->constraintRemoveCount == 0)
+			{
+				continue;
+			}
 
-				// Push the other body onto the stack and mark it.
-				B3_ASSERT(stackCount < stackSize);
-				stack[stackCount++] = other;
-				other->m_flags |= b3Body::e_islandFlag;
+			if (splitCandidate == NULL || 
+				island->sleepTime > splitCandidate->sleepTime ||
+				(island->sleepTime == splitCandidate->sleepTime && island->bodyCount > splitCandidate->bodyCount))
+			{
+				splitCandidate = island;
 			}
 		}
 
-		// Integrate velocities, clear forces and torques, solve constraints, integrate positions.
-		island.Solve(externalForce, dt, velocityIterations, positionIterations, islandFlags);
-		
-		// Allow static bodies to participate in other islands.
-		for (u32 i = 0; i < island.m_bodyCount; ++i)
+		// Move the islands that went to sleep to the sleeping list.
+		for (u32 i = 0; i < islandCount; ++i)
 		{
-			b3Body* b = island.m_bodies[i];
-			if (b->m_type == e_staticBody)
+			b3IslandRange* island = islands + i;
+			if (island == splitCandidate)
+			{
+				continue;
+			}
+
+			if (island->island->bodyHead->IsAwake() == false)
 			{
-				b->m_flags &= ~b3Body::e_islandFlag;
+				m_islandMan.SleepIsland(island->island);
 			}
 		}
+
+		// The new islands are put to sleep in the next step if their bodies are sleeping.
+		if (splitCandidate)
+		{
+			m_islandMan.SplitIsland(splitCandidate->island, &m_stackAllocator);
+		}
 	}
 
-	m_stackAllocator.Free(stack);
+	B3_STAT(timer.Update(); m_stepStats.solveTime += timer.GetElapsedMilis());
 
 	{
 		B3_PROFILE("Find New Pairs");
 
-		for (b3Body* b = m_bodyList.m_head; b; b = b->m_next)
+		// Gather the shapes of the bodies that have moved.
+		// Only the bodies of the solved islands can have moved.
+		u32 shapeCount = 0;
+		for (u32 i = 0; i < bodyCount; ++i)
 		{
-			// If a body didn't participate on a island then it didn't move.
-			if ((b->m_flags & b3Body::e_islandFlag) == 0)
+			b3Body* b = bodies[i];
+			if (b->m_type == e_staticBody)
 			{
 				continue;
 			}
 
+			shapeCount += b->m_shapeList.m_count;
+		}
+
+		b3Shape** shapes = (b3Shape**)m_stackAllocator.Allocate(shapeCount * sizeof(b3Shape*));
+		b3AABB3* aabbs = (b3AABB3*)m_stackAllocator.Allocate(shapeCount * sizeof(b3AABB3));
+		b3Vec3* displacements = (b3Vec3*)m_stackAllocator.Allocate(shapeCount * sizeof(b3Vec3));
+
+		u32 shapeIndex = 0;
+		for (u32 i = 0; i < bodyCount; ++i)
+		{
+			b3Body* b = bodies[i];
 			if (b->m_type == e_staticBody)
 			{
 				continue;
 			}
 
-			// Update shapes for broad-phase.
-			b->SynchronizeShapes();
+			for (b3Shape* s = b->m_shapeList.m_head; s; s = s->m_next)
+			{
+				shapes[shapeIndex++] = s;
+			}
 		}
 
+		B3_ASSERT(shapeIndex == shapeCount);
+
+		// Compute the swept shape AABBs in parallel.
+		b3SynchronizeShapesContext context;
+		context.shapes = shapes;
+		context.aabbs = aabbs;
+		context.displacements = displacements;
+		context.threadStats = m_threadStats;
+
+		m_taskScheduler->ParallelFor(shapeCount, 64, b3ComputeSweptAABBs, &context);
+
+		// Update shapes for broad-phase.
+		b3BroadPhase* broadPhase = &m_contactMan.m_broadPhase;
+		for (u32 i = 0; i < shapeCount; ++i)
+		{
+			broadPhase->MoveProxy(shapes[i]->m_broadPhaseID, aabbs[i], displacements[i]);
+			m_contactMan.TouchSensors(shapes[i]);
+		}
+
+		m_stackAllocator.Free(displacements);
+		m_stackAllocator.Free(aabbs);
+		m_stackAllocator.Free(shapes);
+	}
+
+	m_stackAllocator.Free(islands);
+	m_stackAllocator.Free(joints);
+	m_stackAllocator.Free(contacts);
+	m_stackAllocator.Free(bodies);
+
+	{
+		B3_PROFILE("Find New Contacts");
+
 		// Notify the contacts the AABBs may have been moved.
 		m_contactMan.SynchronizeShapes();
 
 		// Find new contacts.
-		m_contactMan.FindNewContacts();
+		m_contactMan.FindNewContacts(m_taskScheduler);
 	}
+
+	B3_STAT(timer.Update(); m_stepStats.broadPhaseTime += timer.GetElapsedMilis());
 }
 
-struct b3ShapeRayCastCallback
+// Get the sweep of a body for computing a time of impact. 
+// Only awake non-static bodies have moved in the step.
+static b3Sweep b3GetTOISweep(const b3Body* body)
 {
-	float32 Report(const b3RayCastInput& input, u32 proxyId)
+	b3Sweep sweep = body->GetSweep();
+	if (body->GetType() == e_staticBody || body->IsAwake() == false)
 	{
-		// Get shape associated with the proxy.
-		void* userData = broadPhase->GetUserData(proxyId);
-		b3Shape* shape = (b3Shape*)userData;
-		
-		// Calculate transformation from shape local space to world space.
-		b3Transform xf = shape->GetBody()->GetTransform();
+		sweep.worldCenter0 = sweep.worldCenter;
+		sweep.orientation0 = sweep.orientation;
+		sweep.t0 = 0.0f;
+	}
+	return sweep;
+}
 
-		b3RayCastOutput output;
-		bool hit = shape->RayCast(&output, input, xf);
-		if (hit)
-		{
-			// Ray hits shape.
-			float32 fraction = output.fraction;
-			float32 w1 = 1.0f - fraction;
-			float32 w2 = fraction;
-			
-			b3Vec3 point = w1 * input.p1 + w2 * input.p2;
-			b3Vec3 normal = output.normal;
+void b3World::SolveTOI(float32 dt, u32 velocityIterations)
+{
+	B3_PROFILE("Solve TOI");
 
-			// Report the intersection to the user and get the new ray cast fraction.
-			return listener->ReportShape(shape, point, normal, fraction);
-		}
+	b3ContactStore* stores[2] = { &m_contactMan.m_convexStore, &m_contactMan.m_meshStore };
 
-		// Continue search from where we stopped.
-		return input.maxFraction;
+	// Invalidate the times of impact of the last step.
+	for (u32 i = 0; i < 2; ++i)
+	{
+		b3ContactStore* store = stores[i];
+		for (u32 j = 0; j < store->GetActiveCount(); ++j)
+		{
+			store->m_flags[j] &= ~b3Contact::e_toiFlag;
+			store->m_contacts[j]->m_toi.count = 0;
+		}
 	}
 
-	b3RayCastListener* listener;
-	const b3BroadPhase* broadPhase;
-};
+	bool moved = false;
 
-void b3World::RayCast(b3RayCastListener* listener, const b3Vec3& p1, const b3Vec3& p2) const
-{
-	b3RayCastInput input;
-	input.p1 = p1;
+	for (;;)
+	{
+		// Find the first time of impact.
+		b3Contact* minContact = NULL;
+		float32 minAlpha = 1.0f;
+
+		for (u32 k = 0; k < 2; ++k)
+		{
+			b3ContactStore* store = stores[k];
+			for (u32 i = 0; i < store->GetActiveCount(); ++i)
+			{
+				b3Contact* c = store->m_contacts[i];
+
+				b3Shape* shapeA = c->GetShapeA();
+				b3Shape* shapeB = c->GetShapeB();
+
+				b3Body* bodyA = shapeA->GetBody();
+				b3Body* bodyB = shapeB->GetBody();
+
+				// At least one body must be a bullet.
+				bool bulletA = bodyA->m_type == e_dynamicBody && bodyA->IsBullet();
+				bool bulletB = bodyB->m_type == e_dynamicBody && bodyB->IsBullet();
+				if (bulletA == false && bulletB == false)
+				{
+					continue;
+				}
+
+				// Prevent excessive substepping.
+				if (c->m_toi.count >= B3_MAX_TOI_SUBSTEPS)
+				{
+					continue;
+				}
+
+				float32 alpha = 1.0f;
+				if (c->Flags() & b3Contact::e_toiFlag)
+				{
+					// This contact has a valid cached time of impact.
+					alpha = c->m_toi.t;
+				}
+				else
+				{
+					b3Sweep sweepA = b3GetTOISweep(bodyA);
+					b3Sweep sweepB = b3GetTOISweep(bodyB);
+
+					// Put the sweeps onto the same time interval.
+					float32 alpha0 = b3Max(sweepA.t0, sweepB.t0);
+					B3_ASSERT(alpha0 < 1.0f);
+
+					if (sweepA.t0 < alpha0)
+					{
+						sweepA.Advance(alpha0);
+					}
+				
+					if (sweepB.t0 < alpha0)
+					{
+						sweepB.Advance(alpha0);
+					}
+
+					// The time of impact is a fraction of the remaining interval.
+					float32 beta = c->ComputeTOI(sweepA, sweepB);
+					alpha = b3Min(alpha0 + (1.0f - alpha0) * beta, 1.0f);
+
+					c->m_toi.t = alpha;
+					c->Flags() |= b3Contact::e_toiFlag;
+				}
+
+				if (alpha < minAlpha)
+				{
+					// This is the minimum time of impact so far.
+					minContact = c;
+					minAlpha = alpha;
+				}
+			}
+		}
+
+		if (minContact == NULL || 1.0f - 10.0f * B3_EPSILON < minAlpha)
+		{
+			// No more times of impact in this step.
+			break;
+		}
+
+		b3Contact* c = minContact;
+		b3Body* bodies[2] = { c->GetShapeA()->GetBody(), c->GetShapeB()->GetBody() };
+
+		// Advance the bodies to the time of impact.
+		b3Sweep backups[2];
+		for (u32 i = 0; i < 2; ++i)
+		{
+			b3Body* b = bodies[i];
+			backups[i] = b->Sweep();
+
+			if (b->m_type == e_staticBody)
+			{
+				continue;
+			}
+
+			if (b->IsAwake() == false)
+			{
+				// The body didn't move in this step.
+				b->Sweep() = b3GetTOISweep(b);
+			}
+
+			b->Advance(minAlpha);
+		}
+
+		// The contact likely has new contact points at the time of impact.
+		if (c->m_type == e_meshContact)
+		{
+			b3MeshContact* mc = (b3MeshContact*)c;
+			mc->SynchronizeShapes();
+			mc->FindNewPairs();
+		}
+
+		c->Update(&m_stackAllocator);
+		c->Flags() &= ~b3Contact::e_toiFlag;
+		++c->m_toi.count;
+
+		if (c->IsOverlapping() == false)
+		{
+			// The shapes are separated by about a linear slop.
+			c->CollideTOI();
+		}
+
+		m_contactMan.ReportContact(c);
+
+		if (c->IsOverlapping() == false)
+		{
+			// The shapes only got close or the root finder stopped early.
+			// Keep the sweeps beginning at the time of impact but restore the final states
+			// so that the times of impact of the remaining motion are computed again.
+			for (u32 i = 0; i < 2; ++i)
+			{
+				b3Body* b = bodies[i];
+				if (b->m_type == e_staticBody)
+				{
+					continue;
+				}
+
+				b3Sweep& sweep = b->Sweep();
+				sweep.worldCenter = backups[i].worldCenter;
+				sweep.orientation = backups[i].orientation;
+				b->WorldInvI() = b3RotateToFrame(b->m_invI, sweep.orientation);
+				b->SynchronizeTransform();
+
+				for (b3Shape* s = b->m_shapeList.m_head; s; s = s->m_next)
+				{
+					for (b3ContactEdge* ce = s->m_contactEdges.m_head; ce; ce = ce->m_next)
+					{
+						ce->contact->Flags() &= ~b3Contact::e_toiFlag;
+					}
+				}
+			}
+
+			continue;
+		}
+
+		// The contact impulses are not used for warm starting at a time of impact.
+		for (u32 i = 0; i < c->ManifoldCount(); ++i)
+		{
+			b3Manifold* m = c->Manifolds() + i;
+			m->tangentImpulse.SetZero();
+			m->motorImpulse = 0.0f;
+			for (u32 j = 0; j < m->pointCount; ++j)
+			{
+				m->points[j].normalImpulse = 0.0f;
+			}
+		}
+
+		for (u32 i = 0; i < 2; ++i)
+		{
+			if (bodies[i]->m_type != e_staticBody)
+			{
+				bodies[i]->SetAwake(true);
+			}
+		}
+
+		// Solve the contact with the two bodies and move them for the rest of the step.
+		c->m_indexA = 0;
+		c->m_indexB = 1;
+		
+		{
+			b3Island island(&m_stackAllocator, NULL, &m_bodyStore, bodies, 2, &c, 1, NULL, 0);
+			island.SolveTOI((1.0f - minAlpha) * dt, velocityIterations, B3_TOI_POSITION_ITERATIONS);
+		}
+
+		B3_STAT(++m_stepStats.toiCount);
+
+		if (m_recordContactEvents)
+		{
+			c->RecordPostSolve(&m_contactEvents);
+		}
+
+		// The times of impact of the contacts of the moved bodies are invalid.
+		for (u32 i = 0; i < 2; ++i)
+		{
+			b3Body* b = bodies[i];
+			if (b->m_type == e_staticBody)
+			{
+				continue;
+			}
+
+			if (c->m_toi.count == B3_MAX_TOI_SUBSTEPS)
+			{
+				// The contact ran out of substeps.
+				// Keep the body at the time of impact in the rest of the step to prevent tunneling.
+				b3Sweep& sweep = b->Sweep();
+				sweep.worldCenter = sweep.worldCenter0;
+				sweep.orientation = b3Normalize(sweep.orientation0);
+				b->WorldInvI() = b3RotateToFrame(b->m_invI, sweep.orientation);
+				b->SynchronizeTransform();
+			}
+
+			b->SynchronizeShapes();
+
+			for (b3Shape* s = b->m_shapeList.m_head; s; s = s->m_next)
+			{
+				for (b3ContactEdge* ce = s->m_contactEdges.m_head; ce; ce = ce->m_next)
+				{
+					ce->contact->Flags() &= ~b3Contact::e_toiFlag;
+				}
+			}
+		}
+
+		// The bodies may have moved into new shapes.
+		m_contactMan.FindNewContacts(m_taskScheduler);
+
+		moved = true;
+	}
+
+	if (moved)
+	{
+		// Notify the contacts the AABBs may have been moved.
+		m_contactMan.SynchronizeShapes();
+		m_contactMan.FindNewContacts(m_taskScheduler);
+	}
+}
+
+struct b3ShapeRayCastCallback
+{
+	float32 Report(const b3RayCastInput& input, u32 proxyId)
+	{
+		if (filter && b3ShouldCollide(*filter, broadPhase->GetFilter(proxyId)) == false)
+		{
+			// Skip the filtered shape.
+			return input.maxFraction;
+		}
+
+		// Get shape associated with the proxy.
+		void* userData = broadPhase->GetUserData(proxyId);
+		b3Shape* shape = (b3Shape*)userData;
+		
+		// Calculate transformation from shape local space to world space.
+		b3Transform xf = shape->GetBody()->GetTransform();
+
+		b3RayCastOutput output;
+		bool hit = shape->RayCast(&output, input, xf);
+		if (hit)
+		{
+			// Ray hits shape.
+			float32 fraction = output.fraction;
+			float32 w1 = 1.0f - fraction;
+			float32 w2 = fraction;
+			
+			b3Vec3 point = w1 * input.p1 + w2 * input.p2;
+			b3Vec3 normal = output.normal;
+
+			// Report the intersection to the user and get the new ray cast fraction.
+			return listener->ReportShape(shape, point, normal, fraction);
+		}
+
+		// Continue search from where we stopped.
+		return input.maxFraction;
+	}
+
+	b3RayCastListener* listener;
+	const b3Filter* filter;
+	const b3BroadPhase* broadPhase;
+};
+
+void b3World::RayCast(b3RayCastListener* listener, const b3Vec3& p1, const b3Vec3& p2, const b3Filter* filter) const
+{
+	b3RayCastInput input;
+	input.p1 = p1;
 	input.p2 = p2;
 	input.maxFraction = 1.0f;
 	
 	b3ShapeRayCastCallback callback;
 	callback.listener = listener;
+	callback.filter = filter;
 	callback.broadPhase = &m_contactMan.m_broadPhase;
 	m_contactMan.m_broadPhase.RayCast(&callback, input);
 }
@@ -388,6 +1077,12 @@ struct b3RayCastSingleShapeCallback
 {
 	float32 Report(const b3RayCastInput& input, u32 proxyId)
 	{
+		if (filter && b3ShouldCollide(*filter, broadPhase->GetFilter(proxyId)) == false)
+		{
+			// Skip the filtered shape.
+			return input.maxFraction;
+		}
+
 		// Get shape associated with the proxy.
 		void* userData = broadPhase->GetUserData(proxyId);
 		b3Shape* shape = (b3Shape*)userData;
@@ -405,6 +1100,9 @@ struct b3RayCastSingleShapeCallback
 				shape0 = shape;
 				output0 = output;
 			}
+
+			// Clip the ray.
+			return output.fraction;
 		}
 
 		// Continue the search from where we stopped.
@@ -413,10 +1111,11 @@ struct b3RayCastSingleShapeCallback
 
 	b3Shape* shape0;
 	b3RayCastOutput output0; 
+	const b3Filter* filter;
 	const b3BroadPhase* broadPhase;
 };
 
-bool b3World::RayCastSingle(b3RayCastSingleOutput* output, const b3Vec3& p1, const b3Vec3& p2) const
+bool b3World::RayCastSingle(b3RayCastSingleOutput* output, const b3Vec3& p1, const b3Vec3& p2, const b3Filter* filter) const
 {
 	b3RayCastInput input;
 	input.p1 = p1;
@@ -426,6 +1125,7 @@ bool b3World::RayCastSingle(b3RayCastSingleOutput* output, const b3Vec3& p1, con
 	b3RayCastSingleShapeCallback callback;
 	callback.shape0 = NULL;
 	callback.output0.fraction = B3_MAX_FLOAT;
+	callback.filter = filter;
 	callback.broadPhase = &m_contactMan.m_broadPhase;
 	
 	// Perform the ray cast.
@@ -449,22 +1149,663 @@ bool b3World::RayCastSingle(b3RayCastSingleOutput* output, const b3Vec3& p1, con
 	return false;
 }
 
+struct b3RayCastPacketCallback
+{
+	void Report(u32 mask, u32 proxyId)
+	{
+		// Get shape associated with the proxy.
+		b3Shape* shape = (b3Shape*)broadPhase->GetUserData(proxyId);
+		const b3Filter& shapeFilter = broadPhase->GetFilter(proxyId);
+
+		for (u32 i = 0; i < packet.count; ++i)
+		{
+			u32 bit = 1 << i;
+			if ((mask & bit) == 0)
+			{
+				continue;
+			}
+
+			const b3Filter* filter = rays[i].filter;
+			if (filter && b3ShouldCollide(*filter, shapeFilter) == false)
+			{
+				// Skip the filtered shape.
+				mask &= ~bit;
+			}
+		}
+
+		if (mask == 0)
+		{
+			return;
+		}
+
+		b3Transform xf = shape->GetBody()->GetTransform();
+
+		if (shape->GetType() == e_meshShape)
+		{
+			// Cast the rays through the mesh tree together.
+			b3MeshShape* meshShape = (b3MeshShape*)shape;
+
+			b3RayCastOutput meshOutputs[B3_MAX_RAY_PACKET];
+			u32 hitMask = meshShape->RayCastPacket(meshOutputs, &packet, mask, xf);
+
+			for (u32 i = 0; i < packet.count; ++i)
+			{
+				if (hitMask & (1 << i))
+				{
+					inputs[i].maxFraction = meshOutputs[i].fraction;
+					shapes[i] = shape;
+					outputs[i] = meshOutputs[i];
+				}
+			}
+
+			return;
+		}
+
+		for (u32 i = 0; i < packet.count; ++i)
+		{
+			if ((mask & (1 << i)) == 0)
+			{
+				continue;
+			}
+
+			// The ray is already clipped to the closest hit so far.
+			b3RayCastOutput output;
+			if (shape->RayCast(&output, inputs[i], xf))
+			{
+				inputs[i].maxFraction = output.fraction;
+				shapes[i] = shape;
+				outputs[i] = output;
+			}
+		}
+	}
+
+	const b3BroadPhase* broadPhase;
+	const b3RayCastBatchInput* rays;
+
+	b3RayCastInput inputs[B3_MAX_RAY_PACKET];
+	b3RayPacket packet;
+	
+	// The closest hits.
+	b3Shape* shapes[B3_MAX_RAY_PACKET];
+	b3RayCastOutput outputs[B3_MAX_RAY_PACKET];
+};
+
+struct b3RayCastBatchContext
+{
+	const b3BroadPhase* broadPhase;
+	const b3RayCastBatchInput* inputs;
+	b3RayCastSingleOutput* outputs;
+	const u32* order;
+	u32 count;
+};
+
+// Cast a range of ray packets.
+static void b3RayCastPackets(void* data, u32 begin, u32 end, u32 threadIndex)
+{
+	B3_NOT_USED(threadIndex);
+
+	b3RayCastBatchContext* context = (b3RayCastBatchContext*)data;
+
+	for (u32 i = begin; i < end; ++i)
+	{
+		u32 first = i * B3_MAX_RAY_PACKET;
+		u32 count = b3Min(context->count - first, u32(B3_MAX_RAY_PACKET));
+		const u32* order = context->order + first;
+
+		b3RayCastPacketCallback callback;
+		callback.broadPhase = context->broadPhase;
+
+		// Gather the rays of this packet.
+		b3RayCastBatchInput rays[B3_MAX_RAY_PACKET];
+		for (u32 j = 0; j < count; ++j)
+		{
+			rays[j] = context->inputs[order[j]];
+
+			callback.inputs[j].p1 = rays[j].p1;
+			callback.inputs[j].p2 = rays[j].p2;
+			callback.inputs[j].maxFraction = 1.0f;
+			callback.shapes[j] = NULL;
+		}
+		
+		callback.rays = rays;
+		callback.packet.Set(callback.inputs, count);
+
+		context->broadPhase->RayCastPacket(&callback, &callback.packet, callback.packet.GetActiveMask());
+
+		// Scatter the closest hits.
+		for (u32 j = 0; j < count; ++j)
+		{
+			b3RayCastSingleOutput* output = context->outputs + order[j];
+
+			output->shape = callback.shapes[j];
+			
+			if (callback.shapes[j])
+			{
+				float32 fraction = callback.outputs[j].fraction;
+
+				output->point = (1.0f - fraction) * rays[j].p1 + fraction * rays[j].p2;
+				output->normal = callback.outputs[j].normal;
+				output->fraction = fraction;
+			}
+		}
+	}
+}
+
+// Spread the lower 9 bits of a value so that there are two zero bits between each bit.
+static u32 b3SpreadBits(u32 x)
+{
+	x &= 0x1FF;
+	x = (x | (x << 16)) & 0x030000FF;
+	x = (x | (x << 8)) & 0x0300F00F;
+	x = (x | (x << 4)) & 0x030C30C3;
+	x = (x | (x << 2)) & 0x09249249;
+	return x;
+}
+
+// Sort a set of keys and their values.
+// This is a least significant digit radix sort with 8-bit digits.
+static void b3SortKeys(u32* keys, u32* values, u32* tempKeys, u32* tempValues, u32 count)
+{
+	u32* srcKeys = keys;
+	u32* srcValues = values;
+	u32* dstKeys = tempKeys;
+	u32* dstValues = tempValues;
+
+	for (u32 digit = 0; digit < 4; ++digit)
+	{
+		u32 shift = 8 * digit;
+
+		u32 offsets[256];
+		memset(offsets, 0, sizeof(offsets));
+
+		for (u32 i = 0; i < count; ++i)
+		{
+			++offsets[(srcKeys[i] >> shift) & 0xFF];
+		}
+
+		// Skip the pass if all keys share this digit.
+		if (offsets[(srcKeys[0] >> shift) & 0xFF] == count)
+		{
+			continue;
+		}
+
+		u32 sum = 0;
+		for (u32 i = 0; i < 256; ++i)
+		{
+			u32 n = offsets[i];
+			offsets[i] = sum;
+			sum += n;
+		}
+
+		for (u32 i = 0; i < count; ++i)
+		{
+			u32 index = offsets[(srcKeys[i] >> shift) & 0xFF]++;
+			dstKeys[index] = srcKeys[i];
+			dstValues[index] = srcValues[i];
+		}
+
+		b3Swap(srcKeys, dstKeys);
+		b3Swap(srcValues, dstValues);
+	}
+
+	if (srcValues != values)
+	{
+		memcpy(values, srcValues, count * sizeof(u32));
+	}
+}
+
+u32 b3World::RayCastBatch(b3RayCastSingleOutput* outputs, const b3RayCastBatchInput* inputs, u32 count) const
+{
+	if (count == 0)
+	{
+		return 0;
+	}
+
+	B3_PROFILE("Ray Cast Batch");
+
+	// Sort the rays by direction octant and then by origin along a Morton curve 
+	// so that the rays of a packet are coherent.
+	b3AABB3 bounds;
+	bounds.m_lower = inputs[0].p1;
+	bounds.m_upper = inputs[0].p1;
+	for (u32 i = 1; i < count; ++i)
+	{
+		bounds.m_lower = b3Min(bounds.m_lower, inputs[i].p1);
+		bounds.m_upper = b3Max(bounds.m_upper, inputs[i].p1);
+	}
+
+	b3Vec3 extents = bounds.m_upper - bounds.m_lower;
+	b3Vec3 scale;
+	for (u32 j = 0; j < 3; ++j)
+	{
+		scale[j] = extents[j] > 0.0f ? 511.0f / extents[j] : 0.0f;
+	}
+
+	u32* keys = (u32*)b3Alloc(4 * count * sizeof(u32));
+	u32* order = keys + count;
+	u32* tempKeys = order + count;
+	u32* tempOrder = tempKeys + count;
+
+	for (u32 i = 0; i < count; ++i)
+	{
+		b3Vec3 d = inputs[i].p2 - inputs[i].p1;
+		u32 octant = (d.x < 0.0f ? 1 : 0) | (d.y < 0.0f ? 2 : 0) | (d.z < 0.0f ? 4 : 0);
+
+		b3Vec3 p = inputs[i].p1 - bounds.m_lower;
+		u32 x = u32(p.x * scale.x);
+		u32 y = u32(p.y * scale.y);
+		u32 z = u32(p.z * scale.z);
+		u32 morton = b3SpreadBits(x) | (b3SpreadBits(y) << 1) | (b3SpreadBits(z) << 2);
+
+		keys[i] = (octant << 27) | morton;
+		order[i] = i;
+	}
+
+	b3SortKeys(keys, order, tempKeys, tempOrder, count);
+
+	b3RayCastBatchContext context;
+	context.broadPhase = &m_contactMan.m_broadPhase;
+	context.inputs = inputs;
+	context.outputs = outputs;
+	context.order = order;
+	context.count = count;
+
+	u32 packetCount = (count + B3_MAX_RAY_PACKET - 1) / B3_MAX_RAY_PACKET;
+
+	m_taskScheduler->ParallelFor(packetCount, 1, b3RayCastPackets, &context);
+
+	b3Free(keys);
+
+	u32 hitCount = 0;
+	for (u32 i = 0; i < count; ++i)
+	{
+		if (outputs[i].shape)
+		{
+			++hitCount;
+		}
+	}
+
+	return hitCount;
+}
+
+// Cast a shape against a child of another shape. 
+// The translation is clipped to a maximum fraction.
+static bool b3ShapeCastChild(b3ShapeCastSingleOutput* output, 
+	const b3Shape* shape1, u32 index1, const b3Transform& xf1,
+	const b3ShapeGJKProxy& proxy2, const b3Transform& xf2, const b3Vec3& translation2, float32 maxFraction)
+{
+	b3ShapeGJKProxy proxy1(shape1, index1);
+
+	b3GJKShapeCastOutput castOutput;
+	bool hit = b3GJKShapeCast(&castOutput, xf1, proxy1, xf2, proxy2, maxFraction * translation2);
+	
+	if (hit)
+	{
+		output->point = castOutput.point;
+		output->normal = castOutput.normal;
+		output->fraction = maxFraction * castOutput.t;
+		return true;
+	}
+
+	if (castOutput.iterations == 0)
+	{
+		// The shapes overlap at the initial transform.
+		output->point = xf2.position;
+		output->normal.SetZero();
+		output->fraction = 0.0f;
+		return true;
+	}
+
+	return false;
+}
+
+struct b3ShapeCastMeshCallback
+{
+	float32 Report(const b3RayCastInput& input, u32 proxyId)
+	{
+		u32 childIndex = mesh->m_mesh->tree.GetUserData(proxyId);
+
+		b3ShapeCastSingleOutput childOutput;
+		if (b3ShapeCastChild(&childOutput, mesh, childIndex, xf1, *proxy2, xf2, translation2, input.maxFraction))
+		{
+			if (childOutput.fraction < output.fraction)
+			{
+				hit = true;
+				output = childOutput;
+			}
+
+			// Clip the translation.
+			return childOutput.fraction;
+		}
+
+		return input.maxFraction;
+	}
+
+	const b3MeshShape* mesh;
+	b3Transform xf1;
+	const b3ShapeGJKProxy* proxy2;
+	b3Transform xf2;
+	b3Vec3 translation2;
+
+	bool hit;
+	b3ShapeCastSingleOutput output;
+};
+
+// Cast a shape against a shape of the world up to a maximum fraction.
+static bool b3ShapeCastShape(b3ShapeCastSingleOutput* output, 
+	const b3Shape* shape1,
+	const b3Shape* shape2, const b3ShapeGJKProxy& proxy2, const b3Transform& xf2, const b3Vec3& translation2, float32 maxFraction)
+{
+	b3Transform xf1 = shape1->GetBody()->GetTransform();
+
+	if (shape1->GetType() != e_meshShape)
+	{
+		return b3ShapeCastChild(output, shape1, 0, xf1, proxy2, xf2, translation2, maxFraction);
+	}
+
+	const b3MeshShape* mesh = (b3MeshShape*)shape1;
+
+	b3ShapeCastMeshCallback callback;
+	callback.mesh = mesh;
+	callback.xf1 = xf1;
+	callback.proxy2 = &proxy2;
+	callback.xf2 = xf2;
+	callback.hit = false;
+	callback.output.fraction = B3_MAX_FLOAT;
+
+	// Sweep the cast shape through the triangles in the mesh's frame of reference.
+	// The AABB is extended by the contact tolerance so touching triangles are found.
+	b3AABB3 aabb;
+	shape2->ComputeAABB(&aabb, b3MulT(xf1, xf2));
+	aabb.Extend(mesh->m_radius + B3_LINEAR_SLOP);
+
+	b3Vec3 translation = maxFraction * b3MulT(xf1.rotation, translation2);
+	
+	// The mesh callback receives fractions of the clipped translation.
+	callback.translation2 = maxFraction * translation2;
+	mesh->m_mesh->tree.AABBCast(&callback, aabb, translation);
+
+	if (callback.hit)
+	{
+		*output = callback.output;
+		output->fraction *= maxFraction;
+		return true;
+	}
+
+	return false;
+}
+
+struct b3ShapeCastCallback
+{
+	float32 Report(const b3RayCastInput& input, u32 proxyId)
+	{
+		if (filter && b3ShouldCollide(*filter, broadPhase->GetFilter(proxyId)) == false)
+		{
+			// Skip the filtered shape.
+			return input.maxFraction;
+		}
+
+		// Get shape associated with the proxy.
+		b3Shape* shape = (b3Shape*)broadPhase->GetUserData(proxyId);
+		if (shape == shape2)
+		{
+			// Skip the cast shape.
+			return input.maxFraction;
+		}
+
+		b3ShapeCastSingleOutput output;
+		if (b3ShapeCastShape(&output, shape, shape2, proxy2, xf2, translation2, input.maxFraction))
+		{
+			if (listener)
+			{
+				// Report the intersection to the user and get the new fraction.
+				return listener->ReportShape(shape, output.point, output.normal, output.fraction);
+			}
+
+			// Track the closest hit.
+			if (output.fraction < output0.fraction)
+			{
+				output0 = output;
+				output0.shape = shape;
+			}
+
+			// Clip the translation.
+			return output.fraction;
+		}
+
+		// Continue search from where we stopped.
+		return input.maxFraction;
+	}
+
+	b3ShapeCastListener* listener;
+	const b3Filter* filter;
+	const b3BroadPhase* broadPhase;
+
+	const b3Shape* shape2;
+	b3ShapeGJKProxy proxy2;
+	b3Transform xf2;
+	b3Vec3 translation2;
+
+	b3ShapeCastSingleOutput output0;
+};
+
+// Mesh tree callback that stops at the first triangle 
+// overlapping the cast shape.
+struct b3ShapeOverlapMeshCallback
+{
+	bool Report(u32 proxyId)
+	{
+		u32 triangleIndex = mesh->m_mesh->tree.GetUserData(proxyId);
+
+		b3ConvexCache cache;
+		cache.simplexCache.count = 0;
+
+		if (b3TestOverlap(xf1, triangleIndex, mesh, xf2, 0, shape2, &cache))
+		{
+			overlap = true;
+
+			// Stop the query.
+			return false;
+		}
+
+		// Keep looking for triangles.
+		return true;
+	}
+
+	const b3MeshShape* mesh;
+	b3Transform xf1;
+	const b3Shape* shape2;
+	b3Transform xf2;
+	bool overlap;
+};
+
+// Test if a shape of the world overlaps the cast shape.
+static bool b3ShapeOverlapShape(const b3Shape* shape1, const b3Shape* shape2, const b3Transform& xf2)
+{
+	b3Transform xf1 = shape1->GetBody()->GetTransform();
+
+	if (shape1->GetType() != e_meshShape)
+	{
+		b3ConvexCache cache;
+		cache.simplexCache.count = 0;
+		
+		return b3TestOverlap(xf1, 0, shape1, xf2, 0, shape2, &cache);
+	}
+
+	const b3MeshShape* mesh = (b3MeshShape*)shape1;
+
+	// Compute the AABB of the cast shape in the reference frame of the mesh.
+	b3AABB3 aabb;
+	shape2->ComputeAABB(&aabb, b3MulT(xf1, xf2));
+	aabb.Extend(mesh->m_radius);
+
+	b3ShapeOverlapMeshCallback callback;
+	callback.mesh = mesh;
+	callback.xf1 = xf1;
+	callback.shape2 = shape2;
+	callback.xf2 = xf2;
+	callback.overlap = false;
+
+	mesh->m_mesh->tree.QueryAABB(&callback, aabb);
+
+	return callback.overlap;
+}
+
+// Broad-phase callback for a shape cast without a translation. 
+// The shapes overlapping the cast shape are hit at the initial transform.
+struct b3ShapeOverlapCallback
+{
+	bool Report(u32 proxyId)
+	{
+		if (filter && b3ShouldCollide(*filter, broadPhase->GetFilter(proxyId)) == false)
+		{
+			// Skip the filtered shape.
+			return true;
+		}
+
+		b3Shape* shape = (b3Shape*)broadPhase->GetUserData(proxyId);
+		if (b3ShapeOverlapShape(shape, shape2, xf2) == false)
+		{
+			return true;
+		}
+
+		b3ShapeCastSingleOutput output;
+		output.shape = shape;
+		output.point = xf2.position;
+		output.normal.SetZero();
+		output.fraction = 0.0f;
+
+		if (listener)
+		{
+			// Continue the query unless the user canceled it.
+			return listener->ReportShape(shape, output.point, output.normal, output.fraction) > 0.0f;
+		}
+
+		// No hit is closer than an overlap.
+		output0 = output;
+		return false;
+	}
+
+	b3ShapeCastListener* listener;
+	const b3Filter* filter;
+	const b3BroadPhase* broadPhase;
+
+	const b3Shape* shape2;
+	b3Transform xf2;
+
+	b3ShapeCastSingleOutput output0;
+};
+
+void b3World::ShapeCast(b3ShapeCastListener* listener, const b3Shape* shape, const b3Transform& xf, const b3Vec3& translation, const b3Filter* filter) const
+{
+	B3_ASSERT(shape->GetType() != e_meshShape);
+
+	b3AABB3 aabb;
+	shape->ComputeAABB(&aabb, xf);
+
+	if (b3Dot(translation, translation) <= B3_EPSILON * B3_EPSILON)
+	{
+		// The shape doesn't move. Report the shapes it overlaps.
+		b3ShapeOverlapCallback callback;
+		callback.listener = listener;
+		callback.filter = filter;
+		callback.broadPhase = &m_contactMan.m_broadPhase;
+		callback.shape2 = shape;
+		callback.xf2 = xf;
+		callback.output0.shape = NULL;
+
+		m_contactMan.m_broadPhase.QueryAABB(&callback, aabb);
+		return;
+	}
+
+	b3ShapeCastCallback callback;
+	callback.listener = listener;
+	callback.filter = filter;
+	callback.broadPhase = &m_contactMan.m_broadPhase;
+	callback.shape2 = shape;
+	callback.proxy2.Set(shape, 0);
+	callback.xf2 = xf;
+	callback.translation2 = translation;
+	callback.output0.shape = NULL;
+
+	m_contactMan.m_broadPhase.AABBCast(&callback, aabb, translation);
+}
+
+bool b3World::ShapeCastSingle(b3ShapeCastSingleOutput* output, const b3Shape* shape, const b3Transform& xf, const b3Vec3& translation, const b3Filter* filter) const
+{
+	B3_ASSERT(shape->GetType() != e_meshShape);
+
+	b3AABB3 aabb;
+	shape->ComputeAABB(&aabb, xf);
+
+	if (b3Dot(translation, translation) <= B3_EPSILON * B3_EPSILON)
+	{
+		// The shape doesn't move. Return the first shape it overlaps.
+		b3ShapeOverlapCallback callback;
+		callback.listener = NULL;
+		callback.filter = filter;
+		callback.broadPhase = &m_contactMan.m_broadPhase;
+		callback.shape2 = shape;
+		callback.xf2 = xf;
+		callback.output0.shape = NULL;
+
+		m_contactMan.m_broadPhase.QueryAABB(&callback, aabb);
+
+		if (callback.output0.shape)
+		{
+			*output = callback.output0;
+			return true;
+		}
+
+		return false;
+	}
+
+	b3ShapeCastCallback callback;
+	callback.listener = NULL;
+	callback.filter = filter;
+	callback.broadPhase = &m_contactMan.m_broadPhase;
+	callback.shape2 = shape;
+	callback.proxy2.Set(shape, 0);
+	callback.xf2 = xf;
+	callback.translation2 = translation;
+	callback.output0.shape = NULL;
+	callback.output0.fraction = B3_MAX_FLOAT;
+
+	m_contactMan.m_broadPhase.AABBCast(&callback, aabb, translation);
+
+	if (callback.output0.shape)
+	{
+		*output = callback.output0;
+		return true;
+	}
+
+	return false;
+}
+
 struct b3QueryAABBCallback
 {
 	bool Report(u32 proxyID)
 	{
+		if (filter && b3ShouldCollide(*filter, broadPhase->GetFilter(proxyID)) == false)
+		{
+			// Skip the filtered shape.
+			return true;
+		}
+
 		b3Shape* shape = (b3Shape*)broadPhase->GetUserData(proxyID);
 		return listener->ReportShape(shape);
 	}
 
 	b3QueryListener* listener;
+	const b3Filter* filter;
 	const b3BroadPhase* broadPhase;
 };
 
-void b3World::QueryAABB(b3QueryListener* listener, const b3AABB3& aabb) const
+void b3World::QueryAABB(b3QueryListener* listener, const b3AABB3& aabb, const b3Filter* filter) const
 {
 	b3QueryAABBCallback callback;
 	callback.listener = listener;
+	callback.filter = filter;
 	callback.broadPhase = &m_contactMan.m_broadPhase;
 	m_contactMan.m_broadPhase.QueryAABB(&callback, aabb);
 }
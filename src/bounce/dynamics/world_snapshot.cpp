@@ -0,0 +1,660 @@
+/*
+* Copyright (c) 2016-2019 Irlan Robson https://irlanrobson.github.io
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <bounce/dynamics/world.h>
+#include <bounce/dynamics/body.h>
+#include <bounce/dynamics/shapes/shape.h>
+#include <bounce/dynamics/contacts/convex_contact.h>
+#include <bounce/dynamics/contacts/mesh_contact.h>
+#include <bounce/dynamics/contacts/sensor_pair.h>
+#include <bounce/dynamics/joints/joint.h>
+#include <bounce/common/memory/snapshot.h>
+
+// The snapshot refers to contacts and islands by the addresses they had 
+// when it was saved. This maps these addresses to the restored objects.
+struct b3SnapshotMap
+{
+	void Create(b3StackAllocator* allocator, u32 count)
+	{
+		m_allocator = allocator;
+		
+		m_capacity = 16;
+		while (m_capacity < 2 * count)
+		{
+			m_capacity *= 2;
+		}
+
+		m_keys = (const void**)m_allocator->Allocate(m_capacity * sizeof(const void*));
+		m_values = (void**)m_allocator->Allocate(m_capacity * sizeof(void*));
+		for (u32 i = 0; i < m_capacity; ++i)
+		{
+			m_keys[i] = NULL;
+		}
+	}
+
+	void Destroy()
+	{
+		m_allocator->Free(m_values);
+		m_allocator->Free(m_keys);
+	}
+
+	u32 Hash(const void* key) const
+	{
+		u64 x = (u64)(size_t)key;
+		x ^= x >> 33;
+		x *= 0xff51afd7ed558ccdull;
+		x ^= x >> 33;
+		return u32(x) & (m_capacity - 1);
+	}
+
+	void Insert(const void* key, void* value)
+	{
+		B3_ASSERT(key != NULL);
+		u32 i = Hash(key);
+		while (m_keys[i] != NULL)
+		{
+			B3_ASSERT(m_keys[i] != key);
+			i = (i + 1) & (m_capacity - 1);
+		}
+		m_keys[i] = key;
+		m_values[i] = value;
+	}
+
+	void* Find(const void* key) const
+	{
+		if (key == NULL)
+		{
+			return NULL;
+		}
+
+		u32 i = Hash(key);
+		while (m_keys[i] != key)
+		{
+			B3_ASSERT(m_keys[i] != NULL);
+			i = (i + 1) & (m_capacity - 1);
+		}
+		return m_values[i];
+	}
+
+	b3StackAllocator* m_allocator;
+	const void** m_keys;
+	void** m_values;
+	u32 m_capacity;
+};
+
+void b3World::SaveSnapshot(b3Snapshot* snapshot) const
+{
+	B3_PROFILE("Save Snapshot");
+
+	snapshot->Clear();
+
+	// Header
+	snapshot->Write(m_bodyList.m_count);
+	snapshot->Write(m_jointMan.m_jointList.m_count);
+	snapshot->Write(m_flags);
+
+	// Bodies
+	for (b3Body* b = m_bodyList.m_head; b; b = b->m_next)
+	{
+		snapshot->Write(b->m_flags);
+		snapshot->Write(b->m_sleepTime);
+	}
+
+	u32 storeCount = m_bodyStore.m_count;
+	snapshot->Write(m_bodyStore.m_sweeps, storeCount * sizeof(b3Sweep));
+	snapshot->Write(m_bodyStore.m_transforms, storeCount * sizeof(b3Transform));
+	snapshot->Write(m_bodyStore.m_linearVelocities, storeCount * sizeof(b3Vec3));
+	snapshot->Write(m_bodyStore.m_angularVelocities, storeCount * sizeof(b3Vec3));
+	snapshot->Write(m_bodyStore.m_worldInvInertias, storeCount * sizeof(b3Mat33));
+	snapshot->Write(m_bodyStore.m_forces, storeCount * sizeof(b3Vec3));
+	snapshot->Write(m_bodyStore.m_torques, storeCount * sizeof(b3Vec3));
+
+	// Broad-phase
+	m_contactMan.m_broadPhase.WriteSnapshot(snapshot);
+
+	// Contacts
+	snapshot->Write(m_contactMan.m_contactList.m_count);
+	for (b3Contact* c = m_contactMan.m_contactList.m_head; c; c = c->m_next)
+	{
+		snapshot->Write(c);
+		snapshot->Write(c->m_pair.shapeA);
+		snapshot->Write(c->m_pair.shapeB);
+		snapshot->Write(c->Flags());
+		snapshot->Write(c->m_toi);
+		snapshot->Write(c->ManifoldCount());
+		snapshot->Write(c->Manifolds(), c->ManifoldCount() * sizeof(b3Manifold));
+
+		if (c->m_type == e_convexContact)
+		{
+			b3ConvexContact* cc = (b3ConvexContact*)c;
+			snapshot->Write(cc->Cache());
+		}
+		else
+		{
+			b3MeshContact* mc = (b3MeshContact*)c;
+			snapshot->Write(mc->m_aabbMoved);
+			snapshot->Write(mc->m_aabbA);
+			snapshot->Write(mc->m_triangleCount);
+			snapshot->Write(mc->m_triangles, mc->m_triangleCount * sizeof(b3TriangleCache));
+		}
+	}
+
+	// Contact edges. Their order is the order pairs are found in.
+	for (b3Body* b = m_bodyList.m_head; b; b = b->m_next)
+	{
+		for (b3Shape* s = b->m_shapeList.m_head; s; s = s->m_next)
+		{
+			snapshot->Write(s->m_contactEdges.m_count);
+			for (b3ContactEdge* ce = s->m_contactEdges.m_head; ce; ce = ce->m_next)
+			{
+				b3Contact* c = ce->contact;
+				bool edgeA = ce == &c->m_pair.edgeA;
+				snapshot->Write(c);
+				snapshot->Write(edgeA);
+			}
+		}
+	}
+
+	// Contact stores. The active contacts are at the front.
+	const b3ContactStore* stores[2] = { &m_contactMan.m_convexStore, &m_contactMan.m_meshStore };
+	for (u32 i = 0; i < 2; ++i)
+	{
+		const b3ContactStore* store = stores[i];
+		snapshot->Write(store->GetCount());
+		snapshot->Write(store->GetActiveCount());
+		for (u32 j = 0; j < store->GetCount(); ++j)
+		{
+			snapshot->Write(store->m_contacts[j]);
+		}
+	}
+
+	// Mesh contacts
+	snapshot->Write(m_contactMan.m_meshContactList.m_count);
+	for (b3MeshContactLink* l = m_contactMan.m_meshContactList.m_head; l; l = l->m_next)
+	{
+		snapshot->Write(l->m_c);
+	}
+
+	// Sensor pairs
+	snapshot->Write(m_contactMan.m_sensorList.m_count);
+	for (b3SensorPair* p = m_contactMan.m_sensorList.m_head; p; p = p->m_next)
+	{
+		snapshot->Write(p);
+		snapshot->Write(p->shapeA);
+		snapshot->Write(p->shapeB);
+		snapshot->Write(p->flags);
+		snapshot->Write(p->cache);
+	}
+
+	// Sensor edges
+	for (b3Body* b = m_bodyList.m_head; b; b = b->m_next)
+	{
+		for (b3Shape* s = b->m_shapeList.m_head; s; s = s->m_next)
+		{
+			snapshot->Write(s->m_sensorEdges.m_count);
+			for (b3SensorEdge* se = s->m_sensorEdges.m_head; se; se = se->m_next)
+			{
+				b3SensorPair* p = se->pair;
+				bool edgeA = se == &p->edgeA;
+				snapshot->Write(p);
+				snapshot->Write(edgeA);
+			}
+		}
+	}
+
+	// Dirty sensor pairs
+	snapshot->Write(m_contactMan.m_dirtySensors.Count());
+	for (u32 i = 0; i < m_contactMan.m_dirtySensors.Count(); ++i)
+	{
+		snapshot->Write(m_contactMan.m_dirtySensors[i]);
+	}
+
+	// Islands
+	const b3List2<b3PersistentIsland>* islandLists[2] = { &m_islandMan.m_awakeList, &m_islandMan.m_sleepingList };
+	snapshot->Write(islandLists[0]->m_count);
+	snapshot->Write(islandLists[1]->m_count);
+	for (u32 i = 0; i < 2; ++i)
+	{
+		for (b3PersistentIsland* island = islandLists[i]->m_head; island; island = island->m_next)
+		{
+			snapshot->Write(island);
+			snapshot->Write(island->parent);
+			snapshot->Write(island->constraintRemoveCount);
+
+			snapshot->Write(island->bodyCount);
+			for (b3Body* b = island->bodyHead; b; b = b->m_islandNext)
+			{
+				snapshot->Write(b);
+			}
+
+			snapshot->Write(island->contactCount);
+			for (b3Contact* c = island->contactHead; c; c = c->m_islandNext)
+			{
+				snapshot->Write(c);
+			}
+
+			snapshot->Write(island->jointCount);
+			for (b3Joint* j = island->jointHead; j; j = j->m_islandNext)
+			{
+				snapshot->Write(j);
+			}
+		}
+	}
+	snapshot->Write(m_islandMan.m_linkCount);
+
+	// Joints
+	for (b3Joint* j = m_jointMan.m_jointList.m_head; j; j = j->m_next)
+	{
+		snapshot->Write(j->m_flags);
+		j->WriteSnapshot(snapshot);
+	}
+}
+
+void b3World::RestoreSnapshot(const b3Snapshot& snapshot)
+{
+	B3_PROFILE("Restore Snapshot");
+
+	b3SnapshotReader reader(snapshot);
+
+	// Header
+	u32 bodyCount = reader.Read<u32>();
+	u32 jointCount = reader.Read<u32>();
+	B3_ASSERT(bodyCount == m_bodyList.m_count);
+	B3_ASSERT(jointCount == m_jointMan.m_jointList.m_count);
+	B3_NOT_USED(bodyCount);
+	B3_NOT_USED(jointCount);
+	reader.Read(m_flags);
+
+	// Bodies
+	for (b3Body* b = m_bodyList.m_head; b; b = b->m_next)
+	{
+		reader.Read(b->m_flags);
+		reader.Read(b->m_sleepTime);
+	}
+
+	u32 storeCount = m_bodyStore.m_count;
+	reader.Read(m_bodyStore.m_sweeps, storeCount * sizeof(b3Sweep));
+	reader.Read(m_bodyStore.m_transforms, storeCount * sizeof(b3Transform));
+	reader.Read(m_bodyStore.m_linearVelocities, storeCount * sizeof(b3Vec3));
+	reader.Read(m_bodyStore.m_angularVelocities, storeCount * sizeof(b3Vec3));
+	reader.Read(m_bodyStore.m_worldInvInertias, storeCount * sizeof(b3Mat33));
+	reader.Read(m_bodyStore.m_forces, storeCount * sizeof(b3Vec3));
+	reader.Read(m_bodyStore.m_torques, storeCount * sizeof(b3Vec3));
+
+	// Broad-phase
+	m_contactMan.m_broadPhase.ReadSnapshot(&reader);
+
+	// Contacts. 
+	// Reuse the existing contact between the same shapes if possible. 
+	// Mark the existing contacts so the ones that weren't reused can be freed.
+	for (b3Contact* c = m_contactMan.m_contactList.m_head; c; c = c->m_next)
+	{
+		c->Flags() = B3_MAX_U32;
+	}
+
+	u32 contactCount = reader.Read<u32>();
+	b3Contact** contacts = (b3Contact**)m_stackAllocator.Allocate(contactCount * sizeof(b3Contact*));
+	b3SnapshotMap contactMap;
+	contactMap.Create(&m_stackAllocator, contactCount);
+	for (u32 i = 0; i < contactCount; ++i)
+	{
+		const void* key = reader.Read<const void*>();
+		b3Shape* shapeA = reader.Read<b3Shape*>();
+		b3Shape* shapeB = reader.Read<b3Shape*>();
+
+		b3Contact* c = NULL;
+		for (b3ContactEdge* ce = shapeA->m_contactEdges.m_head; ce; ce = ce->m_next)
+		{
+			b3Contact* ec = ce->contact;
+			if (ec->Flags() == B3_MAX_U32 && ec->m_pair.shapeA == shapeA && ec->m_pair.shapeB == shapeB)
+			{
+				c = ec;
+				break;
+			}
+		}
+
+		if (c == NULL)
+		{
+			c = m_contactMan.Create(shapeA, shapeB);
+			B3_ASSERT(c != NULL);
+			B3_ASSERT(c->m_pair.shapeA == shapeA && c->m_pair.shapeB == shapeB);
+
+			c->m_pair.edgeA.contact = c;
+			c->m_pair.edgeA.other = shapeB;
+			c->m_pair.edgeB.contact = c;
+			c->m_pair.edgeB.other = shapeA;
+
+			if (c->m_type == e_meshContact)
+			{
+				b3MeshContact* mc = (b3MeshContact*)c;
+				mc->m_link.m_c = mc;
+			}
+		}
+
+		reader.Read(c->Flags());
+		reader.Read(c->m_toi);
+		reader.Read(c->ManifoldCount());
+		B3_ASSERT(c->ManifoldCount() <= c->GetManifoldCapacity());
+		reader.Read(c->Manifolds(), c->ManifoldCount() * sizeof(b3Manifold));
+
+		if (c->m_type == e_convexContact)
+		{
+			b3ConvexContact* cc = (b3ConvexContact*)c;
+			reader.Read(cc->Cache());
+		}
+		else
+		{
+			b3MeshContact* mc = (b3MeshContact*)c;
+			reader.Read(mc->m_aabbMoved);
+			reader.Read(mc->m_aabbA);
+			reader.Read(mc->m_triangleCount);
+			if (mc->m_triangleCount > mc->m_triangleCapacity)
+			{
+				b3Free(mc->m_triangles);
+				while (mc->m_triangleCapacity < mc->m_triangleCount)
+				{
+					mc->m_triangleCapacity *= 2;
+				}
+				mc->m_triangles = (b3TriangleCache*)b3Alloc(mc->m_triangleCapacity * sizeof(b3TriangleCache));
+			}
+			reader.Read(mc->m_triangles, mc->m_triangleCount * sizeof(b3TriangleCache));
+		}
+
+		c->m_island = NULL;
+
+		contacts[i] = c;
+		contactMap.Insert(key, c);
+	}
+
+	// Free the contacts that weren't in the snapshot.
+	b3Contact* c = m_contactMan.m_contactList.m_head;
+	while (c)
+	{
+		b3Contact* next = c->m_next;
+		
+		if (c->Flags() == B3_MAX_U32)
+		{
+			m_contactMan.m_pairSet.Remove(c->m_pair.shapeA->m_broadPhaseID, c->m_pair.shapeB->m_broadPhaseID);
+
+			if (c->IsActive())
+			{
+				m_contactMan.DeactivateContact(c);
+			}
+
+			c->m_store->Remove(c->m_storeIndex);
+
+			if (c->m_type == e_convexContact)
+			{
+				b3ConvexContact* cc = (b3ConvexContact*)c;
+				cc->~b3ConvexContact();
+				m_contactMan.m_convexBlocks.Free(cc);
+			}
+			else
+			{
+				b3MeshContact* mc = (b3MeshContact*)c;
+				mc->~b3MeshContact();
+				m_contactMan.m_meshBlocks.Free(mc);
+			}
+		}
+
+		c = next;
+	}
+
+	// Rebuild the contact list.
+	m_contactMan.m_contactList.m_head = NULL;
+	m_contactMan.m_contactList.m_count = 0;
+	for (u32 i = contactCount; i > 0; --i)
+	{
+		m_contactMan.m_contactList.PushFront(contacts[i - 1]);
+	}
+
+	// Rebuild the contact edge lists.
+	b3ContactEdge** edges = (b3ContactEdge**)m_stackAllocator.Allocate(2 * contactCount * sizeof(b3ContactEdge*));
+	for (b3Body* b = m_bodyList.m_head; b; b = b->m_next)
+	{
+		for (b3Shape* s = b->m_shapeList.m_head; s; s = s->m_next)
+		{
+			u32 edgeCount = reader.Read<u32>();
+			B3_ASSERT(edgeCount <= 2 * contactCount);
+			for (u32 i = 0; i < edgeCount; ++i)
+			{
+				b3Contact* ec = (b3Contact*)contactMap.Find(reader.Read<const void*>());
+				bool edgeA = reader.Read<bool>();
+				edges[i] = edgeA ? &ec->m_pair.edgeA : &ec->m_pair.edgeB;
+			}
+
+			s->m_contactEdges.m_head = NULL;
+			s->m_contactEdges.m_count = 0;
+			for (u32 i = edgeCount; i > 0; --i)
+			{
+				s->m_contactEdges.PushFront(edges[i - 1]);
+			}
+		}
+	}
+	m_stackAllocator.Free(edges);
+
+	// Restore the order of the contact stores.
+	b3ContactStore* stores[2] = { &m_contactMan.m_convexStore, &m_contactMan.m_meshStore };
+	for (u32 i = 0; i < 2; ++i)
+	{
+		b3ContactStore* store = stores[i];
+		u32 storeContactCount = reader.Read<u32>();
+		u32 activeCount = reader.Read<u32>();
+		B3_ASSERT(storeContactCount == store->GetCount());
+		B3_NOT_USED(storeContactCount);
+		for (u32 j = 0; j < store->GetCount(); ++j)
+		{
+			b3Contact* sc = (b3Contact*)contactMap.Find(reader.Read<const void*>());
+			store->Swap(j, sc->m_storeIndex);
+		}
+		store->m_activeCount = activeCount;
+	}
+
+	// Rebuild the mesh contact list.
+	u32 meshCount = reader.Read<u32>();
+	for (u32 i = 0; i < meshCount; ++i)
+	{
+		contacts[i] = (b3Contact*)contactMap.Find(reader.Read<const void*>());
+	}
+
+	m_contactMan.m_meshContactList.m_head = NULL;
+	m_contactMan.m_meshContactList.m_count = 0;
+	for (u32 i = meshCount; i > 0; --i)
+	{
+		b3MeshContact* mc = (b3MeshContact*)contacts[i - 1];
+		m_contactMan.m_meshContactList.PushFront(&mc->m_link);
+	}
+
+	// Sensor pairs. 
+	// They are cheap to create, so free the current ones and recreate the saved ones.
+	while (m_contactMan.m_sensorList.m_head)
+	{
+		b3SensorPair* p = m_contactMan.m_sensorList.m_head;
+		m_contactMan.m_pairSet.Remove(p->shapeA->m_broadPhaseID, p->shapeB->m_broadPhaseID);
+		m_contactMan.m_sensorList.Remove(p);
+		m_contactMan.m_sensorBlocks.Free(p);
+	}
+
+	u32 sensorCount = reader.Read<u32>();
+	b3SensorPair** sensors = (b3SensorPair**)m_stackAllocator.Allocate(sensorCount * sizeof(b3SensorPair*));
+	b3SnapshotMap sensorMap;
+	sensorMap.Create(&m_stackAllocator, sensorCount);
+	for (u32 i = 0; i < sensorCount; ++i)
+	{
+		const void* key = reader.Read<const void*>();
+
+		b3SensorPair* p = (b3SensorPair*)m_contactMan.m_sensorBlocks.Allocate();
+		reader.Read(p->shapeA);
+		reader.Read(p->shapeB);
+		reader.Read(p->flags);
+		reader.Read(p->cache);
+		p->dirtyIndex = B3_MAX_U32;
+		p->edgeA.pair = p;
+		p->edgeA.other = p->shapeB;
+		p->edgeB.pair = p;
+		p->edgeB.other = p->shapeA;
+
+		m_contactMan.m_pairSet.Add(p->shapeA->m_broadPhaseID, p->shapeB->m_broadPhaseID);
+
+		sensors[i] = p;
+		sensorMap.Insert(key, p);
+	}
+
+	m_contactMan.m_sensorList.m_head = NULL;
+	m_contactMan.m_sensorList.m_count = 0;
+	for (u32 i = sensorCount; i > 0; --i)
+	{
+		m_contactMan.m_sensorList.PushFront(sensors[i - 1]);
+	}
+
+	// Rebuild the sensor edge lists.
+	b3SensorEdge** sensorEdges = (b3SensorEdge**)m_stackAllocator.Allocate(2 * sensorCount * sizeof(b3SensorEdge*));
+	for (b3Body* b = m_bodyList.m_head; b; b = b->m_next)
+	{
+		for (b3Shape* s = b->m_shapeList.m_head; s; s = s->m_next)
+		{
+			u32 edgeCount = reader.Read<u32>();
+			B3_ASSERT(edgeCount <= 2 * sensorCount);
+			for (u32 i = 0; i < edgeCount; ++i)
+			{
+				b3SensorPair* p = (b3SensorPair*)sensorMap.Find(reader.Read<const void*>());
+				bool edgeA = reader.Read<bool>();
+				sensorEdges[i] = edgeA ? &p->edgeA : &p->edgeB;
+			}
+
+			s->m_sensorEdges.m_head = NULL;
+			s->m_sensorEdges.m_count = 0;
+			for (u32 i = edgeCount; i > 0; --i)
+			{
+				s->m_sensorEdges.PushFront(sensorEdges[i - 1]);
+			}
+		}
+	}
+	m_stackAllocator.Free(sensorEdges);
+
+	// Rebuild the dirty sensor pair array.
+	u32 dirtyCount = reader.Read<u32>();
+	m_contactMan.m_dirtySensors.Resize(dirtyCount);
+	for (u32 i = 0; i < dirtyCount; ++i)
+	{
+		b3SensorPair* p = (b3SensorPair*)sensorMap.Find(reader.Read<const void*>());
+		p->dirtyIndex = i;
+		m_contactMan.m_dirtySensors[i] = p;
+	}
+
+	sensorMap.Destroy();
+	m_stackAllocator.Free(sensors);
+
+	// Islands. 
+	// Free the current islands and recreate the saved ones.
+	b3List2<b3PersistentIsland>* islandLists[2] = { &m_islandMan.m_awakeList, &m_islandMan.m_sleepingList };
+	for (u32 i = 0; i < 2; ++i)
+	{
+		while (islandLists[i]->m_head)
+		{
+			m_islandMan.DestroyIsland(islandLists[i]->m_head);
+		}
+	}
+
+	for (b3Body* b = m_bodyList.m_head; b; b = b->m_next)
+	{
+		b->m_island = NULL;
+	}
+
+	for (b3Joint* j = m_jointMan.m_jointList.m_head; j; j = j->m_next)
+	{
+		j->m_island = NULL;
+	}
+
+	u32 islandCounts[2];
+	reader.Read(islandCounts[0]);
+	reader.Read(islandCounts[1]);
+
+	u32 islandCount = 0;
+	b3PersistentIsland** islands = (b3PersistentIsland**)m_stackAllocator.Allocate((islandCounts[0] + islandCounts[1]) * sizeof(b3PersistentIsland*));
+	b3SnapshotMap islandMap;
+	islandMap.Create(&m_stackAllocator, islandCounts[0] + islandCounts[1]);
+	for (u32 i = 0; i < 2; ++i)
+	{
+		for (u32 j = 0; j < islandCounts[i]; ++j)
+		{
+			const void* key = reader.Read<const void*>();
+
+			b3PersistentIsland* island = m_islandMan.CreateIsland(i == 0);
+			
+			// The parent is mapped after all the islands are created.
+			reader.Read(island->parent);
+			reader.Read(island->constraintRemoveCount);
+
+			u32 count = reader.Read<u32>();
+			for (u32 k = 0; k < count; ++k)
+			{
+				m_islandMan.PushBody(island, reader.Read<b3Body*>());
+			}
+
+			count = reader.Read<u32>();
+			for (u32 k = 0; k < count; ++k)
+			{
+				b3Contact* ic = (b3Contact*)contactMap.Find(reader.Read<const void*>());
+				m_islandMan.PushContact(island, ic);
+			}
+
+			count = reader.Read<u32>();
+			for (u32 k = 0; k < count; ++k)
+			{
+				m_islandMan.PushJoint(island, reader.Read<b3Joint*>());
+			}
+
+			islands[islandCount++] = island;
+			islandMap.Insert(key, island);
+		}
+	}
+	reader.Read(m_islandMan.m_linkCount);
+
+	for (u32 i = 0; i < islandCount; ++i)
+	{
+		islands[i]->parent = (b3PersistentIsland*)islandMap.Find(islands[i]->parent);
+	}
+
+	// Islands were pushed to the front of their lists. Restore their order.
+	u32 islandBase = 0;
+	for (u32 i = 0; i < 2; ++i)
+	{
+		islandLists[i]->m_head = NULL;
+		islandLists[i]->m_count = 0;
+		for (u32 j = islandCounts[i]; j > 0; --j)
+		{
+			islandLists[i]->PushFront(islands[islandBase + j - 1]);
+		}
+		islandBase += islandCounts[i];
+	}
+
+	islandMap.Destroy();
+	m_stackAllocator.Free(islands);
+	contactMap.Destroy();
+	m_stackAllocator.Free(contacts);
+
+	// Joints
+	for (b3Joint* j = m_jointMan.m_jointList.m_head; j; j = j->m_next)
+	{
+		reader.Read(j->m_flags);
+		j->ReadSnapshot(&reader);
+	}
+
+	B3_ASSERT(reader.IsAtEnd());
+}
@@ -69,13 +69,13 @@ void b3SoftBodyContactSolver::InitializeBodyContactConstraints()
 		pc->invMassB = vc->bodyB->m_invMass;
 
 		pc->invIA.SetZero();
-		pc->invIB = vc->bodyB->m_worldInvI;
+		pc->invIB = vc->bodyB->WorldInvI();
 
 		pc->radiusA = c->m_n1->m_radius;
 		pc->radiusB = c->m_s2->m_radius;
 
 		pc->localCenterA.SetZero();
-		pc->localCenterB = pc->bodyB->m_sweep.localCenter;
+		pc->localCenterB = pc->bodyB->Sweep().localCenter;
 
 		pc->normalA = c->m_normal1;
 		pc->localPointA = c->m_localPoint1;
@@ -98,10 +98,10 @@ void b3SoftBodyContactSolver::InitializeBodyContactConstraints()
 		b3Mat33 iB = vc->invIB;
 
 		b3Vec3 xA = m_positions[indexA];
-		b3Vec3 xB = bodyB->m_sweep.worldCenter;
+		b3Vec3 xB = bodyB->Sweep().worldCenter;
 
 		b3Quat qA; qA.SetIdentity();
-		b3Quat qB = bodyB->m_sweep.orientation;
+		b3Quat qB = bodyB->Sweep().orientation;
 
 		b3Vec3 localCenterA = pc->localCenterA;
 		b3Vec3 localCenterB = pc->localCenterB;
@@ -358,8 +358,8 @@ bool b3SoftBodyContactSolver::SolveBodyContactPositionConstraints()
 		b3Vec3 cA = m_positions[indexA];
 		b3Quat qA; qA.SetIdentity();
 
-		b3Vec3 cB = bodyB->m_sweep.worldCenter;
-		b3Quat qB = bodyB->m_sweep.orientation;
+		b3Vec3 cB = bodyB->Sweep().worldCenter;
+		b3Quat qB = bodyB->Sweep().orientation;
 
 		// Solve normal constraint
 		b3Transform xfA;
@@ -405,8 +405,8 @@ bool b3SoftBodyContactSolver::SolveBodyContactPositionConstraints()
 
 		m_positions[indexA] = cA;
 
-		bodyB->m_sweep.worldCenter = cB;
-		bodyB->m_sweep.orientation = qB;
+		bodyB->Sweep().worldCenter = cB;
+		bodyB->Sweep().orientation = qB;
 	}
 
 	return minSeparation >= -3.0f * B3_LINEAR_SLOP;
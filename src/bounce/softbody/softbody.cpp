@@ -451,7 +451,9 @@ b3SoftBody::b3SoftBody(const b3SoftBodyDef& def)
 	m_mesh = def.mesh;
 	m_density = def.density;
 	m_gravity.SetZero();
+	m_solverIterations = 0;
 	m_world = nullptr;
+	m_taskScheduler = nullptr;
 	m_contactManager.m_body = this;
 
 	const b3SoftBodyMesh* m = m_mesh;
@@ -519,6 +521,9 @@ b3SoftBody::b3SoftBody(const b3SoftBodyDef& def)
 
 		e->invE = b3Inverse(E);
 
+		// The rotation extraction starts from the rotation of the last step.
+		e->q.SetIdentity();
+
 		// 6 x 6
 		float32 D[36];
 		b3ComputeD(D, e->E, e->nu);
@@ -31,9 +31,6 @@
 // In order to support velocity constraints on node velocities 
 // we solve Ax = b using a Modified Preconditioned Conjugate Gradient (MPCG) algorithm.
 
-// Number of MPCG iterations, a value that is normally small when small time steps are taken.
-u32 b3_softBodySolverIterations = 0;
-
 // Enables the stiffness warping solver.
 bool b3_enableStiffnessWarping = true;
 
@@ -41,6 +38,7 @@ b3SoftBodyForceSolver::b3SoftBodyForceSolver(const b3SoftBodyForceSolverDef& def
 {
 	m_body = def.body;
 	m_allocator = &m_body->m_stackAllocator;
+	m_scheduler = m_body->m_taskScheduler;
 	m_mesh = m_body->m_mesh;
 	m_nodes = m_body->m_nodes;
 	m_elements = m_body->m_elements;
@@ -88,10 +86,11 @@ static void b3ExtractRotation(b3Mat33& out, b3Quat& q, const b3Mat33& A, u32 max
 	out = b3QuatMat33(q);
 }
 
-// Solve A * x = b
-static void b3SolveMPCG(b3DenseVec3& x,
+// Solve A * x = b and return the number of iterations.
+static u32 b3SolveMPCG(b3DenseVec3& x,
 	const b3SparseMat33View& A, const b3DenseVec3& b,
-	const b3DenseVec3& z, const b3DiagMat33& S, u32 maxIterations = 20)
+	const b3DenseVec3& z, const b3DiagMat33& S, 
+	b3TaskScheduler* scheduler, u32 maxIterations = 20)
 {
 	B3_PROFILE("Soft Body Solve MPCG");
 
@@ -128,6 +127,8 @@ static void b3SolveMPCG(b3DenseVec3& x,
 
 	float32 delta_new = b3Dot(r, c);
 
+	b3DenseVec3 Ac(A.rowCount);
+
 	u32 iteration = 0;
 	for (;;)
 	{
@@ -141,7 +142,9 @@ static void b3SolveMPCG(b3DenseVec3& x,
 			break;
 		}
 
-		b3DenseVec3 q = S * (A * c);
+		b3Mul(Ac, A, c, scheduler);
+
+		b3DenseVec3 q = S * Ac;
 
 		float32 alpha = delta_new / b3Dot(c, q);
 
@@ -161,7 +164,7 @@ static void b3SolveMPCG(b3DenseVec3& x,
 		++iteration;
 	}
 
-	b3_softBodySolverIterations = iteration;
+	return iteration;
 }
 
 // C = A * B
@@ -386,7 +389,7 @@ void b3SoftBodyForceSolver::Solve(float32 dt, const b3Vec3& gravity)
 	b3DenseVec3 b = M * v - h * (K * p + f0 - (f_plastic + fe));
 
 	b3DenseVec3 sx(m_mesh->vertexCount);
-	b3SolveMPCG(sx, viewA, b, z, S);
+	m_body->m_solverIterations = b3SolveMPCG(sx, viewA, b, z, S, m_scheduler);
 
 	// Copy velocity back to the particle
 	for (u32 i = 0; i < m_mesh->vertexCount; ++i)
@@ -137,7 +137,7 @@ void b3SoftBodySolver::Solve(float32 dt, const b3Vec3& gravity, u32 velocityIter
 
 			body->SynchronizeTransform();
 
-			body->m_worldInvI = b3RotateToFrame(body->m_invI, body->m_xf.rotation);
+			body->WorldInvI() = b3RotateToFrame(body->m_invI, body->Transform().rotation);
 
 			body->SynchronizeShapes();
 		}